@@ -380,7 +380,8 @@ void bgp_addpath_set_peer_type(struct peer *peer, afi_t afi, safi_t safi,
 	enum bgp_addpath_strat old_type;
 	struct listnode *node, *nnode;
 	struct peer *tmp_peer;
-	struct peer_group *group;
+	struct peer_group *group = NULL;
+	struct list *members = NULL;
 
 	if (safi == SAFI_LABELED_UNICAST)
 		safi = SAFI_UNICAST;
@@ -399,6 +400,34 @@ void bgp_addpath_set_peer_type(struct peer *peer, afi_t afi, safi_t safi,
 
 	peer->addpath_type[afi][safi] = addpath_type;
 
+	/*
+	 * Switch every group member that followed the group's old strategy
+	 * before recounting, so a group with N members costs one recount
+	 * rather than N of them.
+	 */
+	if (CHECK_FLAG(peer->sflags, PEER_STATUS_GROUP)) {
+		group = peer->group;
+
+		/* group will be null as peer_group_delete calls peer_delete on
+		 * group->conf. That peer_delete will eventuallly end up here
+		 * if the group was configured to tx addpaths.
+		 */
+		if (group != NULL) {
+			members = list_new();
+			for (ALL_LIST_ELEMENTS(group->peer, node, nnode,
+			     tmp_peer)) {
+				if (tmp_peer->addpath_type[afi][safi] !=
+				    old_type)
+					continue;
+
+				tmp_peer->addpath_best_selected[afi][safi] =
+					paths;
+				tmp_peer->addpath_type[afi][safi] = addpath_type;
+				listnode_add(members, tmp_peer);
+			}
+		}
+	}
+
 	bgp_addpath_type_changed(bgp);
 
 	if (addpath_type != BGP_ADDPATH_NONE) {
@@ -420,22 +449,14 @@ void bgp_addpath_set_peer_type(struct peer *peer, afi_t afi, safi_t safi,
 		  peer);
 
 	if (CHECK_FLAG(peer->sflags, PEER_STATUS_GROUP)) {
-		group = peer->group;
-
-		/* group will be null as peer_group_delete calls peer_delete on
-		 * group->conf. That peer_delete will eventuallly end up here
-		 * if the group was configured to tx addpaths.
-		 */
-		if (group != NULL) {
-			for (ALL_LIST_ELEMENTS(group->peer, node, nnode,
-			     tmp_peer)) {
-				if (tmp_peer->addpath_type[afi][safi] ==
-				    old_type) {
-					bgp_addpath_set_peer_type(
-						tmp_peer, afi, safi,
-						addpath_type, paths);
-				}
+		if (members) {
+			for (ALL_LIST_ELEMENTS(members, node, nnode, tmp_peer)) {
+				zlog_info("Resetting peer %pBP due to change in addpath config",
+					  tmp_peer);
+				peer_change_action(tmp_peer, afi, safi,
+						   peer_change_reset);
 			}
+			list_delete(&members);
 		}
 	} else {
 		peer_change_action(peer, afi, safi, peer_change_reset);
@@ -453,6 +474,7 @@ void bgp_addpath_update_ids(struct bgp *bgp, struct bgp_dest *bn, afi_t afi,
 			    safi_t safi)
 {
 	int i;
+	bool need_ids;
 	struct bgp_path_info *pi;
 	struct id_alloc_pool **pool_ptr;
 
@@ -467,28 +489,44 @@ void bgp_addpath_update_ids(struct bgp *bgp, struct bgp_dest *bn, afi_t afi,
 		if (bgp->tx_addpath.peercount[afi][safi][i] == 0)
 			continue;
 
-		/* Free Unused IDs back to the pool.*/
+		/*
+		 * Free unused IDs back to the pool, noting whether any path is
+		 * still waiting for one.  In steady state every path that
+		 * should have an ID already does, and the second walk is
+		 * skipped.
+		 */
+		need_ids = false;
 		for (pi = bgp_dest_get_bgp_path_info(bn); pi; pi = pi->next) {
-			if (pi->tx_addpath.addpath_tx_id[i] != IDALLOC_INVALID
-			    && !bgp_addpath_tx_path(i, pi)) {
-				idalloc_free_to_pool(pool_ptr,
-					pi->tx_addpath.addpath_tx_id[i]);
-				pi->tx_addpath.addpath_tx_id[i] =
-					IDALLOC_INVALID;
+			bool tx = bgp_addpath_tx_path(i, pi);
+
+			if (pi->tx_addpath.addpath_tx_id[i] != IDALLOC_INVALID) {
+				if (!tx) {
+					idalloc_free_to_pool(pool_ptr,
+						pi->tx_addpath.addpath_tx_id[i]);
+					pi->tx_addpath.addpath_tx_id[i] =
+						IDALLOC_INVALID;
+				}
+			} else if (tx) {
+				need_ids = true;
 			}
 		}
 
 		/* Give IDs to paths that need them (pulling from the pool) */
-		for (pi = bgp_dest_get_bgp_path_info(bn); pi; pi = pi->next) {
-			if (pi->tx_addpath.addpath_tx_id[i] == IDALLOC_INVALID
-			    && bgp_addpath_tx_path(i, pi)) {
-				pi->tx_addpath.addpath_tx_id[i] =
-					idalloc_allocate_prefer_pool(
-						alloc, pool_ptr);
+		if (need_ids) {
+			for (pi = bgp_dest_get_bgp_path_info(bn); pi;
+			     pi = pi->next) {
+				if (pi->tx_addpath.addpath_tx_id[i] ==
+					    IDALLOC_INVALID &&
+				    bgp_addpath_tx_path(i, pi)) {
+					pi->tx_addpath.addpath_tx_id[i] =
+						idalloc_allocate_prefer_pool(
+							alloc, pool_ptr);
+				}
 			}
 		}
 
 		/* Free any IDs left in the pool to the main allocator */
-		idalloc_drain_pool(alloc, pool_ptr);
+		if (*pool_ptr)
+			idalloc_drain_pool(alloc, pool_ptr);
 	}
 }
@@ -2409,22 +2409,259 @@ void bgp_aggr_aspath_remove(void *arg)
 	aspath_free(aspath);
 }
 
-void bgp_compute_aggregate_aspath(struct bgp_aggregate *aggregate,
-				  struct aspath *aspath)
+/*
+ * Folding every distinct contributing AS-Path with aspath_aggregate() gives
+ * the leading AS_SEQUENCE they all share, followed by an AS_SET of every
+ * other ASN.  When all contributors are a single AS_SEQUENCE, both parts
+ * follow from per-position and per-ASN counts that are kept up to date as
+ * distinct paths come and go, so the aggregate is rebuilt in time
+ * proportional to its own size rather than to the number of contributors.
+ * Paths of any other shape make us fall back to the fold.
+ */
+struct bgp_aggr_asn {
+	as_t asn;
+	/* Occurrences in the distinct contributing paths */
+	unsigned long count;
+	/* Of which in the common leading sequence, while rebuilding */
+	unsigned long lead;
+};
+
+struct bgp_aggr_pos_asn {
+	unsigned int pos;
+	as_t asn;
+	unsigned long count;
+};
+
+struct bgp_aggr_asns {
+	struct hash *asns;
+	struct hash *pos_asns;
+
+	/* Distinct single AS_SEQUENCE paths, and paths of any other shape */
+	unsigned long paths;
+	unsigned long other_paths;
+
+	/* Per position: paths reaching it, distinct ASNs found there and
+	 * the XOR of those, which is the ASN itself when there is only one.
+	 */
+	unsigned long len[AS_SEGMENT_MAX];
+	unsigned long distinct[AS_SEGMENT_MAX];
+	as_t xor[AS_SEGMENT_MAX];
+
+	/* Length of the sequence shared by all paths */
+	unsigned int lead_len;
+
+	enum asnotation_mode asnotation;
+};
+
+static unsigned int bgp_aggr_asn_key(const void *p)
 {
-	bgp_compute_aggregate_aspath_hash(aggregate, aspath);
+	const struct bgp_aggr_asn *a = p;
 
-	bgp_compute_aggregate_aspath_val(aggregate);
+	return jhash_1word(a->asn, 0);
+}
 
+static bool bgp_aggr_asn_cmp(const void *p1, const void *p2)
+{
+	const struct bgp_aggr_asn *a1 = p1, *a2 = p2;
+
+	return a1->asn == a2->asn;
 }
 
-void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
-				       struct aspath *aspath)
+static void *bgp_aggr_asn_alloc(void *p)
 {
-	struct aspath *aggr_aspath = NULL;
+	const struct bgp_aggr_asn *ref = p;
+	struct bgp_aggr_asn *a;
 
-	if ((aggregate == NULL) || (aspath == NULL))
+	a = XCALLOC(MTYPE_AS_AGGR, sizeof(*a));
+	a->asn = ref->asn;
+	return a;
+}
+
+static unsigned int bgp_aggr_pos_asn_key(const void *p)
+{
+	const struct bgp_aggr_pos_asn *a = p;
+
+	return jhash_2words(a->pos, a->asn, 0);
+}
+
+static bool bgp_aggr_pos_asn_cmp(const void *p1, const void *p2)
+{
+	const struct bgp_aggr_pos_asn *a1 = p1, *a2 = p2;
+
+	return a1->pos == a2->pos && a1->asn == a2->asn;
+}
+
+static void *bgp_aggr_pos_asn_alloc(void *p)
+{
+	const struct bgp_aggr_pos_asn *ref = p;
+	struct bgp_aggr_pos_asn *a;
+
+	a = XCALLOC(MTYPE_AS_AGGR, sizeof(*a));
+	a->pos = ref->pos;
+	a->asn = ref->asn;
+	return a;
+}
+
+static void bgp_aggr_asns_entry_free(void *arg)
+{
+	XFREE(MTYPE_AS_AGGR, arg);
+}
+
+void bgp_aggr_aspath_asns_free(struct bgp_aggregate *aggregate)
+{
+	struct bgp_aggr_asns *aa = aggregate->aspath_asns;
+
+	if (!aa)
+		return;
+
+	hash_clean_and_free(&aa->asns, bgp_aggr_asns_entry_free);
+	hash_clean_and_free(&aa->pos_asns, bgp_aggr_asns_entry_free);
+	XFREE(MTYPE_AS_AGGR, aggregate->aspath_asns);
+}
+
+/* Account for a distinct AS-Path entering or leaving the aggregate */
+static void bgp_aggr_asns_update(struct bgp_aggregate *aggregate,
+				 const struct aspath *aspath, bool add)
+{
+	struct bgp_aggr_asns *aa = aggregate->aspath_asns;
+	struct assegment *seg = aspath->segments;
+	struct bgp_aggr_asn asn_ref, *asn;
+	struct bgp_aggr_pos_asn pos_ref, *pos;
+	unsigned int i, n;
+
+	if (!aa) {
+		aa = XCALLOC(MTYPE_AS_AGGR, sizeof(*aa));
+		aa->asns = hash_create(bgp_aggr_asn_key, bgp_aggr_asn_cmp,
+				       "BGP Aggregator ASN counts");
+		aa->pos_asns = hash_create(bgp_aggr_pos_asn_key,
+					   bgp_aggr_pos_asn_cmp,
+					   "BGP Aggregator ASN position counts");
+		aggregate->aspath_asns = aa;
+	}
+
+	if (seg && (seg->type != AS_SEQUENCE || seg->next ||
+		    seg->length > AS_SEGMENT_MAX)) {
+		if (add)
+			aa->other_paths++;
+		else
+			aa->other_paths--;
 		return;
+	}
+
+	n = seg ? seg->length : 0;
+	for (i = 0; i < n; i++) {
+		asn_ref.asn = seg->as[i];
+		pos_ref.pos = i;
+		pos_ref.asn = seg->as[i];
+
+		if (add) {
+			asn = hash_get(aa->asns, &asn_ref, bgp_aggr_asn_alloc);
+			asn->count++;
+
+			pos = hash_get(aa->pos_asns, &pos_ref,
+				       bgp_aggr_pos_asn_alloc);
+			if (pos->count++ == 0) {
+				aa->distinct[i]++;
+				aa->xor[i] ^= pos->asn;
+			}
+			aa->len[i]++;
+			continue;
+		}
+
+		asn = hash_lookup(aa->asns, &asn_ref);
+		if (asn && --asn->count == 0) {
+			hash_release(aa->asns, asn);
+			XFREE(MTYPE_AS_AGGR, asn);
+		}
+
+		pos = hash_lookup(aa->pos_asns, &pos_ref);
+		if (pos && --pos->count == 0) {
+			aa->distinct[i]--;
+			aa->xor[i] ^= pos->asn;
+			hash_release(aa->pos_asns, pos);
+			XFREE(MTYPE_AS_AGGR, pos);
+		}
+		aa->len[i]--;
+	}
+
+	if (add) {
+		aa->paths++;
+		aa->asnotation = aspath->asnotation;
+	} else {
+		aa->paths--;
+	}
+
+	/* A position belongs to the shared sequence when every path reaches
+	 * it with the same ASN.
+	 */
+	aa->lead_len = 0;
+	while (aa->paths && aa->lead_len < AS_SEGMENT_MAX &&
+	       aa->len[aa->lead_len] == aa->paths &&
+	       aa->distinct[aa->lead_len] == 1)
+		aa->lead_len++;
+}
+
+struct bgp_aggr_asns_set {
+	struct assegment *seg;
+};
+
+static void bgp_aggr_asns_set_add(struct hash_bucket *hb, void *arg)
+{
+	struct bgp_aggr_asn *asn = hb->data;
+	struct bgp_aggr_asns_set *set = arg;
+
+	/* Anything not accounted for by the shared sequence goes to AS_SET */
+	if (asn->count > asn->lead)
+		set->seg->as[set->seg->length++] = asn->asn;
+	asn->lead = 0;
+}
+
+/* Same result as folding all distinct paths with aspath_aggregate() */
+static struct aspath *bgp_aggr_asns_build(struct bgp_aggr_asns *aa)
+{
+	struct aspath *aspath;
+	struct assegment *seq = NULL;
+	struct bgp_aggr_asns_set set;
+	struct bgp_aggr_asn ref, *asn;
+	unsigned int i;
+
+	aspath = aspath_new(aa->asnotation);
+
+	if (aa->lead_len) {
+		seq = assegment_new(AS_SEQUENCE, aa->lead_len);
+		for (i = 0; i < aa->lead_len; i++) {
+			seq->as[i] = aa->xor[i];
+			ref.asn = aa->xor[i];
+			asn = hash_lookup(aa->asns, &ref);
+			asn->lead += aa->paths;
+		}
+		aspath->segments = seq;
+	}
+
+	set.seg = assegment_new(AS_SET, aa->asns->count);
+	set.seg->length = 0;
+	hash_iterate(aa->asns, bgp_aggr_asns_set_add, &set);
+	if (set.seg->length) {
+		if (seq)
+			seq->next = set.seg;
+		else
+			aspath->segments = set.seg;
+	} else {
+		assegment_free(set.seg);
+	}
+
+	assegment_normalise(aspath->segments);
+	aspath_str_update(aspath, false);
+	aspath->count = aspath_count_hops_internal(aspath);
+
+	return aspath;
+}
+
+/* Returns true when the AS-Path is new to the aggregate */
+static bool bgp_aggr_aspath_add(struct bgp_aggregate *aggregate,
+				struct aspath *aspath)
+{
+	struct aspath *aggr_aspath = NULL;
 
 	/* Create hash if not already created.
 	 */
@@ -2444,6 +2681,58 @@ void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
 	/* Increment reference counter.
 	 */
 	aggr_aspath->refcnt++;
+
+	if (aggr_aspath->refcnt > 1)
+		return false;
+
+	bgp_aggr_asns_update(aggregate, aggr_aspath, true);
+	return true;
+}
+
+/* Returns true when the last route using the AS-Path is gone */
+static bool bgp_aggr_aspath_del(struct bgp_aggregate *aggregate,
+				struct aspath *aspath)
+{
+	struct aspath *aggr_aspath = NULL;
+	struct aspath *ret_aspath = NULL;
+
+	/* Look-up the aspath in the hash.
+	 */
+	aggr_aspath = bgp_aggr_aspath_lookup(aggregate, aspath);
+	if (!aggr_aspath)
+		return false;
+
+	aggr_aspath->refcnt--;
+	if (aggr_aspath->refcnt != 0)
+		return false;
+
+	bgp_aggr_asns_update(aggregate, aggr_aspath, false);
+
+	ret_aspath = hash_release(aggregate->aspath_hash, aggr_aspath);
+	aspath_free(ret_aspath);
+	return true;
+}
+
+void bgp_compute_aggregate_aspath(struct bgp_aggregate *aggregate,
+				  struct aspath *aspath)
+{
+	if ((aggregate == NULL) || (aspath == NULL))
+		return;
+
+	/* Another route already brought this AS-Path in, nothing changes */
+	if (!bgp_aggr_aspath_add(aggregate, aspath) && aggregate->aspath)
+		return;
+
+	bgp_compute_aggregate_aspath_val(aggregate);
+}
+
+void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
+				       struct aspath *aspath)
+{
+	if ((aggregate == NULL) || (aspath == NULL))
+		return;
+
+	bgp_aggr_aspath_add(aggregate, aspath);
 }
 
 void bgp_compute_aggregate_aspath_val(struct bgp_aggregate *aggregate)
@@ -2458,69 +2747,39 @@ void bgp_compute_aggregate_aspath_val(struct bgp_aggregate *aggregate)
 	}
 	if (aggregate->aspath_hash
 	    && aggregate->aspath_hash->count) {
-		hash_iterate(aggregate->aspath_hash,
-			     bgp_aggr_aspath_prepare,
-			     &aggregate->aspath);
+		if (aggregate->aspath_asns &&
+		    !aggregate->aspath_asns->other_paths &&
+		    aggregate->aspath_asns->asns->count <= AS_SEGMENT_MAX)
+			aggregate->aspath =
+				bgp_aggr_asns_build(aggregate->aspath_asns);
+		else
+			hash_iterate(aggregate->aspath_hash,
+				     bgp_aggr_aspath_prepare,
+				     &aggregate->aspath);
 	}
 }
 
 void bgp_remove_aspath_from_aggregate(struct bgp_aggregate *aggregate,
 				      struct aspath *aspath)
 {
-	struct aspath *aggr_aspath = NULL;
-	struct aspath *ret_aspath = NULL;
-
 	if ((!aggregate)
 	    || (!aggregate->aspath_hash)
 	    || (!aspath))
 		return;
 
-	/* Look-up the aspath in the hash.
-	 */
-	aggr_aspath = bgp_aggr_aspath_lookup(aggregate, aspath);
-	if (aggr_aspath) {
-		aggr_aspath->refcnt--;
-
-		if (aggr_aspath->refcnt == 0) {
-			ret_aspath = hash_release(aggregate->aspath_hash,
-						  aggr_aspath);
-			aspath_free(ret_aspath);
-			ret_aspath = NULL;
-
-			/* Remove aggregate's old as-path.
-			 */
-			aspath_free(aggregate->aspath);
-			aggregate->aspath = NULL;
-
-			bgp_compute_aggregate_aspath_val(aggregate);
-		}
-	}
+	if (bgp_aggr_aspath_del(aggregate, aspath))
+		bgp_compute_aggregate_aspath_val(aggregate);
 }
 
 void bgp_remove_aspath_from_aggregate_hash(struct bgp_aggregate *aggregate,
 					   struct aspath *aspath)
 {
-	struct aspath *aggr_aspath = NULL;
-	struct aspath *ret_aspath = NULL;
-
 	if ((!aggregate)
 	    || (!aggregate->aspath_hash)
 	    || (!aspath))
 		return;
 
-	/* Look-up the aspath in the hash.
-	 */
-	aggr_aspath = bgp_aggr_aspath_lookup(aggregate, aspath);
-	if (aggr_aspath) {
-		aggr_aspath->refcnt--;
-
-		if (aggr_aspath->refcnt == 0) {
-			ret_aspath = hash_release(aggregate->aspath_hash,
-						  aggr_aspath);
-			aspath_free(ret_aspath);
-			ret_aspath = NULL;
-		}
-	}
+	bgp_aggr_aspath_del(aggregate, aspath);
 }
 
 struct aspath *aspath_delete_as_set_seq(struct aspath *aspath)
@@ -907,40 +907,143 @@ static void *bgp_aggr_community_hash_alloc(void *p)
 	return community;
 }
 
-static void bgp_aggr_community_prepare(struct hash_bucket *hb, void *arg)
+void bgp_aggr_community_remove(void *arg)
 {
-	struct community *hb_community = hb->data;
-	struct community **aggr_community = arg;
+	struct community *community = arg;
 
-	if (*aggr_community)
-		*aggr_community = community_merge(*aggr_community,
-						  hb_community);
-	else
-		*aggr_community = community_dup(hb_community);
+	community_free(&community);
 }
 
-void bgp_aggr_community_remove(void *arg)
+/*
+ * Number of distinct communities in community_hash carrying a value. The
+ * aggregate's community only changes when a count leaves or drops back
+ * to zero, so adds and withdraws cost as much as the route's own values.
+ */
+struct bgp_aggr_community_val {
+	/* Network byte order, as in community->val */
+	uint32_t val;
+	unsigned long count;
+};
+
+static unsigned int bgp_aggr_community_val_key(const void *p)
 {
-	struct community *community = arg;
+	const struct bgp_aggr_community_val *v = p;
 
-	community_free(&community);
+	return jhash_1word(v->val, 0);
 }
 
-void bgp_compute_aggregate_community(struct bgp_aggregate *aggregate,
-				     struct community *community)
+static bool bgp_aggr_community_val_cmp(const void *p1, const void *p2)
 {
-	bgp_compute_aggregate_community_hash(aggregate, community);
-	bgp_compute_aggregate_community_val(aggregate);
+	const struct bgp_aggr_community_val *v1 = p1, *v2 = p2;
+
+	return v1->val == v2->val;
 }
 
+static void *bgp_aggr_community_val_alloc(void *p)
+{
+	const struct bgp_aggr_community_val *ref = p;
+	struct bgp_aggr_community_val *v;
 
-void bgp_compute_aggregate_community_hash(struct bgp_aggregate *aggregate,
-					  struct community *community)
+	v = XCALLOC(MTYPE_COMMUNITY_AGGR, sizeof(*v));
+	v->val = ref->val;
+	return v;
+}
+
+static void bgp_aggr_community_val_free(void *arg)
 {
-	struct community *aggr_community = NULL;
+	XFREE(MTYPE_COMMUNITY_AGGR, arg);
+}
 
-	if ((aggregate == NULL) || (community == NULL))
-		return;
+void bgp_aggr_community_vals_free(struct bgp_aggregate *aggregate)
+{
+	hash_clean_and_free(&aggregate->community_vals,
+			    bgp_aggr_community_val_free);
+}
+
+/* Insert or remove a value, keeping com as community_uniq_sort() makes it */
+static void bgp_aggr_community_val_set(struct community *com, uint32_t val,
+				       bool add)
+{
+	int lo = 0, hi = com->size, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (community_compare(&com->val[mid], &val) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (add) {
+		com->size++;
+		com->val = XREALLOC(MTYPE_COMMUNITY_VAL, com->val,
+				    com_length(com));
+		memmove(&com->val[lo + 1], &com->val[lo],
+			(com->size - 1 - lo) * COMMUNITY_SIZE);
+		com->val[lo] = val;
+	} else {
+		assert(lo < com->size && com->val[lo] == val);
+		com->size--;
+		memmove(&com->val[lo], &com->val[lo + 1],
+			(com->size - lo) * COMMUNITY_SIZE);
+		if (com->size)
+			com->val = XREALLOC(MTYPE_COMMUNITY_VAL, com->val,
+					    com_length(com));
+		else
+			XFREE(MTYPE_COMMUNITY_VAL, com->val);
+	}
+
+	XFREE(MTYPE_COMMUNITY_STR, com->str);
+	if (com->json) {
+		json_object_free(com->json);
+		com->json = NULL;
+	}
+}
+
+/* Account for a distinct community entering or leaving community_hash;
+ * with 'apply', the aggregate's community follows along.
+ */
+static void bgp_aggr_community_vals_update(struct bgp_aggregate *aggregate,
+					   const struct community *community,
+					   bool add, bool apply)
+{
+	struct bgp_aggr_community_val ref, *v;
+	int i;
+
+	if (aggregate->community_vals == NULL)
+		aggregate->community_vals = hash_create(
+			bgp_aggr_community_val_key, bgp_aggr_community_val_cmp,
+			"BGP Aggregator community value counts");
+
+	for (i = 0; i < community->size; i++) {
+		ref.val = community->val[i];
+
+		if (add) {
+			v = hash_get(aggregate->community_vals, &ref,
+				     bgp_aggr_community_val_alloc);
+			if (v->count++ == 0 && apply)
+				bgp_aggr_community_val_set(aggregate->community,
+							   v->val, true);
+			continue;
+		}
+
+		v = hash_lookup(aggregate->community_vals, &ref);
+		if (!v || --v->count)
+			continue;
+
+		if (apply)
+			bgp_aggr_community_val_set(aggregate->community, v->val,
+						   false);
+		hash_release(aggregate->community_vals, v);
+		bgp_aggr_community_val_free(v);
+	}
+}
+
+/* Returns true when the community is new to the aggregate */
+static bool bgp_aggr_community_add(struct bgp_aggregate *aggregate,
+				   struct community *community, bool apply)
+{
+	struct community *aggr_community = NULL;
 
 	/* Create hash if not already created.
 	 */
@@ -961,28 +1064,92 @@ void bgp_compute_aggregate_community_hash(struct bgp_aggregate *aggregate,
 	/* Increment reference counter.
 	 */
 	aggr_community->refcnt++;
+	if (aggr_community->refcnt > 1)
+		return false;
+
+	bgp_aggr_community_vals_update(aggregate, aggr_community, true, apply);
+	return true;
+}
+
+/* Returns true when the last route using the community is gone */
+static bool bgp_aggr_community_del(struct bgp_aggregate *aggregate,
+				   struct community *community, bool apply)
+{
+	struct community *aggr_community = NULL;
+	struct community *ret_comm = NULL;
+
+	/* Look-up the community in the hash.
+	 */
+	aggr_community = bgp_aggr_community_lookup(aggregate, community);
+	if (!aggr_community)
+		return false;
+
+	aggr_community->refcnt--;
+	if (aggr_community->refcnt != 0)
+		return false;
+
+	bgp_aggr_community_vals_update(aggregate, aggr_community, false, apply);
+
+	ret_comm = hash_release(aggregate->community_hash, aggr_community);
+	community_free(&ret_comm);
+	return true;
+}
+
+static void bgp_aggr_community_prepare(struct hash_bucket *hb, void *arg)
+{
+	struct bgp_aggr_community_val *v = hb->data;
+	struct community *aggr_community = arg;
+
+	community_add_val(aggr_community, ntohl(v->val));
+}
+
+void bgp_compute_aggregate_community(struct bgp_aggregate *aggregate,
+				     struct community *community)
+{
+	if ((aggregate == NULL) || (community == NULL))
+		return;
+
+	if (!aggregate->community) {
+		bgp_aggr_community_add(aggregate, community, false);
+		bgp_compute_aggregate_community_val(aggregate);
+		return;
+	}
+
+	bgp_aggr_community_add(aggregate, community, true);
+}
+
+
+void bgp_compute_aggregate_community_hash(struct bgp_aggregate *aggregate,
+					  struct community *community)
+{
+	if ((aggregate == NULL) || (community == NULL))
+		return;
+
+	bgp_aggr_community_add(aggregate, community, false);
 }
 
 void bgp_compute_aggregate_community_val(struct bgp_aggregate *aggregate)
 {
-	struct community *commerge = NULL;
+	struct community *aggr_community;
 
 	if (aggregate == NULL)
 		return;
 
-	/* Re-compute aggregate's community.
+	/* Re-compute aggregate's community from the value counts.
 	 */
 	if (aggregate->community)
 		community_free(&aggregate->community);
 	if (aggregate->community_hash &&
 	    aggregate->community_hash->count) {
-		hash_iterate(aggregate->community_hash,
-			     bgp_aggr_community_prepare,
-			     &aggregate->community);
-		commerge = aggregate->community;
-		aggregate->community = community_uniq_sort(commerge);
-		if (commerge)
-			community_free(&commerge);
+		aggr_community = community_new();
+		if (aggregate->community_vals)
+			hash_iterate(aggregate->community_vals,
+				     bgp_aggr_community_prepare,
+				     aggr_community);
+		if (aggr_community->size)
+			qsort(aggr_community->val, aggr_community->size,
+			      sizeof(uint32_t), community_compare);
+		aggregate->community = aggr_community;
 	}
 }
 
@@ -991,52 +1158,28 @@ void bgp_compute_aggregate_community_val(struct bgp_aggregate *aggregate)
 void bgp_remove_community_from_aggregate(struct bgp_aggregate *aggregate,
 					 struct community *community)
 {
-	struct community *aggr_community = NULL;
-	struct community *ret_comm = NULL;
-
 	if ((!aggregate)
 	    || (!aggregate->community_hash)
 	    || (!community))
 		return;
 
-	/* Look-up the community in the hash.
-	 */
-	aggr_community = bgp_aggr_community_lookup(aggregate, community);
-	if (aggr_community) {
-		aggr_community->refcnt--;
-
-		if (aggr_community->refcnt == 0) {
-			ret_comm = hash_release(aggregate->community_hash,
-						aggr_community);
-			community_free(&ret_comm);
+	if (!bgp_aggr_community_del(aggregate, community,
+				    aggregate->community != NULL))
+		return;
 
-			bgp_compute_aggregate_community_val(aggregate);
-		}
-	}
+	if (!aggregate->community_hash->count)
+		community_free(&aggregate->community);
+	else if (!aggregate->community)
+		bgp_compute_aggregate_community_val(aggregate);
 }
 
 void bgp_remove_comm_from_aggregate_hash(struct bgp_aggregate *aggregate,
 		struct community *community)
 {
-
-	struct community *aggr_community = NULL;
-	struct community *ret_comm = NULL;
-
 	if ((!aggregate)
 	    || (!aggregate->community_hash)
 	    || (!community))
 		return;
 
-	/* Look-up the community in the hash.
-	 */
-	aggr_community = bgp_aggr_community_lookup(aggregate, community);
-	if (aggr_community) {
-		aggr_community->refcnt--;
-
-		if (aggr_community->refcnt == 0) {
-			ret_comm = hash_release(aggregate->community_hash,
-						aggr_community);
-			community_free(&ret_comm);
-		}
-	}
+	bgp_aggr_community_del(aggregate, community, false);
 }
@@ -93,6 +93,7 @@ extern void bgp_remove_community_from_aggregate(struct bgp_aggregate *aggregate,
 extern void bgp_remove_comm_from_aggregate_hash(struct bgp_aggregate *aggregate,
 						struct community *community);
 extern void bgp_aggr_community_remove(void *arg);
+extern void bgp_aggr_community_vals_free(struct bgp_aggregate *aggregate);
 
 /* This implies that when propagating routes into a VRF, the ACCEPT_OWN
  * community SHOULD NOT be propagated.
@@ -11,7 +11,6 @@
 #include "command.h"
 #include "log.h"
 #include "frrevent.h"
-#include "queue.h"
 #include "filter.h"
 
 #include "bgpd/bgpd.h"
@@ -22,29 +21,57 @@
 #include "bgpd/bgp_advertise.h"
 #include "bgpd/bgp_vty.h"
 
-static void bgp_reuselist_add(struct reuselist *list, struct bgp_damp_info *info)
+static void bgp_reuselist_add(struct reuselist_head *list,
+			      struct bgp_damp_info *info)
 {
 	assert(info);
-	SLIST_INSERT_HEAD(list, info, entry);
+	reuselist_add_head(list, info);
 }
 
-static void bgp_reuselist_del(struct reuselist *list, struct bgp_damp_info *info)
+static void bgp_reuselist_del(struct reuselist_head *list,
+			      struct bgp_damp_info *info)
 {
 	assert(info);
-	SLIST_REMOVE(list, info, bgp_damp_info, entry);
+	reuselist_del(list, info);
 }
 
-static void bgp_reuselist_switch(struct reuselist *source,
+static void bgp_reuselist_switch(struct reuselist_head *source,
 				 struct bgp_damp_info *info,
-				 struct reuselist *target)
+				 struct reuselist_head *target)
 {
 	assert(source && target && info);
-	SLIST_REMOVE(source, info, bgp_damp_info, entry);
-	SLIST_INSERT_HEAD(target, info, entry);
+	reuselist_del(source, info);
+	reuselist_add_head(target, info);
+}
+
+/* Get a dampening structure, preferably one released earlier into the
+ * config's free list.
+ */
+static struct bgp_damp_info *bgp_damp_info_alloc(struct bgp_damp_config *bdc)
+{
+	struct bgp_damp_info *bdi;
+
+	bdi = reuselist_pop(&bdc->free_list);
+	if (bdi)
+		return bdi;
+
+	return XCALLOC(MTYPE_BGP_DAMP_INFO, sizeof(struct bgp_damp_info));
+}
+
+static void bgp_damp_info_release(struct bgp_damp_config *bdc,
+				  struct bgp_damp_info *bdi)
+{
+	if (reuselist_count(&bdc->free_list) >= BGP_DAMP_FREE_LIST_MAX) {
+		XFREE(MTYPE_BGP_DAMP_INFO, bdi);
+		return;
+	}
+
+	memset(bdi, 0, sizeof(*bdi));
+	reuselist_add_head(&bdc->free_list, bdi);
 }
 
 static void bgp_damp_info_unclaim(struct bgp_damp_info *bdi,
-				  struct reuselist *list)
+				  struct reuselist_head *list)
 {
 	assert(bdi && bdi->config);
 	if (bdi->index == BGP_DAMP_NO_REUSE_LIST_INDEX)
@@ -90,17 +117,16 @@ struct bgp_damp_config *get_active_bdc_from_pi(struct bgp_path_info *pi,
 /* Calculate reuse list index by penalty value.  */
 static int bgp_reuse_index(int penalty, struct bgp_damp_config *bdc)
 {
-	unsigned int i;
+	uint64_t i;
 	unsigned int index;
 
-	/*
-	 * reuse_limit can't be zero, this is for Coverity
-	 * to bypass division by zero test.
-	 */
-	assert(bdc->reuse_limit);
-
-	i = (int)(((double)penalty / bdc->reuse_limit - 1.0)
-		  * bdc->scale_factor);
+	/* (penalty / reuse_limit - 1) * scale_factor, in fixed-point */
+	if ((unsigned int)penalty <= bdc->reuse_limit)
+		i = 0;
+	else
+		i = ((uint64_t)(penalty - bdc->reuse_limit) *
+		     bdc->reuse_index_mult) >>
+		    BGP_DAMP_FIXED_SHIFT;
 
 	if (i >= bdc->reuse_index_size)
 		i = bdc->reuse_index_size - 1;
@@ -141,25 +167,26 @@ static void bgp_no_reuse_list_delete(struct bgp_damp_info *bdi)
 /* Return decayed penalty value.  */
 int bgp_damp_decay(time_t tdiff, int penalty, struct bgp_damp_config *bdc)
 {
-	unsigned int i;
+	time_t i;
 
-	i = (int)((double)tdiff / DELTA_T);
+	i = tdiff / DELTA_T;
 
-	if (i == 0)
+	if (i <= 0)
 		return penalty;
 
 	if (i >= bdc->decay_array_size)
 		return 0;
 
-	return (int)(penalty * bdc->decay_array[i]);
+	return (int)(((uint64_t)penalty * bdc->decay_array[i]) >>
+		     BGP_DAMP_FIXED_SHIFT);
 }
 
 /* Handler of reuse timer event.  Each route in the current reuse-list
    is evaluated.  RFC2439 Section 4.8.7.  */
 static void bgp_reuse_timer(struct event *t)
 {
-	struct bgp_damp_info *bdi, *bdi_next;
-	struct reuselist plist;
+	struct bgp_damp_info *bdi;
+	struct reuselist_head plist;
 	struct bgp *bgp;
 	time_t t_now, t_diff;
 	struct bgp_damp_config *bdc = EVENT_ARG(t);
@@ -173,8 +200,8 @@ static void bgp_reuse_timer(struct event *t)
 	/* 1.  save a pointer to the current queue head and zero the list head
 	 * list head entry. */
 	assert(bdc->reuse_offset < bdc->reuse_list_size);
-	plist = bdc->reuse_list[bdc->reuse_offset];
-	SLIST_INIT(&bdc->reuse_list[bdc->reuse_offset]);
+	reuselist_init(&plist);
+	reuselist_swap_all(&plist, &bdc->reuse_list[bdc->reuse_offset]);
 
 	/* 2.  set offset = modulo reuse-list-size ( offset + 1 ), thereby
 	   rotating the circular queue of list-heads.  */
@@ -182,7 +209,7 @@ static void bgp_reuse_timer(struct event *t)
 	assert(bdc->reuse_offset < bdc->reuse_list_size);
 
 	/* 3. if ( the saved list head pointer is non-empty ) */
-	SLIST_FOREACH_SAFE (bdi, &plist, entry, bdi_next) {
+	frr_each_safe (reuselist, &plist, bdi) {
 		bgp = bdi->path->peer->bgp;
 
 		/* Set t-diff = t-now - t-updated.  */
@@ -212,7 +239,7 @@ static void bgp_reuse_timer(struct event *t)
 					    bdi->safi);
 			}
 
-			if (bdi->penalty <= bdc->reuse_limit / 2.0) {
+			if (bdi->penalty <= bdc->reuse_limit / 2) {
 				bgp_damp_info_free(bdi, &plist, 1);
 			} else {
 				bdi->index = BGP_DAMP_NO_REUSE_LIST_INDEX;
@@ -228,7 +255,8 @@ static void bgp_reuse_timer(struct event *t)
 		}
 	}
 
-	assert(SLIST_EMPTY(&plist));
+	assert(reuselist_count(&plist) == 0);
+	reuselist_fini(&plist);
 }
 
 /* A route becomes unreachable (RFC2439 Section 4.8.2).  */
@@ -257,8 +285,7 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 		   2. set figure-of-merit = 1.
 		   3. withdraw the route.  */
 
-		bdi = XCALLOC(MTYPE_BGP_DAMP_INFO,
-			      sizeof(struct bgp_damp_info));
+		bdi = bgp_damp_info_alloc(bdc);
 		bdi->path = path;
 		bdi->dest = dest;
 		bdi->penalty =
@@ -357,7 +384,7 @@ int bgp_damp_update(struct bgp_path_info *path, struct bgp_dest *dest,
 	} else
 		status = BGP_DAMP_SUPPRESSED;
 
-	if (bdi->penalty > bdc->reuse_limit / 2.0)
+	if (bdi->penalty > bdc->reuse_limit / 2)
 		bdi->t_updated = t_now;
 	else
 		bgp_damp_info_free(bdi, NULL, 0);
@@ -365,11 +392,12 @@ int bgp_damp_update(struct bgp_path_info *path, struct bgp_dest *dest,
 	return status;
 }
 
-void bgp_damp_info_free(struct bgp_damp_info *bdi, struct reuselist *list,
-			int withdraw)
+void bgp_damp_info_free(struct bgp_damp_info *bdi,
+			struct reuselist_head *list, int withdraw)
 {
 	assert(bdi);
 
+	struct bgp_damp_config *bdc = bdi->config;
 	afi_t afi = bdi->afi;
 	safi_t safi = bdi->safi;
 	struct bgp_path_info *bpi = bdi->path;
@@ -387,7 +415,7 @@ void bgp_damp_info_free(struct bgp_damp_info *bdi, struct reuselist *list,
 		bgp_process(bgp, dest, bpi, afi, safi);
 	}
 
-	XFREE(MTYPE_BGP_DAMP_INFO, bdi);
+	bgp_damp_info_release(bdc, bdi);
 }
 
 static void bgp_damp_parameter_set(time_t hlife, unsigned int reuse,
@@ -395,6 +423,7 @@ static void bgp_damp_parameter_set(time_t hlife, unsigned int reuse,
 				   struct bgp_damp_config *bdc)
 {
 	double reuse_max_ratio;
+	double decay;
 	unsigned int i;
 	double j;
 
@@ -410,18 +439,19 @@ static void bgp_damp_parameter_set(time_t hlife, unsigned int reuse,
 			     * (pow(2, (double)bdc->max_suppress_time
 					       / bdc->half_life)));
 
-	/* Decay-array computations */
+	/* Decay-array computations.  The per-tick factors are worked out
+	 * once here, and stored as fixed-point so that bgp_damp_decay() is
+	 * a table lookup, a multiply and a shift.
+	 */
 	bdc->decay_array_size = ceil((double)bdc->max_suppress_time / DELTA_T);
 	bdc->decay_array = XMALLOC(MTYPE_BGP_DAMP_ARRAY,
-				   sizeof(double) * (bdc->decay_array_size));
-	bdc->decay_array[0] = 1.0;
-	bdc->decay_array[1] =
-		exp((1.0 / ((double)bdc->half_life / DELTA_T)) * log(0.5));
+				   sizeof(uint32_t) * (bdc->decay_array_size));
+	decay = exp((1.0 / ((double)bdc->half_life / DELTA_T)) * log(0.5));
 
 	/* Calculate decay values for all possible times */
-	for (i = 2; i < bdc->decay_array_size; i++)
+	for (i = 0; i < bdc->decay_array_size; i++)
 		bdc->decay_array[i] =
-			bdc->decay_array[i - 1] * bdc->decay_array[1];
+			(uint32_t)(pow(decay, i) * BGP_DAMP_FIXED_ONE + 0.5);
 
 	/* Reuse-list computations */
 	i = ceil((double)bdc->max_suppress_time / DELTA_REUSE) + 1;
@@ -431,7 +461,12 @@ static void bgp_damp_parameter_set(time_t hlife, unsigned int reuse,
 
 	bdc->reuse_list =
 		XCALLOC(MTYPE_BGP_DAMP_ARRAY,
-			bdc->reuse_list_size * sizeof(struct reuselist));
+			bdc->reuse_list_size * sizeof(struct reuselist_head));
+	for (i = 0; i < bdc->reuse_list_size; i++)
+		reuselist_init(&bdc->reuse_list[i]);
+	reuselist_init(&bdc->no_reuse_list);
+	reuselist_init(&bdc->free_list);
+
 	/* Reuse-array computations */
 	bdc->reuse_index = XCALLOC(MTYPE_BGP_DAMP_ARRAY,
 				   sizeof(int) * bdc->reuse_index_size);
@@ -443,6 +478,9 @@ static void bgp_damp_parameter_set(time_t hlife, unsigned int reuse,
 
 	bdc->scale_factor =
 		(double)bdc->reuse_index_size / (reuse_max_ratio - 1);
+	bdc->reuse_index_mult = (uint64_t)(bdc->scale_factor /
+					   bdc->reuse_limit *
+					   BGP_DAMP_FIXED_ONE);
 
 	for (i = 0; i < bdc->reuse_index_size; i++) {
 		bdc->reuse_index[i] =
@@ -485,13 +523,17 @@ void bgp_damp_info_clean(struct bgp *bgp, struct bgp_damp_config *bdc,
 			 afi_t afi, safi_t safi)
 {
 	struct bgp_damp_info *bdi;
-	struct reuselist *list;
+	struct reuselist_head *list;
 	unsigned int i;
 
+	/* The lists are only set up once dampening is configured */
+	if (!bdc->reuse_list)
+		return;
+
 	bdc->reuse_offset = 0;
 	for (i = 0; i < bdc->reuse_list_size; ++i) {
 		list = &bdc->reuse_list[i];
-		while ((bdi = SLIST_FIRST(list)) != NULL) {
+		while ((bdi = reuselist_first(list)) != NULL) {
 			if (bdi->lastrecord == BGP_RECORD_UPDATE) {
 				bgp_aggregate_increment(bgp,
 							bgp_dest_get_prefix(
@@ -505,9 +547,12 @@ void bgp_damp_info_clean(struct bgp *bgp, struct bgp_damp_config *bdc,
 		}
 	}
 
-	while ((bdi = SLIST_FIRST(&bdc->no_reuse_list)) != NULL)
+	while ((bdi = reuselist_first(&bdc->no_reuse_list)) != NULL)
 		bgp_damp_info_free(bdi, &bdc->no_reuse_list, 1);
 
+	while ((bdi = reuselist_pop(&bdc->free_list)) != NULL)
+		XFREE(MTYPE_BGP_DAMP_INFO, bdi);
+
 	/* Free decay array */
 	XFREE(MTYPE_BGP_DAMP_ARRAY, bdc->decay_array);
 	bdc->decay_array_size = 0;
@@ -582,9 +627,8 @@ static const char *bgp_get_reuse_time(struct bgp_damp_config *bdc,
 	int time_store = 0;
 
 	if (penalty > bdc->reuse_limit) {
-		reuse_time = (int)(DELTA_T *
-				   ((log((double)bdc->reuse_limit / penalty)) /
-				    (log(bdc->decay_array[1]))));
+		reuse_time = (int)(bdc->half_life *
+				   log2((double)penalty / bdc->reuse_limit));
 
 		if (reuse_time > bdc->max_suppress_time)
 			reuse_time = bdc->max_suppress_time;
@@ -6,8 +6,11 @@
 #ifndef _QUAGGA_BGP_DAMP_H
 #define _QUAGGA_BGP_DAMP_H
 
+#include "typesafe.h"
 #include "bgpd/bgp_table.h"
 
+PREDECL_DLIST(reuselist);
+
 /* Structure maintained on a per-route basis. */
 struct bgp_damp_info {
 	/* Figure-of-merit.  */
@@ -47,10 +50,10 @@ struct bgp_damp_info {
 	afi_t afi;
 	safi_t safi;
 
-	SLIST_ENTRY(bgp_damp_info) entry;
+	struct reuselist_item entry;
 };
 
-SLIST_HEAD(reuselist, bgp_damp_info);
+DECLARE_DLIST(reuselist, struct bgp_damp_info, entry);
 
 /* Specified parameter set configuration. */
 struct bgp_damp_config {
@@ -81,19 +84,31 @@ struct bgp_damp_config {
 	unsigned int reuse_scale_factor;
 	double scale_factor;
 
-	/* Decay array per-set based. */
-	double *decay_array;
+	/* Reuse index multiplier, fixed-point scaled by
+	 * BGP_DAMP_FIXED_SHIFT.  Equals scale_factor / reuse_limit.
+	 */
+	uint64_t reuse_index_mult;
+
+	/* Decay array per-set based, fixed-point scaled by
+	 * BGP_DAMP_FIXED_SHIFT.
+	 */
+	uint32_t *decay_array;
 
 	/* Reuse index array per-set based. */
 	int *reuse_index;
 
 	/* Reuse list array per-set based. */
-	struct reuselist *reuse_list;
+	struct reuselist_head *reuse_list;
 	unsigned int reuse_offset;
 	safi_t safi;
 
 	/* All dampening information which is not on reuse list.  */
-	struct reuselist no_reuse_list;
+	struct reuselist_head no_reuse_list;
+
+	/* Released dampening information kept for reuse, so that churn
+	 * does not turn into a malloc/free per flap.
+	 */
+	struct reuselist_head free_list;
 
 	/* Reuse timer thread per-set base. */
 	struct event *t_reuse;
@@ -120,6 +135,13 @@ struct bgp_damp_config {
 #define REUSE_LIST_SIZE          256
 #define REUSE_ARRAY_SIZE        1024
 
+/* Fractional bits of the fixed-point decay and reuse-index factors */
+#define BGP_DAMP_FIXED_SHIFT      24
+#define BGP_DAMP_FIXED_ONE        (1U << BGP_DAMP_FIXED_SHIFT)
+
+/* Upper bound of bgp_damp_info entries kept on a config's free_list */
+#define BGP_DAMP_FREE_LIST_MAX  4096
+
 extern struct bgp_damp_config *get_active_bdc_from_pi(struct bgp_path_info *pi,
 						      afi_t afi, safi_t safi);
 extern int bgp_damp_enable(struct bgp *bgp, afi_t afi, safi_t safi, time_t half,
@@ -131,7 +153,7 @@ extern int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 extern int bgp_damp_update(struct bgp_path_info *path, struct bgp_dest *dest,
 			   afi_t afi, safi_t saff);
 extern void bgp_damp_info_free(struct bgp_damp_info *bdi,
-			       struct reuselist *list, int withdraw);
+			       struct reuselist_head *list, int withdraw);
 extern void bgp_damp_info_clean(struct bgp *bgp, struct bgp_damp_config *bdc,
 				afi_t afi, safi_t safi);
 extern void bgp_damp_config_clean(struct bgp_damp_config *bdc);
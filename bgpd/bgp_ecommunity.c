@@ -1868,40 +1868,151 @@ static void *bgp_aggr_ecommunty_hash_alloc(void *p)
 	return ecommunity;
 }
 
-static void bgp_aggr_ecommunity_prepare(struct hash_bucket *hb, void *arg)
+void bgp_aggr_ecommunity_remove(void *arg)
 {
-	struct ecommunity *hb_ecommunity = hb->data;
-	struct ecommunity **aggr_ecommunity = arg;
+	struct ecommunity *ecommunity = arg;
 
-	if (*aggr_ecommunity)
-		*aggr_ecommunity = ecommunity_merge(*aggr_ecommunity,
-						    hb_ecommunity);
-	else
-		*aggr_ecommunity = ecommunity_dup(hb_ecommunity);
+	ecommunity_free(&ecommunity);
 }
 
-void bgp_aggr_ecommunity_remove(void *arg)
+/*
+ * Number of distinct ecommunities in ecommunity_hash carrying a value.
+ * The aggregate's ecommunity only changes when a count leaves or drops
+ * back to zero, so adds and withdraws cost as much as the route's own
+ * values.
+ */
+struct bgp_aggr_ecommunity_val {
+	uint8_t val[ECOMMUNITY_SIZE];
+	unsigned long count;
+};
+
+static unsigned int bgp_aggr_ecommunity_val_key(const void *p)
 {
-	struct ecommunity *ecommunity = arg;
+	const struct bgp_aggr_ecommunity_val *v = p;
 
-	ecommunity_free(&ecommunity);
+	return jhash(v->val, ECOMMUNITY_SIZE, 0);
 }
 
-void bgp_compute_aggregate_ecommunity(struct bgp_aggregate *aggregate,
-				      struct ecommunity *ecommunity)
+static bool bgp_aggr_ecommunity_val_cmp(const void *p1, const void *p2)
+{
+	const struct bgp_aggr_ecommunity_val *v1 = p1, *v2 = p2;
+
+	return !memcmp(v1->val, v2->val, ECOMMUNITY_SIZE);
+}
+
+static void *bgp_aggr_ecommunity_val_alloc(void *p)
 {
-	bgp_compute_aggregate_ecommunity_hash(aggregate, ecommunity);
-	bgp_compute_aggregate_ecommunity_val(aggregate);
+	const struct bgp_aggr_ecommunity_val *ref = p;
+	struct bgp_aggr_ecommunity_val *v;
+
+	v = XCALLOC(MTYPE_ECOMMUNITY_AGGR, sizeof(*v));
+	memcpy(v->val, ref->val, ECOMMUNITY_SIZE);
+	return v;
 }
 
+static void bgp_aggr_ecommunity_val_free(void *arg)
+{
+	XFREE(MTYPE_ECOMMUNITY_AGGR, arg);
+}
 
-void bgp_compute_aggregate_ecommunity_hash(struct bgp_aggregate *aggregate,
-					   struct ecommunity *ecommunity)
+void bgp_aggr_ecommunity_vals_free(struct bgp_aggregate *aggregate)
 {
-	struct ecommunity *aggr_ecommunity = NULL;
+	hash_clean_and_free(&aggregate->ecommunity_vals,
+			    bgp_aggr_ecommunity_val_free);
+}
 
-	if ((aggregate == NULL) || (ecommunity == NULL))
-		return;
+static int bgp_aggr_ecommunity_val_order(const void *p1, const void *p2)
+{
+	return memcmp(p1, p2, ECOMMUNITY_SIZE);
+}
+
+/* Insert or remove a value, keeping ecom as ecommunity_uniq_sort() makes it */
+static void bgp_aggr_ecommunity_val_set(struct ecommunity *ecom,
+					const uint8_t *val, bool add)
+{
+	uint32_t lo = 0, hi = ecom->size, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (memcmp(ecom->val + mid * ECOMMUNITY_SIZE, val,
+			   ECOMMUNITY_SIZE) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (add) {
+		ecom->size++;
+		ecom->val = XREALLOC(MTYPE_ECOMMUNITY_VAL, ecom->val,
+				     ecom->size * ECOMMUNITY_SIZE);
+		memmove(ecom->val + (lo + 1) * ECOMMUNITY_SIZE,
+			ecom->val + lo * ECOMMUNITY_SIZE,
+			(ecom->size - 1 - lo) * ECOMMUNITY_SIZE);
+		memcpy(ecom->val + lo * ECOMMUNITY_SIZE, val, ECOMMUNITY_SIZE);
+	} else {
+		assert(lo < ecom->size &&
+		       !memcmp(ecom->val + lo * ECOMMUNITY_SIZE, val,
+			       ECOMMUNITY_SIZE));
+		ecom->size--;
+		memmove(ecom->val + lo * ECOMMUNITY_SIZE,
+			ecom->val + (lo + 1) * ECOMMUNITY_SIZE,
+			(ecom->size - lo) * ECOMMUNITY_SIZE);
+		if (ecom->size)
+			ecom->val = XREALLOC(MTYPE_ECOMMUNITY_VAL, ecom->val,
+					     ecom->size * ECOMMUNITY_SIZE);
+		else
+			XFREE(MTYPE_ECOMMUNITY_VAL, ecom->val);
+	}
+
+	XFREE(MTYPE_ECOMMUNITY_STR, ecom->str);
+}
+
+/* Account for a distinct ecommunity entering or leaving ecommunity_hash;
+ * with 'apply', the aggregate's ecommunity follows along.
+ */
+static void bgp_aggr_ecommunity_vals_update(struct bgp_aggregate *aggregate,
+					    const struct ecommunity *ecommunity,
+					    bool add, bool apply)
+{
+	struct bgp_aggr_ecommunity_val ref, *v;
+	uint32_t i;
+
+	if (aggregate->ecommunity_vals == NULL)
+		aggregate->ecommunity_vals = hash_create(
+			bgp_aggr_ecommunity_val_key,
+			bgp_aggr_ecommunity_val_cmp,
+			"BGP Aggregator ecommunity value counts");
+
+	for (i = 0; i < ecommunity->size; i++) {
+		memcpy(ref.val, ecommunity->val + i * ECOMMUNITY_SIZE,
+		       ECOMMUNITY_SIZE);
+
+		if (add) {
+			v = hash_get(aggregate->ecommunity_vals, &ref,
+				     bgp_aggr_ecommunity_val_alloc);
+			if (v->count++ == 0 && apply)
+				bgp_aggr_ecommunity_val_set(aggregate->ecommunity,
+							    v->val, true);
+			continue;
+		}
+
+		v = hash_lookup(aggregate->ecommunity_vals, &ref);
+		if (!v || --v->count)
+			continue;
+
+		if (apply)
+			bgp_aggr_ecommunity_val_set(aggregate->ecommunity,
+						    v->val, false);
+		hash_release(aggregate->ecommunity_vals, v);
+		bgp_aggr_ecommunity_val_free(v);
+	}
+}
+
+/* Returns true when the ecommunity is new to the aggregate */
+static bool bgp_aggr_ecommunity_add(struct bgp_aggregate *aggregate,
+				    struct ecommunity *ecommunity, bool apply)
+{
+	struct ecommunity *aggr_ecommunity = NULL;
 
 	/* Create hash if not already created.
 	 */
@@ -1922,81 +2033,133 @@ void bgp_compute_aggregate_ecommunity_hash(struct bgp_aggregate *aggregate,
 	/* Increment reference counter.
 	 */
 	aggr_ecommunity->refcnt++;
+	if (aggr_ecommunity->refcnt > 1)
+		return false;
+
+	bgp_aggr_ecommunity_vals_update(aggregate, aggr_ecommunity, true,
+					apply);
+	return true;
+}
+
+/* Returns true when the last route using the ecommunity is gone */
+static bool bgp_aggr_ecommunity_del(struct bgp_aggregate *aggregate,
+				    struct ecommunity *ecommunity, bool apply)
+{
+	struct ecommunity *aggr_ecommunity = NULL;
+	struct ecommunity *ret_ecomm = NULL;
+
+	/* Look-up the ecommunity in the hash.
+	 */
+	aggr_ecommunity = bgp_aggr_ecommunity_lookup(aggregate, ecommunity);
+	if (!aggr_ecommunity)
+		return false;
+
+	aggr_ecommunity->refcnt--;
+	if (aggr_ecommunity->refcnt != 0)
+		return false;
+
+	bgp_aggr_ecommunity_vals_update(aggregate, aggr_ecommunity, false,
+					apply);
+
+	ret_ecomm = hash_release(aggregate->ecommunity_hash, aggr_ecommunity);
+	ecommunity_free(&ret_ecomm);
+	return true;
+}
+
+static void bgp_aggr_ecommunity_prepare(struct hash_bucket *hb, void *arg)
+{
+	struct bgp_aggr_ecommunity_val *v = hb->data;
+	struct ecommunity *aggr_ecommunity = arg;
+
+	memcpy(aggr_ecommunity->val + aggr_ecommunity->size * ECOMMUNITY_SIZE,
+	       v->val, ECOMMUNITY_SIZE);
+	aggr_ecommunity->size++;
+}
+
+void bgp_compute_aggregate_ecommunity(struct bgp_aggregate *aggregate,
+				      struct ecommunity *ecommunity)
+{
+	if ((aggregate == NULL) || (ecommunity == NULL))
+		return;
+
+	if (!aggregate->ecommunity) {
+		bgp_aggr_ecommunity_add(aggregate, ecommunity, false);
+		bgp_compute_aggregate_ecommunity_val(aggregate);
+		return;
+	}
+
+	bgp_aggr_ecommunity_add(aggregate, ecommunity, true);
+}
+
+
+void bgp_compute_aggregate_ecommunity_hash(struct bgp_aggregate *aggregate,
+					   struct ecommunity *ecommunity)
+{
+	if ((aggregate == NULL) || (ecommunity == NULL))
+		return;
+
+	bgp_aggr_ecommunity_add(aggregate, ecommunity, false);
 }
 
 void bgp_compute_aggregate_ecommunity_val(struct bgp_aggregate *aggregate)
 {
-	struct ecommunity *ecommerge = NULL;
+	struct ecommunity *aggr_ecommunity;
+	unsigned long count;
 
 	if (aggregate == NULL)
 		return;
 
-	/* Re-compute aggregate's ecommunity.
+	/* Re-compute aggregate's ecommunity from the value counts.
 	 */
 	if (aggregate->ecommunity)
 		ecommunity_free(&aggregate->ecommunity);
 	if (aggregate->ecommunity_hash
 	    && aggregate->ecommunity_hash->count) {
-		hash_iterate(aggregate->ecommunity_hash,
-			     bgp_aggr_ecommunity_prepare,
-			     &aggregate->ecommunity);
-		ecommerge = aggregate->ecommunity;
-		aggregate->ecommunity = ecommunity_uniq_sort(ecommerge);
-		if (ecommerge)
-			ecommunity_free(&ecommerge);
+		aggr_ecommunity = ecommunity_new();
+		count = aggregate->ecommunity_vals
+				? aggregate->ecommunity_vals->count
+				: 0;
+		if (count) {
+			aggr_ecommunity->val =
+				XMALLOC(MTYPE_ECOMMUNITY_VAL,
+					count * ECOMMUNITY_SIZE);
+			hash_iterate(aggregate->ecommunity_vals,
+				     bgp_aggr_ecommunity_prepare,
+				     aggr_ecommunity);
+			qsort(aggr_ecommunity->val, aggr_ecommunity->size,
+			      ECOMMUNITY_SIZE, bgp_aggr_ecommunity_val_order);
+		}
+		aggregate->ecommunity = aggr_ecommunity;
 	}
 }
 
 void bgp_remove_ecommunity_from_aggregate(struct bgp_aggregate *aggregate,
 					  struct ecommunity *ecommunity)
 {
-	struct ecommunity *aggr_ecommunity = NULL;
-	struct ecommunity *ret_ecomm = NULL;
-
 	if ((!aggregate)
 	    || (!aggregate->ecommunity_hash)
 	    || (!ecommunity))
 		return;
 
-	/* Look-up the ecommunity in the hash.
-	 */
-	aggr_ecommunity = bgp_aggr_ecommunity_lookup(aggregate, ecommunity);
-	if (aggr_ecommunity) {
-		aggr_ecommunity->refcnt--;
-
-		if (aggr_ecommunity->refcnt == 0) {
-			ret_ecomm = hash_release(aggregate->ecommunity_hash,
-						 aggr_ecommunity);
-			ecommunity_free(&ret_ecomm);
-			bgp_compute_aggregate_ecommunity_val(aggregate);
-		}
-	}
+	if (!bgp_aggr_ecommunity_del(aggregate, ecommunity,
+				     aggregate->ecommunity != NULL))
+		return;
+
+	if (!aggregate->ecommunity_hash->count)
+		ecommunity_free(&aggregate->ecommunity);
+	else if (!aggregate->ecommunity)
+		bgp_compute_aggregate_ecommunity_val(aggregate);
 }
 
 void bgp_remove_ecomm_from_aggregate_hash(struct bgp_aggregate *aggregate,
 					  struct ecommunity *ecommunity)
 {
-
-	struct ecommunity *aggr_ecommunity = NULL;
-	struct ecommunity *ret_ecomm = NULL;
-
 	if ((!aggregate)
 	    || (!aggregate->ecommunity_hash)
 	    || (!ecommunity))
 		return;
 
-	/* Look-up the ecommunity in the hash.
-	 */
-	aggr_ecommunity = bgp_aggr_ecommunity_lookup(aggregate, ecommunity);
-	if (aggr_ecommunity) {
-		aggr_ecommunity->refcnt--;
-
-		if (aggr_ecommunity->refcnt == 0) {
-			ret_ecomm = hash_release(aggregate->ecommunity_hash,
-						 aggr_ecommunity);
-			ecommunity_free(&ret_ecomm);
-		}
-	}
+	bgp_aggr_ecommunity_del(aggregate, ecommunity, false);
 }
 
 struct ecommunity *
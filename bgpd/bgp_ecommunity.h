@@ -429,6 +429,7 @@ extern void bgp_remove_ecomm_from_aggregate_hash(
 					struct bgp_aggregate *aggregate,
 					struct ecommunity *ecommunity);
 extern void bgp_aggr_ecommunity_remove(void *arg);
+extern void bgp_aggr_ecommunity_vals_free(struct bgp_aggregate *aggregate);
 extern const uint8_t *ecommunity_linkbw_present(struct ecommunity *ecom,
 						uint64_t *bw);
 extern struct ecommunity *
@@ -731,83 +731,6 @@ static void bgp_llgr_stale_timer_expire(struct event *event)
 	bgp_graceful_restart_timer_off(peer->connection, peer);
 }
 
-static void bgp_set_llgr_stale(struct peer *peer, afi_t afi, safi_t safi)
-{
-	struct bgp *bgp = peer->bgp;
-	struct bgp_dest *dest;
-	struct bgp_path_info *pi, *next;
-	struct bgp_table *table;
-	struct attr attr;
-
-	if (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP || safi == SAFI_EVPN) {
-		for (dest = bgp_table_top(bgp->rib[afi][safi]); dest; dest = bgp_route_next(dest)) {
-			struct bgp_dest *rm;
-
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
-
-			for (rm = bgp_table_top(table); rm;
-			     rm = bgp_route_next(rm))
-				for (pi = bgp_dest_get_bgp_path_info(rm);
-				     (pi != NULL) && (next = pi->next, 1); pi = next) {
-					if (pi->peer != peer)
-						continue;
-
-					if (bgp_attr_get_community(pi->attr) &&
-					    community_include(
-						    bgp_attr_get_community(
-							    pi->attr),
-						    COMMUNITY_NO_LLGR))
-						continue;
-
-					if (bgp_attr_get_community(pi->attr) &&
-					    community_include(bgp_attr_get_community(pi->attr),
-							      COMMUNITY_LLGR_STALE))
-						continue;
-
-					if (bgp_debug_neighbor_events(peer))
-						zlog_debug(
-							"%pBP Long-lived set stale community (LLGR_STALE) for: %pFX",
-							peer, &dest->rn->p);
-
-					attr = *pi->attr;
-					bgp_attr_add_llgr_community(&attr);
-					pi->attr = bgp_attr_intern(&attr);
-					bgp_process(bgp, rm, pi, afi, safi);
-				}
-		}
-	} else {
-		for (dest = bgp_table_top(bgp->rib[afi][safi]); dest; dest = bgp_route_next(dest))
-			for (pi = bgp_dest_get_bgp_path_info(dest);
-			     (pi != NULL) && (next = pi->next, 1); pi = next) {
-				if (pi->peer != peer)
-					continue;
-
-				if (bgp_attr_get_community(pi->attr) &&
-				    community_include(
-					    bgp_attr_get_community(pi->attr),
-					    COMMUNITY_NO_LLGR))
-					continue;
-
-				if (bgp_attr_get_community(pi->attr) &&
-				    community_include(bgp_attr_get_community(pi->attr),
-						      COMMUNITY_LLGR_STALE))
-					continue;
-
-				if (bgp_debug_neighbor_events(peer))
-					zlog_debug(
-						"%pBP Long-lived set stale community (LLGR_STALE) for: %pFX",
-						peer, &dest->rn->p);
-
-				attr = *pi->attr;
-				bgp_attr_add_llgr_community(&attr);
-				pi->attr = bgp_attr_intern(&attr);
-				bgp_process(bgp, dest, pi, afi, safi);
-			}
-	}
-}
-
 static void bgp_graceful_restart_timer_expire(struct event *event)
 {
 	struct peer_connection *connection = EVENT_ARG(event);
@@ -852,8 +775,9 @@ static void bgp_graceful_restart_timer_expire(struct event *event)
 			SET_FLAG(peer->af_sflags[afi][safi],
 				 PEER_STATUS_LLGR_WAIT);
 
-			bgp_set_llgr_stale(peer, afi, safi);
-			bgp_clear_stale_route(peer, afi, safi);
+			bgp_stale_job_add(peer, afi, safi,
+					  BGP_STALE_JOB_LLGR |
+						  BGP_STALE_JOB_SWEEP);
 
 			event_add_timer(bm->master, bgp_llgr_stale_timer_expire,
 					paf, peer->llgr[afi][safi].stale_time,
@@ -540,41 +540,154 @@ static void *bgp_aggr_lcommunty_hash_alloc(void *p)
 	return lcommunity;
 }
 
-static void bgp_aggr_lcommunity_prepare(struct hash_bucket *hb, void *arg)
+void bgp_aggr_lcommunity_remove(void *arg)
 {
-	struct lcommunity *hb_lcommunity = hb->data;
-	struct lcommunity **aggr_lcommunity = arg;
+	struct lcommunity *lcommunity = arg;
 
-	if (*aggr_lcommunity)
-		*aggr_lcommunity = lcommunity_merge(*aggr_lcommunity,
-						    hb_lcommunity);
-	else
-		*aggr_lcommunity = lcommunity_dup(hb_lcommunity);
+	lcommunity_free(&lcommunity);
 }
 
-void bgp_aggr_lcommunity_remove(void *arg)
+/*
+ * Number of distinct lcommunities in lcommunity_hash carrying a value.
+ * The aggregate's lcommunity only changes when a count leaves or drops
+ * back to zero.
+ */
+struct bgp_aggr_lcommunity_val {
+	uint8_t val[LCOMMUNITY_SIZE];
+	unsigned long count;
+};
+
+static unsigned int bgp_aggr_lcommunity_val_key(const void *p)
 {
-	struct lcommunity *lcommunity = arg;
+	const struct bgp_aggr_lcommunity_val *v = p;
 
-	lcommunity_free(&lcommunity);
+	return jhash(v->val, LCOMMUNITY_SIZE, 0);
 }
 
-void bgp_compute_aggregate_lcommunity(struct bgp_aggregate *aggregate,
-				      struct lcommunity *lcommunity)
+static bool bgp_aggr_lcommunity_val_cmp(const void *p1, const void *p2)
 {
+	const struct bgp_aggr_lcommunity_val *v1 = p1, *v2 = p2;
 
-	bgp_compute_aggregate_lcommunity_hash(aggregate, lcommunity);
-	bgp_compute_aggregate_lcommunity_val(aggregate);
+	return !memcmp(v1->val, v2->val, LCOMMUNITY_SIZE);
 }
 
-void bgp_compute_aggregate_lcommunity_hash(struct bgp_aggregate *aggregate,
-					   struct lcommunity *lcommunity)
+static void *bgp_aggr_lcommunity_val_alloc(void *p)
 {
+	const struct bgp_aggr_lcommunity_val *ref = p;
+	struct bgp_aggr_lcommunity_val *v;
 
-	struct lcommunity *aggr_lcommunity = NULL;
+	v = XCALLOC(MTYPE_LCOMMUNITY_AGGR, sizeof(*v));
+	memcpy(v->val, ref->val, LCOMMUNITY_SIZE);
+	return v;
+}
 
-	if ((aggregate == NULL) || (lcommunity == NULL))
-		return;
+static void bgp_aggr_lcommunity_val_free(void *arg)
+{
+	XFREE(MTYPE_LCOMMUNITY_AGGR, arg);
+}
+
+void bgp_aggr_lcommunity_vals_free(struct bgp_aggregate *aggregate)
+{
+	hash_clean_and_free(&aggregate->lcommunity_vals,
+			    bgp_aggr_lcommunity_val_free);
+}
+
+static int bgp_aggr_lcommunity_val_order(const void *p1, const void *p2)
+{
+	return memcmp(p1, p2, LCOMMUNITY_SIZE);
+}
+
+/* Insert or remove a value, keeping lcom as lcommunity_uniq_sort() makes it */
+static void bgp_aggr_lcommunity_val_set(struct lcommunity *lcom,
+					const uint8_t *val, bool add)
+{
+	int lo = 0, hi = lcom->size, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (memcmp(lcom->val + mid * LCOMMUNITY_SIZE, val,
+			   LCOMMUNITY_SIZE) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (add) {
+		lcom->size++;
+		lcom->val = XREALLOC(MTYPE_LCOMMUNITY_VAL, lcom->val,
+				     lcom_length(lcom));
+		memmove(lcom->val + (lo + 1) * LCOMMUNITY_SIZE,
+			lcom->val + lo * LCOMMUNITY_SIZE,
+			(lcom->size - 1 - lo) * LCOMMUNITY_SIZE);
+		memcpy(lcom->val + lo * LCOMMUNITY_SIZE, val, LCOMMUNITY_SIZE);
+	} else {
+		assert(lo < lcom->size &&
+		       !memcmp(lcom->val + lo * LCOMMUNITY_SIZE, val,
+			       LCOMMUNITY_SIZE));
+		lcom->size--;
+		memmove(lcom->val + lo * LCOMMUNITY_SIZE,
+			lcom->val + (lo + 1) * LCOMMUNITY_SIZE,
+			(lcom->size - lo) * LCOMMUNITY_SIZE);
+		if (lcom->size)
+			lcom->val = XREALLOC(MTYPE_LCOMMUNITY_VAL, lcom->val,
+					     lcom_length(lcom));
+		else
+			XFREE(MTYPE_LCOMMUNITY_VAL, lcom->val);
+	}
+
+	XFREE(MTYPE_LCOMMUNITY_STR, lcom->str);
+	if (lcom->json) {
+		json_object_free(lcom->json);
+		lcom->json = NULL;
+	}
+}
+
+/* Account for a distinct lcommunity entering or leaving lcommunity_hash;
+ * with 'apply', the aggregate's lcommunity follows along.
+ */
+static void bgp_aggr_lcommunity_vals_update(struct bgp_aggregate *aggregate,
+					    const struct lcommunity *lcommunity,
+					    bool add, bool apply)
+{
+	struct bgp_aggr_lcommunity_val ref, *v;
+	int i;
+
+	if (aggregate->lcommunity_vals == NULL)
+		aggregate->lcommunity_vals = hash_create(
+			bgp_aggr_lcommunity_val_key,
+			bgp_aggr_lcommunity_val_cmp,
+			"BGP Aggregator lcommunity value counts");
+
+	for (i = 0; i < lcommunity->size; i++) {
+		memcpy(ref.val, lcommunity->val + i * LCOMMUNITY_SIZE,
+		       LCOMMUNITY_SIZE);
+
+		if (add) {
+			v = hash_get(aggregate->lcommunity_vals, &ref,
+				     bgp_aggr_lcommunity_val_alloc);
+			if (v->count++ == 0 && apply)
+				bgp_aggr_lcommunity_val_set(aggregate->lcommunity,
+							    v->val, true);
+			continue;
+		}
+
+		v = hash_lookup(aggregate->lcommunity_vals, &ref);
+		if (!v || --v->count)
+			continue;
+
+		if (apply)
+			bgp_aggr_lcommunity_val_set(aggregate->lcommunity,
+						    v->val, false);
+		hash_release(aggregate->lcommunity_vals, v);
+		bgp_aggr_lcommunity_val_free(v);
+	}
+}
+
+/* Returns true when the lcommunity is new to the aggregate */
+static bool bgp_aggr_lcommunity_add(struct bgp_aggregate *aggregate,
+				    struct lcommunity *lcommunity, bool apply)
+{
+	struct lcommunity *aggr_lcommunity = NULL;
 
 	/* Create hash if not already created.
 	 */
@@ -595,80 +708,130 @@ void bgp_compute_aggregate_lcommunity_hash(struct bgp_aggregate *aggregate,
 	/* Increment reference counter.
 	 */
 	aggr_lcommunity->refcnt++;
+	if (aggr_lcommunity->refcnt > 1)
+		return false;
+
+	bgp_aggr_lcommunity_vals_update(aggregate, aggr_lcommunity, true,
+					apply);
+	return true;
+}
+
+/* Returns true when the last route using the lcommunity is gone */
+static bool bgp_aggr_lcommunity_del(struct bgp_aggregate *aggregate,
+				    struct lcommunity *lcommunity, bool apply)
+{
+	struct lcommunity *aggr_lcommunity = NULL;
+	struct lcommunity *ret_lcomm = NULL;
+
+	/* Look-up the lcommunity in the hash.
+	 */
+	aggr_lcommunity = bgp_aggr_lcommunity_lookup(aggregate, lcommunity);
+	if (!aggr_lcommunity)
+		return false;
+
+	aggr_lcommunity->refcnt--;
+	if (aggr_lcommunity->refcnt != 0)
+		return false;
+
+	bgp_aggr_lcommunity_vals_update(aggregate, aggr_lcommunity, false,
+					apply);
+
+	ret_lcomm = hash_release(aggregate->lcommunity_hash, aggr_lcommunity);
+	lcommunity_free(&ret_lcomm);
+	return true;
+}
+
+static void bgp_aggr_lcommunity_prepare(struct hash_bucket *hb, void *arg)
+{
+	struct bgp_aggr_lcommunity_val *v = hb->data;
+	struct lcommunity *aggr_lcommunity = arg;
+
+	memcpy(aggr_lcommunity->val + aggr_lcommunity->size * LCOMMUNITY_SIZE,
+	       v->val, LCOMMUNITY_SIZE);
+	aggr_lcommunity->size++;
+}
+
+void bgp_compute_aggregate_lcommunity(struct bgp_aggregate *aggregate,
+				      struct lcommunity *lcommunity)
+{
+	if ((aggregate == NULL) || (lcommunity == NULL))
+		return;
+
+	if (!aggregate->lcommunity) {
+		bgp_aggr_lcommunity_add(aggregate, lcommunity, false);
+		bgp_compute_aggregate_lcommunity_val(aggregate);
+		return;
+	}
+
+	bgp_aggr_lcommunity_add(aggregate, lcommunity, true);
+}
+
+void bgp_compute_aggregate_lcommunity_hash(struct bgp_aggregate *aggregate,
+					   struct lcommunity *lcommunity)
+{
+	if ((aggregate == NULL) || (lcommunity == NULL))
+		return;
+
+	bgp_aggr_lcommunity_add(aggregate, lcommunity, false);
 }
 
 void bgp_compute_aggregate_lcommunity_val(struct bgp_aggregate *aggregate)
 {
-	struct lcommunity *lcommerge = NULL;
+	struct lcommunity *aggr_lcommunity;
+	unsigned long count;
 
 	if (aggregate == NULL)
 		return;
 
-	/* Re-compute aggregate's lcommunity.
+	/* Re-compute aggregate's lcommunity from the value counts.
 	 */
 	if (aggregate->lcommunity)
 		lcommunity_free(&aggregate->lcommunity);
 	if (aggregate->lcommunity_hash &&
 	    aggregate->lcommunity_hash->count) {
-		hash_iterate(aggregate->lcommunity_hash,
-			     bgp_aggr_lcommunity_prepare,
-			     &aggregate->lcommunity);
-		lcommerge = aggregate->lcommunity;
-		aggregate->lcommunity = lcommunity_uniq_sort(lcommerge);
-		if (lcommerge)
-			lcommunity_free(&lcommerge);
+		aggr_lcommunity = lcommunity_new();
+		count = aggregate->lcommunity_vals
+				? aggregate->lcommunity_vals->count
+				: 0;
+		if (count) {
+			aggr_lcommunity->val =
+				XMALLOC(MTYPE_LCOMMUNITY_VAL,
+					count * LCOMMUNITY_SIZE);
+			hash_iterate(aggregate->lcommunity_vals,
+				     bgp_aggr_lcommunity_prepare,
+				     aggr_lcommunity);
+			qsort(aggr_lcommunity->val, aggr_lcommunity->size,
+			      LCOMMUNITY_SIZE, bgp_aggr_lcommunity_val_order);
+		}
+		aggregate->lcommunity = aggr_lcommunity;
 	}
 }
 
 void bgp_remove_lcommunity_from_aggregate(struct bgp_aggregate *aggregate,
 					  struct lcommunity *lcommunity)
 {
-	struct lcommunity *aggr_lcommunity = NULL;
-	struct lcommunity *ret_lcomm = NULL;
-
 	if ((!aggregate)
 	    || (!aggregate->lcommunity_hash)
 	    || (!lcommunity))
 		return;
 
-	/* Look-up the lcommunity in the hash.
-	 */
-	aggr_lcommunity = bgp_aggr_lcommunity_lookup(aggregate, lcommunity);
-	if (aggr_lcommunity) {
-		aggr_lcommunity->refcnt--;
-
-		if (aggr_lcommunity->refcnt == 0) {
-			ret_lcomm = hash_release(aggregate->lcommunity_hash,
-						 aggr_lcommunity);
-			lcommunity_free(&ret_lcomm);
-
-			bgp_compute_aggregate_lcommunity_val(aggregate);
+	if (!bgp_aggr_lcommunity_del(aggregate, lcommunity,
+				     aggregate->lcommunity != NULL))
+		return;
 
-		}
-	}
+	if (!aggregate->lcommunity_hash->count)
+		lcommunity_free(&aggregate->lcommunity);
+	else if (!aggregate->lcommunity)
+		bgp_compute_aggregate_lcommunity_val(aggregate);
 }
 
 void bgp_remove_lcomm_from_aggregate_hash(struct bgp_aggregate *aggregate,
 					  struct lcommunity *lcommunity)
 {
-	struct lcommunity *aggr_lcommunity = NULL;
-	struct lcommunity *ret_lcomm = NULL;
-
 	if ((!aggregate)
 	    || (!aggregate->lcommunity_hash)
 	    || (!lcommunity))
 		return;
 
-	/* Look-up the lcommunity in the hash.
-	 */
-	aggr_lcommunity = bgp_aggr_lcommunity_lookup(aggregate, lcommunity);
-	if (aggr_lcommunity) {
-		aggr_lcommunity->refcnt--;
-
-		if (aggr_lcommunity->refcnt == 0) {
-			ret_lcomm = hash_release(aggregate->lcommunity_hash,
-						 aggr_lcommunity);
-			lcommunity_free(&ret_lcomm);
-		}
-	}
+	bgp_aggr_lcommunity_del(aggregate, lcommunity, false);
 }
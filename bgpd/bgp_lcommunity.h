@@ -76,5 +76,6 @@ extern void bgp_remove_lcomm_from_aggregate_hash(
 					struct bgp_aggregate *aggregate,
 					struct lcommunity *lcommunity);
 extern void bgp_aggr_lcommunity_remove(void *arg);
+extern void bgp_aggr_lcommunity_vals_free(struct bgp_aggregate *aggregate);
 
 #endif /* _QUAGGA_BGP_LCOMMUNITY_H */
@@ -72,6 +72,7 @@ static const struct option longopts[] = { { "bgp_port", required_argument, NULL,
 					  { "no_zebra", no_argument, NULL, 'Z' },
 					  { "socket_size", required_argument, NULL, 's' },
 					  { "v6-with-v4-nexthops", no_argument, NULL, 'x' },
+					  { "zapi-ring", required_argument, NULL, 'R' },
 					  { 0 } };
 
 /* signal definitions */
@@ -399,6 +400,9 @@ FRR_DAEMON_INFO(bgpd, BGP,
 
 #define DEPRECATED_OPTIONS ""
 
+/* Largest shared memory ring lib/shmring will create */
+#define BGP_ZAPI_RING_MAX_KB (1024U * 1024U)
+
 /* Main routine of bgpd. Treatment of argument and start bgp finite
    state machine is handled at here. */
 int main(int argc, char **argv)
@@ -416,11 +420,12 @@ int main(int argc, char **argv)
 	char *address;
 	struct listnode *node;
 	bool v6_with_v4_nexthops = false;
+	unsigned long zapi_ring_kb = 0;
 
 	addresses->cmp = (int (*)(void *, void *))strcmp;
 
 	frr_preinit(&bgpd_di, argc, argv);
-	frr_opt_add("p:l:SnZe:I:s:x" DEPRECATED_OPTIONS, longopts,
+	frr_opt_add("p:l:SnZe:I:s:xR:" DEPRECATED_OPTIONS, longopts,
 		    "  -p, --bgp_port           Set BGP listen port number (0 means do not listen).\n"
 		    "  -l, --listenon           Listen on specified address (implies -n)\n"
 		    "  -n, --no_kernel          Do not install route to kernel.\n"
@@ -429,7 +434,8 @@ int main(int argc, char **argv)
 		    "  -e, --ecmp               Specify ECMP to use.\n"
 		    "  -I, --int_num            Set instance number (label-manager)\n"
 		    "  -s, --socket_size        Set BGP peer socket send buffer size\n"
-		    "  -x, --v6-with-v4-nexthop Allow BGP to form v6 neighbors using v4 nexthops\n");
+		    "  -x, --v6-with-v4-nexthop Allow BGP to form v6 neighbors using v4 nexthops\n"
+		    "  -R, --zapi-ring          Send messages to zebra through a shared memory ring of this many KiB\n");
 
 	/* Command line argument treatment. */
 	while (1) {
@@ -495,6 +501,15 @@ int main(int argc, char **argv)
 		case 'x':
 			v6_with_v4_nexthops = true;
 			break;
+		case 'R':
+			zapi_ring_kb = strtoul(optarg, NULL, 10);
+			if (zapi_ring_kb > BGP_ZAPI_RING_MAX_KB) {
+				fprintf(stderr,
+					"ZAPI ring size must be at most %u KiB\n",
+					BGP_ZAPI_RING_MAX_KB);
+				return 1;
+			}
+			break;
 		default:
 			frr_help_exit(1);
 		}
@@ -508,6 +523,7 @@ int main(int argc, char **argv)
 	bm->startup_time = monotime(NULL);
 	bm->port = bgp_port;
 	bm->v6_with_v4_nexthops = v6_with_v4_nexthops;
+	bm->zapi_ring_size = zapi_ring_kb * 1024;
 	if (bgp_port == 0)
 		bgp_option_set(BGP_OPT_NO_LISTEN);
 	if (no_fib_flag || no_zebra_flag)
@@ -34,6 +34,7 @@ DEFINE_MTYPE(BGPD, AS_PATH, "BGP aspath");
 DEFINE_MTYPE(BGPD, AS_SEG, "BGP aspath seg");
 DEFINE_MTYPE(BGPD, AS_SEG_DATA, "BGP aspath segment data");
 DEFINE_MTYPE(BGPD, AS_STR, "BGP aspath str");
+DEFINE_MTYPE(BGPD, AS_AGGR, "BGP aggregate aspath counts");
 
 DEFINE_MTYPE(BGPD, BGP_TABLE, "BGP table");
 DEFINE_MTYPE(BGPD, BGP_NODE, "BGP node");
@@ -61,10 +62,12 @@ DEFINE_MTYPE(BGPD, COMMUNITY_ALIAS, "community alias");
 DEFINE_MTYPE(BGPD, COMMUNITY, "community");
 DEFINE_MTYPE(BGPD, COMMUNITY_VAL, "community val");
 DEFINE_MTYPE(BGPD, COMMUNITY_STR, "community str");
+DEFINE_MTYPE(BGPD, COMMUNITY_AGGR, "community aggregate counts");
 
 DEFINE_MTYPE(BGPD, ECOMMUNITY, "extcommunity");
 DEFINE_MTYPE(BGPD, ECOMMUNITY_VAL, "extcommunity val");
 DEFINE_MTYPE(BGPD, ECOMMUNITY_STR, "extcommunity str");
+DEFINE_MTYPE(BGPD, ECOMMUNITY_AGGR, "extcommunity aggregate counts");
 
 DEFINE_MTYPE(BGPD, COMMUNITY_LIST, "community-list");
 DEFINE_MTYPE(BGPD, COMMUNITY_LIST_NAME, "community-list name");
@@ -77,6 +80,7 @@ DEFINE_MTYPE(BGPD, CLUSTER_VAL, "Cluster list val");
 
 DEFINE_MTYPE(BGPD, BGP_PROCESS_QUEUE, "BGP Process queue");
 DEFINE_MTYPE(BGPD, BGP_CLEAR_NODE_QUEUE, "BGP node clear queue");
+DEFINE_MTYPE(BGPD, BGP_STALE_JOB, "BGP stale path job");
 
 DEFINE_MTYPE(BGPD, TRANSIT, "BGP transit attr");
 DEFINE_MTYPE(BGPD, TRANSIT_VAL, "BGP transit val");
@@ -110,6 +114,7 @@ DEFINE_MTYPE(BGPD, BGP_TEA_OPTIONS_VALUE, "BGP TEA Options Value");
 DEFINE_MTYPE(BGPD, LCOMMUNITY, "Large Community");
 DEFINE_MTYPE(BGPD, LCOMMUNITY_STR, "Large Community display string");
 DEFINE_MTYPE(BGPD, LCOMMUNITY_VAL, "Large Community value");
+DEFINE_MTYPE(BGPD, LCOMMUNITY_AGGR, "Large Community aggregate counts");
 
 DEFINE_MTYPE(BGPD, BGP_EVPN, "BGP EVPN Information");
 DEFINE_MTYPE(BGPD, BGP_EVPN_MH_INFO, "BGP EVPN MH Information");
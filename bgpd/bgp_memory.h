@@ -30,6 +30,7 @@ DECLARE_MTYPE(AS_PATH);
 DECLARE_MTYPE(AS_SEG);
 DECLARE_MTYPE(AS_SEG_DATA);
 DECLARE_MTYPE(AS_STR);
+DECLARE_MTYPE(AS_AGGR);
 
 DECLARE_MTYPE(BGP_TABLE);
 DECLARE_MTYPE(BGP_NODE);
@@ -57,10 +58,12 @@ DECLARE_MTYPE(COMMUNITY_ALIAS);
 DECLARE_MTYPE(COMMUNITY);
 DECLARE_MTYPE(COMMUNITY_VAL);
 DECLARE_MTYPE(COMMUNITY_STR);
+DECLARE_MTYPE(COMMUNITY_AGGR);
 
 DECLARE_MTYPE(ECOMMUNITY);
 DECLARE_MTYPE(ECOMMUNITY_VAL);
 DECLARE_MTYPE(ECOMMUNITY_STR);
+DECLARE_MTYPE(ECOMMUNITY_AGGR);
 
 DECLARE_MTYPE(COMMUNITY_LIST);
 DECLARE_MTYPE(COMMUNITY_LIST_NAME);
@@ -73,6 +76,7 @@ DECLARE_MTYPE(CLUSTER_VAL);
 
 DECLARE_MTYPE(BGP_PROCESS_QUEUE);
 DECLARE_MTYPE(BGP_CLEAR_NODE_QUEUE);
+DECLARE_MTYPE(BGP_STALE_JOB);
 
 DECLARE_MTYPE(TRANSIT);
 DECLARE_MTYPE(TRANSIT_VAL);
@@ -106,6 +110,7 @@ DECLARE_MTYPE(BGP_TEA_OPTIONS_VALUE);
 DECLARE_MTYPE(LCOMMUNITY);
 DECLARE_MTYPE(LCOMMUNITY_STR);
 DECLARE_MTYPE(LCOMMUNITY_VAL);
+DECLARE_MTYPE(LCOMMUNITY_AGGR);
 
 DECLARE_MTYPE(BGP_EVPN_MH_INFO);
 DECLARE_MTYPE(BGP_EVPN_ES);
@@ -46,122 +46,96 @@ static int bgp_pbr_match_entry_counter_unique;
 static int bgp_pbr_action_counter_unique;
 static int bgp_pbr_match_iptable_counter_unique;
 
-struct bgp_pbr_match_iptable_unique {
-	uint32_t unique;
-	struct bgp_pbr_match *bpm_found;
-};
-
-struct bgp_pbr_match_entry_unique {
-	uint32_t unique;
-	struct bgp_pbr_match_entry *bpme_found;
-};
+/* zebra notifications carry the unique ID of the object they refer to;
+ * index every object by it so that the lookup does not walk a whole
+ * hash table per notification.
+ */
+static int bgp_pbr_rule_unique_cmp(const struct bgp_pbr_rule *a,
+				   const struct bgp_pbr_rule *b)
+{
+	return numcmp(a->unique, b->unique);
+}
 
-struct bgp_pbr_action_unique {
-	uint32_t unique;
-	struct bgp_pbr_action *bpa_found;
-};
+static uint32_t bgp_pbr_rule_unique_hash(const struct bgp_pbr_rule *a)
+{
+	return jhash_1word(a->unique, 0);
+}
 
-struct bgp_pbr_rule_unique {
-	uint32_t unique;
-	struct bgp_pbr_rule *bpr_found;
-};
+DECLARE_HASH(bgp_pbr_rule_unique, struct bgp_pbr_rule, unique_item,
+	     bgp_pbr_rule_unique_cmp, bgp_pbr_rule_unique_hash);
 
-static int bgp_pbr_rule_walkcb(struct hash_bucket *bucket, void *arg)
+static int bgp_pbr_match_unique_cmp(const struct bgp_pbr_match *a,
+				    const struct bgp_pbr_match *b)
 {
-	struct bgp_pbr_rule *bpr = (struct bgp_pbr_rule *)bucket->data;
-	struct bgp_pbr_rule_unique *bpru = (struct bgp_pbr_rule_unique *)
-		arg;
-	uint32_t unique = bpru->unique;
-
-	if (bpr->unique == unique) {
-		bpru->bpr_found = bpr;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+	return numcmp(a->unique, b->unique);
 }
 
-static int bgp_pbr_action_walkcb(struct hash_bucket *bucket, void *arg)
+static uint32_t bgp_pbr_match_unique_hash(const struct bgp_pbr_match *a)
 {
-	struct bgp_pbr_action *bpa = (struct bgp_pbr_action *)bucket->data;
-	struct bgp_pbr_action_unique *bpau = (struct bgp_pbr_action_unique *)
-		arg;
-	uint32_t unique = bpau->unique;
-
-	if (bpa->unique == unique) {
-		bpau->bpa_found = bpa;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+	return jhash_1word(a->unique, 0);
 }
 
-static int bgp_pbr_match_entry_walkcb(struct hash_bucket *bucket, void *arg)
+DECLARE_HASH(bgp_pbr_match_unique, struct bgp_pbr_match, unique_item,
+	     bgp_pbr_match_unique_cmp, bgp_pbr_match_unique_hash);
+
+static int bgp_pbr_match_iptable_unique_cmp(const struct bgp_pbr_match *a,
+					    const struct bgp_pbr_match *b)
 {
-	struct bgp_pbr_match_entry *bpme =
-		(struct bgp_pbr_match_entry *)bucket->data;
-	struct bgp_pbr_match_entry_unique *bpmeu =
-		(struct bgp_pbr_match_entry_unique *)arg;
-	uint32_t unique = bpmeu->unique;
+	return numcmp(a->unique2, b->unique2);
+}
 
-	if (bpme->unique == unique) {
-		bpmeu->bpme_found = bpme;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+static uint32_t
+bgp_pbr_match_iptable_unique_hash(const struct bgp_pbr_match *a)
+{
+	return jhash_1word(a->unique2, 0);
 }
 
-struct bgp_pbr_match_ipsetname {
-	char *ipsetname;
-	struct bgp_pbr_match *bpm_found;
-};
+DECLARE_HASH(bgp_pbr_match_iptable_unique, struct bgp_pbr_match, unique2_item,
+	     bgp_pbr_match_iptable_unique_cmp,
+	     bgp_pbr_match_iptable_unique_hash);
 
-static int bgp_pbr_match_pername_walkcb(struct hash_bucket *bucket, void *arg)
+static int bgp_pbr_match_entry_unique_cmp(const struct bgp_pbr_match_entry *a,
+					  const struct bgp_pbr_match_entry *b)
 {
-	struct bgp_pbr_match *bpm = (struct bgp_pbr_match *)bucket->data;
-	struct bgp_pbr_match_ipsetname *bpmi =
-		(struct bgp_pbr_match_ipsetname *)arg;
-	char *ipset_name = bpmi->ipsetname;
-
-	if (!strncmp(ipset_name, bpm->ipset_name,
-		     ZEBRA_IPSET_NAME_SIZE)) {
-		bpmi->bpm_found = bpm;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+	return numcmp(a->unique, b->unique);
 }
 
-static int bgp_pbr_match_iptable_walkcb(struct hash_bucket *bucket, void *arg)
+static uint32_t
+bgp_pbr_match_entry_unique_hash(const struct bgp_pbr_match_entry *a)
 {
-	struct bgp_pbr_match *bpm = (struct bgp_pbr_match *)bucket->data;
-	struct bgp_pbr_match_iptable_unique *bpmiu =
-		(struct bgp_pbr_match_iptable_unique *)arg;
-	uint32_t unique = bpmiu->unique;
-
-	if (bpm->unique2 == unique) {
-		bpmiu->bpm_found = bpm;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+	return jhash_1word(a->unique, 0);
 }
 
-struct bgp_pbr_match_unique {
-	uint32_t unique;
-	struct bgp_pbr_match *bpm_found;
-};
+DECLARE_HASH(bgp_pbr_match_entry_unique, struct bgp_pbr_match_entry,
+	     unique_item, bgp_pbr_match_entry_unique_cmp,
+	     bgp_pbr_match_entry_unique_hash);
 
-static int bgp_pbr_match_walkcb(struct hash_bucket *bucket, void *arg)
+static int bgp_pbr_action_unique_cmp(const struct bgp_pbr_action *a,
+				     const struct bgp_pbr_action *b)
 {
-	struct bgp_pbr_match *bpm = (struct bgp_pbr_match *)bucket->data;
-	struct bgp_pbr_match_unique *bpmu = (struct bgp_pbr_match_unique *)
-		arg;
-	uint32_t unique = bpmu->unique;
+	return numcmp(a->unique, b->unique);
+}
 
-	if (bpm->unique == unique) {
-		bpmu->bpm_found = bpm;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+static uint32_t bgp_pbr_action_unique_hash(const struct bgp_pbr_action *a)
+{
+	return jhash_1word(a->unique, 0);
 }
 
+DECLARE_HASH(bgp_pbr_action_unique, struct bgp_pbr_action, unique_item,
+	     bgp_pbr_action_unique_cmp, bgp_pbr_action_unique_hash);
+
+/* unique counters are global, so are the indexes */
+static struct bgp_pbr_rule_unique_head bgp_pbr_rules_by_unique =
+	INIT_HASH(bgp_pbr_rules_by_unique);
+static struct bgp_pbr_match_unique_head bgp_pbr_matches_by_unique =
+	INIT_HASH(bgp_pbr_matches_by_unique);
+static struct bgp_pbr_match_iptable_unique_head bgp_pbr_matches_by_unique2 =
+	INIT_HASH(bgp_pbr_matches_by_unique2);
+static struct bgp_pbr_match_entry_unique_head bgp_pbr_entries_by_unique =
+	INIT_HASH(bgp_pbr_entries_by_unique);
+static struct bgp_pbr_action_unique_head bgp_pbr_actions_by_unique =
+	INIT_HASH(bgp_pbr_actions_by_unique);
+
 static int snprintf_bgp_pbr_match_val(char *str, int len,
 				      struct bgp_pbr_match_val *mval,
 				      const char *prepend)
@@ -975,6 +949,10 @@ int bgp_pbr_build_and_validate_entry(const struct prefix *p,
 
 static void bgp_pbr_match_entry_free(struct bgp_pbr_match_entry *bpme)
 {
+	bgp_send_pbr_ipset_entry_cancel(bpme);
+	if (bpme->unique)
+		bgp_pbr_match_entry_unique_del(&bgp_pbr_entries_by_unique,
+					       bpme);
 	XFREE(MTYPE_PBR_MATCH_ENTRY, bpme);
 }
 
@@ -994,6 +972,11 @@ static void bgp_pbr_match_entry_hash_free(void *arg)
 
 static void bgp_pbr_match_free(struct bgp_pbr_match *bpm)
 {
+	if (bpm->unique)
+		bgp_pbr_match_unique_del(&bgp_pbr_matches_by_unique, bpm);
+	if (bpm->unique2)
+		bgp_pbr_match_iptable_unique_del(&bgp_pbr_matches_by_unique2,
+						 bpm);
 	XFREE(MTYPE_PBR_MATCH, bpm);
 }
 
@@ -1039,6 +1022,8 @@ static void *bgp_pbr_match_alloc_intern(void *arg)
 
 static void bgp_pbr_rule_free(struct bgp_pbr_rule *pbr)
 {
+	if (pbr->unique)
+		bgp_pbr_rule_unique_del(&bgp_pbr_rules_by_unique, pbr);
 	XFREE(MTYPE_PBR_RULE, pbr);
 }
 
@@ -1095,6 +1080,8 @@ static void bgp_pbr_action_free(void *arg)
 
 	bgp_pbr_bpa_remove(bpa);
 
+	if (bpa->unique)
+		bgp_pbr_action_unique_del(&bgp_pbr_actions_by_unique, bpa);
 	XFREE(MTYPE_PBR_ACTION, bpa);
 }
 
@@ -1317,42 +1304,45 @@ struct bgp_pbr_rule *bgp_pbr_rule_lookup(vrf_id_t vrf_id,
 					 uint32_t unique)
 {
 	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
-	struct bgp_pbr_rule_unique bpru;
+	struct bgp_pbr_rule ref, *bpr;
 
 	if (!bgp || unique == 0)
 		return NULL;
-	bpru.unique = unique;
-	bpru.bpr_found = NULL;
-	hash_walk(bgp->pbr_rule_hash, bgp_pbr_rule_walkcb, &bpru);
-	return bpru.bpr_found;
+	ref.unique = unique;
+	bpr = bgp_pbr_rule_unique_find(&bgp_pbr_rules_by_unique, &ref);
+	if (!bpr || !bpr->action || bpr->action->bgp != bgp)
+		return NULL;
+	return bpr;
 }
 
 struct bgp_pbr_action *bgp_pbr_action_rule_lookup(vrf_id_t vrf_id,
 						  uint32_t unique)
 {
 	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
-	struct bgp_pbr_action_unique bpau;
+	struct bgp_pbr_action ref, *bpa;
 
 	if (!bgp || unique == 0)
 		return NULL;
-	bpau.unique = unique;
-	bpau.bpa_found = NULL;
-	hash_walk(bgp->pbr_action_hash, bgp_pbr_action_walkcb, &bpau);
-	return bpau.bpa_found;
+	ref.unique = unique;
+	bpa = bgp_pbr_action_unique_find(&bgp_pbr_actions_by_unique, &ref);
+	if (!bpa || bpa->bgp != bgp)
+		return NULL;
+	return bpa;
 }
 
 struct bgp_pbr_match *bgp_pbr_match_ipset_lookup(vrf_id_t vrf_id,
 						 uint32_t unique)
 {
 	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
-	struct bgp_pbr_match_unique bpmu;
+	struct bgp_pbr_match ref, *bpm;
 
 	if (!bgp || unique == 0)
 		return NULL;
-	bpmu.unique = unique;
-	bpmu.bpm_found = NULL;
-	hash_walk(bgp->pbr_match_hash, bgp_pbr_match_walkcb, &bpmu);
-	return bpmu.bpm_found;
+	ref.unique = unique;
+	bpm = bgp_pbr_match_unique_find(&bgp_pbr_matches_by_unique, &ref);
+	if (!bpm || !bpm->action || bpm->action->bgp != bgp)
+		return NULL;
+	return bpm;
 }
 
 struct bgp_pbr_match_entry *bgp_pbr_match_ipset_entry_lookup(vrf_id_t vrf_id,
@@ -1360,37 +1350,37 @@ struct bgp_pbr_match_entry *bgp_pbr_match_ipset_entry_lookup(vrf_id_t vrf_id,
 						       uint32_t unique)
 {
 	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
-	struct bgp_pbr_match_entry_unique bpmeu;
-	struct bgp_pbr_match_ipsetname bpmi;
+	struct bgp_pbr_match_entry ref, *bpme;
+	struct bgp_pbr_match *bpm;
 
 	if (!bgp || unique == 0)
 		return NULL;
-	bpmi.ipsetname = XCALLOC(MTYPE_TMP, ZEBRA_IPSET_NAME_SIZE);
-	snprintf(bpmi.ipsetname, ZEBRA_IPSET_NAME_SIZE, "%s", ipset_name);
-	bpmi.bpm_found = NULL;
-	hash_walk(bgp->pbr_match_hash, bgp_pbr_match_pername_walkcb, &bpmi);
-	XFREE(MTYPE_TMP, bpmi.ipsetname);
-	if (!bpmi.bpm_found)
+	ref.unique = unique;
+	bpme = bgp_pbr_match_entry_unique_find(&bgp_pbr_entries_by_unique,
+					       &ref);
+	if (!bpme || !bpme->backpointer)
 		return NULL;
-	bpmeu.bpme_found = NULL;
-	bpmeu.unique = unique;
-	hash_walk(bpmi.bpm_found->entry_hash,
-		  bgp_pbr_match_entry_walkcb, &bpmeu);
-	return bpmeu.bpme_found;
+	bpm = bpme->backpointer;
+	if (!bpm->action || bpm->action->bgp != bgp ||
+	    strncmp(ipset_name, bpm->ipset_name, ZEBRA_IPSET_NAME_SIZE))
+		return NULL;
+	return bpme;
 }
 
 struct bgp_pbr_match *bgp_pbr_match_iptable_lookup(vrf_id_t vrf_id,
 						   uint32_t unique)
 {
 	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
-	struct bgp_pbr_match_iptable_unique bpmiu;
+	struct bgp_pbr_match ref, *bpm;
 
 	if (!bgp || unique == 0)
 		return NULL;
-	bpmiu.unique = unique;
-	bpmiu.bpm_found = NULL;
-	hash_walk(bgp->pbr_match_hash, bgp_pbr_match_iptable_walkcb, &bpmiu);
-	return bpmiu.bpm_found;
+	ref.unique2 = unique;
+	bpm = bgp_pbr_match_iptable_unique_find(&bgp_pbr_matches_by_unique2,
+						&ref);
+	if (!bpm || !bpm->action || bpm->action->bgp != bgp)
+		return NULL;
+	return bpm;
 }
 
 void bgp_pbr_cleanup(struct bgp *bgp)
@@ -1735,36 +1725,32 @@ static void bgp_pbr_flush_entry(struct bgp *bgp, struct bgp_pbr_action *bpa,
 }
 
 struct bgp_pbr_match_entry_remain {
+	struct bgp *bgp;
 	struct bgp_pbr_match_entry *bpme_to_match;
 	struct bgp_pbr_match_entry *bpme_found;
 };
 
 struct bgp_pbr_rule_remain {
+	struct bgp *bgp;
 	struct bgp_pbr_rule *bpr_to_match;
 	struct bgp_pbr_rule *bpr_found;
 };
 
+/* The two walkers below look for an object that only differs from the
+ * one to match by its action. They iterate over the handful of actions
+ * and do a hash lookup for each, rather than comparing against every
+ * rule or match installed.
+ */
 static int bgp_pbr_get_same_rule(struct hash_bucket *bucket, void *arg)
 {
-	struct bgp_pbr_rule *r1 = (struct bgp_pbr_rule *)bucket->data;
+	struct bgp_pbr_action *bpa = (struct bgp_pbr_action *)bucket->data;
 	struct bgp_pbr_rule_remain *ctxt =
 		(struct bgp_pbr_rule_remain *)arg;
 	struct bgp_pbr_rule *r2;
+	struct bgp_pbr_rule lookup;
 
 	r2 = ctxt->bpr_to_match;
 
-	if (r1->vrf_id != r2->vrf_id)
-		return HASHWALK_CONTINUE;
-
-	if (r1->flags != r2->flags)
-		return HASHWALK_CONTINUE;
-
-	if (CHECK_FLAG(r1->flags, MATCH_IP_SRC_SET) && !prefix_same(&r1->src, &r2->src))
-		return HASHWALK_CONTINUE;
-
-	if (CHECK_FLAG(r1->flags, MATCH_IP_DST_SET) && !prefix_same(&r1->dst, &r2->dst))
-		return HASHWALK_CONTINUE;
-
 	/* this function is used for two cases:
 	 * - remove an entry upon withdraw request
 	 * (case r2->action is null)
@@ -1773,39 +1759,34 @@ static int bgp_pbr_get_same_rule(struct hash_bucket *bucket, void *arg)
 	 * the old one is removed after the new one
 	 * this is to avoid disruption in traffic
 	 */
-	if (r2->action == NULL ||
-	    r1->action != r2->action) {
-		ctxt->bpr_found = r1;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+	if (r2->action != NULL && bpa == r2->action)
+		return HASHWALK_CONTINUE;
+
+	lookup = *r2;
+	lookup.action = bpa;
+	ctxt->bpr_found = hash_lookup(ctxt->bgp->pbr_rule_hash, &lookup);
+	if (!ctxt->bpr_found)
+		return HASHWALK_CONTINUE;
+	return HASHWALK_ABORT;
 }
 
 static int bgp_pbr_get_remaining_entry(struct hash_bucket *bucket, void *arg)
 {
-	struct bgp_pbr_match *bpm = (struct bgp_pbr_match *)bucket->data;
+	struct bgp_pbr_action *bpa = (struct bgp_pbr_action *)bucket->data;
 	struct bgp_pbr_match_entry_remain *bpmer =
 		(struct bgp_pbr_match_entry_remain *)arg;
-	struct bgp_pbr_match *bpm_temp;
+	struct bgp_pbr_match *bpm;
+	struct bgp_pbr_match lookup;
 	struct bgp_pbr_match_entry *bpme = bpmer->bpme_to_match;
 
 	if (!bpme->backpointer ||
-	    bpm == bpme->backpointer ||
-	    bpme->backpointer->action == bpm->action)
+	    bpme->backpointer->action == bpa)
 		return HASHWALK_CONTINUE;
-	/* ensure bpm other characteristics are equal */
-	bpm_temp = bpme->backpointer;
-	if (bpm_temp->vrf_id != bpm->vrf_id ||
-	    bpm_temp->type != bpm->type ||
-	    bpm_temp->flags != bpm->flags ||
-	    bpm_temp->tcp_flags != bpm->tcp_flags ||
-	    bpm_temp->tcp_mask_flags != bpm->tcp_mask_flags ||
-	    bpm_temp->pkt_len_min != bpm->pkt_len_min ||
-	    bpm_temp->pkt_len_max != bpm->pkt_len_max ||
-	    bpm_temp->dscp_value != bpm->dscp_value ||
-	    bpm_temp->flow_label != bpm->flow_label ||
-	    bpm_temp->family != bpm->family ||
-	    bpm_temp->fragment != bpm->fragment)
+	/* bpm with the same characteristics, bound to that action */
+	lookup = *bpme->backpointer;
+	lookup.action = bpa;
+	bpm = hash_lookup(bpmer->bgp->pbr_match_hash, &lookup);
+	if (!bpm)
 		return HASHWALK_CONTINUE;
 
 	/* look for remaining bpme */
@@ -1861,9 +1842,10 @@ static void bgp_pbr_policyroute_remove_from_zebra_unit(
 		/* A previous entry may already exist
 		 * flush previous entry if necessary
 		 */
+		bprr.bgp = bgp;
 		bprr.bpr_to_match = bpr;
 		bprr.bpr_found = NULL;
-		hash_walk(bgp->pbr_rule_hash, bgp_pbr_get_same_rule, &bprr);
+		hash_walk(bgp->pbr_action_hash, bgp_pbr_get_same_rule, &bprr);
 		if (bprr.bpr_found) {
 			static struct bgp_pbr_rule *local_bpr;
 			static struct bgp_pbr_action *local_bpa;
@@ -1964,9 +1946,10 @@ static void bgp_pbr_policyroute_remove_from_zebra_unit(
 	/* right now, a previous entry may already exist
 	 * flush previous entry if necessary
 	 */
+	bpmer.bgp = bgp;
 	bpmer.bpme_to_match = bpme;
 	bpmer.bpme_found = NULL;
-	hash_walk(bgp->pbr_match_hash, bgp_pbr_get_remaining_entry, &bpmer);
+	hash_walk(bgp->pbr_action_hash, bgp_pbr_get_remaining_entry, &bpmer);
 	if (bpmer.bpme_found) {
 		static struct bgp_pbr_match *local_bpm;
 		static struct bgp_pbr_action *local_bpa;
@@ -2308,7 +2291,12 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 			bpa->installed = false;
 		}
 		bpa->bgp = bgp;
+		/* a drop action keeps fwmark 0 and gets renumbered */
+		if (bpa->unique)
+			bgp_pbr_action_unique_del(&bgp_pbr_actions_by_unique,
+						  bpa);
 		bpa->unique = ++bgp_pbr_action_counter_unique;
+		bgp_pbr_action_unique_add(&bgp_pbr_actions_by_unique, bpa);
 		/* 0 value is forbidden */
 		bpa->install_in_progress = false;
 	}
@@ -2329,6 +2317,7 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 			       bgp_pbr_rule_alloc_intern);
 		if (bpr->unique == 0) {
 			bpr->unique = ++bgp_pbr_action_counter_unique;
+			bgp_pbr_rule_unique_add(&bgp_pbr_rules_by_unique, bpr);
 			bpr->installed = false;
 			bpr->install_in_progress = false;
 			/* link bgp info to bpr */
@@ -2360,9 +2349,10 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 		/* A previous entry may already exist
 		 * flush previous entry if necessary
 		 */
+		bprr.bgp = bgp;
 		bprr.bpr_to_match = bpr;
 		bprr.bpr_found = NULL;
-		hash_walk(bgp->pbr_rule_hash, bgp_pbr_get_same_rule, &bprr);
+		hash_walk(bgp->pbr_action_hash, bgp_pbr_get_same_rule, &bprr);
 		if (bprr.bpr_found) {
 			static struct bgp_pbr_rule *local_bpr;
 			static struct bgp_pbr_action *local_bpa;
@@ -2452,6 +2442,7 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 	/* new, then self allocate ipset_name and unique */
 	if (bpm->unique == 0) {
 		bpm->unique = ++bgp_pbr_match_counter_unique;
+		bgp_pbr_match_unique_add(&bgp_pbr_matches_by_unique, bpm);
 		/* 0 value is forbidden */
 		snprintf(bpm->ipset_name, sizeof(bpm->ipset_name),
 			 "match%p", bpm);
@@ -2463,6 +2454,8 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 
 		/* unique2 should be updated too */
 		bpm->unique2 = ++bgp_pbr_match_iptable_counter_unique;
+		bgp_pbr_match_iptable_unique_add(&bgp_pbr_matches_by_unique2,
+						 bpm);
 		bpm->installed_in_iptable = false;
 		bpm->install_in_progress = false;
 		bpm->install_iptable_in_progress = false;
@@ -2486,6 +2479,8 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 			bgp_pbr_match_entry_alloc_intern);
 	if (bpme->unique == 0) {
 		bpme->unique = ++bgp_pbr_match_entry_counter_unique;
+		bgp_pbr_match_entry_unique_add(&bgp_pbr_entries_by_unique,
+					       bpme);
 		/* 0 value is forbidden */
 		bpme->backpointer = bpm;
 		bpme->installed = false;
@@ -2536,9 +2531,10 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 	/* A previous entry may already exist
 	 * flush previous entry if necessary
 	 */
+	bpmer.bgp = bgp;
 	bpmer.bpme_to_match = bpme;
 	bpmer.bpme_found = NULL;
-	hash_walk(bgp->pbr_match_hash, bgp_pbr_get_remaining_entry, &bpmer);
+	hash_walk(bgp->pbr_action_hash, bgp_pbr_get_remaining_entry, &bpmer);
 	if (bpmer.bpme_found) {
 		static struct bgp_pbr_match *local_bpm;
 		static struct bgp_pbr_action *local_bpa;
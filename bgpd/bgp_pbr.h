@@ -8,6 +8,7 @@
 
 #include "nexthop.h"
 #include "zclient.h"
+#include "typesafe.h"
 
 /* flowspec case: 0 to 3 actions maximum:
  * 1 redirect
@@ -151,6 +152,16 @@ struct bgp_pbr_config {
 	bool pbr_interface_any_ipv6;
 };
 
+/* lookup of PBR objects by the unique ID zebra echoes back in notifications */
+PREDECL_HASH(bgp_pbr_rule_unique);
+PREDECL_HASH(bgp_pbr_match_unique);
+PREDECL_HASH(bgp_pbr_match_iptable_unique);
+PREDECL_HASH(bgp_pbr_match_entry_unique);
+PREDECL_HASH(bgp_pbr_action_unique);
+
+/* ipset entries waiting to be sent to zebra in a single message */
+PREDECL_DLIST(bgp_pbr_entry_batch);
+
 struct bgp_pbr_rule {
 	uint32_t flags;
 	struct prefix src;
@@ -162,6 +173,8 @@ struct bgp_pbr_rule {
 	bool installed;
 	bool install_in_progress;
 	void *path;
+
+	struct bgp_pbr_rule_unique_item unique_item;
 };
 
 struct bgp_pbr_match {
@@ -203,6 +216,8 @@ struct bgp_pbr_match {
 
 	struct bgp_pbr_action *action;
 
+	struct bgp_pbr_match_unique_item unique_item;
+	struct bgp_pbr_match_iptable_unique_item unique2_item;
 };
 
 struct bgp_pbr_match_entry {
@@ -223,6 +238,9 @@ struct bgp_pbr_match_entry {
 
 	bool installed;
 	bool install_in_progress;
+
+	struct bgp_pbr_match_entry_unique_item unique_item;
+	struct bgp_pbr_entry_batch_item batch_item;
 };
 
 struct bgp_pbr_action {
@@ -250,6 +268,8 @@ struct bgp_pbr_action {
 	uint32_t refcnt;
 	struct bgp *bgp;
 	afi_t afi;
+
+	struct bgp_pbr_action_unique_item unique_item;
 };
 
 extern struct bgp_pbr_rule *bgp_pbr_rule_lookup(vrf_id_t vrf_id,
@@ -7276,6 +7276,9 @@ void bgp_clear_route(struct peer *peer, afi_t afi, safi_t safi)
 	struct bgp_dest *dest;
 	struct bgp_table *table;
 
+	/* Finish stale path work before paths get marked stale anew */
+	bgp_stale_job_flush(peer, afi, safi);
+
 	if (peer->clear_node_queue == NULL)
 		bgp_clear_node_queue_init(peer);
 
@@ -7772,6 +7775,9 @@ void bgp_clear_route_all(struct peer *peer)
 	if (bgp_debug_neighbor_events(peer))
 		zlog_debug("%s: peer %pBP", __func__, peer);
 
+	/* Finish stale path work before paths get marked stale anew */
+	bgp_stale_job_flush_all(peer);
+
 	/* We may be able to batch multiple peers' clearing work: check
 	 * and see.
 	 */
@@ -7814,103 +7820,360 @@ void bgp_clear_adj_in(struct peer *peer, afi_t afi, safi_t safi)
 	}
 }
 
+/* Paced stale path processing.
+ *
+ * Marking retained paths LLGR_STALE and sweeping stale paths when a GR,
+ * LLGR or enhanced route-refresh timer fires used to walk the whole table
+ * synchronously, which with several large peers going through GR at once
+ * held up the main thread long enough to expire other peers' hold timers.
+ * The walk is now a per (peer, afi, safi) job on the peer's stale_queue,
+ * that handles BGP_STALE_JOB_MAX_DESTS dests per run and then requeues
+ * itself, resuming after the last prefix it saw.
+ */
+#define BGP_STALE_JOB_DONE (1 << 7)
+
+struct bgp_stale_job {
+	struct peer *peer;
+	afi_t afi;
+	safi_t safi;
+	uint8_t flags;
+
+	/* Resume point: prefix, and RD for the two-level VPN tables */
+	bool resume;
+	struct prefix pfx;
+	bool rd_resume;
+	struct prefix rd_pfx;
+};
+
+/* Attach the LLGR_STALE community to a stale path, once the "Restart Time"
+ * period has ended.
+ */
+static void bgp_stale_path_llgr(struct bgp_stale_job *job,
+				struct bgp_dest *dest, struct bgp_path_info *pi)
+{
+	struct peer *peer = job->peer;
+	struct attr attr;
+
+	if (bgp_attr_get_community(pi->attr) &&
+	    community_include(bgp_attr_get_community(pi->attr),
+			      COMMUNITY_NO_LLGR))
+		return;
+
+	if (bgp_attr_get_community(pi->attr) &&
+	    community_include(bgp_attr_get_community(pi->attr),
+			      COMMUNITY_LLGR_STALE))
+		return;
+
+	if (bgp_debug_neighbor_events(peer))
+		zlog_debug("%pBP Long-lived set stale community (LLGR_STALE) for: %pBD",
+			   peer, dest);
+
+	attr = *pi->attr;
+	bgp_attr_add_llgr_community(&attr);
+	pi->attr = bgp_attr_intern(&attr);
+	bgp_process(peer->bgp, dest, pi, job->afi, job->safi);
+
+	peer->stale_progress[job->afi][job->safi].paths_llgr_marked++;
+}
+
 /* If any of the routes from the peer have been marked with the NO_LLGR
  * community, either as sent by the peer, or as the result of a configured
  * policy, they MUST NOT be retained, but MUST be removed as per the normal
  * operation of [RFC4271].
  */
-void bgp_clear_stale_route(struct peer *peer, afi_t afi, safi_t safi)
+static void bgp_stale_path_remove(struct bgp_stale_job *job,
+				  struct bgp_dest *dest,
+				  struct bgp_path_info *pi)
 {
-	struct bgp_dest *dest;
-	struct bgp_path_info *pi, *next;
-	struct bgp_table *table;
+	struct peer *peer = job->peer;
+	afi_t afi = job->afi;
+	safi_t safi = job->safi;
+
+	if (CHECK_FLAG(peer->af_sflags[afi][safi], PEER_STATUS_LLGR_WAIT) &&
+	    bgp_attr_get_community(pi->attr) &&
+	    !community_include(bgp_attr_get_community(pi->attr),
+			       COMMUNITY_NO_LLGR))
+		return;
 
 	if (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP || safi == SAFI_EVPN) {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			struct bgp_dest *rm;
+		/*
+		 * If stale route which is being deleted is a l2vpn evpn
+		 * route, then unimport it from all the VRFs and VNIs.
+		 */
+		if (safi == SAFI_EVPN && pi->sub_type == BGP_ROUTE_NORMAL)
+			bgp_evpn_unimport_route(peer->bgp, afi, safi,
+						bgp_dest_get_prefix(dest), pi);
+		/*
+		 * If this is VRF leaked route process for withdraw.
+		 */
+		if (pi->sub_type == BGP_ROUTE_IMPORTED &&
+		    peer->bgp->inst_type == BGP_INSTANCE_TYPE_DEFAULT)
+			vpn_leak_to_vrf_withdraw(pi);
+	} else {
+		if (safi == SAFI_UNICAST &&
+		    (peer->bgp->inst_type == BGP_INSTANCE_TYPE_VRF ||
+		     peer->bgp->inst_type == BGP_INSTANCE_TYPE_DEFAULT))
+			vpn_leak_from_vrf_withdraw(bgp_get_default(), peer->bgp,
+						   pi);
+		if (advertise_type5_routes_multipath(peer->bgp, afi) &&
+		    is_route_injectable_into_evpn(pi))
+			bgp_evpn_unexport_type5_route(peer->bgp, dest, pi, afi,
+						      safi);
 
-			/* look for neighbor in tables */
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
+		bgp_ls_withdraw_bgp_prefix(peer->bgp, afi, safi, dest, pi);
+	}
 
-			for (rm = bgp_table_top(table); rm;
-			     rm = bgp_route_next(rm))
-				for (pi = bgp_dest_get_bgp_path_info(rm);
-				     (pi != NULL) && (next = pi->next, 1);
-				     pi = next) {
-					if (pi->peer != peer)
-						continue;
-					if (CHECK_FLAG(
-						    peer->af_sflags[afi][safi],
-						    PEER_STATUS_LLGR_WAIT) &&
-					    bgp_attr_get_community(pi->attr) &&
-					    !community_include(
-						    bgp_attr_get_community(
-							    pi->attr),
-						    COMMUNITY_NO_LLGR))
-						continue;
-					if (!CHECK_FLAG(pi->flags,
-							BGP_PATH_STALE))
-						continue;
+	bgp_rib_remove(dest, pi, peer, afi, safi);
 
-					/*
-					 * If stale route which is being deleted
-					 * is a l2vpn evpn route, then unimport
-					 * it from all the VRFs and VNIs.
-					 */
-					if (safi == SAFI_EVPN && pi->sub_type == BGP_ROUTE_NORMAL)
-						bgp_evpn_unimport_route(peer->bgp, afi, safi,
-									bgp_dest_get_prefix(rm),
-									pi);
-					/*
-					 * If this is VRF leaked route
-					 * process for withdraw.
-					 */
-					if (pi->sub_type ==
-						    BGP_ROUTE_IMPORTED &&
-					    peer->bgp->inst_type ==
-						    BGP_INSTANCE_TYPE_DEFAULT)
-						vpn_leak_to_vrf_withdraw(pi);
+	peer->stale_progress[afi][safi].paths_removed++;
+}
 
-					bgp_rib_remove(rm, pi, peer, afi, safi);
-				}
+static void bgp_stale_job_dest(struct bgp_stale_job *job,
+			       struct bgp_dest *dest)
+{
+	struct bgp_path_info *pi, *next;
+
+	for (pi = bgp_dest_get_bgp_path_info(dest);
+	     (pi != NULL) && (next = pi->next, 1); pi = next) {
+		if (pi->peer != job->peer)
+			continue;
+
+		/* Only paths that are still stale: the peer may have
+		 * refreshed some of them since the job was queued.
+		 */
+		if (!CHECK_FLAG(pi->flags, BGP_PATH_STALE))
+			continue;
+
+		if (CHECK_FLAG(job->flags, BGP_STALE_JOB_LLGR))
+			bgp_stale_path_llgr(job, dest, pi);
+
+		if (CHECK_FLAG(job->flags, BGP_STALE_JOB_SWEEP))
+			bgp_stale_path_remove(job, dest, pi);
+	}
+}
+
+/*
+ * Walk a table from the resume point in 'pfx', if any.  Returns true once
+ * the table is done, false if the budget ran out first, with 'pfx' set to
+ * the last prefix handled.  A budget of zero means no limit.
+ */
+static bool bgp_stale_job_walk_table(struct bgp_stale_job *job,
+				     struct bgp_table *table,
+				     struct prefix *pfx, bool *resume,
+				     uint32_t *budget)
+{
+	struct bgp_dest *dest;
+
+	if (*resume)
+		dest = bgp_table_get_next(table, pfx);
+	else
+		dest = bgp_table_top(table);
+	*resume = false;
+
+	for (; dest; dest = bgp_route_next(dest)) {
+		bgp_stale_job_dest(job, dest);
+		job->peer->stale_progress[job->afi][job->safi].dests_walked++;
+
+		if (*budget && --(*budget) == 0) {
+			prefix_copy(pfx, bgp_dest_get_prefix(dest));
+			*resume = true;
+
+			/* Unref, since we're breaking the iteration */
+			bgp_dest_unlock_node(dest);
+			return false;
 		}
-	} else {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest))
-			for (pi = bgp_dest_get_bgp_path_info(dest);
-			     (pi != NULL) && (next = pi->next, 1); pi = next) {
-				if (pi->peer != peer)
-					continue;
-				if (CHECK_FLAG(peer->af_sflags[afi][safi],
-					       PEER_STATUS_LLGR_WAIT) &&
-				    bgp_attr_get_community(pi->attr) &&
-				    !community_include(
-					    bgp_attr_get_community(pi->attr),
-					    COMMUNITY_NO_LLGR))
-					continue;
-				if (!CHECK_FLAG(pi->flags, BGP_PATH_STALE))
-					continue;
-				if (safi == SAFI_UNICAST &&
-				    (peer->bgp->inst_type ==
-					     BGP_INSTANCE_TYPE_VRF ||
-				     peer->bgp->inst_type ==
-					     BGP_INSTANCE_TYPE_DEFAULT))
-					vpn_leak_from_vrf_withdraw(
-						bgp_get_default(), peer->bgp,
-						pi);
-				if (advertise_type5_routes_multipath(peer->bgp, afi) &&
-				    is_route_injectable_into_evpn(pi))
-					bgp_evpn_unexport_type5_route(peer->bgp, dest, pi, afi,
-								      safi);
+	}
 
-				bgp_ls_withdraw_bgp_prefix(peer->bgp, afi, safi, dest, pi);
+	return true;
+}
 
-				bgp_rib_remove(dest, pi, peer, afi, safi);
-			}
+static bool bgp_stale_job_walk(struct bgp_stale_job *job, uint32_t budget)
+{
+	struct bgp_table *table, *outer_table;
+	struct bgp_dest *dest;
+	afi_t afi = job->afi;
+	safi_t safi = job->safi;
+
+	outer_table = job->peer->bgp->rib[afi][safi];
+	if (!outer_table)
+		return true;
+
+	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN)
+		return bgp_stale_job_walk_table(job, outer_table, &job->pfx,
+						&job->resume, &budget);
+
+	dest = NULL;
+	if (job->rd_resume) {
+		/* Stay on the current RD if it is still there */
+		dest = bgp_node_lookup(outer_table, &job->rd_pfx);
+		if (!dest) {
+			dest = bgp_table_get_next(outer_table, &job->rd_pfx);
+			job->resume = false;
+		}
+		job->rd_resume = false;
+	} else
+		dest = bgp_table_top(outer_table);
+
+	for (; dest; dest = bgp_route_next(dest)) {
+		table = bgp_dest_get_bgp_table_info(dest);
+		if (!table) {
+			job->resume = false;
+			continue;
+		}
+
+		if (!bgp_stale_job_walk_table(job, table, &job->pfx,
+					      &job->resume, &budget)) {
+			prefix_copy(&job->rd_pfx, bgp_dest_get_prefix(dest));
+			job->rd_resume = true;
+
+			/* Unref, since we're breaking the iteration */
+			bgp_dest_unlock_node(dest);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void bgp_stale_job_done(struct bgp_stale_job *job)
+{
+	struct peer *peer = job->peer;
+	afi_t afi = job->afi;
+	safi_t safi = job->safi;
+
+	SET_FLAG(job->flags, BGP_STALE_JOB_DONE);
+	peer->stale_progress[afi][safi].running = false;
+	if (peer->stale_job[afi][safi] == job)
+		peer->stale_job[afi][safi] = NULL;
+
+	if (bgp_debug_neighbor_events(peer))
+		zlog_debug("%pBP stale path job for %s done: %u dests walked, %u paths marked LLGR stale, %u paths removed",
+			   peer, get_afi_safi_str(afi, safi, false),
+			   peer->stale_progress[afi][safi].dests_walked,
+			   peer->stale_progress[afi][safi].paths_llgr_marked,
+			   peer->stale_progress[afi][safi].paths_removed);
+}
+
+static wq_item_status bgp_stale_job_run(struct work_queue *wq, void *data)
+{
+	struct bgp_stale_job *job = data;
+
+	/* Already run to completion by bgp_stale_job_flush() */
+	if (CHECK_FLAG(job->flags, BGP_STALE_JOB_DONE))
+		return WQ_SUCCESS;
+
+	if (!bgp_stale_job_walk(job, BGP_STALE_JOB_MAX_DESTS))
+		return WQ_REQUEUE;
+
+	bgp_stale_job_done(job);
+	return WQ_SUCCESS;
+}
+
+static void bgp_stale_job_del(struct work_queue *wq, void *data)
+{
+	struct bgp_stale_job *job = data;
+
+	if (job->peer->stale_job[job->afi][job->safi] == job)
+		job->peer->stale_job[job->afi][job->safi] = NULL;
+
+	XFREE(MTYPE_BGP_STALE_JOB, job);
+}
+
+static void bgp_stale_queue_complete(struct work_queue *wq)
+{
+	struct peer *peer = wq->spec.data;
+
+	peer_unlock(peer); /* bgp_stale_job_add */
+}
+
+static void bgp_stale_queue_init(struct peer *peer)
+{
+	char wname[sizeof("stale xxxx:xxxx:xxxx:xxxx:xxxx:xxxx:xxxx:xxxx")];
+
+	snprintf(wname, sizeof(wname), "stale %s", peer->host);
+
+	peer->stale_queue = work_queue_new(bm->master, wname);
+	peer->stale_queue->spec.hold = 10;
+	peer->stale_queue->spec.workfunc = &bgp_stale_job_run;
+	peer->stale_queue->spec.del_item_data = &bgp_stale_job_del;
+	peer->stale_queue->spec.completion_func = &bgp_stale_queue_complete;
+	peer->stale_queue->spec.max_retries = 0;
+	peer->stale_queue->spec.data = peer;
+}
+
+/*
+ * Run whatever is left of a pending stale path job right away.  Used
+ * before anything that changes which paths are stale, so that the
+ * outcome is the same as if the job had run synchronously when queued.
+ */
+void bgp_stale_job_flush(struct peer *peer, afi_t afi, safi_t safi)
+{
+	struct bgp_stale_job *job = peer->stale_job[afi][safi];
+
+	if (!job)
+		return;
+
+	bgp_stale_job_walk(job, 0);
+	bgp_stale_job_done(job);
+}
+
+void bgp_stale_job_flush_all(struct peer *peer)
+{
+	afi_t afi;
+	safi_t safi;
+
+	FOREACH_AFI_SAFI (afi, safi)
+		bgp_stale_job_flush(peer, afi, safi);
+}
+
+/*
+ * Queue a paced walk over the peer's stale paths for afi/safi, marking
+ * them LLGR_STALE and/or removing them as per 'flags'.
+ */
+void bgp_stale_job_add(struct peer *peer, afi_t afi, safi_t safi,
+		       uint8_t flags)
+{
+	struct bgp_stale_job *job;
+
+	if (!peer->bgp->rib[afi][safi])
+		return;
+
+	job = peer->stale_job[afi][safi];
+	if (job) {
+		/* A sweep restarted from the top covers a pending one */
+		if (job->flags == flags && flags == BGP_STALE_JOB_SWEEP) {
+			job->resume = false;
+			job->rd_resume = false;
+			return;
+		}
+
+		bgp_stale_job_flush(peer, afi, safi);
 	}
+
+	if (peer->stale_queue == NULL)
+		bgp_stale_queue_init(peer);
+
+	/* unlocked in bgp_stale_queue_complete */
+	if (work_queue_empty(peer->stale_queue))
+		peer_lock(peer);
+
+	job = XCALLOC(MTYPE_BGP_STALE_JOB, sizeof(struct bgp_stale_job));
+	job->peer = peer;
+	job->afi = afi;
+	job->safi = safi;
+	job->flags = flags;
+
+	peer->stale_job[afi][safi] = job;
+	memset(&peer->stale_progress[afi][safi], 0,
+	       sizeof(peer->stale_progress[afi][safi]));
+	peer->stale_progress[afi][safi].running = true;
+
+	work_queue_add(peer->stale_queue, job);
+}
+
+void bgp_clear_stale_route(struct peer *peer, afi_t afi, safi_t safi)
+{
+	bgp_stale_job_add(peer, afi, safi, BGP_STALE_JOB_SWEEP);
 }
 
 void bgp_set_stale_route(struct peer *peer, afi_t afi, safi_t safi)
@@ -7919,6 +8182,8 @@ void bgp_set_stale_route(struct peer *peer, afi_t afi, safi_t safi)
 	struct bgp_path_info *pi;
 	struct bgp_table *table;
 
+	bgp_stale_job_flush(peer, afi, safi);
+
 	if (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP || safi == SAFI_EVPN) {
 		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
 		     dest = bgp_route_next(dest)) {
@@ -10568,23 +10833,27 @@ void bgp_free_aggregate_info(struct bgp_aggregate *aggregate)
 
 	hash_clean_and_free(&aggregate->community_hash,
 			    bgp_aggr_community_remove);
+	bgp_aggr_community_vals_free(aggregate);
 
 	if (aggregate->ecommunity)
 		ecommunity_free(&aggregate->ecommunity);
 
 	hash_clean_and_free(&aggregate->ecommunity_hash,
 			    bgp_aggr_ecommunity_remove);
+	bgp_aggr_ecommunity_vals_free(aggregate);
 
 	if (aggregate->lcommunity)
 		lcommunity_free(&aggregate->lcommunity);
 
 	hash_clean_and_free(&aggregate->lcommunity_hash,
 			    bgp_aggr_lcommunity_remove);
+	bgp_aggr_lcommunity_vals_free(aggregate);
 
 	if (aggregate->aspath)
 		aspath_free(aggregate->aspath);
 
 	hash_clean_and_free(&aggregate->aspath_hash, bgp_aggr_aspath_remove);
+	bgp_aggr_aspath_asns_free(aggregate);
 
 	bgp_aggregate_free(aggregate);
 }
@@ -493,6 +493,14 @@ struct bgp_aggregate {
 	 */
 	struct hash *aspath_hash;
 
+	/* Per-ASN counts of the AS-Paths in aspath_hash. */
+	struct bgp_aggr_asns *aspath_asns;
+
+	/* Per-value counts of the sets in the (e|l)community hashes. */
+	struct hash *community_vals;
+	struct hash *ecommunity_vals;
+	struct hash *lcommunity_vals;
+
 	/* Aggregate route's community. */
 	struct community *community;
 
@@ -803,6 +811,14 @@ void bgp_clear_route_batch(struct bgp_clearing_info *cinfo);
 
 extern void bgp_clear_adj_in(struct peer *peer, afi_t afi, safi_t safi);
 extern void bgp_clear_stale_route(struct peer *peer, afi_t afi, safi_t safi);
+
+/* Paced stale path jobs */
+#define BGP_STALE_JOB_LLGR  (1 << 0) /* Attach LLGR_STALE community */
+#define BGP_STALE_JOB_SWEEP (1 << 1) /* Remove stale paths */
+extern void bgp_stale_job_add(struct peer *peer, afi_t afi, safi_t safi,
+			      uint8_t flags);
+extern void bgp_stale_job_flush(struct peer *peer, afi_t afi, safi_t safi);
+extern void bgp_stale_job_flush_all(struct peer *peer);
 extern void bgp_set_stale_route(struct peer *peer, afi_t afi, safi_t safi);
 extern bool bgp_outbound_policy_exists(struct peer *peer, struct bgp_filter *filter);
 extern bool bgp_inbound_policy_exists(struct peer *peer, struct bgp_filter *filter);
@@ -14632,6 +14632,38 @@ static void bgp_show_neighbor_graceful_restart_local_mode(struct vty *vty,
 		vty_out(vty, "    Local GR Mode: %s\n", mode);
 }
 
+static void bgp_show_peer_gr_stale_progress(struct vty *vty, struct peer *peer,
+					    afi_t afi, safi_t safi,
+					    json_object *json)
+{
+	json_object *json_stale;
+
+	if (json) {
+		json_stale = json_object_new_object();
+		json_object_boolean_add(json_stale, "running",
+					peer->stale_progress[afi][safi].running);
+		json_object_int_add(json_stale, "destsWalked",
+				    peer->stale_progress[afi][safi].dests_walked);
+		json_object_int_add(json_stale, "pathsLlgrMarked",
+				    peer->stale_progress[afi][safi]
+					    .paths_llgr_marked);
+		json_object_int_add(json_stale, "pathsRemoved",
+				    peer->stale_progress[afi][safi]
+					    .paths_removed);
+		json_object_object_add(json, "stalePathJob", json_stale);
+	} else {
+		vty_out(vty, "      Stale Path Job: %s\n",
+			peer->stale_progress[afi][safi].running ? "Running"
+								: "Done");
+		vty_out(vty, "        Dests walked: %u\n",
+			peer->stale_progress[afi][safi].dests_walked);
+		vty_out(vty, "        Paths marked LLGR stale: %u\n",
+			peer->stale_progress[afi][safi].paths_llgr_marked);
+		vty_out(vty, "        Paths removed: %u\n",
+			peer->stale_progress[afi][safi].paths_removed);
+	}
+}
+
 static void bgp_show_peer_gr_info_afi_safi(struct vty *vty, struct peer *peer, bool use_json,
 					   json_object *json)
 {
@@ -14823,6 +14855,11 @@ static void bgp_show_peer_gr_info_afi_safi(struct vty *vty, struct peer *peer, b
 								.t_select_deferral_tier2));
 			}
 		}
+		if (peer->stale_progress[afi][safi].running ||
+		    peer->stale_progress[afi][safi].dests_walked)
+			bgp_show_peer_gr_stale_progress(vty, peer, afi, safi,
+							json_afi_safi);
+
 		if (json) {
 			json_object_object_add(json_afi_safi, "endOfRibStatus",
 					       json_endofrib_status);
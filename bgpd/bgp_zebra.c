@@ -69,6 +69,13 @@ DEFINE_HOOK(bgp_vrf_status_changed, (struct bgp *bgp, struct interface *ifp),
 
 DEFINE_MTYPE_STATIC(BGPD, BGP_IF_INFO, "BGP interface context");
 
+/* FlowSpec ipset entries waiting to be sent to zebra */
+DECLARE_DLIST(bgp_pbr_entry_batch, struct bgp_pbr_match_entry, batch_item);
+
+static struct bgp_pbr_entry_batch_head bgp_pbr_entry_batch =
+	INIT_DLIST(bgp_pbr_entry_batch);
+static struct event *bgp_pbr_entry_batch_ev;
+
 /* Can we install into zebra? */
 static inline bool bgp_install_info_to_zebra(struct bgp *bgp)
 {
@@ -4564,6 +4571,7 @@ void bgp_zebra_init(struct event_loop *master, unsigned short instance)
 	bgp_zclient->zebra_capabilities = bgp_zebra_capabilities;
 	bgp_zclient->nexthop_update = bgp_nexthop_update;
 	bgp_zclient->instance = instance;
+	bgp_zclient->ring_size = bm->zapi_ring_size;
 
 	/* Initialize special zclient for synchronous message exchanges. */
 	bgp_zclient_sync = zclient_new(master, &zclient_options_sync, NULL, 0);
@@ -4580,6 +4588,10 @@ void bgp_zebra_init(struct event_loop *master, unsigned short instance)
 
 void bgp_zebra_destroy(void)
 {
+	event_cancel(&bgp_pbr_entry_batch_ev);
+	while (bgp_pbr_entry_batch_pop(&bgp_pbr_entry_batch))
+		;
+
 	if (bgp_zclient == NULL)
 		return;
 	zclient_stop(bgp_zclient);
@@ -4598,6 +4610,69 @@ int bgp_zebra_num_connects(void)
 	return zclient_num_connects;
 }
 
+/* ipset entries are what thousands of FlowSpec rules turn into; zebra
+ * accepts several of them per ZEBRA_IPSET_ENTRY_ADD, so installs are
+ * queued and sent together from an event.  PBR deletes still go out
+ * right away, so the queue is flushed ahead of each: a replacement must
+ * be installed before what it replaces is removed.
+ */
+#define BGP_PBR_ENTRY_BATCH_MAX 128
+#define BGP_PBR_ENTRY_ENCODE_MAX                                               \
+	(4 + ZEBRA_IPSET_NAME_SIZE + 2 * (2 + sizeof(struct in6_addr)) + 4 * 2 + 1)
+
+static void bgp_send_pbr_ipset_entry_batch(struct event *event);
+
+static void bgp_pbr_entry_batch_flush(void)
+{
+	struct bgp_pbr_match_entry *sent[BGP_PBR_ENTRY_BATCH_MAX];
+	struct bgp_pbr_match_entry *pbrime;
+	struct stream *s;
+	size_t count_pos;
+	uint32_t count, i;
+
+	while (bgp_pbr_entry_batch_count(&bgp_pbr_entry_batch)) {
+		s = bgp_zclient->obuf;
+		stream_reset(s);
+
+		zclient_create_header(s, ZEBRA_IPSET_ENTRY_ADD, VRF_DEFAULT);
+
+		count_pos = stream_get_endp(s);
+		stream_putl(s, 0);
+
+		count = 0;
+		while (count < BGP_PBR_ENTRY_BATCH_MAX &&
+		       STREAM_WRITEABLE(s) >= BGP_PBR_ENTRY_ENCODE_MAX) {
+			pbrime = bgp_pbr_entry_batch_pop(&bgp_pbr_entry_batch);
+			if (!pbrime)
+				break;
+			bgp_encode_pbr_ipset_entry_match(s, pbrime);
+			sent[count++] = pbrime;
+		}
+
+		stream_putl_at(s, count_pos, count);
+		stream_putw_at(s, 0, stream_get_endp(s));
+		if (zclient_send_message(bgp_zclient) == ZCLIENT_SEND_FAILURE) {
+			/* Put them back, in order, and try again later */
+			while (count)
+				bgp_pbr_entry_batch_add_head(&bgp_pbr_entry_batch,
+							     sent[--count]);
+			event_add_timer(bm->master,
+					bgp_send_pbr_ipset_entry_batch, NULL, 1,
+					&bgp_pbr_entry_batch_ev);
+			return;
+		}
+		for (i = 0; i < count; i++)
+			sent[i]->install_in_progress = true;
+	}
+
+	event_cancel(&bgp_pbr_entry_batch_ev);
+}
+
+static void bgp_send_pbr_ipset_entry_batch(struct event *event)
+{
+	bgp_pbr_entry_batch_flush();
+}
+
 void bgp_send_pbr_rule_action(struct bgp_pbr_action *pbra,
 			      struct bgp_pbr_rule *pbr,
 			      bool install)
@@ -4616,6 +4691,8 @@ void bgp_send_pbr_rule_action(struct bgp_pbr_action *pbra,
 			zlog_debug("%s: table %d fwmark %d %d", __func__,
 				   pbra->table_id, pbra->fwmark, install);
 	}
+	if (!install)
+		bgp_pbr_entry_batch_flush();
 	s = bgp_zclient->obuf;
 	stream_reset(s);
 
@@ -4644,6 +4721,8 @@ void bgp_send_pbr_ipset_match(struct bgp_pbr_match *pbrim, bool install)
 		zlog_debug("%s: name %s type %d %d, ID %u", __func__,
 			   pbrim->ipset_name, pbrim->type, install,
 			   pbrim->unique);
+	if (!install)
+		bgp_pbr_entry_batch_flush();
 	s = bgp_zclient->obuf;
 	stream_reset(s);
 
@@ -4661,6 +4740,12 @@ void bgp_send_pbr_ipset_match(struct bgp_pbr_match *pbrim, bool install)
 		pbrim->install_in_progress = true;
 }
 
+void bgp_send_pbr_ipset_entry_cancel(struct bgp_pbr_match_entry *pbrime)
+{
+	if (bgp_pbr_entry_batch_anywhere(pbrime))
+		bgp_pbr_entry_batch_del(&bgp_pbr_entry_batch, pbrime);
+}
+
 void bgp_send_pbr_ipset_entry_match(struct bgp_pbr_match_entry *pbrime,
 				    bool install)
 {
@@ -4672,21 +4757,30 @@ void bgp_send_pbr_ipset_entry_match(struct bgp_pbr_match_entry *pbrime,
 		zlog_debug("%s: name %s %d %d, ID %u", __func__,
 			   pbrime->backpointer->ipset_name, pbrime->unique,
 			   install, pbrime->unique);
+
+	if (install) {
+		if (!bgp_pbr_entry_batch_anywhere(pbrime))
+			bgp_pbr_entry_batch_add_tail(&bgp_pbr_entry_batch,
+						     pbrime);
+		event_add_event(bm->master, bgp_send_pbr_ipset_entry_batch,
+				NULL, 0, &bgp_pbr_entry_batch_ev);
+		return;
+	}
+
+	bgp_send_pbr_ipset_entry_cancel(pbrime);
+	bgp_pbr_entry_batch_flush();
+
 	s = bgp_zclient->obuf;
 	stream_reset(s);
 
-	zclient_create_header(s,
-			      install ? ZEBRA_IPSET_ENTRY_ADD :
-			      ZEBRA_IPSET_ENTRY_DELETE,
-			      VRF_DEFAULT);
+	zclient_create_header(s, ZEBRA_IPSET_ENTRY_DELETE, VRF_DEFAULT);
 
 	stream_putl(s, 1); /* send one pbr action */
 
 	bgp_encode_pbr_ipset_entry_match(s, pbrime);
 
 	stream_putw_at(s, 0, stream_get_endp(s));
-	if ((zclient_send_message(bgp_zclient) != ZCLIENT_SEND_FAILURE) && install)
-		pbrime->install_in_progress = true;
+	zclient_send_message(bgp_zclient);
 }
 
 static void bgp_encode_pbr_interface_list(struct bgp *bgp, struct stream *s,
@@ -4744,6 +4838,8 @@ void bgp_send_pbr_iptable(struct bgp_pbr_action *pba,
 		zlog_debug("%s: name %s type %d mark %d %d, ID %u", __func__,
 			   pbm->ipset_name, pbm->type, pba->fwmark, install,
 			   pbm->unique2);
+	if (!install)
+		bgp_pbr_entry_batch_flush();
 	s = bgp_zclient->obuf;
 	stream_reset(s);
 
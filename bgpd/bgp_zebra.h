@@ -121,6 +121,7 @@ extern void bgp_send_pbr_ipset_match(struct bgp_pbr_match *pbrim,
 				     bool install);
 extern void bgp_send_pbr_ipset_entry_match(struct bgp_pbr_match_entry *pbrime,
 				    bool install);
+extern void bgp_send_pbr_ipset_entry_cancel(struct bgp_pbr_match_entry *pbrime);
 extern void bgp_send_pbr_iptable(struct bgp_pbr_action *pba,
 			  struct bgp_pbr_match *pbm,
 			  bool install);
@@ -1470,6 +1470,8 @@ static void peer_free(struct peer *peer)
 
 	if (peer->clear_node_queue)
 		work_queue_free_and_null(&peer->clear_node_queue);
+	if (peer->stale_queue)
+		work_queue_free_and_null(&peer->stale_queue);
 
 	XFREE(MTYPE_PEER_CONF_IF, peer->conf_if);
 
@@ -62,8 +62,11 @@ DECLARE_HOOK(bgp_hook_config_write_vrf, (struct vty *vty, struct vrf *vrf),
 #define BGP_CONN_ERROR_DEQUEUE_MAX 10
 /* Limit the number of clearing dests we'll process per callback */
 #define BGP_CLEARING_BATCH_MAX_DESTS 100
+/* Limit the number of dests a stale path job walks per work queue run */
+#define BGP_STALE_JOB_MAX_DESTS 100
 
 struct update_subgroup;
+struct bgp_stale_job;
 struct bpacket;
 struct bgp_pbr_config;
 
@@ -233,6 +236,9 @@ struct bgp_master {
 
 	bool v6_with_v4_nexthops;
 
+	/* Size of the shared memory ring for messages to zebra, 0 if unused */
+	size_t zapi_ring_size;
+
 	/* To preserve ordering of installations into zebra across all Vrfs */
 	struct zebra_announce_head zebra_announce_head;
 	struct zebra_announce_head zebra_announce_early_head;
@@ -1999,6 +2005,16 @@ struct peer {
 
 	/* workqueues */
 	struct work_queue *clear_node_queue;
+	struct work_queue *stale_queue;
+
+	/* Paced GR/LLGR stale path jobs, see bgp_stale_job_add() */
+	struct bgp_stale_job *stale_job[AFI_MAX][SAFI_MAX];
+	struct {
+		bool running;
+		uint32_t dests_walked;
+		uint32_t paths_llgr_marked;
+		uint32_t paths_removed;
+	} stale_progress[AFI_MAX][SAFI_MAX];
 
 #define PEER_TOTAL_RX(peer)                                                    \
 	atomic_load_explicit(&peer->open_in, memory_order_relaxed)             \
@@ -33,6 +33,9 @@
 #include "vty.h"
 #include "command.h"
 
+DEFINE_HOOK(show_memory_extra, (struct vty *vty, struct json_object *json),
+	    (vty, json));
+
 #if defined(HAVE_MALLINFO2) || defined(HAVE_MALLINFO)
 static int show_memory_mallinfo(struct vty *vty)
 {
@@ -181,6 +184,7 @@ DEFUN_NOSH (show_memory,
 		jarg.json = json;
 		jarg.current_group = NULL;
 		qmem_walk(qmem_walker_json, &jarg);
+		hook_call(show_memory_extra, vty, json);
 
 		vty_json(vty, json);
 	} else {
@@ -189,6 +193,7 @@ DEFUN_NOSH (show_memory,
 #endif /* HAVE_MALLINFO */
 
 		qmem_walk(qmem_walker, vty);
+		hook_call(show_memory_extra, vty, NULL);
 	}
 
 	return CMD_SUCCESS;
@@ -7,6 +7,7 @@
 #define _ZEBRA_LIB_VTY_H
 
 #include "memory.h"
+#include "hook.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,6 +15,15 @@ extern "C" {
 
 extern void lib_cmd_init(void);
 
+/*
+ * Called at the end of "show memory", for daemons to add statistics from
+ * their own allocators. json is NULL for text output.
+ */
+struct vty;
+struct json_object;
+DECLARE_HOOK(show_memory_extra, (struct vty *vty, struct json_object *json),
+	     (vty, json));
+
 /* Human friendly string for given byte count */
 #define MTYPE_MEMSTR_LEN 20
 extern const char *mtype_memstr(char *buf, size_t len, unsigned long bytes);
@@ -19,6 +19,7 @@
 #include "lib/nexthop_group_clippy.c"
 
 DEFINE_MTYPE_STATIC(LIB, NEXTHOP_GROUP, "Nexthop Group");
+DEFINE_MTYPE_STATIC(LIB, NEXTHOP_GROUP_KEY, "Nexthop Group key");
 
 /*
  * Internal struct used to hold nhg config strings
@@ -488,6 +489,213 @@ void nexthop_group_mark_duplicates(struct nexthop_group *nhg)
 	}
 }
 
+/*
+ * Fixed part of a nexthop's key record. Fields nexthop_same() ignores for
+ * the nexthop's type are left zeroed, so they can't make two otherwise
+ * equal records differ.
+ */
+struct nhg_key_nexthop {
+	vrf_id_t vrf_id;
+	ifindex_t ifindex;
+	uint32_t srte_color;
+	uint16_t weight;
+	uint8_t type;
+	uint8_t flags;
+#define NHG_KEY_ACTIVE (1 << 0)
+#define NHG_KEY_BACKUP (1 << 1)
+#define NHG_KEY_LABELS (1 << 2)
+#define NHG_KEY_SRV6   (1 << 3)
+#define NHG_KEY_SEGS   (1 << 4)
+	union g_addr gate;
+	union g_addr src;
+	union g_addr rmap_src;
+	uint8_t backup_num;
+	uint8_t num_labels;
+	uint8_t num_segs;
+	uint8_t pad;
+	uint8_t backup_idx[NEXTHOP_MAX_BACKUPS];
+};
+_Static_assert(sizeof(struct nhg_key_nexthop) == NEXTHOP_GROUP_KEY_NEXTHOP_SIZE,
+	       "NEXTHOP_GROUP_KEY_NEXTHOP_SIZE out of date");
+
+void nexthop_group_key_init(struct nexthop_group_key *key, void *buf,
+			    size_t size)
+{
+	memset(key, 0, sizeof(*key));
+	key->data = buf;
+	key->size = buf ? size : 0;
+}
+
+static void *nhg_key_reserve(struct nexthop_group_key *key, size_t len)
+{
+	void *p;
+
+	if (key->len + len > key->size) {
+		uint32_t size = MAX(key->size * 2, key->len + len);
+
+		if (key->heap)
+			key->data = XREALLOC(MTYPE_NEXTHOP_GROUP_KEY, key->data,
+					     size);
+		else {
+			uint8_t *data = XMALLOC(MTYPE_NEXTHOP_GROUP_KEY, size);
+
+			if (key->len)
+				memcpy(data, key->data, key->len);
+			key->data = data;
+			key->heap = true;
+		}
+		key->size = size;
+	}
+
+	p = key->data + key->len;
+	key->len += len;
+	return p;
+}
+
+static void nhg_key_append(struct nexthop_group_key *key, const void *buf,
+			   size_t len)
+{
+	memcpy(nhg_key_reserve(key, len), buf, len);
+}
+
+static void nhg_key_addr(enum nexthop_types_t type, union g_addr *to,
+			 const union g_addr *from)
+{
+	switch (type) {
+	case NEXTHOP_TYPE_IPV4:
+	case NEXTHOP_TYPE_IPV4_IFINDEX:
+		to->ipv4 = from->ipv4;
+		break;
+	case NEXTHOP_TYPE_IPV6:
+	case NEXTHOP_TYPE_IPV6_IFINDEX:
+		to->ipv6 = from->ipv6;
+		break;
+	case NEXTHOP_TYPE_IFINDEX:
+	case NEXTHOP_TYPE_BLACKHOLE:
+		break;
+	}
+}
+
+static void nhg_key_add_nexthop(struct nexthop_group_key *key,
+				const struct nexthop *nh)
+{
+	struct nhg_key_nexthop rec;
+	const struct nexthop_srv6 *srv6 = nh->nh_srv6;
+
+	memset(&rec, 0, sizeof(rec));
+
+	rec.vrf_id = nh->vrf_id;
+	rec.type = nh->type;
+	rec.weight = nh->weight;
+	rec.srte_color = nh->srte_color;
+
+	switch (nh->type) {
+	case NEXTHOP_TYPE_IPV4_IFINDEX:
+	case NEXTHOP_TYPE_IPV6_IFINDEX:
+	case NEXTHOP_TYPE_IFINDEX:
+		rec.ifindex = nh->ifindex;
+		break;
+	case NEXTHOP_TYPE_BLACKHOLE:
+		rec.gate.ipv4.s_addr = nh->bh_type;
+		break;
+	case NEXTHOP_TYPE_IPV4:
+	case NEXTHOP_TYPE_IPV6:
+		break;
+	}
+	nhg_key_addr(nh->type, &rec.gate, &nh->gate);
+	nhg_key_addr(nh->type, &rec.src, &nh->src);
+	nhg_key_addr(nh->type, &rec.rmap_src, &nh->rmap_src);
+
+	if (CHECK_FLAG(nh->flags, NEXTHOP_FLAG_ACTIVE))
+		SET_FLAG(rec.flags, NHG_KEY_ACTIVE);
+
+	if (CHECK_FLAG(nh->flags, NEXTHOP_FLAG_HAS_BACKUP)) {
+		SET_FLAG(rec.flags, NHG_KEY_BACKUP);
+		rec.backup_num = MIN(nh->backup_num, NEXTHOP_MAX_BACKUPS);
+		memcpy(rec.backup_idx, nh->backup_idx, rec.backup_num);
+	}
+
+	if (nh->nh_label) {
+		SET_FLAG(rec.flags, NHG_KEY_LABELS);
+		rec.num_labels = nh->nh_label->num_labels;
+	}
+
+	if (srv6) {
+		SET_FLAG(rec.flags, NHG_KEY_SRV6);
+		if (srv6->seg6_segs) {
+			SET_FLAG(rec.flags, NHG_KEY_SEGS);
+			rec.num_segs = srv6->seg6_segs->num_segs;
+		}
+	}
+
+	nhg_key_append(key, &rec, sizeof(rec));
+
+	if (rec.num_labels)
+		nhg_key_append(key, nh->nh_label->label,
+			       rec.num_labels * sizeof(mpls_label_t));
+
+	if (srv6) {
+		uint32_t action = srv6->seg6local_action;
+
+		nhg_key_append(key, &action, sizeof(action));
+		nhg_key_append(key, &srv6->seg6local_ctx,
+			       sizeof(srv6->seg6local_ctx));
+	}
+
+	if (srv6 && srv6->seg6_segs) {
+		uint32_t behavior = srv6->seg6_segs->encap_behavior;
+
+		nhg_key_append(key, &behavior, sizeof(behavior));
+		nhg_key_append(key, srv6->seg6_segs->seg,
+			       rec.num_segs * sizeof(struct in6_addr));
+	}
+}
+
+void nexthop_group_key_add(struct nexthop_group_key *key,
+			   const struct nexthop_group *nhg)
+{
+	struct nexthop *nh;
+	uint32_t start = key->len;
+	uint32_t count = 0;
+
+	/* Count goes in front, filled in once we know it */
+	nhg_key_reserve(key, sizeof(count));
+
+	for (ALL_NEXTHOPS_PTR(nhg, nh)) {
+		nhg_key_add_nexthop(key, nh);
+		count++;
+	}
+
+	memcpy(key->data + start, &count, sizeof(count));
+}
+
+void nexthop_group_key_finish(struct nexthop_group_key *key)
+{
+	uint32_t hi, lo;
+
+	hi = jhash(key->data, key->len, 0x6b4e8a71);
+	lo = jhash(key->data, key->len, 0x1f3d5b79);
+	key->hash = ((uint64_t)hi << 32) | lo;
+}
+
+void nexthop_group_key_copy(struct nexthop_group_key *to,
+			    const struct nexthop_group_key *from)
+{
+	to->hash = from->hash;
+	to->len = from->len;
+	to->size = from->len;
+	to->data = XMALLOC(MTYPE_NEXTHOP_GROUP_KEY, MAX(from->len, 1U));
+	to->heap = true;
+	memcpy(to->data, from->data, from->len);
+}
+
+void nexthop_group_key_free(struct nexthop_group_key *key)
+{
+	if (key->heap)
+		XFREE(MTYPE_NEXTHOP_GROUP_KEY, key->data);
+	memset(key, 0, sizeof(*key));
+}
+
 static void nhgc_delete_nexthops(struct nexthop_group_cmd *nhgc)
 {
 	struct nexthop *nexthop;
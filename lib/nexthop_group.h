@@ -54,6 +54,50 @@ uint32_t nexthop_group_hash_no_recurse(const struct nexthop_group *nhg);
 uint32_t nexthop_group_hash(const struct nexthop_group *nhg);
 void nexthop_group_mark_duplicates(struct nexthop_group *nhg);
 
+/*
+ * Flat, canonical encoding of one or more nexthop groups, used as a hash
+ * table key. Each nexthop (resolved ones included, in walk order) becomes
+ * a fixed-size zeroed record holding only the fields nexthop_same() looks
+ * at, plus the ACTIVE flag, followed by any labels and SRv6 data. Two sets
+ * of groups compare equal under nexthop_same() exactly when their keys are
+ * byte-for-byte identical, so lookups need one memcmp instead of a walk.
+ *
+ * A key may start out in a caller-supplied buffer (typically on the stack)
+ * and only moves to the heap if it outgrows it.
+ */
+struct nexthop_group_key {
+	uint64_t hash;
+	uint32_t len;
+	uint32_t size;
+	uint8_t *data;
+	bool heap;
+};
+
+/* Key space taken by one nexthop without labels or SRv6 data */
+#define NEXTHOP_GROUP_KEY_NEXTHOP_SIZE 76
+/* Key space taken by a group of 'n' such nexthops, count included */
+#define NEXTHOP_GROUP_KEY_GROUP_SIZE(n)                                        \
+	(sizeof(uint32_t) + (n) * NEXTHOP_GROUP_KEY_NEXTHOP_SIZE)
+
+extern void nexthop_group_key_init(struct nexthop_group_key *key, void *buf,
+				   size_t size);
+/* Append a group; groups are delimited, so order and count both matter */
+extern void nexthop_group_key_add(struct nexthop_group_key *key,
+				  const struct nexthop_group *nhg);
+/* Compute the hash once all groups have been added */
+extern void nexthop_group_key_finish(struct nexthop_group_key *key);
+/* Heap copy of exactly the used length */
+extern void nexthop_group_key_copy(struct nexthop_group_key *to,
+				   const struct nexthop_group_key *from);
+extern void nexthop_group_key_free(struct nexthop_group_key *key);
+
+static inline bool nexthop_group_key_equal(const struct nexthop_group_key *k1,
+					   const struct nexthop_group_key *k2)
+{
+	return k1->hash == k2->hash && k1->len == k2->len &&
+	       !memcmp(k1->data, k2->data, k1->len);
+}
+
 /* Add a nexthop to a list, enforcing the canonical sort order. */
 void nexthop_group_add_sorted(struct nexthop_group *nhg,
 			      struct nexthop *nexthop);
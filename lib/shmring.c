@@ -0,0 +1,315 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Shared memory message ring.
+ */
+#include <zebra.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#endif
+
+#include "shmring.h"
+#include "memory.h"
+#include "frratomic.h"
+
+DEFINE_MTYPE_STATIC(LIB, SHMRING, "Shared memory ring");
+
+/* Largest data area we are willing to create or map */
+#define SHMRING_SIZE_MAX (1U << 30)
+
+/*
+ * Seals on the memfd: the size of the mapping may never change, so the
+ * peer can't truncate it and have us fault on SIGBUS.
+ */
+#define SHMRING_SEALS (F_SEAL_SHRINK | F_SEAL_GROW)
+
+/*
+ * Layout of the shared mapping. head is only written by the producer and
+ * tail only by the consumer; both run freely and are reduced modulo size
+ * when indexing data.
+ */
+struct shmring_shared {
+	_Atomic uint32_t head;
+	_Atomic uint32_t tail;
+	_Atomic uint32_t producer_waiting;
+	uint32_t size;
+	uint8_t data[];
+};
+
+struct shmring {
+	struct shmring_shared *shm;
+	size_t maplen;
+	/* Private copy, so the peer can't change it under us */
+	uint32_t size;
+	int fds[SHMRING_NFDS];
+};
+
+#ifdef __linux__
+
+static void shmring_signal(struct shmring *ring, enum shmring_fd which)
+{
+	uint64_t one = 1;
+
+	/* EAGAIN means the counter is already non-zero, which is enough */
+	if (write(ring->fds[which], &one, sizeof(one)) < 0 && errno != EAGAIN)
+		zlog_warn("%s: eventfd write failed: %s", __func__,
+			  safe_strerror(errno));
+}
+
+static struct shmring *shmring_map(const int fds[SHMRING_NFDS], size_t maplen)
+{
+	struct shmring *ring;
+	void *p;
+
+	p = mmap(NULL, maplen, PROT_READ | PROT_WRITE, MAP_SHARED,
+		 fds[SHMRING_FD_MEM], 0);
+	if (p == MAP_FAILED)
+		return NULL;
+
+	ring = XCALLOC(MTYPE_SHMRING, sizeof(*ring));
+	ring->shm = p;
+	ring->maplen = maplen;
+	memcpy(ring->fds, fds, sizeof(ring->fds));
+	return ring;
+}
+
+static void shmring_close_fds(const int fds[SHMRING_NFDS])
+{
+	for (int i = 0; i < SHMRING_NFDS; i++)
+		if (fds[i] >= 0)
+			close(fds[i]);
+}
+
+struct shmring *shmring_new(size_t size)
+{
+	struct shmring *ring;
+	int fds[SHMRING_NFDS];
+	size_t maplen;
+	uint32_t rsize = 1;
+
+	if (size == 0 || size > SHMRING_SIZE_MAX)
+		return NULL;
+	while (rsize < size)
+		rsize <<= 1;
+	maplen = sizeof(struct shmring_shared) + rsize;
+
+	fds[SHMRING_FD_MEM] = memfd_create("frr-shmring",
+					   MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	fds[SHMRING_FD_DATA] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	fds[SHMRING_FD_SPACE] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (fds[SHMRING_FD_MEM] < 0 || fds[SHMRING_FD_DATA] < 0 ||
+	    fds[SHMRING_FD_SPACE] < 0 ||
+	    ftruncate(fds[SHMRING_FD_MEM], maplen) < 0 ||
+	    fcntl(fds[SHMRING_FD_MEM], F_ADD_SEALS, SHMRING_SEALS) < 0) {
+		zlog_warn("%s: unable to create ring: %s", __func__,
+			  safe_strerror(errno));
+		shmring_close_fds(fds);
+		return NULL;
+	}
+
+	ring = shmring_map(fds, maplen);
+	if (!ring) {
+		zlog_warn("%s: unable to map ring: %s", __func__,
+			  safe_strerror(errno));
+		shmring_close_fds(fds);
+		return NULL;
+	}
+
+	ring->size = rsize;
+	ring->shm->size = rsize;
+	return ring;
+}
+
+struct shmring *shmring_attach(const int fds[SHMRING_NFDS])
+{
+	struct shmring *ring;
+	struct stat st;
+	uint32_t size;
+	int seals;
+
+	/* Without the seals, the size checked below could change later */
+	seals = fcntl(fds[SHMRING_FD_MEM], F_GET_SEALS);
+	if (seals < 0 || (seals & SHMRING_SEALS) != SHMRING_SEALS) {
+		zlog_warn("%s: ring memory is not sealed", __func__);
+		shmring_close_fds(fds);
+		return NULL;
+	}
+
+	if (fstat(fds[SHMRING_FD_MEM], &st) < 0 ||
+	    st.st_size < (off_t)sizeof(struct shmring_shared) ||
+	    st.st_size > (off_t)(sizeof(struct shmring_shared) +
+				 SHMRING_SIZE_MAX)) {
+		shmring_close_fds(fds);
+		return NULL;
+	}
+
+	ring = shmring_map(fds, st.st_size);
+	if (!ring) {
+		shmring_close_fds(fds);
+		return NULL;
+	}
+
+	size = ring->shm->size;
+	if (size == 0 || (size & (size - 1)) ||
+	    sizeof(struct shmring_shared) + size != (size_t)st.st_size) {
+		shmring_free(&ring);
+		return NULL;
+	}
+
+	ring->size = size;
+	return ring;
+}
+
+void shmring_free(struct shmring **ringp)
+{
+	struct shmring *ring = *ringp;
+
+	if (!ring)
+		return;
+
+	munmap(ring->shm, ring->maplen);
+	shmring_close_fds(ring->fds);
+	XFREE(MTYPE_SHMRING, ring);
+	*ringp = NULL;
+}
+
+bool shmring_put(struct shmring *ring, const void *buf, size_t len)
+{
+	struct shmring_shared *shm = ring->shm;
+	uint32_t head, tail, off, chunk;
+
+	head = atomic_load_explicit(&shm->head, memory_order_relaxed);
+	tail = atomic_load_explicit(&shm->tail, memory_order_acquire);
+
+	if (len > ring->size)
+		return false;
+
+	if (len > ring->size - (head - tail)) {
+		/*
+		 * Ask for a wakeup, then look again in case the consumer
+		 * made room before it could have seen the flag.
+		 */
+		atomic_store_explicit(&shm->producer_waiting, 1,
+				      memory_order_seq_cst);
+		tail = atomic_load_explicit(&shm->tail, memory_order_seq_cst);
+		if (len > ring->size - (head - tail))
+			return false;
+		atomic_store_explicit(&shm->producer_waiting, 0,
+				      memory_order_relaxed);
+	}
+
+	off = head & (ring->size - 1);
+	chunk = MIN(len, ring->size - off);
+	memcpy(shm->data + off, buf, chunk);
+	memcpy(shm->data, (const uint8_t *)buf + chunk, len - chunk);
+
+	atomic_store_explicit(&shm->head, head + len, memory_order_seq_cst);
+
+	/*
+	 * The consumer only sleeps once it has caught up with the head it
+	 * last saw; if that was the old head, it needs telling.
+	 */
+	if (atomic_load_explicit(&shm->tail, memory_order_seq_cst) == head)
+		shmring_signal(ring, SHMRING_FD_DATA);
+
+	return true;
+}
+
+ssize_t shmring_used(struct shmring *ring)
+{
+	struct shmring_shared *shm = ring->shm;
+	uint32_t used;
+
+	used = atomic_load_explicit(&shm->head, memory_order_seq_cst) -
+	       atomic_load_explicit(&shm->tail, memory_order_relaxed);
+	if (used > ring->size)
+		return -1;
+	return used;
+}
+
+void shmring_peek(struct shmring *ring, void *buf, size_t len)
+{
+	struct shmring_shared *shm = ring->shm;
+	uint32_t off, chunk;
+
+	off = atomic_load_explicit(&shm->tail, memory_order_relaxed) &
+	      (ring->size - 1);
+	chunk = MIN(len, ring->size - off);
+	memcpy(buf, shm->data + off, chunk);
+	memcpy((uint8_t *)buf + chunk, shm->data, len - chunk);
+}
+
+void shmring_consume(struct shmring *ring, size_t len)
+{
+	struct shmring_shared *shm = ring->shm;
+	uint32_t tail;
+
+	tail = atomic_load_explicit(&shm->tail, memory_order_relaxed);
+	atomic_store_explicit(&shm->tail, tail + len, memory_order_seq_cst);
+
+	if (atomic_load_explicit(&shm->producer_waiting,
+				 memory_order_seq_cst) &&
+	    atomic_exchange_explicit(&shm->producer_waiting, 0,
+				     memory_order_seq_cst))
+		shmring_signal(ring, SHMRING_FD_SPACE);
+}
+
+void shmring_clear(struct shmring *ring, enum shmring_fd which)
+{
+	uint64_t val;
+
+	if (read(ring->fds[which], &val, sizeof(val)) < 0 && errno != EAGAIN)
+		zlog_warn("%s: eventfd read failed: %s", __func__,
+			  safe_strerror(errno));
+}
+
+#else /* !__linux__ */
+
+struct shmring *shmring_new(size_t size)
+{
+	return NULL;
+}
+
+struct shmring *shmring_attach(const int fds[SHMRING_NFDS])
+{
+	for (int i = 0; i < SHMRING_NFDS; i++)
+		if (fds[i] >= 0)
+			close(fds[i]);
+	return NULL;
+}
+
+void shmring_free(struct shmring **ringp)
+{
+	*ringp = NULL;
+}
+
+bool shmring_put(struct shmring *ring, const void *buf, size_t len)
+{
+	return false;
+}
+
+ssize_t shmring_used(struct shmring *ring)
+{
+	return -1;
+}
+
+void shmring_peek(struct shmring *ring, void *buf, size_t len)
+{
+}
+
+void shmring_consume(struct shmring *ring, size_t len)
+{
+}
+
+void shmring_clear(struct shmring *ring, enum shmring_fd which)
+{
+}
+
+#endif /* __linux__ */
+
+int shmring_fd(const struct shmring *ring, enum shmring_fd which)
+{
+	return ring->fds[which];
+}
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Shared memory message ring.
+ *
+ * A single-producer, single-consumer byte ring living in a memfd, with an
+ * eventfd in each direction for wakeups. The producer creates the ring and
+ * passes the descriptors to the consumer, which maps the same memory.
+ * Only available on Linux; elsewhere creation fails and callers are
+ * expected to keep using their socket.
+ */
+#ifndef _FRR_SHMRING_H_
+#define _FRR_SHMRING_H_
+
+#include <zebra.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Descriptors making up a ring, in the order they are passed around */
+enum shmring_fd {
+	SHMRING_FD_MEM,
+	SHMRING_FD_DATA,
+	SHMRING_FD_SPACE,
+	SHMRING_NFDS,
+};
+
+struct shmring;
+
+/*
+ * Create a ring of (at least) the given size, for the producer side.
+ *
+ * @param size	data area size in bytes, rounded up to a power of two
+ * @return the ring, or NULL if it could not be created
+ */
+extern struct shmring *shmring_new(size_t size);
+
+/*
+ * Map a ring created by another process, for the consumer side. The
+ * descriptors are owned by the ring from here on, even on failure.
+ *
+ * @param fds	descriptors as received from the producer
+ * @return the ring, or NULL if the descriptors don't describe a usable ring
+ */
+extern struct shmring *shmring_attach(const int fds[SHMRING_NFDS]);
+
+/*
+ * Unmap the ring and close its descriptors.
+ */
+extern void shmring_free(struct shmring **ringp);
+
+/*
+ * Descriptor to poll: the data eventfd on the consumer side, the space
+ * eventfd on the producer side.
+ */
+extern int shmring_fd(const struct shmring *ring, enum shmring_fd which);
+
+/*
+ * Producer: copy a whole message into the ring, waking the consumer if it
+ * may be waiting.
+ *
+ * @return false if there is not enough room; the consumer will then signal
+ *	   the space eventfd once it has made some
+ */
+extern bool shmring_put(struct shmring *ring, const void *buf, size_t len);
+
+/*
+ * Consumer: number of bytes available, or -1 if the producer has left the
+ * shared indexes in an impossible state.
+ */
+extern ssize_t shmring_used(struct shmring *ring);
+
+/*
+ * Consumer: copy out len bytes without consuming them. The caller must
+ * have checked shmring_used() first.
+ */
+extern void shmring_peek(struct shmring *ring, void *buf, size_t len);
+
+/*
+ * Consumer: release len bytes, waking the producer if it is waiting for
+ * room.
+ */
+extern void shmring_consume(struct shmring *ring, size_t len);
+
+/*
+ * Clear a ring eventfd after it polled readable.
+ */
+extern void shmring_clear(struct shmring *ring, enum shmring_fd which);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_SHMRING_H_ */
@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Fixed-size object slab allocator.
+ */
+#include <zebra.h>
+
+#include "slab.h"
+#include "memory.h"
+#include "frr_pthread.h"
+
+DEFINE_MTYPE_STATIC(LIB, SLAB, "Slab allocator");
+
+#ifndef __has_feature /* not available on old GCC */
+#define __has_feature(x) 0
+#endif
+
+/*
+ * Under AddressSanitizer, give every object its own allocation, so that
+ * use-after-free and overruns are still caught.
+ */
+#if (defined(__SANITIZE_ADDRESS__) || __has_feature(address_sanitizer))
+#define SLAB_PASSTHROUGH 1
+#else
+#define SLAB_PASSTHROUGH 0
+#endif
+
+/* A freed object, threaded onto the slab's free list */
+struct slab_free {
+	struct slab_free *next;
+};
+
+/* Objects are laid out on this alignment */
+#define SLAB_ALIGN sizeof(uint64_t)
+
+struct slab_chunk {
+	struct slab_chunk *next;
+	/* Objects follow */
+	uint64_t data[];
+};
+
+struct slab {
+	pthread_mutex_t mtx;
+	struct memtype *mt;
+
+	size_t objsize;
+	size_t per_chunk;
+
+	struct slab_chunk *chunks;
+	struct slab_free *free;
+
+	/* Next never-used object in the newest chunk, and how many remain */
+	uint8_t *fresh;
+	size_t n_fresh;
+
+	size_t n_chunks;
+	size_t n_in_use;
+	size_t n_free;
+};
+
+struct slab *slab_new(struct memtype *mt, size_t objsize, size_t per_chunk)
+{
+	struct slab *slab;
+
+	slab = XCALLOC(MTYPE_SLAB, sizeof(*slab));
+	pthread_mutex_init(&slab->mtx, NULL);
+	slab->mt = mt;
+
+	/* Room for the free list link, and keep every object aligned */
+	objsize = MAX(objsize, sizeof(struct slab_free));
+	slab->objsize = (objsize + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1);
+	slab->per_chunk = MAX(per_chunk, 1U);
+
+	return slab;
+}
+
+void slab_destroy(struct slab **slabp)
+{
+	struct slab *slab = *slabp;
+	struct slab_chunk *chunk;
+
+	if (!slab)
+		return;
+
+	while ((chunk = slab->chunks)) {
+		slab->chunks = chunk->next;
+		XFREE(slab->mt, chunk);
+	}
+
+	pthread_mutex_destroy(&slab->mtx);
+	XFREE(MTYPE_SLAB, slab);
+	*slabp = NULL;
+}
+
+/* Called with the lock held */
+static void slab_grow(struct slab *slab)
+{
+	struct slab_chunk *chunk;
+
+	chunk = XMALLOC(slab->mt, sizeof(*chunk) +
+					  slab->objsize * slab->per_chunk);
+	chunk->next = slab->chunks;
+	slab->chunks = chunk;
+	slab->n_chunks++;
+
+	slab->fresh = (uint8_t *)chunk->data;
+	slab->n_fresh = slab->per_chunk;
+}
+
+void *slab_alloc(struct slab *slab)
+{
+	void *obj;
+
+	if (SLAB_PASSTHROUGH) {
+		frr_with_mutex (&slab->mtx) {
+			slab->n_in_use++;
+		}
+		return XCALLOC(slab->mt, slab->objsize);
+	}
+
+	frr_with_mutex (&slab->mtx) {
+		if (slab->free) {
+			obj = slab->free;
+			slab->free = slab->free->next;
+			slab->n_free--;
+		} else {
+			if (!slab->n_fresh)
+				slab_grow(slab);
+			obj = slab->fresh;
+			slab->fresh += slab->objsize;
+			slab->n_fresh--;
+		}
+		slab->n_in_use++;
+	}
+
+	memset(obj, 0, slab->objsize);
+	return obj;
+}
+
+void slab_free(struct slab *slab, void *obj)
+{
+	struct slab_free *f = obj;
+
+	if (!obj)
+		return;
+
+	if (SLAB_PASSTHROUGH) {
+		frr_with_mutex (&slab->mtx) {
+			slab->n_in_use--;
+		}
+		XFREE(slab->mt, obj);
+		return;
+	}
+
+	frr_with_mutex (&slab->mtx) {
+		f->next = slab->free;
+		slab->free = f;
+		slab->n_free++;
+		slab->n_in_use--;
+	}
+}
+
+void slab_get_stats(struct slab *slab, struct slab_stats *stats)
+{
+	frr_with_mutex (&slab->mtx) {
+		stats->objsize = slab->objsize;
+		stats->in_use = slab->n_in_use;
+		stats->free = slab->n_free + slab->n_fresh;
+		stats->chunks = slab->n_chunks;
+		stats->bytes = slab->n_chunks *
+			       (sizeof(struct slab_chunk) +
+				slab->objsize * slab->per_chunk);
+	}
+	if (SLAB_PASSTHROUGH)
+		stats->bytes = stats->in_use * stats->objsize;
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Fixed-size object slab allocator.
+ *
+ * Hands out objects of one size, carved from larger chunks, for structures
+ * that exist in very large numbers (e.g. one per route). Compared to one
+ * malloc per object this saves the allocator's per-block header and size
+ * rounding, and keeps objects of a kind close together. Freed objects are
+ * kept for reuse; chunks are only released when the slab is destroyed.
+ * Objects are 8-byte aligned, so this is not for types needing more.
+ *
+ * All functions may be called from any pthread.
+ */
+#ifndef _FRR_SLAB_H_
+#define _FRR_SLAB_H_
+
+#include "memory.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct slab;
+
+struct slab_stats {
+	/* Size of one object, as laid out in a chunk */
+	size_t objsize;
+	/* Objects handed out and not yet freed */
+	size_t in_use;
+	/* Objects ready for reuse, without growing the slab */
+	size_t free;
+	/* Chunks allocated, and the bytes they take up in total */
+	size_t chunks;
+	size_t bytes;
+};
+
+/*
+ * Create a slab.
+ *
+ * @param mt	     memory type the chunks are accounted to
+ * @param objsize    size of each object
+ * @param per_chunk  number of objects carved from each chunk
+ */
+extern struct slab *slab_new(struct memtype *mt, size_t objsize,
+			     size_t per_chunk);
+
+/*
+ * Release a slab and all of its chunks. Objects still in use become
+ * invalid.
+ */
+extern void slab_destroy(struct slab **slabp);
+
+/* Get a zeroed object */
+extern void *slab_alloc(struct slab *slab);
+
+/* Return an object to the slab it came from; NULL is ignored */
+extern void slab_free(struct slab *slab, void *obj);
+
+extern void slab_get_stats(struct slab *slab, struct slab_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_SLAB_H_ */
@@ -28,6 +28,7 @@
 #include "srte.h"
 #include "printfrr.h"
 #include "srv6.h"
+#include "shmring.h"
 
 DEFINE_MTYPE_STATIC(LIB, ZCLIENT, "Zclient");
 DEFINE_MTYPE_STATIC(LIB, REDIST_INST, "Redistribution instance IDs");
@@ -85,6 +86,8 @@ struct zclient *zclient_new(struct event_loop *master,
 	zclient->synchronous = opt->synchronous;
 	zclient->auxiliary = opt->auxiliary;
 
+	zclient->ring_pending = stream_fifo_new();
+
 	return zclient;
 }
 
@@ -101,6 +104,9 @@ void zclient_free(struct zclient *zclient)
 		stream_free(zclient->obuf);
 	if (zclient->wb)
 		buffer_free(zclient->wb);
+	if (zclient->ring_pending)
+		stream_fifo_free(zclient->ring_pending);
+	shmring_free(&zclient->ring);
 
 	XFREE(MTYPE_ZCLIENT, zclient);
 }
@@ -260,6 +266,7 @@ void zclient_stop(struct zclient *zclient)
 	event_cancel(&zclient->t_read);
 	event_cancel(&zclient->t_connect);
 	event_cancel(&zclient->t_write);
+	event_cancel(&zclient->t_ring_space);
 
 	/* Reset streams. */
 	stream_reset(zclient->ibuf);
@@ -268,6 +275,11 @@ void zclient_stop(struct zclient *zclient)
 	/* Empty the write buffer. */
 	buffer_reset(zclient->wb);
 
+	/* The ring only lives as long as the session. */
+	stream_fifo_clean(zclient->ring_pending);
+	shmring_free(&zclient->ring);
+	zclient->ring_acked = false;
+
 	/* Close socket. */
 	if (zclient->sock >= 0) {
 		close(zclient->sock);
@@ -340,6 +352,16 @@ int zclient_socket_connect(struct zclient *zclient)
 
 static enum zclient_send_status zclient_failed(struct zclient *zclient)
 {
+	/*
+	 * Zebra drops sessions whose ring it cannot use before answering
+	 * anything; don't offer one again.
+	 */
+	if (zclient->ring && !zclient->ring_acked) {
+		zlog_warn("zclient %p: session failed after offering a shared memory ring, using the socket only",
+			  zclient);
+		zclient->ring_size = 0;
+	}
+
 	zclient->fail++;
 	zclient_stop(zclient);
 	zclient_event(ZCLIENT_CONNECT, zclient);
@@ -374,6 +396,53 @@ static void zclient_flush_data(struct event *event)
 	}
 }
 
+/*
+ * Zebra made room in the ring: move over whatever has queued up meanwhile.
+ */
+static void zclient_ring_space(struct event *event)
+{
+	struct zclient *zclient = EVENT_ARG(event);
+	struct stream *s;
+
+	shmring_clear(zclient->ring, SHMRING_FD_SPACE);
+
+	while ((s = stream_fifo_head(zclient->ring_pending))) {
+		if (!shmring_put(zclient->ring, STREAM_DATA(s),
+				 stream_get_endp(s))) {
+			event_add_read(zclient->master, zclient_ring_space,
+				       zclient,
+				       shmring_fd(zclient->ring,
+						  SHMRING_FD_SPACE),
+				       &zclient->t_ring_space);
+			return;
+		}
+		stream_free(stream_fifo_pop(zclient->ring_pending));
+	}
+
+	if (zclient->zebra_buffer_write_ready)
+		(*zclient->zebra_buffer_write_ready)();
+}
+
+/*
+ * Messages to zebra go into the ring once one is in use; the socket then
+ * only carries messages from zebra. Keep them in order behind anything
+ * already waiting for room.
+ */
+static enum zclient_send_status zclient_ring_send(struct zclient *zclient)
+{
+	struct stream *s = zclient->obuf;
+
+	if (!stream_fifo_head(zclient->ring_pending) &&
+	    shmring_put(zclient->ring, STREAM_DATA(s), stream_get_endp(s)))
+		return ZCLIENT_SEND_SUCCESS;
+
+	stream_fifo_push(zclient->ring_pending, stream_dup(s));
+	event_add_read(zclient->master, zclient_ring_space, zclient,
+		       shmring_fd(zclient->ring, SHMRING_FD_SPACE),
+		       &zclient->t_ring_space);
+	return ZCLIENT_SEND_BUFFERED;
+}
+
 /*
  * Returns:
  * ZCLIENT_SEND_FAILED   - is a failure
@@ -384,6 +453,8 @@ enum zclient_send_status zclient_send_message(struct zclient *zclient)
 {
 	if (zclient->sock < 0)
 		return ZCLIENT_SEND_FAILURE;
+	if (zclient->ring)
+		return zclient_ring_send(zclient);
 	switch (buffer_write(zclient->wb, zclient->sock,
 			     STREAM_DATA(zclient->obuf),
 			     stream_get_endp(zclient->obuf))) {
@@ -477,14 +548,90 @@ static enum zclient_send_status zebra_message_send(struct zclient *zclient,
 	return zclient_send_message(zclient);
 }
 
+/*
+ * Send the HELLO in obuf together with the ring descriptors.
+ *
+ * Returns false, with the ring released and the flag dropped from the
+ * message, if the descriptors could not be passed; the caller then sends
+ * the HELLO the usual way.
+ */
+static bool zclient_send_hello_ring(struct zclient *zclient)
+{
+	struct stream *s = zclient->obuf;
+	union {
+		char buf[CMSG_SPACE(sizeof(int) * SHMRING_NFDS)];
+		struct cmsghdr align;
+	} cmsgbuf = {};
+	struct msghdr msgh = {};
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	int *fds;
+	size_t len = stream_get_endp(s);
+	ssize_t nb;
+
+	iov.iov_base = STREAM_DATA(s);
+	iov.iov_len = len;
+	msgh.msg_iov = &iov;
+	msgh.msg_iovlen = 1;
+	msgh.msg_control = cmsgbuf.buf;
+	msgh.msg_controllen = sizeof(cmsgbuf.buf);
+
+	cmsg = CMSG_FIRSTHDR(&msgh);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int) * SHMRING_NFDS);
+	fds = (int *)CMSG_DATA(cmsg);
+	for (int i = 0; i < SHMRING_NFDS; i++)
+		fds[i] = shmring_fd(zclient->ring, i);
+
+	nb = sendmsg(zclient->sock, &msgh, 0);
+	if (nb < 0) {
+		if (zclient_debug)
+			zlog_debug("%s: unable to pass ring to zebra: %s",
+				   __func__, safe_strerror(errno));
+		shmring_free(&zclient->ring);
+		/* Drop the trailing flags byte again */
+		stream_set_endp(s, len - 1);
+		stream_putw_at(s, 0, stream_get_endp(s));
+		return false;
+	}
+
+	/* The descriptors went with the first byte; queue the rest. */
+	if ((size_t)nb < len) {
+		buffer_put(zclient->wb, STREAM_DATA(s) + nb, len - nb);
+		event_add_write(zclient->master, zclient_flush_data, zclient,
+				zclient->sock, &zclient->t_write);
+	}
+
+	if (zclient_debug)
+		zlog_debug("zclient %p passed shared memory ring to zebra",
+			   zclient);
+	return true;
+}
+
 enum zclient_send_status zclient_send_hello(struct zclient *zclient)
 {
 	struct stream *s;
 
 	if (zclient->redist_default || zclient->synchronous) {
+		bool ring = false;
+
 		s = zclient->obuf;
 		stream_reset(s);
 
+		/*
+		 * Only offer a ring over a local socket, and only if nothing
+		 * is buffered that the HELLO would overtake. It must hold the
+		 * largest possible message.
+		 */
+		if (zclient->ring_size && !zclient->synchronous &&
+		    !zclient->ring && zclient_addr.ss_family == AF_UNIX &&
+		    buffer_empty(zclient->wb)) {
+			zclient->ring = shmring_new(MAX(zclient->ring_size,
+							(size_t)UINT16_MAX + 1));
+			ring = !!zclient->ring;
+		}
+
 		/* The VRF ID in the HELLO message is always 0. */
 		zclient_create_header(s, ZEBRA_HELLO, VRF_DEFAULT);
 		stream_putc(s, zclient->redist_default);
@@ -494,8 +641,14 @@ enum zclient_send_status zclient_send_hello(struct zclient *zclient)
 			stream_putc(s, 1);
 		else
 			stream_putc(s, 0);
+		if (ring)
+			stream_putc(s, ZAPI_HELLO_F_RING);
 
 		stream_putw_at(s, 0, stream_get_endp(s));
+		if (ring && zclient->sock >= 0 &&
+		    zclient_send_hello_ring(zclient))
+			return ZCLIENT_SEND_SUCCESS;
+		shmring_free(&zclient->ring);
 		return zclient_send_message(zclient);
 	}
 
@@ -4873,6 +5026,7 @@ static void zclient_read(struct event *event)
 	}
 
 	length -= ZEBRA_HEADER_SIZE;
+	zclient->ring_acked = true;
 
 	if (zclient_debug)
 		zlog_debug("zclient %p command %s VRF %u", zclient,
@@ -7,6 +7,7 @@
 #define _ZEBRA_ZCLIENT_H
 
 struct zclient;
+struct shmring;
 
 /* For struct zapi_route. */
 #include "prefix.h"
@@ -353,6 +354,20 @@ struct zclient {
 	/* Thread to write buffered data to zebra. */
 	struct event *t_write;
 
+	/*
+	 * Size of the shared memory ring to offer zebra for messages to it,
+	 * 0 to only use the socket. Set by the daemon before zclient_start.
+	 */
+	size_t ring_size;
+
+	/* Ring in use for this session, and messages waiting for room */
+	struct shmring *ring;
+	struct stream_fifo *ring_pending;
+	struct event *t_ring_space;
+
+	/* Zebra has sent us something since the ring was offered */
+	bool ring_acked;
+
 	/* Redistribute information. */
 	uint8_t redist_default; /* clients protocol */
 	unsigned short instance;
@@ -421,6 +436,9 @@ extern int zclient_bfd_session_update(ZAPI_CALLBACK_ARGS);
 #define ZAPI_MESSAGE_OPAQUE 0x0400
 
 #define ZSERV_VERSION 6
+
+/* Optional flags trailing the HELLO message */
+#define ZAPI_HELLO_F_RING 0x01 /* ring descriptors passed with HELLO */
 /* Zserv protocol message header */
 struct zmsghdr {
 	uint16_t length;
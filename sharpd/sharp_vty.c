@@ -1052,6 +1052,32 @@ DEFPY (send_opaque,
 	return CMD_SUCCESS;
 }
 
+DEFPY (sharp_remote_macs,
+       sharp_remote_macs_cmd,
+       "sharp install remote-macs vni (1-16777215)$vni vtep A.B.C.D$vtep mac WORD$mac_str (1-1000000)$count [remove$remove]",
+       SHARP_STR
+       "install some things\n"
+       "Remote EVPN MACs, as bgpd would send them\n"
+       "VxLAN Network Identifier\n"
+       "VNI number\n"
+       "Remote VTEP\n"
+       "Remote VTEP address\n"
+       "First MAC address\n"
+       "MAC address (e.g. 00:00:00:00:00:01)\n"
+       "How many MACs to send\n"
+       "Withdraw the MACs instead\n")
+{
+	struct ethaddr mac;
+
+	if (!prefix_str2mac(mac_str, &mac)) {
+		vty_out(vty, "%% Malformed MAC address\n");
+		return CMD_WARNING;
+	}
+
+	sharp_remote_macs_send(!remove, vni, &mac, &vtep, count);
+	return CMD_SUCCESS;
+}
+
 DEFPY (send_opaque_unicast,
        send_opaque_unicast_cmd,
        "sharp send opaque unicast type (1-255) \
@@ -1723,6 +1749,7 @@ void sharp_vty_init(void)
 	install_element(ENABLE_NODE, &send_opaque_cmd);
 	install_element(ENABLE_NODE, &send_opaque_unicast_cmd);
 	install_element(ENABLE_NODE, &send_opaque_reg_cmd);
+	install_element(ENABLE_NODE, &sharp_remote_macs_cmd);
 	install_element(ENABLE_NODE, &send_opaque_notif_reg_cmd);
 	install_element(ENABLE_NODE, &neigh_discover_cmd);
 	install_element(ENABLE_NODE, &import_te_cmd);
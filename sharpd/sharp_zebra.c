@@ -904,6 +904,58 @@ void sharp_opaque_send(uint32_t type, uint32_t proto, uint32_t instance,
 	}
 }
 
+/*
+ * Send remote MACs to zebra as bgpd would for EVPN type-2 routes, one MAC
+ * per message, starting at 'mac' and counting up.
+ */
+void sharp_remote_macs_send(bool add, vni_t vni, const struct ethaddr *mac,
+			    const struct in_addr *vtep, uint32_t count)
+{
+	struct stream *s = g_zclient->obuf;
+	struct ipaddr vtep_ip = { .ipa_type = IPADDR_V4 };
+	struct ethaddr cur = *mac;
+	esi_t esi = {};
+	struct timeval t_start, t_end, t_diff;
+	uint32_t i;
+	int j;
+
+	vtep_ip.ipaddr_v4 = *vtep;
+
+	monotime(&t_start);
+	for (i = 0; i < count; i++) {
+		stream_reset(s);
+		zclient_create_header(s,
+				      add ? ZEBRA_REMOTE_MACIP_ADD
+					  : ZEBRA_REMOTE_MACIP_DEL,
+				      VRF_DEFAULT);
+		stream_putl(s, vni);
+		stream_put(s, cur.octet, ETH_ALEN);
+		stream_putw(s, 0); /* No IP */
+		stream_put_ipaddr(s, &vtep_ip);
+		if (add) {
+			stream_putc(s, 0); /* flags */
+			stream_putl(s, 0); /* seq */
+			stream_put(s, &esi, sizeof(esi));
+		}
+		stream_putw_at(s, 0, stream_get_endp(s));
+
+		if (zclient_send_message(g_zclient) == ZCLIENT_SEND_FAILURE) {
+			zlog_debug("%s: send failed after %u MACs", __func__, i);
+			break;
+		}
+
+		/* Next MAC, carrying into the upper octets */
+		for (j = ETH_ALEN - 1; j >= 0 && ++cur.octet[j] == 0; j--)
+			;
+	}
+	monotime(&t_end);
+
+	timersub(&t_end, &t_start, &t_diff);
+	zlog_debug("%s: %s %u remote MACs in VNI %u in %ld.%06ld seconds",
+		   __func__, add ? "Sent" : "Withdrew", i, vni,
+		   (long)t_diff.tv_sec, (long)t_diff.tv_usec);
+}
+
 /*
  * Register/unregister for opaque notifications from zebra about 'type'.
  */
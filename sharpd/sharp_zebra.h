@@ -49,6 +49,11 @@ void sharp_opaque_reg_send(bool is_reg, uint32_t proto, uint32_t instance,
 /* Register/unregister for opaque notifications from zebra about 'type'. */
 void sharp_zebra_opaque_notif_reg(bool is_reg, uint32_t type);
 
+/* Send or withdraw 'count' consecutive remote MACs, standing in for bgpd. */
+extern void sharp_remote_macs_send(bool add, vni_t vni,
+				   const struct ethaddr *mac,
+				   const struct in_addr *vtep, uint32_t count);
+
 extern void sharp_zebra_send_arp(const struct interface *ifp,
 				 const struct prefix *p);
 
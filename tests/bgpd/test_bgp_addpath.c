@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BGP Add-Path TX ID test
+ *
+ * Checks the TX IDs handed out when an addpath strategy comes into use,
+ * their upkeep after bestpath, and their release when the strategy is
+ * no longer used.
+ *
+ * This file is part of FRR
+ */
+
+#include <zebra.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "privs.h"
+#include "memory.h"
+#include "filter.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_addpath.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_network.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_table.h"
+
+/* need these to link in libbgp */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+static struct bgp *bgp;
+static as_t asn = 100;
+
+#define ADDPATH_PREFIXES 100
+#define ADDPATH_PATHS	 4
+
+static struct peer *sources[ADDPATH_PATHS + 1];
+static struct peer *client;
+static struct bgp_dest *dests[ADDPATH_PREFIXES];
+
+static void set_client_type(enum bgp_addpath_strat type)
+{
+	client->addpath_type[AFI_IP][SAFI_UNICAST] = type;
+	bgp_addpath_type_changed(bgp);
+}
+
+static uint32_t path_id(struct bgp_path_info *pi, enum bgp_addpath_strat type)
+{
+	return pi->tx_addpath.addpath_tx_id[type];
+}
+
+/* Every path that's sent has an ID no other path of the dest has */
+static void check_ids(struct bgp_dest *dest, enum bgp_addpath_strat type)
+{
+	struct bgp_path_info *pi, *pi2;
+
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next) {
+		if (!bgp_addpath_tx_path(type, pi)) {
+			assert(path_id(pi, type) == IDALLOC_INVALID);
+			continue;
+		}
+
+		assert(path_id(pi, type) != IDALLOC_INVALID);
+		for (pi2 = pi->next; pi2; pi2 = pi2->next)
+			assert(path_id(pi, type) != path_id(pi2, type));
+	}
+}
+
+static void test_populate(void)
+{
+	unsigned int i;
+
+	set_client_type(BGP_ADDPATH_ALL);
+
+	for (i = 0; i < ADDPATH_PREFIXES; i++)
+		check_ids(dests[i], BGP_ADDPATH_ALL);
+
+	printf("ID population passed.\n");
+}
+
+static void test_update_ids(void)
+{
+	struct bgp_path_info *pi, *added;
+	uint32_t ids[ADDPATH_PATHS];
+	unsigned int i, j;
+
+	/* Nothing changed, so no ID may move */
+	for (i = 0; i < ADDPATH_PREFIXES; i++) {
+		j = 0;
+		for (pi = bgp_dest_get_bgp_path_info(dests[i]); pi;
+		     pi = pi->next)
+			ids[j++] = path_id(pi, BGP_ADDPATH_ALL);
+
+		bgp_addpath_update_ids(bgp, dests[i], AFI_IP, SAFI_UNICAST);
+
+		j = 0;
+		for (pi = bgp_dest_get_bgp_path_info(dests[i]); pi;
+		     pi = pi->next)
+			assert(path_id(pi, BGP_ADDPATH_ALL) == ids[j++]);
+	}
+
+	/* A new path gets an ID of its own, the others keep theirs */
+	added = info_make(ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, 0,
+			  sources[ADDPATH_PATHS], NULL, dests[0]);
+	bgp_path_info_add(dests[0], added);
+	assert(path_id(added, BGP_ADDPATH_ALL) == IDALLOC_INVALID);
+
+	j = 0;
+	for (pi = added->next; pi; pi = pi->next)
+		ids[j++] = path_id(pi, BGP_ADDPATH_ALL);
+
+	bgp_addpath_update_ids(bgp, dests[0], AFI_IP, SAFI_UNICAST);
+	check_ids(dests[0], BGP_ADDPATH_ALL);
+
+	j = 0;
+	for (pi = added->next; pi; pi = pi->next)
+		assert(path_id(pi, BGP_ADDPATH_ALL) == ids[j++]);
+
+	printf("ID upkeep passed.\n");
+}
+
+static void test_best_per_as(void)
+{
+	struct bgp_path_info *first, *second;
+	uint32_t id;
+
+	set_client_type(BGP_ADDPATH_BEST_PER_AS);
+	assert(!bgp->tx_addpath.id_allocators[AFI_IP][SAFI_UNICAST]
+					      [BGP_ADDPATH_ALL]);
+
+	first = bgp_dest_get_bgp_path_info(dests[1]);
+	second = first->next;
+
+	/* Only the selected path is sent */
+	SET_FLAG(first->flags, BGP_PATH_DMED_SELECTED);
+	bgp_addpath_update_ids(bgp, dests[1], AFI_IP, SAFI_UNICAST);
+	check_ids(dests[1], BGP_ADDPATH_BEST_PER_AS);
+	assert(path_id(first, BGP_ADDPATH_BEST_PER_AS) != IDALLOC_INVALID);
+	assert(path_id(second, BGP_ADDPATH_BEST_PER_AS) == IDALLOC_INVALID);
+	id = path_id(first, BGP_ADDPATH_BEST_PER_AS);
+
+	/* The new selection picks up the ID the old one gave back */
+	UNSET_FLAG(first->flags, BGP_PATH_DMED_SELECTED);
+	SET_FLAG(second->flags, BGP_PATH_DMED_SELECTED);
+	bgp_addpath_update_ids(bgp, dests[1], AFI_IP, SAFI_UNICAST);
+	check_ids(dests[1], BGP_ADDPATH_BEST_PER_AS);
+	assert(path_id(first, BGP_ADDPATH_BEST_PER_AS) == IDALLOC_INVALID);
+	assert(path_id(second, BGP_ADDPATH_BEST_PER_AS) == id);
+
+	printf("Best-per-AS ID moves passed.\n");
+}
+
+static void test_flush(void)
+{
+	struct bgp_path_info *pi;
+	unsigned int i;
+
+	set_client_type(BGP_ADDPATH_NONE);
+	assert(!bgp_addpath_is_addpath_used(&bgp->tx_addpath, AFI_IP,
+					    SAFI_UNICAST));
+
+	for (i = 0; i < ADDPATH_PREFIXES; i++)
+		for (pi = bgp_dest_get_bgp_path_info(dests[i]); pi;
+		     pi = pi->next)
+			assert(!bgp_addpath_info_has_ids(&pi->tx_addpath));
+
+	printf("ID release passed.\n");
+}
+
+int main(int argc, char **argv)
+{
+	struct bgp_path_info *pi;
+	struct prefix_ipv4 p = {};
+	unsigned int i, j;
+
+	qobj_init();
+	bgp_attr_init();
+	master = event_master_create(NULL);
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	vrf_init(NULL, NULL, NULL, NULL);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+
+	if (bgp_get(&bgp, &asn, NULL, BGP_INSTANCE_TYPE_DEFAULT, NULL,
+		    ASNOTATION_PLAIN) < 0)
+		return -1;
+
+	for (j = 0; j < array_size(sources); j++) {
+		sources[j] = peer_create_accept(bgp, NULL);
+		sources[j]->host = (char *)"source";
+	}
+	client = peer_create_accept(bgp, NULL);
+	client->host = (char *)"client";
+
+	p.family = AF_INET;
+	p.prefixlen = IPV4_MAX_BITLEN;
+	for (i = 0; i < ADDPATH_PREFIXES; i++) {
+		p.prefix.s_addr = htonl(0x0a000000 + i);
+		dests[i] = bgp_node_get(bgp->rib[AFI_IP][SAFI_UNICAST],
+					(struct prefix *)&p);
+		for (j = 0; j < ADDPATH_PATHS; j++) {
+			pi = info_make(ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, 0,
+				       sources[j], NULL, dests[i]);
+			bgp_path_info_add(dests[i], pi);
+		}
+	}
+
+	test_populate();
+	test_update_ids();
+	test_best_per_as();
+	test_flush();
+
+	return 0;
+}
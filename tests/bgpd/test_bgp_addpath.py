@@ -0,0 +1,12 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestBgpAddpath(frrtest.TestMultiOut):
+    program = "./test_bgp_addpath"
+
+
+TestBgpAddpath.onesimple("ID population passed.")
+TestBgpAddpath.onesimple("ID upkeep passed.")
+TestBgpAddpath.onesimple("Best-per-AS ID moves passed.")
+TestBgpAddpath.onesimple("ID release passed.")
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * BGP route flap dampening test
+ *
+ * Flaps a set of prefixes and checks the penalty, suppression and
+ * reuse list bookkeeping, and that dampening state that was never
+ * configured can be cleaned.
+ *
+ * This file is part of FRR
+ */
+
+#include <zebra.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "privs.h"
+#include "memory.h"
+#include "filter.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_damp.h"
+#include "bgpd/bgp_network.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_table.h"
+
+/* need these to link in libbgp */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+static struct bgp *bgp;
+static as_t asn = 100;
+
+#define DAMP_PREFIXES 1000
+
+static void test_clean_unconfigured(struct peer *peer)
+{
+	/* Neither config has been through bgp_damp_parameter_set() */
+	bgp_damp_info_clean(bgp, &bgp->damp[AFI_IP][SAFI_UNICAST], AFI_IP,
+			    SAFI_UNICAST);
+	bgp_damp_info_clean(bgp, &peer->damp[AFI_IP][SAFI_UNICAST], AFI_IP,
+			    SAFI_UNICAST);
+	bgp_damp_disable(bgp, AFI_IP, SAFI_UNICAST);
+	bgp_peer_damp_disable(peer, AFI_IP, SAFI_UNICAST);
+
+	printf("Clean of unconfigured dampening passed.\n");
+}
+
+static void test_decay(void)
+{
+	struct bgp_damp_config *bdc = &bgp->damp[AFI_IP][SAFI_UNICAST];
+	int penalty;
+
+	assert(bgp_damp_decay(0, DEFAULT_PENALTY, bdc) == DEFAULT_PENALTY);
+
+	penalty = bgp_damp_decay(bdc->half_life, DEFAULT_PENALTY, bdc);
+	assert(abs(penalty - DEFAULT_PENALTY / 2) <= 1);
+
+	penalty = bgp_damp_decay(2 * bdc->half_life, DEFAULT_PENALTY, bdc);
+	assert(abs(penalty - DEFAULT_PENALTY / 4) <= 1);
+
+	assert(bgp_damp_decay(bdc->max_suppress_time, DEFAULT_PENALTY, bdc) ==
+	       0);
+
+	printf("Penalty decay passed.\n");
+}
+
+static void test_flap(struct bgp_dest **dests, struct bgp_path_info **paths)
+{
+	struct bgp_damp_info *bdi;
+	unsigned int i;
+
+	/* One flap: penalised, but still announced */
+	for (i = 0; i < DAMP_PREFIXES; i++) {
+		assert(bgp_damp_withdraw(paths[i], dests[i], AFI_IP,
+					 SAFI_UNICAST, 0) == BGP_DAMP_USED);
+		bdi = paths[i]->extra->damp_info;
+		assert(bdi && bdi->penalty == DEFAULT_PENALTY);
+		assert(bdi->index == BGP_DAMP_NO_REUSE_LIST_INDEX);
+
+		assert(bgp_damp_update(paths[i], dests[i], AFI_IP,
+				       SAFI_UNICAST) == BGP_DAMP_USED);
+		assert(!CHECK_FLAG(paths[i]->flags, BGP_PATH_DAMPED));
+	}
+
+	/* Two flaps reach the suppress limit */
+	for (i = 0; i < DAMP_PREFIXES; i++) {
+		assert(bgp_damp_withdraw(paths[i], dests[i], AFI_IP,
+					 SAFI_UNICAST, 0) == BGP_DAMP_USED);
+		bdi = paths[i]->extra->damp_info;
+		assert(bdi->flap == 2);
+		assert(CHECK_FLAG(paths[i]->flags, BGP_PATH_DAMPED));
+		assert(bdi->index != BGP_DAMP_NO_REUSE_LIST_INDEX);
+
+		assert(bgp_damp_update(paths[i], dests[i], AFI_IP,
+				       SAFI_UNICAST) == BGP_DAMP_SUPPRESSED);
+	}
+
+	/* Further flaps keep it suppressed and move it to a later list */
+	for (i = 0; i < DAMP_PREFIXES; i++) {
+		unsigned int index = paths[i]->extra->damp_info->index;
+
+		assert(bgp_damp_withdraw(paths[i], dests[i], AFI_IP,
+					 SAFI_UNICAST, 0) ==
+		       BGP_DAMP_SUPPRESSED);
+		bdi = paths[i]->extra->damp_info;
+		assert(bdi->flap == 3);
+		assert(bdi->index != BGP_DAMP_NO_REUSE_LIST_INDEX);
+		assert(bdi->index != index);
+	}
+
+	printf("Flap suppression passed.\n");
+}
+
+int main(int argc, char **argv)
+{
+	struct peer *peer;
+	struct bgp_dest **dests;
+	struct bgp_path_info **paths;
+	struct prefix_ipv4 p = {};
+	unsigned int i;
+
+	qobj_init();
+	bgp_attr_init();
+	master = event_master_create(NULL);
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	vrf_init(NULL, NULL, NULL, NULL);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+
+	if (bgp_get(&bgp, &asn, NULL, BGP_INSTANCE_TYPE_DEFAULT, NULL,
+		    ASNOTATION_PLAIN) < 0)
+		return -1;
+
+	peer = peer_create_accept(bgp, NULL);
+	peer->host = (char *)"foo";
+
+	test_clean_unconfigured(peer);
+
+	bgp_damp_enable(bgp, AFI_IP, SAFI_UNICAST, DEFAULT_HALF_LIFE * 60,
+			DEFAULT_REUSE, DEFAULT_SUPPRESS,
+			DEFAULT_HALF_LIFE * 60 * 4);
+
+	test_decay();
+
+	dests = calloc(DAMP_PREFIXES, sizeof(*dests));
+	paths = calloc(DAMP_PREFIXES, sizeof(*paths));
+	assert(dests && paths);
+
+	p.family = AF_INET;
+	p.prefixlen = IPV4_MAX_BITLEN;
+	for (i = 0; i < DAMP_PREFIXES; i++) {
+		p.prefix.s_addr = htonl(0x0a000000 + i);
+		dests[i] = bgp_node_get(bgp->rib[AFI_IP][SAFI_UNICAST],
+					(struct prefix *)&p);
+		paths[i] = info_make(ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, 0, peer,
+				     NULL, dests[i]);
+		bgp_path_info_extra_get(paths[i]);
+	}
+
+	test_flap(dests, paths);
+
+	free(paths);
+	free(dests);
+	return 0;
+}
@@ -0,0 +1,11 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestBgpDamp(frrtest.TestMultiOut):
+    program = "./test_bgp_damp"
+
+
+TestBgpDamp.onesimple("Clean of unconfigured dampening passed.")
+TestBgpDamp.onesimple("Penalty decay passed.")
+TestBgpDamp.onesimple("Flap suppression passed.")
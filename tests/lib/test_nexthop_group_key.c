@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Nexthop group key test.
+ *
+ * Checks that flat nexthop group keys compare equal exactly when the
+ * groups do under nexthop_group_equal(), wherever the key is built.
+ */
+
+#include <zebra.h>
+
+#include "nexthop.h"
+#include "nexthop_group.h"
+#include "prng.h"
+
+#define GROUPS 1000
+#define WIDTH  16
+
+static void build_group(struct nexthop_group *nhg, struct prng *prng,
+			unsigned int idx)
+{
+	struct in_addr addr;
+	struct nexthop *nh;
+	mpls_label_t label;
+	int i;
+
+	memset(nhg, 0, sizeof(*nhg));
+
+	for (i = 0; i < WIDTH; i++) {
+		addr.s_addr = htonl(0x0a000000 | (idx << 8) | i);
+		nh = nexthop_from_ipv4_ifindex(&addr, NULL,
+					       1 + prng_rand(prng) % 64, 0);
+		SET_FLAG(nh->flags, NEXTHOP_FLAG_ACTIVE);
+		if (i % 4 == 0) {
+			label = 16 + idx;
+			nexthop_add_labels(nh, ZEBRA_LSP_STATIC, 1, &label);
+		}
+		nexthop_group_add_sorted(nhg, nh);
+	}
+}
+
+static void build_key(struct nexthop_group_key *key,
+		      const struct nexthop_group *nhg)
+{
+	nexthop_group_key_init(key, NULL, 0);
+	nexthop_group_key_add(key, nhg);
+	nexthop_group_key_finish(key);
+}
+
+/* Keys agree with the list comparison, across many groups */
+static void test_equal(struct nexthop_group *groups,
+		       struct nexthop_group *copies)
+{
+	struct nexthop_group_key ka, kb;
+	unsigned int i;
+
+	for (i = 0; i < GROUPS; i++) {
+		build_key(&ka, &groups[i]);
+		build_key(&kb, &copies[i]);
+		assert(nexthop_group_equal(&groups[i], &copies[i]));
+		assert(nexthop_group_key_equal(&ka, &kb));
+		nexthop_group_key_free(&kb);
+
+		if (i) {
+			build_key(&kb, &groups[i - 1]);
+			assert(!nexthop_group_equal(&groups[i],
+						    &groups[i - 1]));
+			assert(!nexthop_group_key_equal(&ka, &kb));
+			nexthop_group_key_free(&kb);
+		}
+		nexthop_group_key_free(&ka);
+	}
+
+	printf("Key equality passed.\n");
+}
+
+/* Where the key starts out doesn't change it */
+static void test_buffer(struct nexthop_group *nhg)
+{
+	struct nexthop_group_key ka, kb;
+	uint8_t small[64];
+	uint8_t *fit;
+	size_t fit_size;
+
+	build_key(&ka, nhg);
+
+	nexthop_group_key_init(&kb, small, sizeof(small));
+	nexthop_group_key_add(&kb, nhg);
+	nexthop_group_key_finish(&kb);
+	assert(kb.heap && kb.data != small);
+	assert(nexthop_group_key_equal(&ka, &kb));
+	nexthop_group_key_free(&kb);
+
+	/* A buffer with room for the group, labels included, keeps it off
+	 * the heap.
+	 */
+	fit_size = NEXTHOP_GROUP_KEY_GROUP_SIZE(WIDTH) +
+		   WIDTH * sizeof(mpls_label_t);
+	fit = calloc(1, fit_size);
+	nexthop_group_key_init(&kb, fit, fit_size);
+	nexthop_group_key_add(&kb, nhg);
+	nexthop_group_key_finish(&kb);
+	assert(!kb.heap && kb.data == fit);
+	assert(nexthop_group_key_equal(&ka, &kb));
+	nexthop_group_key_free(&kb);
+	free(fit);
+
+	nexthop_group_key_free(&ka);
+
+	printf("Key buffers passed.\n");
+}
+
+/* Every field nexthop_same() looks at, and the ACTIVE flag, is keyed */
+static void test_fields(struct nexthop_group *a, struct nexthop_group *b)
+{
+	struct nexthop_group_key ka, kb;
+	mpls_label_t label = 99;
+
+	build_key(&ka, a);
+
+	UNSET_FLAG(b->nexthop->flags, NEXTHOP_FLAG_ACTIVE);
+	build_key(&kb, b);
+	assert(!nexthop_group_key_equal(&ka, &kb));
+	nexthop_group_key_free(&kb);
+	SET_FLAG(b->nexthop->flags, NEXTHOP_FLAG_ACTIVE);
+
+	nexthop_del_labels(b->nexthop->next);
+	nexthop_add_labels(b->nexthop->next, ZEBRA_LSP_STATIC, 1, &label);
+	assert(!nexthop_group_equal(a, b));
+	build_key(&kb, b);
+	assert(!nexthop_group_key_equal(&ka, &kb));
+	nexthop_group_key_free(&kb);
+
+	/* Group boundaries count too */
+	build_key(&kb, a);
+	nexthop_group_key_add(&kb, &(struct nexthop_group){});
+	nexthop_group_key_finish(&kb);
+	assert(!nexthop_group_key_equal(&ka, &kb));
+	nexthop_group_key_free(&kb);
+
+	nexthop_group_key_free(&ka);
+
+	printf("Key fields passed.\n");
+}
+
+int main(int argc, char **argv)
+{
+	struct prng *prng;
+	struct nexthop_group *groups, *copies;
+	unsigned int i;
+
+	prng = prng_new(0);
+	groups = calloc(GROUPS, sizeof(*groups));
+	copies = calloc(GROUPS, sizeof(*copies));
+
+	for (i = 0; i < GROUPS; i++) {
+		build_group(&groups[i], prng, i);
+		nexthop_group_copy(&copies[i], &groups[i]);
+	}
+
+	test_equal(groups, copies);
+	test_buffer(&groups[0]);
+	test_fields(&groups[0], &copies[0]);
+
+	for (i = 0; i < GROUPS; i++) {
+		nexthops_free(groups[i].nexthop);
+		nexthops_free(copies[i].nexthop);
+	}
+	free(groups);
+	free(copies);
+	prng_free(prng);
+
+	return 0;
+}
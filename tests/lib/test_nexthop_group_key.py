@@ -0,0 +1,11 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestNexthopGroupKey(frrtest.TestMultiOut):
+    program = "./test_nexthop_group_key"
+
+
+TestNexthopGroupKey.onesimple("Key equality passed.")
+TestNexthopGroupKey.onesimple("Key buffers passed.")
+TestNexthopGroupKey.onesimple("Key fields passed.")
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Shared memory ring tests.
+ */
+#include <zebra.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#endif
+
+#include "shmring.h"
+
+#define RING_SIZE 4096
+
+static bool fd_readable(int fd)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+
+	return poll(&pfd, 1, 0) == 1;
+}
+
+int main(int argc, char **argv)
+{
+	struct shmring *prod, *cons;
+	int fds[SHMRING_NFDS];
+	uint8_t msg[1000], out[1000];
+	unsigned int i, n;
+
+	prod = shmring_new(RING_SIZE - 100);
+	if (!prod) {
+#ifdef __linux__
+		assert(!"unable to create ring");
+#endif
+		printf("Shared memory rings not supported here, skipping\n");
+		return 0;
+	}
+
+	/* The consumer gets its own copies, as if passed over a socket */
+	for (i = 0; i < SHMRING_NFDS; i++)
+		fds[i] = dup(shmring_fd(prod, i));
+	cons = shmring_attach(fds);
+	assert(cons);
+
+	printf("Validating empty ring...\n");
+	assert(shmring_used(cons) == 0);
+	assert(!fd_readable(shmring_fd(cons, SHMRING_FD_DATA)));
+
+	printf("Validating put and wakeup...\n");
+	for (i = 0; i < sizeof(msg); i++)
+		msg[i] = i;
+	assert(shmring_put(prod, msg, sizeof(msg)));
+	assert(shmring_used(cons) == sizeof(msg));
+	assert(fd_readable(shmring_fd(cons, SHMRING_FD_DATA)));
+	shmring_clear(cons, SHMRING_FD_DATA);
+	assert(!fd_readable(shmring_fd(cons, SHMRING_FD_DATA)));
+
+	/* Consumer has not caught up, so no further wakeup is needed */
+	assert(shmring_put(prod, msg, sizeof(msg)));
+	assert(!fd_readable(shmring_fd(cons, SHMRING_FD_DATA)));
+
+	printf("Validating peek and consume...\n");
+	shmring_peek(cons, out, sizeof(out));
+	assert(!memcmp(msg, out, sizeof(out)));
+	assert(shmring_used(cons) == 2 * sizeof(msg));
+	shmring_consume(cons, sizeof(out));
+	assert(shmring_used(cons) == sizeof(msg));
+
+	printf("Validating full ring...\n");
+	n = 1;
+	while (shmring_put(prod, msg, sizeof(msg)))
+		n++;
+	assert(n == RING_SIZE / sizeof(msg));
+	assert(!fd_readable(shmring_fd(prod, SHMRING_FD_SPACE)));
+
+	/* Making room wakes the waiting producer */
+	shmring_peek(cons, out, sizeof(out));
+	shmring_consume(cons, sizeof(out));
+	assert(fd_readable(shmring_fd(prod, SHMRING_FD_SPACE)));
+	shmring_clear(prod, SHMRING_FD_SPACE);
+
+	printf("Validating wraparound...\n");
+	for (i = 0; i < 64; i++) {
+		msg[0] = i;
+		assert(shmring_put(prod, msg, sizeof(msg)));
+		shmring_peek(cons, out, sizeof(out));
+		assert(!memcmp(msg + 1, out + 1, sizeof(out) - 1));
+		shmring_consume(cons, sizeof(out));
+	}
+	while ((n = shmring_used(cons)) > 0) {
+		shmring_peek(cons, out, sizeof(out));
+		shmring_consume(cons, sizeof(out));
+	}
+	assert(shmring_used(cons) == 0);
+
+	printf("Validating oversized message...\n");
+	assert(!shmring_put(prod, msg, RING_SIZE + 1));
+
+	shmring_free(&cons);
+	shmring_free(&prod);
+	assert(!cons && !prod);
+
+#ifdef __linux__
+	printf("Validating unsealed memory is refused...\n");
+	fds[SHMRING_FD_MEM] = memfd_create("test-shmring", MFD_CLOEXEC);
+	fds[SHMRING_FD_DATA] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	fds[SHMRING_FD_SPACE] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	assert(fds[SHMRING_FD_MEM] >= 0);
+	assert(ftruncate(fds[SHMRING_FD_MEM], 64 + RING_SIZE) == 0);
+	assert(!shmring_attach(fds));
+#endif
+
+	printf("Done.\n");
+	return 0;
+}
@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestShmring(frrtest.TestMultiOut):
+    program = "./test_shmring"
+
+
+TestShmring.exit_cleanly()
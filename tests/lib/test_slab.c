@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Slab allocator tests.
+ */
+#include <zebra.h>
+
+#include "memory.h"
+#include "slab.h"
+
+DEFINE_MGROUP(TEST_SLAB, "slab test");
+DEFINE_MTYPE_STATIC(TEST_SLAB, TEST_SLAB, "slab test objects");
+
+#define PER_CHUNK 100
+#define OBJECTS	  1000
+
+struct obj {
+	uint32_t id;
+	uint8_t fill[37];
+};
+
+int main(int argc, char **argv)
+{
+	struct slab *slab;
+	struct slab_stats st;
+	struct obj *objs[OBJECTS], *o;
+	unsigned int i;
+	bool chunked;
+
+	slab = slab_new(MTYPE_TEST_SLAB, sizeof(struct obj), PER_CHUNK);
+
+	printf("Validating allocation...\n");
+	for (i = 0; i < OBJECTS; i++) {
+		objs[i] = slab_alloc(slab);
+		assert(objs[i]);
+		assert(((uintptr_t)objs[i] & 7) == 0);
+		assert(objs[i]->id == 0 && objs[i]->fill[36] == 0);
+		objs[i]->id = i;
+		memset(objs[i]->fill, 0xff, sizeof(objs[i]->fill));
+	}
+	for (i = 0; i < OBJECTS; i++)
+		assert(objs[i]->id == i);
+
+	slab_get_stats(slab, &st);
+	assert(st.in_use == OBJECTS);
+	assert(st.objsize >= sizeof(struct obj) && st.objsize % 8 == 0);
+
+	/* Under AddressSanitizer objects are allocated one by one */
+	chunked = st.chunks > 0;
+	if (chunked) {
+		assert(st.chunks == OBJECTS / PER_CHUNK);
+		assert(st.free == 0);
+		assert(st.bytes < OBJECTS * (st.objsize + 16));
+	}
+
+	printf("Validating reuse...\n");
+	for (i = 0; i < OBJECTS; i += 2) {
+		slab_free(slab, objs[i]);
+		objs[i] = NULL;
+	}
+	slab_get_stats(slab, &st);
+	assert(st.in_use == OBJECTS / 2);
+	if (chunked)
+		assert(st.free == OBJECTS / 2);
+
+	for (i = 0; i < OBJECTS; i += 2) {
+		o = slab_alloc(slab);
+		/* Reused objects come back zeroed too */
+		assert(o->id == 0 && o->fill[0] == 0);
+		o->id = i;
+		objs[i] = o;
+	}
+	slab_get_stats(slab, &st);
+	assert(st.in_use == OBJECTS);
+	if (chunked)
+		assert(st.chunks == OBJECTS / PER_CHUNK && st.free == 0);
+
+	/* Nothing got handed out twice */
+	for (i = 0; i < OBJECTS; i++)
+		assert(objs[i]->id == i);
+
+	printf("Validating free...\n");
+	slab_free(slab, NULL);
+	for (i = 0; i < OBJECTS; i++)
+		slab_free(slab, objs[i]);
+	slab_get_stats(slab, &st);
+	assert(st.in_use == 0);
+
+	slab_destroy(&slab);
+	assert(!slab);
+
+	printf("Done.\n");
+	return 0;
+}
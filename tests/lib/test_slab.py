@@ -0,0 +1,9 @@
+# SPDX-License-Identifier: GPL-2.0-or-later
+import frrtest
+
+
+class TestSlab(frrtest.TestMultiOut):
+    program = "./test_slab"
+
+
+TestSlab.exit_cleanly()
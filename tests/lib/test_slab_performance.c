@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Test program which measures the allocator traffic of dataplane route
+ * contexts: one allocation per context plus a copy of its nexthop, against
+ * contexts from a slab sharing one nexthop snapshot.
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+
+#include "memory.h"
+#include "monotime.h"
+#include "slab.h"
+
+DEFINE_MGROUP(TEST_SLAB_PERF, "slab performance test");
+DEFINE_MTYPE_STATIC(TEST_SLAB_PERF, TEST_CTX, "test route contexts");
+DEFINE_MTYPE_STATIC(TEST_SLAB_PERF, TEST_NH, "test nexthop copies");
+
+/* sizeof(struct zebra_dplane_ctx) and sizeof(struct nexthop) on x86_64 */
+#define CTX_SIZE 1160
+#define NH_SIZE	 152
+
+#define ROUTES	  1000000
+/* Contexts queued to, or coming back from, the dataplane at any time */
+#define IN_FLIGHT 1000
+#define PER_CHUNK 64
+
+static void *ctxs[IN_FLIGHT];
+static void *nhs[IN_FLIGHT];
+
+int main(int argc, char **argv)
+{
+	struct slab *slab;
+	struct slab_stats st;
+	struct timeval tv_start;
+	int64_t t_malloc, t_slab;
+	unsigned int i, w;
+
+	monotime(&tv_start);
+
+	for (i = 0; i < ROUTES; i++) {
+		w = i % IN_FLIGHT;
+		XFREE(MTYPE_TEST_CTX, ctxs[w]);
+		XFREE(MTYPE_TEST_NH, nhs[w]);
+		ctxs[w] = XCALLOC(MTYPE_TEST_CTX, CTX_SIZE);
+		nhs[w] = XCALLOC(MTYPE_TEST_NH, NH_SIZE);
+	}
+
+	t_malloc = monotime_since(&tv_start, NULL);
+
+	for (w = 0; w < IN_FLIGHT; w++) {
+		XFREE(MTYPE_TEST_CTX, ctxs[w]);
+		XFREE(MTYPE_TEST_NH, nhs[w]);
+	}
+
+	slab = slab_new(MTYPE_TEST_CTX, CTX_SIZE, PER_CHUNK);
+
+	monotime(&tv_start);
+
+	for (i = 0; i < ROUTES; i++) {
+		w = i % IN_FLIGHT;
+		slab_free(slab, ctxs[w]);
+		ctxs[w] = slab_alloc(slab);
+	}
+
+	t_slab = monotime_since(&tv_start, NULL);
+
+	slab_get_stats(slab, &st);
+	slab_destroy(&slab);
+
+	printf("Per-context allocation: %u allocations, %" PRId64
+	       " ns/route.\n",
+	       2 * ROUTES, t_malloc * 1000 / ROUTES);
+	printf("Slab contexts, shared nexthops: %zu chunks, %" PRId64
+	       " ns/route.\n",
+	       st.chunks, t_slab * 1000 / ROUTES);
+	fflush(stdout);
+
+	return 0;
+}
@@ -14,7 +14,9 @@ test_fpm_topo1.py: Testing FPM module
 
 """
 import os
+import re
 import sys
+import time
 import pytest
 import json
 from functools import partial
@@ -27,6 +29,7 @@ sys.path.append(os.path.join(CWD, "../"))
 # Import topogen and topotest helpers
 from lib import topotest
 from lib.topogen import Topogen, TopoRouter, get_topogen
+from lib.topolog import logger
 
 
 pytestmark = [pytest.mark.fpm, pytest.mark.sharpd]
@@ -224,6 +227,81 @@ def test_fpm_connected_and_local_routes():
     assert success, f"Failed to find {result} local routes"
 
 
+def test_fpm_multiple_connections_throughput():
+    "Test that routes stream to the fpm_listener over several connections"
+
+    tgen = get_topogen()
+    router = tgen.gears["r1"]
+    fpm_data_file = os.path.join(router.gearlogdir, "fpm_test.data")
+    pid_file = os.path.join(router.gearlogdir, "fpm_listener.pid")
+
+    def listener_dump():
+        "Have fpm_listener dump its state and return it"
+        with open(pid_file, "r") as f:
+            pid = f.read().strip()
+        router.run("kill -SIGUSR1 {}".format(pid))
+        time.sleep(0.2)
+        with open(fpm_data_file, "r") as f:
+            return f.read()
+
+    def sharp_routes_seen():
+        return len(re.findall(r"NHG \d+: 10\.0\.\d+\.\d+/32", listener_dump()))
+
+    router.vtysh_cmd(
+        """
+        configure terminal
+        fpm connections 4
+        """
+    )
+
+    expected = {"connected": True, "connections": 4, "connectionsUp": 4}
+    test_func = partial(
+        topotest.router_json_cmp, router, "show fpm status json", expected
+    )
+    success, result = topotest.run_and_expect(test_func, None, 30, 1)
+    assert success, "Unable to open 4 fpm connections:\n{}".format(result)
+
+    success, result = topotest.run_and_expect(
+        lambda: "Clients: 4" in listener_dump(), True, count=30, wait=1
+    )
+    assert success, "fpm_listener does not see 4 clients"
+
+    start = time.time()
+    router.vtysh_cmd("sharp install routes 10.0.0.0 nexthop 192.168.44.33 10000")
+
+    success, result = topotest.run_and_expect(
+        sharp_routes_seen, 10000, count=120, wait=0.5
+    )
+    assert success, "fpm_listener only received {} of 10000 routes".format(result)
+    elapsed = time.time() - start
+    logger.info(
+        "10000 routes over 4 FPM connections in %.2fs (%.0f routes/s)",
+        elapsed,
+        10000 / elapsed,
+    )
+
+    output = router.vtysh_cmd("show fpm counters json", isjson=True)
+    for idx, conn in enumerate(output["connections"]):
+        assert conn["bytes-sent"] > 0, "FPM connection {} sent nothing".format(idx)
+
+    router.vtysh_cmd("sharp remove routes 10.0.0.0 10000")
+    success, result = topotest.run_and_expect(sharp_routes_seen, 0, count=120, wait=0.5)
+    assert success, "fpm_listener still has {} routes".format(result)
+
+    router.vtysh_cmd(
+        """
+        configure terminal
+        no fpm connections 4
+        """
+    )
+    expected = {"connected": True, "connections": 1, "connectionsUp": 1}
+    test_func = partial(
+        topotest.router_json_cmp, router, "show fpm status json", expected
+    )
+    success, result = topotest.run_and_expect(test_func, None, 30, 1)
+    assert success, "Unable to go back to one fpm connection:\n{}".format(result)
+
+
 if __name__ == "__main__":
     args = ["-s"] + sys.argv[1:]
     sys.exit(pytest.main(args))
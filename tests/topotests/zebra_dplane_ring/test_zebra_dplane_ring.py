@@ -0,0 +1,156 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: ISC
+
+#
+# test_zebra_dplane_ring.py
+#
+
+"""
+test_zebra_dplane_ring.py: Run route updates through a dataplane provider
+whose queues are lock-free rings, with the provider's work done on its own
+pthread (the sample plugin), and check that updates to a route stay in
+order even when far more of them are queued than the rings can hold.
+"""
+
+import json
+import re
+import sys
+
+import pytest
+from lib.common_config import step
+from lib.topogen import Topogen, TopoRouter, get_topogen
+from lib.topolog import logger
+from munet.testing.util import retry
+
+ROUTES = 10000
+
+
+def build_topo(tgen):
+    "Build function"
+
+    tgen.add_router("r1")
+
+    switch = tgen.add_switch("s1")
+    switch.add_link(tgen.gears["r1"])
+
+
+def setup_module(mod):
+    "Sets up the pytest environment"
+    tgen = Topogen(build_topo, mod.__name__)
+    tgen.start_topology()
+
+    for rname, router in tgen.routers().items():
+        logger.info("Loading router %s" % rname)
+        router.load_frr_config(
+            "frr.conf",
+            [
+                (TopoRouter.RD_ZEBRA, "-M dplane_sample_plugin"),
+                (TopoRouter.RD_SHARP, None),
+            ],
+        )
+
+    tgen.start_router()
+
+
+def teardown_module():
+    "Teardown the pytest environment"
+    tgen = get_topogen()
+
+    tgen.stop_topology()
+
+
+def _sample_counters(router):
+    "Return (in, out) of the sample provider, None if it isn't loaded"
+    output = router.vtysh_cmd("show zebra dplane providers")
+    match = re.search(r"SAMPLE \(\d+\): in: (\d+), .*, out: (\d+),", output)
+    if not match:
+        return None
+    return int(match.group(1)), int(match.group(2))
+
+
+def _kernel_gateways(router):
+    "Count the sharp routes in the kernel, by gateway"
+    output = router.run("ip -j -4 route show proto 194")
+    gateways = {}
+    for route in json.loads(output or "[]"):
+        gateway = route.get("gateway")
+        gateways[gateway] = gateways.get(gateway, 0) + 1
+    return gateways
+
+
+def _check_kernel(router, expected):
+    @retry(retry_timeout=60, retry_sleep=1)
+    def _check():
+        gateways = _kernel_gateways(router)
+        assert gateways == expected, "Kernel has {}, expected {}".format(
+            gateways, expected
+        )
+
+    return _check()
+
+
+def test_zebra_dplane_ring_provider():
+    "Check that the sample plugin is in the dataplane"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+    if _sample_counters(r1) is None:
+        pytest.skip("dplane sample plugin is not available")
+
+
+def test_zebra_dplane_ring_order():
+    "Replace routes while their installs are still in the rings"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+    before = _sample_counters(r1)
+    if before is None:
+        pytest.skip("dplane sample plugin is not available")
+
+    step("Install {} routes, replacing them right away".format(ROUTES))
+    r1.vtysh_multicmd(
+        "sharp install routes 10.0.0.0 nexthop 192.168.1.2 {0}\n"
+        "sharp install routes 10.0.0.0 nexthop 192.168.1.3 {0}\n".format(ROUTES)
+    )
+
+    step("Verify the kernel ends up with the replacements only")
+    assert not _check_kernel(r1, {"192.168.1.3": ROUTES})
+
+    step("Remove the routes, and install them again right away")
+    r1.vtysh_multicmd(
+        "sharp remove routes 10.0.0.0 {0}\n"
+        "sharp install routes 10.0.0.0 nexthop 192.168.1.2 {0}\n".format(ROUTES)
+    )
+
+    step("Verify the kernel ends up with all of them installed")
+    assert not _check_kernel(r1, {"192.168.1.2": ROUTES})
+
+    step("Verify everything went through the sample plugin")
+
+    @retry(retry_timeout=30, retry_sleep=1)
+    def _check_counters():
+        after = _sample_counters(r1)
+        assert after[0] - before[0] >= 2 * ROUTES, "Provider saw {} updates".format(
+            after[0] - before[0]
+        )
+        assert after[0] == after[1], "Provider in {} but out {}".format(*after)
+
+    assert not _check_counters()
+
+
+def test_memory_leak():
+    "Run the memory leak test and report results."
+    tgen = get_topogen()
+    if not tgen.is_memleak_enabled():
+        pytest.skip("Memory leak test/report is disabled")
+
+    tgen.report_memory_leaks()
+
+
+if __name__ == "__main__":
+    args = ["-s"] + sys.argv[1:]
+    sys.exit(pytest.main(args))
@@ -0,0 +1,166 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: ISC
+
+#
+# test_zebra_evpn_mac_scale.py
+#
+
+"""
+test_zebra_evpn_mac_scale.py: Install and withdraw a large number of
+remote EVPN MACs, with sharpd standing in for bgpd, and log how long
+zebra takes to learn them and program them into the kernel FDB.
+"""
+
+import os
+import sys
+import time
+from functools import partial
+
+import pytest
+
+CWD = os.path.dirname(os.path.realpath(__file__))
+sys.path.append(os.path.join(CWD, "../"))
+
+# pylint: disable=C0413
+from lib import topotest
+from lib.topogen import Topogen, get_topogen
+from lib.topolog import logger
+
+pytestmark = [pytest.mark.bgpd, pytest.mark.sharpd]
+
+VNI = 101
+MAC_COUNT = 20000
+
+
+def build_topo(tgen):
+    "Build function"
+
+    tgen.add_router("r1")
+    switch = tgen.add_switch("s1")
+    switch.add_link(tgen.gears["r1"])
+
+
+def setup_module(mod):
+    "Sets up the pytest environment"
+
+    tgen = Topogen(build_topo, mod.__name__)
+    tgen.start_topology()
+
+    r1 = tgen.gears["r1"]
+    r1.run("ip link add name br101 type bridge stp_state 0")
+    r1.run("ip link set up dev br101")
+    r1.run(
+        "ip link add vxlan101 type vxlan id {} dstport 4789 local 10.10.10.10 nolearning".format(
+            VNI
+        )
+    )
+    r1.run("ip link set dev vxlan101 master br101")
+    r1.run("ip link set up dev vxlan101")
+
+    for _, router in tgen.routers().items():
+        router.load_frr_config(os.path.join(CWD, "{}/frr.conf".format(router.name)))
+
+    tgen.start_router()
+
+
+def teardown_module(_mod):
+    "Teardown the pytest environment"
+    tgen = get_topogen()
+    tgen.stop_topology()
+
+
+def check_mac_count(router, count):
+    output = router.vtysh_cmd("show evpn vni {} json".format(VNI), isjson=True)
+    if output.get("numMacs", 0) != count:
+        return "expected {} MACs, have {}".format(count, output.get("numMacs"))
+    return None
+
+
+def check_fdb_count(router, count):
+    output = router.run("bridge fdb show dev vxlan101 | grep -c 'dst 10.10.10.20'")
+    have = int(output.strip() or 0)
+    if have != count:
+        return "expected {} FDB entries, have {}".format(count, have)
+    return None
+
+
+def test_evpn_vni_up():
+    "Wait for zebra to know the VNI"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+    expected = {"numVnis": 1}
+    test_func = partial(topotest.router_json_cmp, r1, "show evpn json", expected)
+    _, result = topotest.run_and_expect(test_func, None, count=30, wait=1)
+    assert result is None, "VNI {} not known to zebra".format(VNI)
+
+
+def test_evpn_remote_mac_scale():
+    "Install and withdraw remote MACs from a stand-in client"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    start = time.time()
+    r1.vtysh_cmd(
+        "sharp install remote-macs vni {} vtep 10.10.10.20 mac 00:00:00:01:00:00 {}".format(
+            VNI, MAC_COUNT
+        )
+    )
+    _, result = topotest.run_and_expect(
+        partial(check_mac_count, r1, MAC_COUNT), None, count=120, wait=1
+    )
+    assert result is None, result
+    learned = time.time()
+    _, result = topotest.run_and_expect(
+        partial(check_fdb_count, r1, MAC_COUNT), None, count=120, wait=1
+    )
+    assert result is None, result
+    installed = time.time()
+
+    logger.info(
+        "%d remote MACs: learned in %.2fs, in the kernel FDB in %.2fs",
+        MAC_COUNT,
+        learned - start,
+        installed - start,
+    )
+    logger.info(
+        "\n%s",
+        r1.vtysh_cmd("show zebra dplane detailed"),
+    )
+    logger.info("\n%s", r1.vtysh_cmd("show memory zebra"))
+
+    start = time.time()
+    r1.vtysh_cmd(
+        "sharp install remote-macs vni {} vtep 10.10.10.20 mac 00:00:00:01:00:00 {} remove".format(
+            VNI, MAC_COUNT
+        )
+    )
+    _, result = topotest.run_and_expect(
+        partial(check_fdb_count, r1, 0), None, count=120, wait=1
+    )
+    assert result is None, result
+    logger.info("%d remote MACs withdrawn in %.2fs", MAC_COUNT, time.time() - start)
+
+    _, result = topotest.run_and_expect(
+        partial(check_mac_count, r1, 0), None, count=30, wait=1
+    )
+    assert result is None, result
+
+
+def test_memory_leak():
+    "Run the memory leak test and report results."
+    tgen = get_topogen()
+    if not tgen.is_memleak_enabled():
+        pytest.skip("Memory leak test/report is disabled")
+
+    tgen.report_memory_leaks()
+
+
+if __name__ == "__main__":
+    args = ["-s"] + sys.argv[1:]
+    sys.exit(pytest.main(args))
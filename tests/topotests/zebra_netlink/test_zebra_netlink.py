@@ -13,7 +13,9 @@ test_zebra_netlink.py: Test some basic interactions with kernel using Netlink
 """
 # pylint: disable=C0413
 import ipaddress
+import os
 import sys
+import time
 
 import pytest
 from lib import topotest
@@ -103,6 +105,63 @@ def test_zebra_netlink_batching(tgen):
     r1.vtysh_cmd("sharp remove routes 2.1.3.7 " + str(count))
 
 
+def test_zebra_netlink_interface_scale(tgen):
+    "Test zebra keeps up with many interfaces being created and flapped."
+    r1 = tgen.gears["r1"]
+
+    count = 2000
+    batch = os.path.join(tgen.logdir, "r1", "links.batch")
+
+    def run_batch(cmds):
+        with open(batch, "w") as f:
+            f.write("\n".join(cmds) + "\n")
+        r1.run("ip -batch {}".format(batch))
+
+    def wait_for(op, ok):
+        logger.info("Waiting for zebra to see %d interfaces %s", count, op)
+        start = time.time()
+        _, result = topotest.run_and_expect(
+            lambda: ok(r1.vtysh_cmd("show interface brief json", isjson=True)),
+            True,
+            count=120,
+            wait=0.5,
+        )
+        assert result, "zebra did not see all interfaces {}".format(op)
+        logger.info("%s took %.2fs", op, time.time() - start)
+
+    def dummies(output):
+        return {k: v for k, v in output.items() if k.startswith("dum")}
+
+    run_batch(["link add dum{} type dummy".format(i) for i in range(count)])
+    run_batch(["link set dum{} up".format(i) for i in range(count)])
+    wait_for(
+        "created",
+        lambda out: len(dummies(out)) == count
+        and all(v["status"] == "up" for v in dummies(out).values()),
+    )
+
+    # Flap every interface a few times in quick succession
+    cmds = []
+    for _ in range(3):
+        cmds += ["link set dum{} down".format(i) for i in range(count)]
+        cmds += ["link set dum{} up".format(i) for i in range(count)]
+    cmds += ["link set dum{} down".format(i) for i in range(count)]
+    run_batch(cmds)
+    wait_for(
+        "flapped",
+        lambda out: len(dummies(out)) == count
+        and all(v["status"] == "down" for v in dummies(out).values()),
+    )
+
+    output = r1.vtysh_cmd("show zebra dplane detailed")
+    for line in output.splitlines():
+        if "coalesced" in line:
+            logger.info(line.strip())
+
+    run_batch(["link del dum{}".format(i) for i in range(count)])
+    wait_for("deleted", lambda out: len(dummies(out)) == 0)
+
+
 if __name__ == "__main__":
     args = ["-s"] + sys.argv[1:]
     sys.exit(pytest.main(args))
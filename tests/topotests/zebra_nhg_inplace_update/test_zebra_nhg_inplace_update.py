@@ -0,0 +1,239 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: ISC
+
+#
+# test_zebra_nhg_inplace_update.py
+#
+
+"""
+test_zebra_nhg_inplace_update.py: Test that an ECMP member going down and
+coming back updates the shared nexthop group in place, and that every route
+sharing the group is redistributed and re-evaluated for NHT.
+"""
+
+import json
+import sys
+
+import pytest
+from lib.common_config import step
+from lib.topogen import Topogen, TopoRouter, get_topogen
+from lib.topolog import logger
+from munet.testing.util import retry
+
+# pylint: disable=C0413
+from lib import topotest
+
+ROUTES = ["10.0.0.{}/32".format(i) for i in range(1, 6)]
+
+
+def build_topo(tgen):
+    "Build function"
+
+    tgen.add_router("r1")
+
+    for i in range(1, 4):
+        switch = tgen.add_switch("s{}".format(i))
+        switch.add_link(tgen.gears["r1"])
+
+
+def setup_module(mod):
+    "Sets up the pytest environment"
+    tgen = Topogen(build_topo, mod.__name__)
+    tgen.start_topology()
+
+    for rname, router in tgen.routers().items():
+        logger.info("Loading router %s" % rname)
+        router.load_frr_config(
+            "frr.conf", [(TopoRouter.RD_ZEBRA, None), (TopoRouter.RD_SHARP, None)]
+        )
+
+    tgen.start_router()
+
+
+def teardown_module():
+    "Teardown the pytest environment"
+    tgen = get_topogen()
+
+    tgen.stop_topology()
+
+
+def _route_nhg_ids(router):
+    "Return {prefix: (nexthopGroupId, installedNexthopGroupId, active count)}"
+    route_json = json.loads(router.vtysh_cmd("show ip route static json"))
+    ids = {}
+    for prefix in ROUTES:
+        if prefix not in route_json:
+            continue
+        route = route_json[prefix][0]
+        active = [nh for nh in route.get("nexthops", []) if nh.get("active")]
+        ids[prefix] = (
+            route.get("nexthopGroupId"),
+            route.get("installedNexthopGroupId"),
+            len(active),
+        )
+    return ids
+
+
+def _kernel_nhg_members(router, nhg_id):
+    "Number of members of the kernel nexthop group"
+    output = router.run("ip -j nexthop show id {}".format(nhg_id))
+    try:
+        nhg = json.loads(output)
+    except ValueError:
+        return None
+    if not nhg:
+        return None
+    return len(nhg[0].get("group", []))
+
+
+def _nht_active(router, address):
+    "Number of active nexthops zebra reports to NHT clients for address"
+    nht_json = json.loads(router.vtysh_cmd("show ip nht json"))
+    entry = nht_json.get("default", {}).get("ipv4", {}).get(address)
+    if not entry:
+        return None
+    count = 0
+    for resolution in entry.get("resolutions", []):
+        nexthops = resolution.get("nexthops", [])
+        count += len([nh for nh in nexthops if nh.get("active")])
+    return count
+
+
+def _sharp_redist_adds(router):
+    "Number of IPv4 routes zebra redistributed to sharpd"
+    clients = json.loads(router.vtysh_cmd("show zebra client json"))
+    sharp = clients.get("sharp")
+    if not sharp:
+        return None
+    return sharp[0]["redistV4"]["add"]
+
+
+def _check_group(router, nhg_id, installed_id, members, address):
+    @retry(retry_timeout=30, retry_sleep=0.25)
+    def _check():
+        ids = _route_nhg_ids(router)
+        for prefix in ROUTES:
+            assert prefix in ids, "Route {} not found".format(prefix)
+            nhe, installed, active = ids[prefix]
+            assert nhe == nhg_id, "Route {} moved to NHG {} from {}".format(
+                prefix, nhe, nhg_id
+            )
+            assert (
+                installed == installed_id
+            ), "Route {} installed with NHG {} instead of {}".format(
+                prefix, installed, installed_id
+            )
+            assert active == members, "Route {} has {} active nexthops".format(
+                prefix, active
+            )
+
+        count = _kernel_nhg_members(router, installed_id)
+        assert count == members, "Kernel NHG {} has {} members".format(
+            installed_id, count
+        )
+
+        count = _nht_active(router, address)
+        assert count == members, "NHT for {} reports {} nexthops".format(
+            address, count
+        )
+
+    return _check()
+
+
+def _check_redistributed(router, before):
+    @retry(retry_timeout=30, retry_sleep=0.25)
+    def _check():
+        adds = _sharp_redist_adds(router)
+        assert adds is not None, "sharpd is not a zebra client"
+        assert adds >= before + len(
+            ROUTES
+        ), "Only {} of {} routes redistributed".format(adds - before, len(ROUTES))
+
+    return _check()
+
+
+def test_zebra_nhg_inplace_setup():
+    "Install the ECMP routes and start watching them"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+
+    step("Wait for all routes to share one 3-way group")
+
+    @retry(retry_timeout=30, retry_sleep=0.25)
+    def _check_installed():
+        ids = _route_nhg_ids(r1)
+        assert len(ids) == len(ROUTES), "Not all routes installed"
+        groups = set((nhe, installed) for nhe, installed, _ in ids.values())
+        assert len(groups) == 1, "Routes do not share one group: {}".format(groups)
+        for prefix, (_, installed, active) in ids.items():
+            assert installed, "Route {} is not installed".format(prefix)
+            assert active == 3, "Route {} has {} active nexthops".format(
+                prefix, active
+            )
+
+    assert not _check_installed()
+
+    step("Watch a nexthop and static redistribution from sharpd")
+    r1.vtysh_cmd("sharp watch nexthop 10.0.0.1")
+    r1.vtysh_cmd("sharp watch redistribute static")
+
+    nhg_id, installed_id, _ = _route_nhg_ids(r1)[ROUTES[0]]
+    assert not _check_group(r1, nhg_id, installed_id, 3, "10.0.0.1")
+    assert not _check_redistributed(r1, 0)
+
+
+def test_zebra_nhg_inplace_member_down():
+    "Take one ECMP member down"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+    nhg_id, installed_id, _ = _route_nhg_ids(r1)[ROUTES[0]]
+    before = _sharp_redist_adds(r1)
+
+    step("Take r1-eth1 down")
+    r1.run("ip link set r1-eth1 down")
+
+    step("Verify the routes keep NHG {} with 2 members".format(nhg_id))
+    assert not _check_group(r1, nhg_id, installed_id, 2, "10.0.0.1")
+
+    step("Verify every route was redistributed again")
+    assert not _check_redistributed(r1, before)
+
+
+def test_zebra_nhg_inplace_member_up():
+    "Bring the ECMP member back"
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+    nhg_id, installed_id, _ = _route_nhg_ids(r1)[ROUTES[0]]
+    before = _sharp_redist_adds(r1)
+
+    step("Bring r1-eth1 back up")
+    r1.run("ip link set r1-eth1 up")
+
+    step("Verify the routes keep NHG {} with 3 members".format(nhg_id))
+    assert not _check_group(r1, nhg_id, installed_id, 3, "10.0.0.1")
+
+    step("Verify every route was redistributed again")
+    assert not _check_redistributed(r1, before)
+
+
+def test_memory_leak():
+    "Run the memory leak test and report results."
+    tgen = get_topogen()
+    if not tgen.is_memleak_enabled():
+        pytest.skip("Memory leak test/report is disabled")
+
+    tgen.report_memory_leaks()
+
+
+if __name__ == "__main__":
+    args = ["-s"] + sys.argv[1:]
+    sys.exit(pytest.main(args))
@@ -68,23 +68,74 @@
  */
 #define FPM_HEADER_SIZE 4
 
+/* Largest single encoded message, and input buffer size. */
+#define DPLANE_FPM_NL_BUF_SIZE 65536
+
+/* Most parallel connections we'll open to the FPM server. */
+#define FPM_NL_CONNS_MAX 8
+
+/*
+ * Output is kept in chunks that messages are encoded straight into and
+ * that are handed to writev() as they are.
+ *
+ * A connection stops taking new messages once it has FPM_NL_OBUF_HIGH
+ * bytes queued and starts again when the writer has brought that down to
+ * FPM_NL_OBUF_LOW.
+ */
+#define FPM_NL_OBUF_CHUNK_SIZE (DPLANE_FPM_NL_BUF_SIZE * 16)
+#define FPM_NL_OBUF_HIGH (DPLANE_FPM_NL_BUF_SIZE * 128)
+#define FPM_NL_OBUF_LOW (FPM_NL_OBUF_HIGH / 2)
+#define FPM_NL_IOV_MAX 64
+
 static const char *prov_name = "dplane_fpm_nl";
 
 static atomic_bool fpm_cleaning_up;
 
-struct fpm_nl_ctx {
-	/* data plane connection. */
+struct fpm_nl_ctx;
+
+/* One TCP connection to the FPM server. */
+struct fpm_nl_conn {
+	struct fpm_nl_ctx *fnc;
+
 	int socket;
-	bool disabled;
 	bool connecting;
+
+	struct stream *ibuf;
+
+	/* Output chunks and queued byte count, protected by obuf_mutex. */
+	struct stream_fifo obuf;
+	size_t obuf_bytes;
+	bool blocked;
+	pthread_mutex_t obuf_mutex;
+
+	struct event *t_read;
+	struct event *t_write;
+
+	/* Amount of bytes written on this connection. */
+	_Atomic uint32_t bytes_sent;
+	/* Amount of flow control stops on this connection. */
+	_Atomic uint32_t blocks;
+};
+
+struct fpm_nl_ctx {
+	bool disabled;
 	bool use_nhg;
 	bool use_route_replace;
 	struct sockaddr_storage addr;
 
-	/* data plane buffers. */
-	struct stream *ibuf;
-	struct stream *obuf;
-	pthread_mutex_t obuf_mutex;
+	/*
+	 * data plane connections: routes, LSPs and MACs are sharded across
+	 * them, next hop groups go to all of them.
+	 */
+	struct fpm_nl_conn conns[FPM_NL_CONNS_MAX];
+	unsigned int conn_count;
+	_Atomic unsigned int conn_count_cfg;
+	_Atomic unsigned int conns_up;
+
+	/* Queue processing is waiting for a connection to drain. */
+	bool paused;
+	/* Queue processing is waiting for all output buffers to empty. */
+	bool barrier;
 
 	/*
 	 * data plane context queue:
@@ -98,8 +149,6 @@ struct fpm_nl_ctx {
 	struct zebra_dplane_provider *prov;
 	struct frr_pthread *fthread;
 	struct event *t_connect;
-	struct event *t_read;
-	struct event *t_write;
 	struct event *t_event;
 	struct event *t_nhg;
 	struct event *t_dequeue;
@@ -143,6 +192,8 @@ struct fpm_nl_ctx {
 
 		/* Amount of buffer full events. */
 		_Atomic uint32_t buffer_full;
+		/* Amount of times queue processing waited for the server. */
+		_Atomic uint32_t flow_pauses;
 	} counters;
 } *gfnc;
 
@@ -157,6 +208,8 @@ enum fpm_nl_events {
 	FNE_TOGGLE_NHG,
 	/* Reconnect request by our own code to avoid races. */
 	FNE_INTERNAL_RECONNECT,
+	/* Number of connections changed. */
+	FNE_SET_CONNECTIONS,
 
 	/* LSP walk finished. */
 	FNE_LSP_FINISHED,
@@ -180,6 +233,7 @@ enum fpm_nl_events {
  * Prototypes.
  */
 static void fpm_process_event(struct event *t);
+static void fpm_process_queue(struct event *t);
 static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx);
 static void fpm_lsp_send(struct event *t);
 static void fpm_lsp_reset(struct event *t);
@@ -314,6 +368,25 @@ DEFUN(no_fpm_use_route_replace, no_fpm_use_route_replace_cmd,
 	return CMD_SUCCESS;
 }
 
+DEFPY(fpm_connections, fpm_connections_cmd,
+      "[no] fpm connections (1-8)$count",
+      NO_STR
+      FPM_STR
+      "Number of parallel connections to the FPM server\n"
+      "Connections\n")
+{
+	unsigned int wanted = no ? 1 : count;
+
+	if (wanted == gfnc->conn_count_cfg)
+		return CMD_SUCCESS;
+
+	gfnc->conn_count_cfg = wanted;
+	event_add_event(gfnc->fthread->master, fpm_process_event, gfnc,
+			FNE_SET_CONNECTIONS, &gfnc->t_event);
+
+	return CMD_SUCCESS;
+}
+
 DEFUN(fpm_reset_counters, fpm_reset_counters_cmd,
       "clear fpm counters",
       CLEAR_STR
@@ -336,8 +409,10 @@ DEFPY(fpm_show_status,
 	struct sockaddr_in *sin;
 	struct sockaddr_in6 *sin6;
 	char buf[BUFSIZ];
+	unsigned int conn_count = gfnc->conn_count;
+	unsigned int conns_up = gfnc->conns_up;
 
-	connected = gfnc->socket > 0 ? true : false;
+	connected = conn_count && conns_up == conn_count;
 
 	switch (gfnc->addr.ss_family) {
 	case AF_INET:
@@ -366,6 +441,8 @@ DEFPY(fpm_show_status,
 		json_object_boolean_add(j, "disabled", gfnc->disabled);
 		json_object_string_add(j, "address", buf);
 		json_object_int_add(j, "port", port);
+		json_object_int_add(j, "connections", conn_count);
+		json_object_int_add(j, "connectionsUp", conns_up);
 
 		vty_json(vty, j);
 	} else {
@@ -376,6 +453,8 @@ DEFPY(fpm_show_status,
 		ttable_add_row(table, "Address to connect to|%s", buf);
 		ttable_add_row(table, "Port|%u", port);
 		ttable_add_row(table, "Connected|%s", connected ? "Yes" : "No");
+		ttable_add_row(table, "Connections|%u (%u up)", conn_count,
+			       conns_up);
 		ttable_add_row(table, "Use Nexthop Groups|%s",
 			       gfnc->use_nhg ? "Yes" : "No");
 		ttable_add_row(table, "Use Route Replace Semantics|%s",
@@ -422,9 +501,16 @@ DEFUN(fpm_show_counters, fpm_show_counters_cmd,
 	SHOW_COUNTER("Data plane items queue peak",
 		     gfnc->counters.ctxqueue_len_peak);
 	SHOW_COUNTER("Buffer full hits", gfnc->counters.buffer_full);
+	SHOW_COUNTER("Flow control pauses", gfnc->counters.flow_pauses);
 	SHOW_COUNTER("User FPM configurations", gfnc->counters.user_configures);
 	SHOW_COUNTER("User FPM disable requests", gfnc->counters.user_disables);
 
+	for (unsigned int i = 0; i < gfnc->conn_count; i++) {
+		vty_out(vty, "%26s %u: %u bytes sent, %u flow control stops\n",
+			"Connection", i, gfnc->conns[i].bytes_sent,
+			gfnc->conns[i].blocks);
+	}
+
 #undef SHOW_COUNTER
 
 	return CMD_SUCCESS;
@@ -443,7 +529,7 @@ DEFUN(fpm_show_counters_json, fpm_show_counters_json_cmd,
 		curr_queue_len = dplane_ctx_queue_count(&gfnc->ctxqueue);
 	}
 
-	struct json_object *jo;
+	struct json_object *jo, *jconns;
 
 	jo = json_object_new_object();
 	json_object_int_add(jo, "bytes-read", gfnc->counters.bytes_read);
@@ -460,9 +546,23 @@ DEFUN(fpm_show_counters_json, fpm_show_counters_json_cmd,
 	json_object_int_add(jo, "data-plane-contexts-queue-peak",
 			    gfnc->counters.ctxqueue_len_peak);
 	json_object_int_add(jo, "buffer-full-hits", gfnc->counters.buffer_full);
+	json_object_int_add(jo, "flow-control-pauses",
+			    gfnc->counters.flow_pauses);
 	json_object_int_add(jo, "user-configures",
 			    gfnc->counters.user_configures);
 	json_object_int_add(jo, "user-disables", gfnc->counters.user_disables);
+
+	jconns = json_object_new_array();
+	for (unsigned int i = 0; i < gfnc->conn_count; i++) {
+		struct json_object *jconn = json_object_new_object();
+
+		json_object_int_add(jconn, "bytes-sent",
+				    gfnc->conns[i].bytes_sent);
+		json_object_int_add(jconn, "flow-control-stops",
+				    gfnc->conns[i].blocks);
+		json_object_array_add(jconns, jconn);
+	}
+	json_object_object_add(jo, "connections", jconns);
 	vty_json(vty, jo);
 
 	return CMD_SUCCESS;
@@ -511,6 +611,11 @@ static int fpm_write_config(struct vty *vty)
 		written = 1;
 	}
 
+	if (gfnc->conn_count_cfg != 1) {
+		vty_out(vty, "fpm connections %u\n", gfnc->conn_count_cfg);
+		written = 1;
+	}
+
 	return written;
 }
 
@@ -525,6 +630,16 @@ static struct cmd_node fpm_node = {
  * FPM functions.
  */
 static void fpm_connect(struct event *t);
+static void fpm_write(struct event *t);
+
+/* All configured connections are established. */
+static bool fpm_nl_connected(struct fpm_nl_ctx *fnc)
+{
+	unsigned int up = atomic_load_explicit(&fnc->conns_up,
+					       memory_order_relaxed);
+
+	return up != 0 && up == fnc->conn_count;
+}
 
 static void fpm_reconnect(struct fpm_nl_ctx *fnc)
 {
@@ -548,22 +663,41 @@ static void fpm_reconnect(struct fpm_nl_ctx *fnc)
 	event_cancel_async(zrouter.master, &fnc->t_rmacreset, NULL);
 	event_cancel_async(zrouter.master, &fnc->t_rmacwalk, NULL);
 
-	/*
-	 * Grab the lock to empty the streams (data plane might try to
-	 * enqueue updates while we are closing).
-	 */
-	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
+	for (unsigned int i = 0; i < FPM_NL_CONNS_MAX; i++) {
+		struct fpm_nl_conn *conn = &fnc->conns[i];
 
-	/* Avoid calling close on `-1`. */
-	if (fnc->socket != -1) {
-		close(fnc->socket);
-		fnc->socket = -1;
-	}
+		/*
+		 * Grab the lock to empty the streams (data plane might try to
+		 * enqueue updates while we are closing).
+		 */
+		frr_with_mutex (&conn->obuf_mutex) {
+			/* Avoid calling close on `-1`. */
+			if (conn->socket != -1) {
+				close(conn->socket);
+				conn->socket = -1;
+			}
+			conn->connecting = false;
 
-	stream_reset(fnc->ibuf);
-	stream_reset(fnc->obuf);
-	event_cancel(&fnc->t_read);
-	event_cancel(&fnc->t_write);
+			stream_reset(conn->ibuf);
+			stream_fifo_clean(&conn->obuf);
+			conn->obuf_bytes = 0;
+			conn->blocked = false;
+		}
+		event_cancel(&conn->t_read);
+		event_cancel(&conn->t_write);
+	}
+	atomic_store_explicit(&fnc->counters.obuf_bytes, 0,
+			      memory_order_relaxed);
+	fnc->conns_up = 0;
+	fnc->conn_count = fnc->conn_count_cfg;
+
+	/* Nothing left to wait for; let the queue drain into the void. */
+	if (fnc->paused || fnc->barrier) {
+		fnc->paused = false;
+		fnc->barrier = false;
+		event_add_event(fnc->fthread->master, fpm_process_queue, fnc, 0,
+				&fnc->t_dequeue);
+	}
 
 	/* Reset the barrier value */
 	cleaning_p = true;
@@ -581,7 +715,8 @@ static void fpm_reconnect(struct fpm_nl_ctx *fnc)
 
 static void fpm_read(struct event *t)
 {
-	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
+	struct fpm_nl_conn *conn = EVENT_ARG(t);
+	struct fpm_nl_ctx *fnc = conn->fnc;
 	fpm_msg_hdr_t fpm;
 	ssize_t rv;
 	char buf[65535];
@@ -595,8 +730,8 @@ static void fpm_read(struct event *t)
 	dplane_ctx_q_init(&batch_list);
 
 	/* Let's ignore the input at the moment. */
-	rv = stream_read_try(fnc->ibuf, fnc->socket,
-			     STREAM_WRITEABLE(fnc->ibuf));
+	rv = stream_read_try(conn->ibuf, conn->socket,
+			     STREAM_WRITEABLE(conn->ibuf));
 	if (rv == 0) {
 		atomic_fetch_add_explicit(&fnc->counters.connection_closes, 1,
 					  memory_order_relaxed);
@@ -617,8 +752,8 @@ static void fpm_read(struct event *t)
 	}
 
 	/* Schedule the next read */
-	event_add_read(fnc->fthread->master, fpm_read, fnc, fnc->socket,
-		       &fnc->t_read);
+	event_add_read(fnc->fthread->master, fpm_read, conn, conn->socket,
+		       &conn->t_read);
 
 	/* We've got an interruption. */
 	if (rv == -2)
@@ -629,20 +764,20 @@ static void fpm_read(struct event *t)
 	atomic_fetch_add_explicit(&fnc->counters.bytes_read, rv,
 				  memory_order_relaxed);
 
-	available_bytes = STREAM_READABLE(fnc->ibuf);
+	available_bytes = STREAM_READABLE(conn->ibuf);
 	while (available_bytes) {
 		if (available_bytes < (ssize_t)FPM_MSG_HDR_LEN) {
-			stream_pulldown(fnc->ibuf);
+			stream_pulldown(conn->ibuf);
 			goto send_batch;
 		}
 
-		fpm.version = stream_getc(fnc->ibuf);
-		fpm.msg_type = stream_getc(fnc->ibuf);
-		fpm.msg_len = stream_getw(fnc->ibuf);
+		fpm.version = stream_getc(conn->ibuf);
+		fpm.msg_type = stream_getc(conn->ibuf);
+		fpm.msg_len = stream_getw(conn->ibuf);
 
 		if (fpm.version != FPM_PROTO_VERSION &&
 		    fpm.msg_type != FPM_MSG_TYPE_NETLINK) {
-			stream_reset(fnc->ibuf);
+			stream_reset(conn->ibuf);
 			zlog_warn(
 				"%s: Received version/msg_type %u/%u, expected 1/1",
 				__func__, fpm.version, fpm.msg_type);
@@ -669,8 +804,8 @@ static void fpm_read(struct event *t)
 		 * top.
 		 */
 		if (fpm.msg_len > available_bytes) {
-			stream_rewind_getp(fnc->ibuf, FPM_MSG_HDR_LEN);
-			stream_pulldown(fnc->ibuf);
+			stream_rewind_getp(conn->ibuf, FPM_MSG_HDR_LEN);
+			stream_pulldown(conn->ibuf);
 			goto send_batch;
 		}
 
@@ -680,7 +815,7 @@ static void fpm_read(struct event *t)
 		 * Place the data from the stream into a buffer
 		 */
 		hdr = (struct nlmsghdr *)buf;
-		stream_get(buf, fnc->ibuf, fpm.msg_len - FPM_MSG_HDR_LEN);
+		stream_get(buf, conn->ibuf, fpm.msg_len - FPM_MSG_HDR_LEN);
 		hdr_available_bytes = fpm.msg_len - FPM_MSG_HDR_LEN;
 		available_bytes -= hdr_available_bytes;
 
@@ -750,7 +885,7 @@ static void fpm_read(struct event *t)
 				 * Even if we ignore this one.
 				 */
 				dplane_ctx_fini(&ctx);
-				stream_pulldown(fnc->ibuf);
+				stream_pulldown(conn->ibuf);
 			}
 			break;
 		default:
@@ -762,7 +897,7 @@ static void fpm_read(struct event *t)
 		}
 	}
 
-	stream_reset(fnc->ibuf);
+	stream_reset(conn->ibuf);
 
 send_batch:
 	/* Send all contexts to zebra in a single batch if we have any */
@@ -774,19 +909,144 @@ send_batch:
 	}
 }
 
+/* A connection finished connecting: start reading, replay once all are up. */
+static void fpm_conn_up(struct fpm_nl_conn *conn)
+{
+	struct fpm_nl_ctx *fnc = conn->fnc;
+	unsigned int up;
+
+	conn->connecting = false;
+
+	/* Permit receiving messages now. */
+	event_add_read(fnc->fthread->master, fpm_read, conn, conn->socket,
+		       &conn->t_read);
+
+	up = atomic_fetch_add_explicit(&fnc->conns_up, 1,
+				       memory_order_seq_cst) + 1;
+	if (up < fnc->conn_count)
+		return;
+
+	/*
+	 * Starting with LSPs walk all FPM objects, marking them
+	 * as unsent and then replaying them.
+	 */
+	event_add_timer(zrouter.master, fpm_lsp_reset, fnc, 0,
+			&fnc->t_lspreset);
+}
+
+/* Is any connection above its high watermark? */
+static bool fpm_nl_blocked(struct fpm_nl_ctx *fnc)
+{
+	bool blocked = false;
+
+	for (unsigned int i = 0; i < fnc->conn_count; i++) {
+		struct fpm_nl_conn *conn = &fnc->conns[i];
+
+		frr_with_mutex (&conn->obuf_mutex) {
+			if (conn->obuf_bytes >= FPM_NL_OBUF_HIGH &&
+			    !conn->blocked) {
+				conn->blocked = true;
+				atomic_fetch_add_explicit(&conn->blocks, 1,
+							  memory_order_relaxed);
+			}
+			blocked |= conn->blocked;
+		}
+	}
+
+	return blocked;
+}
+
+/*
+ * Every connection's output buffer is empty: all it held has been written
+ * to its socket. That is all it means; FPM has no acknowledgements, so it
+ * says nothing about what the server has received or processed.
+ */
+static bool fpm_nl_drained(struct fpm_nl_ctx *fnc)
+{
+	bool drained = true;
+
+	for (unsigned int i = 0; i < fnc->conn_count; i++) {
+		struct fpm_nl_conn *conn = &fnc->conns[i];
+
+		frr_with_mutex (&conn->obuf_mutex) {
+			drained &= conn->obuf_bytes == 0;
+		}
+	}
+
+	return drained;
+}
+
+/*
+ * A next hop group delete goes to every connection, while the route
+ * updates that moved routes off the group went to one connection each.
+ * Hold the delete back until those have been written to their sockets,
+ * so that no connection carries the delete before the updates are sent.
+ *
+ * This orders the writes, not the server's reads: a server reading its
+ * connections independently may still handle the delete on one before
+ * an update still in flight on another. FPM has no acknowledgement to
+ * wait for; servers that care should use a single connection.
+ */
+static bool fpm_nl_nhg_delete_waits(struct fpm_nl_ctx *fnc)
+{
+	struct zebra_dplane_ctx *ctx;
+
+	if (fnc->conn_count <= 1 || !fnc->use_nhg || !fpm_nl_connected(fnc))
+		return false;
+
+	frr_with_mutex (&fnc->ctxqueue_mutex) {
+		ctx = dplane_ctx_get_head(&fnc->ctxqueue);
+	}
+	if (!ctx || dplane_ctx_get_op(ctx) != DPLANE_OP_NH_DELETE)
+		return false;
+
+	return !fpm_nl_drained(fnc);
+}
+
+/* Release written bytes from the front of the output chunks. */
+static void fpm_nl_obuf_consume(struct fpm_nl_conn *conn, size_t len)
+{
+	struct stream *s;
+	size_t n;
+
+	conn->obuf_bytes -= len;
+
+	while (len) {
+		s = stream_fifo_head(&conn->obuf);
+		n = MIN(len, STREAM_READABLE(s));
+		stream_forward_getp(s, n);
+		len -= n;
+
+		if (STREAM_READABLE(s))
+			break;
+
+		/* Keep the chunk being filled, drop the others. */
+		if (s == conn->obuf.tail)
+			stream_reset(s);
+		else
+			stream_free(stream_fifo_pop(&conn->obuf));
+	}
+
+	if (conn->blocked && conn->obuf_bytes <= FPM_NL_OBUF_LOW)
+		conn->blocked = false;
+}
+
 static void fpm_write(struct event *t)
 {
-	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
+	struct fpm_nl_conn *conn = EVENT_ARG(t);
+	struct fpm_nl_ctx *fnc = conn->fnc;
+	struct iovec iov[FPM_NL_IOV_MAX];
+	struct stream *s;
 	socklen_t statuslen;
 	ssize_t bwritten;
-	int rv, status;
-	size_t btotal;
+	int rv, status, iovcnt;
+	size_t pending;
 
-	if (fnc->connecting == true) {
+	if (conn->connecting == true) {
 		status = 0;
 		statuslen = sizeof(status);
 
-		rv = getsockopt(fnc->socket, SOL_SOCKET, SO_ERROR, &status,
+		rv = getsockopt(conn->socket, SOL_SOCKET, SO_ERROR, &status,
 				&statuslen);
 		if (rv == -1 || status != 0) {
 			if (rv != -1)
@@ -804,33 +1064,33 @@ static void fpm_write(struct event *t)
 			return;
 		}
 
-		fnc->connecting = false;
+		fpm_conn_up(conn);
+	}
 
+	while (true) {
 		/*
-		 * Starting with LSPs walk all FPM objects, marking them
-		 * as unsent and then replaying them.
+		 * Point straight at the queued chunks. Encoders only ever
+		 * append past the end of what we send here, so the lock
+		 * doesn't need to be held across the write.
 		 */
-		event_add_timer(zrouter.master, fpm_lsp_reset, fnc, 0,
-				&fnc->t_lspreset);
-
-		/* Permit receiving messages now. */
-		event_add_read(fnc->fthread->master, fpm_read, fnc, fnc->socket,
-			       &fnc->t_read);
-	}
-
-	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
+		iovcnt = 0;
+		frr_with_mutex (&conn->obuf_mutex) {
+			for (s = conn->obuf.head; s && iovcnt < FPM_NL_IOV_MAX;
+			     s = s->next) {
+				if (STREAM_READABLE(s) == 0)
+					continue;
+
+				iov[iovcnt].iov_base = stream_pnt(s);
+				iov[iovcnt].iov_len = STREAM_READABLE(s);
+				iovcnt++;
+			}
+		}
 
-	while (true) {
-		/* Stream is empty: reset pointers and return. */
-		if (STREAM_READABLE(fnc->obuf) == 0) {
-			stream_reset(fnc->obuf);
+		/* Nothing queued. */
+		if (iovcnt == 0)
 			break;
-		}
 
-		/* Try to write all at once. */
-		btotal = stream_get_endp(fnc->obuf) -
-			stream_get_getp(fnc->obuf);
-		bwritten = write(fnc->socket, stream_pnt(fnc->obuf), btotal);
+		bwritten = writev(conn->socket, iov, iovcnt);
 		if (bwritten == 0) {
 			atomic_fetch_add_explicit(
 				&fnc->counters.connection_closes, 1,
@@ -861,42 +1121,53 @@ static void fpm_write(struct event *t)
 		/* Account all bytes sent. */
 		atomic_fetch_add_explicit(&fnc->counters.bytes_sent, bwritten,
 					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&conn->bytes_sent, bwritten,
+					  memory_order_relaxed);
 
 		/* Account number of bytes free. */
 		atomic_fetch_sub_explicit(&fnc->counters.obuf_bytes, bwritten,
 					  memory_order_relaxed);
 
-		stream_forward_getp(fnc->obuf, (size_t)bwritten);
+		frr_with_mutex (&conn->obuf_mutex) {
+			fpm_nl_obuf_consume(conn, (size_t)bwritten);
+		}
 	}
 
-	/* Stream is not empty yet, we must schedule more writes. */
-	if (STREAM_READABLE(fnc->obuf)) {
-		stream_pulldown(fnc->obuf);
-		event_add_write(fnc->fthread->master, fpm_write, fnc,
-				fnc->socket, &fnc->t_write);
-		return;
+	frr_with_mutex (&conn->obuf_mutex) {
+		pending = conn->obuf_bytes;
+	}
+
+	/* Output is not empty yet, we must schedule more writes. */
+	if (pending)
+		event_add_write(fnc->fthread->master, fpm_write, conn,
+				conn->socket, &conn->t_write);
+
+	/* Tell queue processing it can go on once all connections drained. */
+	if (fnc->paused && !fpm_nl_blocked(fnc)) {
+		fnc->paused = false;
+		event_add_event(fnc->fthread->master, fpm_process_queue, fnc, 0,
+				&fnc->t_dequeue);
+	}
+
+	/* Or once they are all empty, if a group delete is waiting. */
+	if (fnc->barrier && fpm_nl_drained(fnc)) {
+		fnc->barrier = false;
+		event_add_event(fnc->fthread->master, fpm_process_queue, fnc, 0,
+				&fnc->t_dequeue);
 	}
 }
 
 static void fpm_connect(struct event *t)
 {
 	struct fpm_nl_ctx *fnc = EVENT_ARG(t);
+	struct fpm_nl_conn *conn;
 	struct sockaddr_in *sin = (struct sockaddr_in *)&fnc->addr;
 	struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)&fnc->addr;
 	socklen_t slen;
 	int rv, sock;
+	unsigned int i;
 	char addrstr[INET6_ADDRSTRLEN];
 
-	sock = socket(fnc->addr.ss_family, SOCK_STREAM, 0);
-	if (sock == -1) {
-		flog_err(EC_LIB_SOCKET, "%s: fpm socket failed: %s", __func__, strerror(errno));
-		event_add_timer(fnc->fthread->master, fpm_connect, fnc, 3,
-				&fnc->t_connect);
-		return;
-	}
-
-	set_nonblocking(sock);
-
 	if (fnc->addr.ss_family == AF_INET) {
 		inet_ntop(AF_INET, &sin->sin_addr, addrstr, sizeof(addrstr));
 		slen = sizeof(*sin);
@@ -906,80 +1177,87 @@ static void fpm_connect(struct event *t)
 	}
 
 	if (IS_ZEBRA_DEBUG_FPM)
-		zlog_debug("%s: attempting to connect to %s:%d", __func__,
-			   addrstr, ntohs(sin->sin_port));
+		zlog_debug("%s: attempting %u connection(s) to %s:%d",
+			   __func__, fnc->conn_count, addrstr,
+			   ntohs(sin->sin_port));
+
+	for (i = 0; i < fnc->conn_count; i++) {
+		conn = &fnc->conns[i];
+
+		sock = socket(fnc->addr.ss_family, SOCK_STREAM, 0);
+		if (sock == -1) {
+			flog_err(EC_LIB_SOCKET, "%s: fpm socket failed: %s",
+				 __func__, strerror(errno));
+			goto retry;
+		}
 
-	rv = connect(sock, (struct sockaddr *)&fnc->addr, slen);
-	if (rv == -1 && errno != EINPROGRESS) {
-		atomic_fetch_add_explicit(&fnc->counters.connection_errors, 1,
-					  memory_order_relaxed);
-		close(sock);
-		zlog_warn("%s: fpm connection failed: %s", __func__,
-			  strerror(errno));
-		event_add_timer(fnc->fthread->master, fpm_connect, fnc, 3,
-				&fnc->t_connect);
-		return;
-	}
+		set_nonblocking(sock);
 
-	fnc->connecting = (errno == EINPROGRESS);
-	fnc->socket = sock;
-	if (!fnc->connecting)
-		event_add_read(fnc->fthread->master, fpm_read, fnc, sock,
-			       &fnc->t_read);
-	event_add_write(fnc->fthread->master, fpm_write, fnc, sock,
-			&fnc->t_write);
+		rv = connect(sock, (struct sockaddr *)&fnc->addr, slen);
+		if (rv == -1 && errno != EINPROGRESS) {
+			atomic_fetch_add_explicit(
+				&fnc->counters.connection_errors, 1,
+				memory_order_relaxed);
+			close(sock);
+			zlog_warn("%s: fpm connection failed: %s", __func__,
+				  strerror(errno));
+			goto retry;
+		}
+
+		conn->connecting = (rv == -1);
+		conn->socket = sock;
+	}
 
 	/*
-	 * Starting with LSPs walk all FPM objects, marking them
-	 * as unsent and then replaying them.
+	 * Connected ones start reading now; the others do once their first
+	 * write event tells us how connecting went.
 	 *
-	 * If we are not connected, then delay the objects reset/send.
+	 * When the last one is up we walk all FPM objects, starting with
+	 * LSPs, marking them as unsent and then replaying them.
 	 */
-	if (!fnc->connecting)
-		event_add_timer(zrouter.master, fpm_lsp_reset, fnc, 0,
-				&fnc->t_lspreset);
+	for (i = 0; i < fnc->conn_count; i++) {
+		conn = &fnc->conns[i];
+
+		if (!conn->connecting)
+			fpm_conn_up(conn);
+		event_add_write(fnc->fthread->master, fpm_write, conn,
+				conn->socket, &conn->t_write);
+	}
+	return;
+
+retry:
+	/* All or nothing: drop what we did open and try again later. */
+	while (i-- > 0) {
+		close(fnc->conns[i].socket);
+		fnc->conns[i].socket = -1;
+		fnc->conns[i].connecting = false;
+	}
+	event_add_timer(fnc->fthread->master, fpm_connect, fnc, 3,
+			&fnc->t_connect);
 }
 
-#define DPLANE_FPM_NL_BUF_SIZE 65536
 /**
- * Encode data plane operation context into netlink and enqueue it in the FPM
- * output buffer.
+ * Encode data plane operation context into netlink.
  *
  * @param fnc the netlink FPM context.
  * @param ctx the data plane operation context data.
- * @return 0 on success or -1 on not enough space.
+ * @param op the operation to encode.
+ * @param nl_buf where to put the netlink message(s).
+ * @param nl_buf_size space available at nl_buf.
+ * @return encoded length, 0 if there is nothing to send.
  */
-static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
+static size_t fpm_nl_encode(struct fpm_nl_ctx *fnc,
+			    struct zebra_dplane_ctx *ctx, enum dplane_op_e op,
+			    uint8_t *nl_buf, size_t nl_buf_size)
 {
-	uint8_t nl_buf[DPLANE_FPM_NL_BUF_SIZE];
-	size_t nl_buf_len;
+	size_t nl_buf_len = 0;
 	ssize_t rv;
-	uint64_t obytes, obytes_peak;
-	enum dplane_op_e op = dplane_ctx_get_op(ctx);
-
-	/*
-	 * If we were configured to not use next hop groups, then quit as soon
-	 * as possible.
-	 */
-	if ((!fnc->use_nhg)
-	    && (op == DPLANE_OP_NH_DELETE || op == DPLANE_OP_NH_INSTALL
-		|| op == DPLANE_OP_NH_UPDATE))
-		return 0;
-
-	nl_buf_len = 0;
-
-	/*
-	 * If route replace is enabled then directly encode the install which
-	 * is going to use `NLM_F_REPLACE` (instead of delete/add operations).
-	 */
-	if (fnc->use_route_replace && op == DPLANE_OP_ROUTE_UPDATE)
-		op = DPLANE_OP_ROUTE_INSTALL;
 
 	switch (op) {
 	case DPLANE_OP_ROUTE_UPDATE:
 	case DPLANE_OP_ROUTE_DELETE:
 		rv = netlink_route_multipath_msg_encode(RTM_DELROUTE, ctx,
-							nl_buf, sizeof(nl_buf),
+							nl_buf, nl_buf_size,
 							true, fnc->use_nhg,
 							false);
 		if (rv <= 0) {
@@ -999,7 +1277,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_ROUTE_INSTALL:
 		rv = netlink_route_multipath_msg_encode(RTM_NEWROUTE, ctx,
 							&nl_buf[nl_buf_len],
-							sizeof(nl_buf) -
+							nl_buf_size -
 								nl_buf_len,
 							true, fnc->use_nhg,
 							fnc->use_route_replace);
@@ -1015,7 +1293,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 
 	case DPLANE_OP_MAC_INSTALL:
 	case DPLANE_OP_MAC_DELETE:
-		rv = netlink_macfdb_update_ctx(ctx, nl_buf, sizeof(nl_buf));
+		rv = netlink_macfdb_update_ctx(ctx, nl_buf, nl_buf_size);
 		if (rv <= 0) {
 			flog_err(EC_ZEBRA_FPM_ENCODE_FAIL, "%s: netlink_macfdb_update_ctx failed",
 				 __func__);
@@ -1028,7 +1306,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 
 	case DPLANE_OP_NH_DELETE:
 		rv = netlink_nexthop_msg_encode(RTM_DELNEXTHOP, ctx, nl_buf,
-						sizeof(nl_buf), true);
+						nl_buf_size, true);
 		if (rv <= 0) {
 			flog_err(EC_ZEBRA_FPM_ENCODE_FAIL, "%s: netlink_nexthop_msg_encode failed",
 				 __func__);
@@ -1042,7 +1320,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_NH_INSTALL:
 	case DPLANE_OP_NH_UPDATE:
 		rv = netlink_nexthop_msg_encode(RTM_NEWNEXTHOP, ctx, nl_buf,
-						sizeof(nl_buf), true);
+						nl_buf_size, true);
 		if (rv <= 0) {
 			flog_err(EC_ZEBRA_FPM_ENCODE_FAIL, "%s: netlink_nexthop_msg_encode failed",
 				 __func__);
@@ -1056,7 +1334,7 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_LSP_INSTALL:
 	case DPLANE_OP_LSP_UPDATE:
 	case DPLANE_OP_LSP_DELETE:
-		rv = netlink_lsp_msg_encoder(ctx, nl_buf, sizeof(nl_buf));
+		rv = netlink_lsp_msg_encoder(ctx, nl_buf, nl_buf_size);
 		if (rv <= 0) {
 			flog_err(EC_ZEBRA_FPM_ENCODE_FAIL, "%s: netlink_lsp_msg_encoder failed",
 				 __func__);
@@ -1118,44 +1396,88 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 
 	}
 
-	/* Skip empty enqueues. */
-	if (nl_buf_len == 0)
-		return 0;
+	return nl_buf_len;
+}
 
-	/* We must know if someday a message goes beyond 65KiB. */
-	assert((nl_buf_len + FPM_HEADER_SIZE) <= UINT16_MAX);
+/*
+ * Pick the connection a context goes to, or NULL if it goes to all of
+ * them. Routes are spread by VRF and prefix, so updates to one route stay
+ * in order. Next hop groups go everywhere, so that every connection has
+ * seen a group before any route on it refers to it; deletes of groups wait
+ * until all connections have written out what they hold, see
+ * fpm_nl_nhg_delete_waits().
+ */
+static struct fpm_nl_conn *fpm_nl_conn_select(struct fpm_nl_ctx *fnc,
+					      struct zebra_dplane_ctx *ctx,
+					      enum dplane_op_e op)
+{
+	uint32_t key;
 
-	frr_mutex_lock_autounlock(&fnc->obuf_mutex);
+	if (fnc->conn_count <= 1)
+		return &fnc->conns[0];
 
-	/* Check if we have enough buffer space. */
-	if (STREAM_WRITEABLE(fnc->obuf) < (nl_buf_len + FPM_HEADER_SIZE)) {
-		atomic_fetch_add_explicit(&fnc->counters.buffer_full, 1,
-					  memory_order_relaxed);
+	switch (op) {
+	case DPLANE_OP_ROUTE_INSTALL:
+	case DPLANE_OP_ROUTE_UPDATE:
+	case DPLANE_OP_ROUTE_DELETE:
+		key = jhash_2words(prefix_hash_key(dplane_ctx_get_dest(ctx)),
+				   dplane_ctx_get_vrf(ctx), 0xfb3d0c41);
+		break;
+	case DPLANE_OP_LSP_INSTALL:
+	case DPLANE_OP_LSP_UPDATE:
+	case DPLANE_OP_LSP_DELETE:
+		key = jhash_1word(dplane_ctx_get_in_label(ctx), 0xfb3d0c41);
+		break;
+	case DPLANE_OP_MAC_INSTALL:
+	case DPLANE_OP_MAC_DELETE:
+		key = jhash(dplane_ctx_mac_get_addr(ctx), ETH_ALEN, 0xfb3d0c41);
+		break;
+	default:
+		return NULL;
+	}
 
-		if (IS_ZEBRA_DEBUG_FPM)
-			zlog_debug(
-				"%s: buffer full: wants to write %zu but has %zu",
-				__func__, nl_buf_len + FPM_HEADER_SIZE,
-				STREAM_WRITEABLE(fnc->obuf));
+	return &fnc->conns[key % fnc->conn_count];
+}
 
-		return -1;
+/*
+ * Make room for one more message on a connection (obuf_mutex held).
+ *
+ * @return the chunk to write into, or NULL if the connection has reached
+ *	   its high watermark and force is not set.
+ */
+static struct stream *fpm_nl_obuf_reserve(struct fpm_nl_conn *conn,
+					  bool force)
+{
+	struct stream *s = conn->obuf.tail;
+
+	if (!force && conn->obuf_bytes >= FPM_NL_OBUF_HIGH) {
+		if (!conn->blocked) {
+			conn->blocked = true;
+			atomic_fetch_add_explicit(&conn->blocks, 1,
+						  memory_order_relaxed);
+		}
+		return NULL;
 	}
 
-	/*
-	 * Fill in the FPM header information.
-	 *
-	 * See FPM_HEADER_SIZE definition for more information.
-	 */
-	stream_putc(fnc->obuf, 1);
-	stream_putc(fnc->obuf, 1);
-	stream_putw(fnc->obuf, nl_buf_len + FPM_HEADER_SIZE);
+	if (!s ||
+	    STREAM_WRITEABLE(s) < FPM_HEADER_SIZE + DPLANE_FPM_NL_BUF_SIZE) {
+		s = stream_new(FPM_NL_OBUF_CHUNK_SIZE);
+		stream_fifo_push(&conn->obuf, s);
+	}
+
+	return s;
+}
+
+/* Account a message just added to a connection (obuf_mutex held). */
+static void fpm_nl_obuf_commit(struct fpm_nl_conn *conn, size_t len)
+{
+	struct fpm_nl_ctx *fnc = conn->fnc;
+	uint64_t obytes, obytes_peak;
 
-	/* Write current data. */
-	stream_write(fnc->obuf, nl_buf, (size_t)nl_buf_len);
+	conn->obuf_bytes += len;
 
 	/* Account number of bytes waiting to be written. */
-	atomic_fetch_add_explicit(&fnc->counters.obuf_bytes,
-				  nl_buf_len + FPM_HEADER_SIZE,
+	atomic_fetch_add_explicit(&fnc->counters.obuf_bytes, len,
 				  memory_order_relaxed);
 	obytes = atomic_load_explicit(&fnc->counters.obuf_bytes,
 				      memory_order_relaxed);
@@ -1166,8 +1488,151 @@ static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
 				      memory_order_relaxed);
 
 	/* Tell the thread to start writing. */
-	event_add_write(fnc->fthread->master, fpm_write, fnc, fnc->socket,
-			&fnc->t_write);
+	event_add_write(fnc->fthread->master, fpm_write, conn, conn->socket,
+			&conn->t_write);
+}
+
+/*
+ * Fill in the FPM header information.
+ *
+ * See FPM_HEADER_SIZE definition for more information.
+ */
+static void fpm_nl_put_header(struct stream *s, size_t nl_buf_len)
+{
+	/* We must know if someday a message goes beyond 65KiB. */
+	assert((nl_buf_len + FPM_HEADER_SIZE) <= UINT16_MAX);
+
+	stream_putc(s, 1);
+	stream_putc(s, 1);
+	stream_putw(s, nl_buf_len + FPM_HEADER_SIZE);
+}
+
+/*
+ * Encode a context for every connection. This is the one case where we
+ * encode into a separate buffer, since it is copied several times anyway.
+ */
+static int fpm_nl_enqueue_all(struct fpm_nl_ctx *fnc,
+			      struct zebra_dplane_ctx *ctx,
+			      enum dplane_op_e op)
+{
+	uint8_t nl_buf[DPLANE_FPM_NL_BUF_SIZE];
+	size_t nl_buf_len;
+	struct fpm_nl_conn *conn;
+	struct stream *s;
+	unsigned int i;
+
+	nl_buf_len = fpm_nl_encode(fnc, ctx, op, nl_buf, sizeof(nl_buf));
+
+	/* Skip empty enqueues. */
+	if (nl_buf_len == 0)
+		return 0;
+
+	/* Don't send it anywhere unless it can go everywhere. */
+	for (i = 0; i < fnc->conn_count; i++) {
+		conn = &fnc->conns[i];
+
+		frr_with_mutex (&conn->obuf_mutex) {
+			s = fpm_nl_obuf_reserve(conn, false);
+		}
+		if (!s)
+			goto full;
+	}
+
+	for (i = 0; i < fnc->conn_count; i++) {
+		conn = &fnc->conns[i];
+
+		frr_with_mutex (&conn->obuf_mutex) {
+			s = fpm_nl_obuf_reserve(conn, true);
+			fpm_nl_put_header(s, nl_buf_len);
+			stream_put(s, nl_buf, nl_buf_len);
+			fpm_nl_obuf_commit(conn, nl_buf_len + FPM_HEADER_SIZE);
+		}
+	}
+
+	return 0;
+
+full:
+	atomic_fetch_add_explicit(&fnc->counters.buffer_full, 1,
+				  memory_order_relaxed);
+
+	if (IS_ZEBRA_DEBUG_FPM)
+		zlog_debug("%s: buffer full on connection %u", __func__, i);
+
+	return -1;
+}
+
+/**
+ * Encode data plane operation context into netlink and enqueue it in the FPM
+ * output buffer of the connection(s) it belongs to.
+ *
+ * @param fnc the netlink FPM context.
+ * @param ctx the data plane operation context data.
+ * @return 0 on success or -1 on not enough space.
+ */
+static int fpm_nl_enqueue(struct fpm_nl_ctx *fnc, struct zebra_dplane_ctx *ctx)
+{
+	struct fpm_nl_conn *conn;
+	struct stream *s;
+	size_t start, nl_buf_len;
+	enum dplane_op_e op = dplane_ctx_get_op(ctx);
+
+	/*
+	 * If we were configured to not use next hop groups, then quit as soon
+	 * as possible.
+	 */
+	if ((!fnc->use_nhg)
+	    && (op == DPLANE_OP_NH_DELETE || op == DPLANE_OP_NH_INSTALL
+		|| op == DPLANE_OP_NH_UPDATE))
+		return 0;
+
+	/*
+	 * If route replace is enabled then directly encode the install which
+	 * is going to use `NLM_F_REPLACE` (instead of delete/add operations).
+	 */
+	if (fnc->use_route_replace && op == DPLANE_OP_ROUTE_UPDATE)
+		op = DPLANE_OP_ROUTE_INSTALL;
+
+	conn = fpm_nl_conn_select(fnc, ctx, op);
+	if (!conn)
+		return fpm_nl_enqueue_all(fnc, ctx, op);
+
+	frr_mutex_lock_autounlock(&conn->obuf_mutex);
+
+	/* Check if we have enough buffer space. */
+	s = fpm_nl_obuf_reserve(conn, false);
+	if (!s) {
+		atomic_fetch_add_explicit(&fnc->counters.buffer_full, 1,
+					  memory_order_relaxed);
+
+		if (IS_ZEBRA_DEBUG_FPM)
+			zlog_debug("%s: buffer full: %zu bytes queued on connection %td",
+				   __func__, conn->obuf_bytes,
+				   conn - fnc->conns);
+
+		return -1;
+	}
+
+	/*
+	 * Encode right behind a header placeholder in the output chunk, so
+	 * the message is never copied before it hits the socket.
+	 */
+	start = stream_get_endp(s);
+	fpm_nl_put_header(s, 0);
+	nl_buf_len = fpm_nl_encode(fnc, ctx, op,
+				   STREAM_DATA(s) + stream_get_endp(s),
+				   DPLANE_FPM_NL_BUF_SIZE);
+
+	/* Skip empty enqueues. */
+	if (nl_buf_len == 0) {
+		stream_set_endp(s, start);
+		return 0;
+	}
+
+	assert((nl_buf_len + FPM_HEADER_SIZE) <= UINT16_MAX);
+	stream_forward_endp(s, nl_buf_len);
+	stream_putw_at(s, start + 2, nl_buf_len + FPM_HEADER_SIZE);
+
+	fpm_nl_obuf_commit(conn, nl_buf_len + FPM_HEADER_SIZE);
 
 	return 0;
 }
@@ -1528,15 +1993,17 @@ static void fpm_process_queue(struct event *t)
 	uint64_t processed_contexts = 0;
 
 	while (true) {
-		size_t writeable_amount;
-
-		frr_with_mutex (&fnc->obuf_mutex) {
-			writeable_amount = STREAM_WRITEABLE(fnc->obuf);
+		/*
+		 * A connection is over its high watermark: wait for its writer
+		 * to tell us it drained, rather than polling.
+		 */
+		if (fpm_nl_blocked(fnc)) {
+			no_bufs = true;
+			break;
 		}
 
-		/* No space available yet. */
-		if (writeable_amount < DPLANE_FPM_NL_BUF_SIZE) {
-			no_bufs = true;
+		if (fpm_nl_nhg_delete_waits(fnc)) {
+			fnc->barrier = true;
 			break;
 		}
 
@@ -1550,10 +2017,10 @@ static void fpm_process_queue(struct event *t)
 		/*
 		 * Intentionally ignoring the return value
 		 * as that we are ensuring that we can write to
-		 * the output data in the STREAM_WRITEABLE
+		 * the output data in the fpm_nl_blocked()
 		 * check above, so we can ignore the return
 		 */
-		if (fnc->socket != -1)
+		if (fpm_nl_connected(fnc))
 			(void)fpm_nl_enqueue(fnc, ctx);
 
 		/* Account the processed entries. */
@@ -1566,17 +2033,19 @@ static void fpm_process_queue(struct event *t)
 	atomic_fetch_add_explicit(&fnc->counters.dplane_contexts,
 				  processed_contexts, memory_order_relaxed);
 
-	/* Re-schedule if we ran out of buffer space */
-	if (no_bufs) {
-		if (processed_contexts)
-			event_add_event(fnc->fthread->master, fpm_process_queue, fnc, 0,
-					&fnc->t_dequeue);
-		else
-			event_add_timer_msec(fnc->fthread->master, fpm_process_queue, fnc, 10,
-					     &fnc->t_dequeue);
+	/*
+	 * Wait for fpm_write() to resume us if we ran out of buffer space,
+	 * or are holding a group delete back.
+	 */
+	if (no_bufs && !fnc->paused) {
+		fnc->paused = true;
+		atomic_fetch_add_explicit(&fnc->counters.flow_pauses, 1,
+					  memory_order_relaxed);
+	}
+	if (no_bufs || fnc->barrier)
 		event_add_timer(fnc->fthread->master, fpm_process_wedged, fnc,
 				DPLANE_FPM_NL_WEDGIE_TIME, &fnc->t_wedged);
-	} else
+	else
 		event_cancel(&fnc->t_wedged);
 
 	/*
@@ -1631,6 +2100,13 @@ static void fpm_process_event(struct event *t)
 		fpm_reconnect(fnc);
 		break;
 
+	case FNE_SET_CONNECTIONS:
+		zlog_info("%s: FPM connections set to %u", __func__,
+			  fnc->conn_count_cfg);
+		/* The new count is picked up while everything is closed. */
+		fpm_reconnect(fnc);
+		break;
+
 	case FNE_NHG_FINISHED:
 		if (IS_ZEBRA_DEBUG_FPM)
 			zlog_debug("%s: next hop groups walk finished",
@@ -1661,10 +2137,17 @@ static int fpm_nl_start(struct zebra_dplane_provider *prov)
 	fnc = dplane_provider_get_data(prov);
 	fnc->fthread = frr_pthread_new(NULL, prov_name, prov_name);
 	assert(frr_pthread_run(fnc->fthread, NULL) == 0);
-	fnc->ibuf = stream_new(DPLANE_FPM_NL_BUF_SIZE);
-	fnc->obuf = stream_new(DPLANE_FPM_NL_BUF_SIZE * 128);
-	pthread_mutex_init(&fnc->obuf_mutex, NULL);
-	fnc->socket = -1;
+	for (unsigned int i = 0; i < FPM_NL_CONNS_MAX; i++) {
+		struct fpm_nl_conn *conn = &fnc->conns[i];
+
+		conn->fnc = fnc;
+		conn->socket = -1;
+		conn->ibuf = stream_new(DPLANE_FPM_NL_BUF_SIZE);
+		stream_fifo_init(&conn->obuf);
+		pthread_mutex_init(&conn->obuf_mutex, NULL);
+	}
+	fnc->conn_count = 1;
+	fnc->conn_count_cfg = 1;
 	fnc->disabled = true;
 	fnc->prov = prov;
 	dplane_ctx_q_init(&fnc->ctxqueue);
@@ -1700,13 +2183,18 @@ static int fpm_nl_finish_early(struct fpm_nl_ctx *fnc)
 	event_cancel(&fnc->t_rmacwalk);
 	event_cancel(&fnc->t_event);
 	event_cancel(&fnc->t_nhg);
-	event_cancel_async(fnc->fthread->master, &fnc->t_read, NULL);
-	event_cancel_async(fnc->fthread->master, &fnc->t_write, NULL);
 	event_cancel_async(fnc->fthread->master, &fnc->t_connect, NULL);
 
-	if (fnc->socket != -1) {
-		close(fnc->socket);
-		fnc->socket = -1;
+	for (unsigned int i = 0; i < FPM_NL_CONNS_MAX; i++) {
+		struct fpm_nl_conn *conn = &fnc->conns[i];
+
+		event_cancel_async(fnc->fthread->master, &conn->t_read, NULL);
+		event_cancel_async(fnc->fthread->master, &conn->t_write, NULL);
+
+		if (conn->socket != -1) {
+			close(conn->socket);
+			conn->socket = -1;
+		}
 	}
 
 	/* Reset the barrier value */
@@ -1724,10 +2212,14 @@ static int fpm_nl_finish_late(struct fpm_nl_ctx *fnc)
 	frr_pthread_stop(fnc->fthread, NULL);
 
 	/* Free all allocated resources. */
-	pthread_mutex_destroy(&fnc->obuf_mutex);
+	for (unsigned int i = 0; i < FPM_NL_CONNS_MAX; i++) {
+		struct fpm_nl_conn *conn = &fnc->conns[i];
+
+		pthread_mutex_destroy(&conn->obuf_mutex);
+		stream_free(conn->ibuf);
+		stream_fifo_deinit(&conn->obuf);
+	}
 	pthread_mutex_destroy(&fnc->ctxqueue_mutex);
-	stream_free(fnc->ibuf);
-	stream_free(fnc->obuf);
 	free(gfnc);
 	gfnc = NULL;
 
@@ -1782,7 +2274,7 @@ static int fpm_nl_process(struct zebra_dplane_provider *prov)
 		 * Skip all notifications if not connected, we'll walk the RIB
 		 * anyway.
 		 */
-		if (fnc->socket != -1 && fnc->connecting == false) {
+		if (fpm_nl_connected(fnc)) {
 			enum dplane_op_e op = dplane_ctx_get_op(ctx);
 
 			/*
@@ -1858,6 +2350,7 @@ static int fpm_nl_new(struct event_loop *tm)
 	install_element(CONFIG_NODE, &no_fpm_use_nhg_cmd);
 	install_element(CONFIG_NODE, &fpm_use_route_replace_cmd);
 	install_element(CONFIG_NODE, &no_fpm_use_route_replace_cmd);
+	install_element(CONFIG_NODE, &fpm_connections_cmd);
 
 	return 0;
 }
@@ -30,6 +30,7 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <poll.h>
 #include <assert.h>
 #include <err.h>
 #include <sys/types.h>
@@ -110,9 +111,14 @@ static uint32_t fpm_nhg_hash(const struct fpm_nhg *a)
 /* Hash table for storing nexthop groups */
 DECLARE_HASH(fpm_nhg, struct fpm_nhg, hash_item, fpm_nhg_cmp, fpm_nhg_hash);
 
+/* zebra opens at most 8 connections, leave room for a reconnect */
+#define MAX_CLIENTS 16
+
 struct glob {
 	int server_sock;
 	int sock;
+	int clients[MAX_CLIENTS];
+	int num_clients;
 	bool reflect;
 	bool reflect_fail_all;
 	bool dump_hex;
@@ -120,6 +126,12 @@ struct glob {
 	const char *dump_file;
 	struct fpm_route_head route_tree;
 	struct fpm_nhg_head nhg_hash;
+
+	/* Throughput accounting, from the first message received */
+	uint64_t msgs;
+	uint64_t bytes;
+	struct timespec first_msg;
+	struct timespec last_msg;
 };
 
 struct glob glob_space;
@@ -213,22 +225,18 @@ static int accept_conn(int listen_sock)
 	int sock;
 	struct sockaddr_in client_addr = { 0 };
 	unsigned int client_len;
+	char buf[120];
 
-	while (1) {
-		char buf[120];
-
-		fprintf(glob->output_file, "Waiting for client connection...\n");
-		client_len = sizeof(client_addr);
-		sock = accept(listen_sock, (struct sockaddr *)&client_addr,
-			      &client_len);
+	client_len = sizeof(client_addr);
+	sock = accept(listen_sock, (struct sockaddr *)&client_addr, &client_len);
 
-		if (sock >= 0) {
-			fprintf(glob->output_file, "[%s] Accepted client %s\n", get_timestamp(),
-				inet_ntop(AF_INET, &client_addr.sin_addr, buf, sizeof(buf)));
-			return sock;
-		}
-		fprintf(stderr, "Failed to accept socket: %s\n", strerror(errno));
+	if (sock >= 0) {
+		fprintf(glob->output_file, "[%s] Accepted client %s\n", get_timestamp(),
+			inet_ntop(AF_INET, &client_addr.sin_addr, buf, sizeof(buf)));
+		return sock;
 	}
+	fprintf(stderr, "Failed to accept socket: %s\n", strerror(errno));
+	return -1;
 }
 
 /*
@@ -1089,6 +1097,12 @@ static void parse_netlink_msg(char *buf, size_t buf_len, fpm_msg_hdr_t *fpm)
  */
 static void process_fpm_msg(fpm_msg_hdr_t *hdr)
 {
+	if (glob->msgs == 0)
+		clock_gettime(CLOCK_MONOTONIC, &glob->first_msg);
+	clock_gettime(CLOCK_MONOTONIC, &glob->last_msg);
+	glob->msgs++;
+	glob->bytes += fpm_msg_len(hdr);
+
 	fprintf(glob->output_file, "[%s] FPM message - Type: %d, Length %d\n", get_timestamp(),
 		hdr->msg_type, ntohs(hdr->msg_len));
 
@@ -1102,21 +1116,62 @@ static void process_fpm_msg(fpm_msg_hdr_t *hdr)
 
 /*
  * fpm_serve
+ *
+ * Serve any number of client connections (zebra may open several), one
+ * whole message at a time from whichever is readable.
  */
 static void fpm_serve(void)
 {
 	char buf[FPM_MAX_MSG_LEN * 4];
+	struct pollfd pfds[MAX_CLIENTS + 1];
 	fpm_msg_hdr_t *hdr;
+	int i, sock;
 
 	while (1) {
+		if (glob->num_clients == 0)
+			fprintf(glob->output_file, "Waiting for client connection...\n");
+
+		pfds[0].fd = glob->server_sock;
+		pfds[0].events = POLLIN;
+		for (i = 0; i < glob->num_clients; i++) {
+			pfds[i + 1].fd = glob->clients[i];
+			pfds[i + 1].events = POLLIN;
+		}
+
+		if (poll(pfds, glob->num_clients + 1, -1) < 0) {
+			if (errno != EINTR)
+				fprintf(stderr, "poll failed: %s\n", strerror(errno));
+			continue;
+		}
+
+		/* Walk backwards so removing a client doesn't skip another */
+		for (i = glob->num_clients - 1; i >= 0; i--) {
+			if (!(pfds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)))
+				continue;
+
+			glob->sock = glob->clients[i];
+			hdr = read_fpm_msg(buf, sizeof(buf));
+			if (hdr) {
+				process_fpm_msg(hdr);
+				continue;
+			}
 
-		hdr = read_fpm_msg(buf, sizeof(buf));
-		if (!hdr) {
 			close(glob->sock);
-			return;
+			fprintf(glob->output_file, "Done serving client\n");
+			glob->clients[i] = glob->clients[--glob->num_clients];
 		}
 
-		process_fpm_msg(hdr);
+		if (pfds[0].revents & POLLIN) {
+			sock = accept_conn(glob->server_sock);
+			if (sock < 0)
+				continue;
+			if (glob->num_clients == MAX_CLIENTS) {
+				fprintf(stderr, "Too many clients, dropping new one\n");
+				close(sock);
+				continue;
+			}
+			glob->clients[glob->num_clients++] = sock;
+		}
 	}
 }
 
@@ -1128,6 +1183,7 @@ static void sigusr1_handler(int signum)
 	char buf[PREFIX_STRLEN];
 	FILE *out = glob->output_file;
 	FILE *dump_fp = NULL;
+	double elapsed;
 
 	if (glob->dump_file) {
 		dump_fp = fopen(glob->dump_file, "w");
@@ -1184,6 +1240,16 @@ static void sigusr1_handler(int signum)
 	}
 	fprintf(out, "=====================\n\n");
 
+	elapsed = (glob->last_msg.tv_sec - glob->first_msg.tv_sec) +
+		  (glob->last_msg.tv_nsec - glob->first_msg.tv_nsec) / 1e9;
+	fprintf(out, "\n=== Throughput ===\n");
+	fprintf(out, "Clients: %d\n", glob->num_clients);
+	fprintf(out, "Messages: %" PRIu64 ", Bytes: %" PRIu64 ", Seconds: %.3f\n", glob->msgs,
+		glob->bytes, elapsed);
+	if (elapsed > 0)
+		fprintf(out, "Messages/sec: %.0f, Bytes/sec: %.0f\n", glob->msgs / elapsed,
+			glob->bytes / elapsed);
+	fprintf(out, "=====================\n\n");
 
 	fflush(out);
 
@@ -1280,11 +1346,7 @@ int main(int argc, char **argv)
 	/*
 	 * Server forever.
 	 */
-	while (1) {
-		glob->sock = accept_conn(glob->server_sock);
-		fpm_serve();
-		fprintf(glob->output_file, "Done serving client\n");
-	}
+	fpm_serve();
 }
 #else
 
@@ -26,6 +26,8 @@
 #include "mpls.h"
 #include "lib_errors.h"
 #include "hash.h"
+#include "frr_pthread.h"
+#include "typesafe.h"
 #include "lib/netlink_parser.h"
 
 #include "zebra/zebra_router.h"
@@ -162,6 +164,8 @@ extern struct event_loop *master;
 extern struct zebra_privs_t zserv_privs;
 
 DEFINE_MTYPE_STATIC(ZEBRA, NL_BUF, "Zebra Netlink buffers");
+DEFINE_MTYPE_STATIC(ZEBRA, NL_SHARDS, "Zebra Netlink dplane shard sockets");
+DEFINE_MTYPE_STATIC(ZEBRA, NL_DUMP, "Zebra Netlink parallel dump");
 
 /* Hashtable and mutex to allow lookup of nlsock structs by socket/fd value.
  * We have both the main and dplane pthreads using these structs, so we have
@@ -174,8 +178,17 @@ pthread_mutex_t nlsock_mutex;
 #define NLSOCK_LOCK() pthread_mutex_lock(&nlsock_mutex)
 #define NLSOCK_UNLOCK() pthread_mutex_unlock(&nlsock_mutex)
 
-size_t nl_batch_tx_bufsize;
-char *nl_batch_tx_buf;
+/*
+ * Batch transmit buffer. Kernel updates may be sent from several dplane
+ * pthreads at once, so each one gets its own buffer, released when the
+ * pthread exits.
+ */
+struct nl_batch_txbuf {
+	size_t size;
+	char *buf;
+};
+
+static pthread_key_t nl_batch_txbuf_key;
 
 _Atomic uint32_t nl_batch_bufsize = NL_DEFAULT_BATCH_BUFSIZE;
 _Atomic uint32_t nl_batch_send_threshold = NL_DEFAULT_BATCH_SEND_THRESHOLD;
@@ -534,7 +547,13 @@ int kernel_dplane_read(struct zebra_dplane_info *info)
  * so that we only have to write one way to handle incoming
  * address add/delete and xxxNETCONF changes.
  */
-static void netlink_install_filter(int sock, uint32_t pid, uint32_t dplane_pid)
+/* Our own sockets whose messages the listening sockets filter out: the
+ * command socket, the dplane socket and the dplane shard sockets.
+ */
+#define NL_FILTER_PIDS_MAX (2 + DPLANE_SHARDS_MAX)
+
+static void netlink_install_filter(int sock, const uint32_t *pids,
+				   unsigned int npids)
 {
 	/*
 	 * BPF_JUMP instructions and where you jump to are based upon
@@ -542,70 +561,66 @@ static void netlink_install_filter(int sock, uint32_t pid, uint32_t dplane_pid)
 	 * this down because every time I look at this I have to
 	 * re-remember it.
 	 */
-	struct sock_filter filter[] = {
-		/*
-		 * Logic:
-		 *   if (nlmsg_pid == pid ||
-		 *       nlmsg_pid == dplane_pid) {
-		 *       if (the incoming nlmsg_type ==
-		 *           RTM_NEWADDR || RTM_DELADDR || RTM_NEWNETCONF ||
-		 *           RTM_DELNETCONF)
-		 *           keep this message
-		 *       else
-		 *           skip this message
-		 *   } else
-		 *       keep this netlink message
-		 */
-		/*
-		 * 0: Load the nlmsg_pid into the BPF register
-		 */
-		BPF_STMT(BPF_LD | BPF_ABS | BPF_W,
-			 offsetof(struct nlmsghdr, nlmsg_pid)),
-		/*
-		 * 1: Compare to pid
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(pid), 1, 0),
-		/*
-		 * 2: Compare to dplane pid
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(dplane_pid), 0, 6),
-		/*
-		 * 3: Load the nlmsg_type into BPF register
-		 */
-		BPF_STMT(BPF_LD | BPF_ABS | BPF_H,
-			 offsetof(struct nlmsghdr, nlmsg_type)),
-		/*
-		 * 4: Compare to RTM_NEWADDR
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWADDR), 4, 0),
-		/*
-		 * 5: Compare to RTM_DELADDR
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELADDR), 3, 0),
-		/*
-		 * 6: Compare to RTM_NEWNETCONF
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_NEWNETCONF), 2,
-			 0),
-		/*
-		 * 7: Compare to RTM_DELNETCONF
-		 */
-		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htons(RTM_DELNETCONF), 1,
-			 0),
-		/*
-		 * 8: This is the end state of we want to skip the
-		 *    message
-		 */
-		BPF_STMT(BPF_RET | BPF_K, 0),
-		/* 9: This is the end state of we want to keep
-		 *     the message
-		 */
-		BPF_STMT(BPF_RET | BPF_K, 0xffff),
-	};
+	struct sock_filter filter[NL_FILTER_PIDS_MAX + 8];
+	struct sock_fprog prog = {};
+	unsigned int i, n = 0;
 
-	struct sock_fprog prog = {
-		.len = array_size(filter), .filter = filter,
-	};
+	/*
+	 * Logic:
+	 *   if (nlmsg_pid == pids[0] || ... ||
+	 *       nlmsg_pid == pids[npids - 1]) {
+	 *       if (the incoming nlmsg_type ==
+	 *           RTM_NEWADDR || RTM_DELADDR || RTM_NEWNETCONF ||
+	 *           RTM_DELNETCONF)
+	 *           keep this message
+	 *       else
+	 *           skip this message
+	 *   } else
+	 *       keep this netlink message
+	 */
+	assert(npids > 0 && npids <= NL_FILTER_PIDS_MAX);
+
+	/*
+	 * 0: Load the nlmsg_pid into the BPF register
+	 */
+	filter[n++] = (struct sock_filter)BPF_STMT(
+		BPF_LD | BPF_ABS | BPF_W, offsetof(struct nlmsghdr, nlmsg_pid));
+	/*
+	 * 1 .. npids: Compare to each of our pids; a match jumps to the
+	 * type checks, the last mismatch jumps to the keep state.
+	 */
+	for (i = 0; i < npids; i++)
+		filter[n++] = (struct sock_filter)BPF_JUMP(
+			BPF_JMP | BPF_JEQ | BPF_K, htonl(pids[i]),
+			npids - 1 - i, (i == npids - 1) ? 6 : 0);
+	/*
+	 * Load the nlmsg_type into BPF register
+	 */
+	filter[n++] = (struct sock_filter)BPF_STMT(
+		BPF_LD | BPF_ABS | BPF_H, offsetof(struct nlmsghdr, nlmsg_type));
+	/*
+	 * Compare to RTM_NEWADDR, RTM_DELADDR, RTM_NEWNETCONF and
+	 * RTM_DELNETCONF
+	 */
+	filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+						   htons(RTM_NEWADDR), 4, 0);
+	filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+						   htons(RTM_DELADDR), 3, 0);
+	filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+						   htons(RTM_NEWNETCONF), 2, 0);
+	filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+						   htons(RTM_DELNETCONF), 1, 0);
+	/*
+	 * This is the end state of we want to skip the message
+	 */
+	filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+	/*
+	 * This is the end state of we want to keep the message
+	 */
+	filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0xffff);
+
+	prog.len = n;
+	prog.filter = filter;
 
 	if (setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog))
 	    < 0)
@@ -920,9 +935,11 @@ static int netlink_parse_error(const struct nlsock *nl, struct nlmsghdr *h,
  * startup -> Are we reading in under startup conditions? passed to
  *            the filter.
  */
-int netlink_parse_info(int (*filter)(struct nlmsghdr *, ns_id_t, int),
-		       struct nlsock *nl, const struct zebra_dplane_info *zns,
-		       int count, bool startup)
+static int netlink_parse_info_internal(int (*filter)(struct nlmsghdr *,
+						      ns_id_t, int),
+				       struct nlsock *nl,
+				       const struct zebra_dplane_info *zns,
+				       int count, bool startup)
 {
 	int status;
 	int ret = 0;
@@ -1020,6 +1037,23 @@ int netlink_parse_info(int (*filter)(struct nlmsghdr *, ns_id_t, int),
 	return ret;
 }
 
+int netlink_parse_info(int (*filter)(struct nlmsghdr *, ns_id_t, int),
+		       struct nlsock *nl, const struct zebra_dplane_info *zns,
+		       int count, bool startup)
+{
+	int ret;
+
+	/*
+	 * Whatever the messages read here generate for zebra main, e.g. link
+	 * and address events, is handed over in one go.
+	 */
+	dplane_zebra_batch_begin();
+	ret = netlink_parse_info_internal(filter, nl, zns, count, startup);
+	dplane_zebra_batch_end();
+
+	return ret;
+}
+
 /*
  * netlink_talk_info
  *
@@ -1132,6 +1166,309 @@ int netlink_request(struct nlsock *nl, void *req)
 	return 0;
 }
 
+/*
+ * Parallel kernel dumps.
+ *
+ * Each dump request gets its own socket and a reader pthread that only
+ * receives and queues the raw responses, so the kernel side of several
+ * dumps runs concurrently. Parsing stays on the calling (main) pthread,
+ * which consumes whatever the readers have queued in one go while they
+ * keep reading.
+ */
+PREDECL_DLIST(nl_dump_bufs);
+
+struct nl_dump_buf {
+	struct nl_dump_bufs_item item;
+
+	struct nl_dump_reader *reader;
+	uint32_t pid;
+	bool truncated;
+	int len;
+	uint8_t data[];
+};
+
+DECLARE_DLIST(nl_dump_bufs, struct nl_dump_buf, item);
+
+struct nl_dump {
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+
+	/* Received buffers, and the number of readers still running */
+	struct nl_dump_bufs_head bufs;
+	unsigned int running;
+};
+
+struct nl_dump_reader {
+	struct nlsock nl;
+	struct nl_dump *dump;
+	struct frr_pthread *fpt;
+
+	/* Set by the parser once the dump's end has been seen */
+	bool finished;
+};
+
+/* Does this buffer end the dump? */
+static bool nl_dump_buf_is_last(const uint8_t *data, int len)
+{
+	const struct nlmsghdr *h;
+
+	for (h = (const struct nlmsghdr *)data; NLMSG_OK(h, (unsigned int)len);
+	     h = NLMSG_NEXT(h, len)) {
+		if (h->nlmsg_type == NLMSG_DONE ||
+		    h->nlmsg_type == NLMSG_ERROR)
+			return true;
+	}
+
+	return false;
+}
+
+static void *nl_dump_reader_run(void *arg)
+{
+	struct frr_pthread *fpt = arg;
+	struct nl_dump_reader *rdr = fpt->data;
+	struct nl_dump *dump = rdr->dump;
+	struct nl_dump_buf *buf;
+	bool last = false;
+	int status;
+
+	frr_pthread_set_name(fpt);
+
+	while (!last) {
+		struct sockaddr_nl snl;
+		struct msghdr msg = { .msg_name = (void *)&snl,
+				      .msg_namelen = sizeof(snl) };
+
+		status = netlink_recv_msg(&rdr->nl, &msg);
+		if (status <= 0)
+			break;
+
+		buf = XMALLOC(MTYPE_NL_DUMP, sizeof(*buf) + status);
+		buf->reader = rdr;
+		buf->pid = snl.nl_pid;
+		buf->truncated = !!(msg.msg_flags & MSG_TRUNC);
+		buf->len = status;
+		memcpy(buf->data, rdr->nl.buf, status);
+
+		last = nl_dump_buf_is_last(buf->data, status);
+
+		frr_with_mutex (&dump->mtx) {
+			nl_dump_bufs_add_tail(&dump->bufs, buf);
+			pthread_cond_signal(&dump->cond);
+		}
+	}
+
+	frr_with_mutex (&dump->mtx) {
+		dump->running--;
+		pthread_cond_signal(&dump->cond);
+	}
+
+	return NULL;
+}
+
+static int nl_dump_reader_stop(struct frr_pthread *fpt, void **result)
+{
+	pthread_join(fpt->thread, result);
+	return 0;
+}
+
+/* Hand the messages of one received buffer to the filter */
+static int nl_dump_buf_parse(int (*filter)(struct nlmsghdr *, ns_id_t, int),
+			     struct nl_dump_buf *buf, ns_id_t ns_id,
+			     bool startup)
+{
+	struct nl_dump_reader *rdr = buf->reader;
+	struct nlmsghdr *h;
+	int status = buf->len;
+	int ret = 0;
+
+	if (rdr->finished)
+		return 0;
+
+	for (h = (struct nlmsghdr *)buf->data;
+	     NLMSG_OK(h, (unsigned int)status); h = NLMSG_NEXT(h, status)) {
+		if (h->nlmsg_type == NLMSG_DONE) {
+			rdr->finished = true;
+			return ret;
+		}
+
+		if (h->nlmsg_type == NLMSG_ERROR) {
+			int err = netlink_parse_error(&rdr->nl, h, true,
+						      startup);
+
+			if (err == 1 && (h->nlmsg_flags & NLM_F_MULTI))
+				continue;
+
+			rdr->finished = true;
+			return err == 1 ? 0 : err;
+		}
+
+		if (h->nlmsg_flags & NLM_F_DUMP_INTR)
+			flog_err(EC_ZEBRA_NETLINK_BAD_SEQUENCE,
+				 "netlink recvmsg: The Dump request was interrupted");
+
+		if (buf->pid != 0) {
+			zlog_debug("Ignoring message from pid %u", buf->pid);
+			continue;
+		}
+
+		if ((*filter)(h, ns_id, startup) < 0) {
+			zlog_debug("%s filter function error", rdr->nl.name);
+			ret = -1;
+		}
+	}
+
+	if (buf->truncated)
+		flog_err(EC_ZEBRA_NETLINK_LENGTH_ERROR,
+			 "%s error: message truncated", rdr->nl.name);
+	else if (status) {
+		flog_err(EC_ZEBRA_NETLINK_LENGTH_ERROR,
+			 "%s error: data remnant size %d", rdr->nl.name,
+			 status);
+		ret = -1;
+	}
+
+	return ret;
+}
+
+/*
+ * netlink_dump_parallel
+ *
+ * Issue several dump requests at once, each on its own socket, and pass
+ * the results to the filter on the calling pthread. Requests whose socket
+ * or reader can't be set up are run serially on the command socket.
+ *
+ * filter  -> Function to call to read the results
+ * zns     -> The zebra namespace data
+ * reqs    -> The dump requests
+ * nreqs   -> How many requests there are
+ * startup -> Are we reading in under startup conditions? passed to
+ *            the filter.
+ */
+int netlink_dump_parallel(int (*filter)(struct nlmsghdr *, ns_id_t, int),
+			  struct zebra_ns *zns, struct nlmsghdr *reqs[],
+			  unsigned int nreqs, bool startup)
+{
+	struct frr_pthread_attr pattr = {
+		.start = nl_dump_reader_run,
+		.stop = nl_dump_reader_stop,
+	};
+	struct zebra_dplane_info dp_info;
+	struct nl_dump_reader *readers;
+	struct nl_dump_bufs_head batch;
+	struct nl_dump_buf *buf;
+	struct nl_dump dump = {};
+	unsigned int i, running;
+	int ret = 0, err;
+
+	zebra_dplane_info_from_zns(&dp_info, zns, true /*is_cmd*/);
+
+	readers = XCALLOC(MTYPE_NL_DUMP, nreqs * sizeof(*readers));
+	pthread_mutex_init(&dump.mtx, NULL);
+	pthread_cond_init(&dump.cond, NULL);
+	nl_dump_bufs_init(&dump.bufs);
+	nl_dump_bufs_init(&batch);
+
+	for (i = 0; i < nreqs; i++) {
+		struct nl_dump_reader *rdr = &readers[i];
+		char name[32];
+
+		rdr->dump = &dump;
+		rdr->nl.sock = -1;
+		snprintf(rdr->nl.name, sizeof(rdr->nl.name),
+			 "netlink-dump-%u (NS %u)", i, zns->ns_id);
+
+		if (netlink_socket(&rdr->nl, 0, NULL, 0, zns->ns_id,
+				   NETLINK_ROUTE) < 0)
+			continue;
+
+		if (rcvbufsize)
+			netlink_recvbuf(&rdr->nl, rcvbufsize);
+
+		if (netlink_request(&rdr->nl, reqs[i]) < 0)
+			goto serial;
+
+		snprintf(name, sizeof(name), "zebra_nl_dump_%u", i);
+		rdr->fpt = frr_pthread_new(&pattr, rdr->nl.name, name);
+		rdr->fpt->data = rdr;
+
+		frr_with_mutex (&dump.mtx) {
+			dump.running++;
+		}
+
+		if (frr_pthread_run(rdr->fpt, NULL) != 0) {
+			frr_with_mutex (&dump.mtx) {
+				dump.running--;
+			}
+			frr_pthread_destroy(rdr->fpt);
+			rdr->fpt = NULL;
+
+			/* The request is out, read it here */
+			err = netlink_parse_info(filter, &rdr->nl, &dp_info, 0,
+						 startup);
+			if (err < 0)
+				ret = err;
+			rdr->finished = true;
+		}
+		continue;
+
+serial:
+		close(rdr->nl.sock);
+		rdr->nl.sock = -1;
+		XFREE(MTYPE_NL_BUF, rdr->nl.buf);
+	}
+
+	/* Feed the RIB with whatever the readers have queued so far */
+	do {
+		frr_with_mutex (&dump.mtx) {
+			while (nl_dump_bufs_count(&dump.bufs) == 0 &&
+			       dump.running)
+				pthread_cond_wait(&dump.cond, &dump.mtx);
+
+			nl_dump_bufs_swap_all(&batch, &dump.bufs);
+			running = dump.running;
+		}
+
+		while ((buf = nl_dump_bufs_pop(&batch)) != NULL) {
+			err = nl_dump_buf_parse(filter, buf, zns->ns_id,
+						startup);
+			if (err < 0)
+				ret = err;
+			XFREE(MTYPE_NL_DUMP, buf);
+		}
+	} while (running);
+
+	for (i = 0; i < nreqs; i++) {
+		struct nl_dump_reader *rdr = &readers[i];
+
+		if (rdr->fpt) {
+			frr_pthread_stop(rdr->fpt, NULL);
+			frr_pthread_destroy(rdr->fpt);
+		}
+
+		if (rdr->nl.sock >= 0) {
+			close(rdr->nl.sock);
+			XFREE(MTYPE_NL_BUF, rdr->nl.buf);
+			continue;
+		}
+
+		/* No socket of its own, fall back to the command socket */
+		err = netlink_request(&zns->netlink_cmd, reqs[i]);
+		if (err == 0)
+			err = netlink_parse_info(filter, &zns->netlink_cmd,
+						 &dp_info, 0, startup);
+		if (err < 0)
+			ret = err;
+	}
+
+	nl_dump_bufs_fini(&batch);
+	nl_dump_bufs_fini(&dump.bufs);
+	pthread_cond_destroy(&dump.cond);
+	pthread_mutex_destroy(&dump.mtx);
+	XFREE(MTYPE_NL_DUMP, readers);
+
+	return ret;
+}
+
 static int nl_batch_read_resp(struct nl_batch *bth, struct nlsock *nl)
 {
 	struct nlmsghdr *h;
@@ -1165,6 +1502,7 @@ static int nl_batch_read_resp(struct nl_batch *bth, struct nlsock *nl)
 					dplane_ctx_set_status(
 						ctx,
 						ZEBRA_DPLANE_REQUEST_FAILURE);
+				dplane_ctx_lat_mark(ctx, ZEBRA_LAT_KERNEL);
 				dplane_ctx_enqueue_tail(bth->ctx_out_q, ctx);
 			}
 			return status;
@@ -1208,6 +1546,7 @@ static int nl_batch_read_resp(struct nl_batch *bth, struct nlsock *nl)
 			}
 
 			ctx = dplane_ctx_dequeue(&(bth->ctx_list));
+			dplane_ctx_lat_mark(ctx, ZEBRA_LAT_KERNEL);
 			dplane_ctx_enqueue_tail(bth->ctx_out_q, ctx);
 
 			/* We have found corresponding context object. */
@@ -1297,15 +1636,22 @@ static void nl_batch_init(struct nl_batch *bth,
 	 */
 	size_t bufsize =
 		atomic_load_explicit(&nl_batch_bufsize, memory_order_relaxed);
-	if (bufsize != nl_batch_tx_bufsize) {
-		if (nl_batch_tx_buf)
-			XFREE(MTYPE_NL_BUF, nl_batch_tx_buf);
+	struct nl_batch_txbuf *txbuf = pthread_getspecific(nl_batch_txbuf_key);
 
-		nl_batch_tx_buf = XCALLOC(MTYPE_NL_BUF, bufsize);
-		nl_batch_tx_bufsize = bufsize;
+	if (!txbuf) {
+		txbuf = XCALLOC(MTYPE_NL_BUF, sizeof(*txbuf));
+		pthread_setspecific(nl_batch_txbuf_key, txbuf);
 	}
 
-	bth->buf = nl_batch_tx_buf;
+	if (bufsize != txbuf->size) {
+		if (txbuf->buf)
+			XFREE(MTYPE_NL_BUF, txbuf->buf);
+
+		txbuf->buf = XCALLOC(MTYPE_NL_BUF, bufsize);
+		txbuf->size = bufsize;
+	}
+
+	bth->buf = txbuf->buf;
 	bth->bufsiz = bufsize;
 	bth->limit = atomic_load_explicit(&nl_batch_send_threshold,
 					  memory_order_relaxed);
@@ -1509,6 +1855,14 @@ static enum netlink_msg_status nl_put_msg(struct nl_batch *bth,
 	return FRR_NETLINK_ERROR;
 }
 
+static void nl_batch_txbuf_free(void *arg)
+{
+	struct nl_batch_txbuf *txbuf = arg;
+
+	XFREE(MTYPE_NL_BUF, txbuf->buf);
+	XFREE(MTYPE_NL_BUF, txbuf);
+}
+
 void kernel_update_multi(struct dplane_ctx_list_head *ctx_list)
 {
 	struct nl_batch batch;
@@ -1524,8 +1878,9 @@ void kernel_update_multi(struct dplane_ctx_list_head *ctx_list)
 		if (ctx == NULL)
 			break;
 
-		if (batch.zns != NULL
-		    && batch.zns->ns_id != dplane_ctx_get_ns(ctx)->ns_id)
+		if (batch.zns != NULL &&
+		    (batch.zns->ns_id != dplane_ctx_get_ns(ctx)->ns_id ||
+		     batch.zns->sock != dplane_ctx_get_ns(ctx)->sock))
 			nl_batch_send(&batch);
 
 		/*
@@ -1603,6 +1958,8 @@ static bool kernel_netlink_nlsock_hash_equal(const void *arg1, const void *arg2)
 void kernel_init(struct zebra_ns *zns)
 {
 	uint32_t groups, dplane_groups, ext_groups;
+	uint32_t pids[NL_FILTER_PIDS_MAX];
+	unsigned int i, nshards, npids = 0;
 #if defined SOL_NETLINK
 	int one, ret, grp;
 #endif
@@ -1670,6 +2027,29 @@ void kernel_init(struct zebra_ns *zns)
 
 	kernel_netlink_nlsock_insert(&zns->netlink_dplane_out);
 
+	/* Additional outbound sockets for dplane shards, if configured */
+	nshards = dplane_get_shard_count();
+	if (nshards > 1)
+		zns->netlink_dplane_shards =
+			XCALLOC(MTYPE_NL_SHARDS,
+				(nshards - 1) * sizeof(struct nlsock));
+
+	for (i = 0; i < nshards - 1; i++) {
+		struct nlsock *nls = &zns->netlink_dplane_shards[i];
+
+		snprintf(nls->name, sizeof(nls->name),
+			 "netlink-dp-%u (NS %u)", i + 1, zns->ns_id);
+		nls->sock = -1;
+		if (netlink_socket(nls, 0, 0, 0, zns->ns_id, NETLINK_ROUTE) <
+		    0) {
+			flog_err(EC_LIB_SOCKET, "Failure to create %s socket",
+				 nls->name);
+			frr_exit_with_buffer_flush(-1);
+		}
+
+		kernel_netlink_nlsock_insert(nls);
+	}
+
 	/* Inbound socket for OS events coming to the dplane. */
 	snprintf(zns->netlink_dplane_in.name,
 		 sizeof(zns->netlink_dplane_in.name), "netlink-dp-in (NS %u)",
@@ -1734,6 +2114,14 @@ void kernel_init(struct zebra_ns *zns)
 		zlog_notice("Registration for extended dp ACK failed : %d %s",
 			    errno, safe_strerror(errno));
 
+	for (i = 0; i < nshards - 1; i++) {
+		one = 1;
+		setsockopt(zns->netlink_dplane_shards[i].sock, SOL_NETLINK,
+			   NETLINK_EXT_ACK, &one, sizeof(one));
+		setsockopt(zns->netlink_dplane_shards[i].sock, SOL_NETLINK,
+			   NETLINK_CAP_ACK, &one, sizeof(one));
+	}
+
 	if (zns->ge_netlink_cmd.sock >= 0) {
 		one = 1;
 		ret = setsockopt(zns->ge_netlink_cmd.sock, SOL_NETLINK,
@@ -1774,6 +2162,14 @@ void kernel_init(struct zebra_ns *zns)
 		flog_err(EC_LIB_SOCKET, "Can't set %s socket error: %s(%d)",
 			 zns->netlink_dplane_in.name, safe_strerror(errno), errno);
 
+	for (i = 0; i < nshards - 1; i++)
+		if (fcntl(zns->netlink_dplane_shards[i].sock, F_SETFL,
+			  O_NONBLOCK) < 0)
+			flog_err(EC_LIB_SOCKET,
+				 "Can't set %s socket error: %s(%d)",
+				 zns->netlink_dplane_shards[i].name,
+				 safe_strerror(errno), errno);
+
 	if (zns->ge_netlink_cmd.sock >= 0) {
 		if (fcntl(zns->ge_netlink_cmd.sock, F_SETFL, O_NONBLOCK) < 0)
 			flog_err(EC_LIB_SOCKET, "Can't set %s socket error: %s(%d)",
@@ -1786,6 +2182,9 @@ void kernel_init(struct zebra_ns *zns)
 		netlink_recvbuf(&zns->netlink_cmd, rcvbufsize);
 		netlink_recvbuf(&zns->netlink_dplane_out, rcvbufsize);
 		netlink_recvbuf(&zns->netlink_dplane_in, rcvbufsize);
+		for (i = 0; i < nshards - 1; i++)
+			netlink_recvbuf(&zns->netlink_dplane_shards[i],
+					rcvbufsize);
 
 		if (zns->ge_netlink_cmd.sock >= 0)
 			netlink_recvbuf(&zns->ge_netlink_cmd, rcvbufsize);
@@ -1794,12 +2193,14 @@ void kernel_init(struct zebra_ns *zns)
 	/* Set filter for inbound sockets, to exclude events we've generated
 	 * ourselves.
 	 */
-	netlink_install_filter(zns->netlink.sock, zns->netlink_cmd.snl.nl_pid,
-			       zns->netlink_dplane_out.snl.nl_pid);
+	pids[npids++] = zns->netlink_cmd.snl.nl_pid;
+	pids[npids++] = zns->netlink_dplane_out.snl.nl_pid;
+	for (i = 0; i < nshards - 1; i++)
+		pids[npids++] = zns->netlink_dplane_shards[i].snl.nl_pid;
+
+	netlink_install_filter(zns->netlink.sock, pids, npids);
 
-	netlink_install_filter(zns->netlink_dplane_in.sock,
-			       zns->netlink_cmd.snl.nl_pid,
-			       zns->netlink_dplane_out.snl.nl_pid);
+	netlink_install_filter(zns->netlink_dplane_in.sock, pids, npids);
 
 	zns->t_netlink = NULL;
 
@@ -1825,6 +2226,8 @@ static void kernel_nlsock_fini(struct nlsock *nls)
 
 void kernel_terminate(struct zebra_ns *zns, bool complete)
 {
+	unsigned int i;
+
 	event_cancel(&zns->t_netlink);
 
 	kernel_nlsock_fini(&zns->netlink);
@@ -1838,8 +2241,15 @@ void kernel_terminate(struct zebra_ns *zns, bool complete)
 	/* During zebra shutdown, we need to leave the dataplane socket
 	 * around until all work is done.
 	 */
-	if (complete)
+	if (complete) {
 		kernel_nlsock_fini(&zns->netlink_dplane_out);
+
+		for (i = 0; zns->netlink_dplane_shards &&
+			    i < dplane_get_shard_count() - 1;
+		     i++)
+			kernel_nlsock_fini(&zns->netlink_dplane_shards[i]);
+		XFREE(MTYPE_NL_SHARDS, zns->netlink_dplane_shards);
+	}
 }
 
 /*
@@ -1847,6 +2257,8 @@ void kernel_terminate(struct zebra_ns *zns, bool complete)
  */
 void kernel_router_init(void)
 {
+	pthread_key_create(&nl_batch_txbuf_key, nl_batch_txbuf_free);
+
 	/* Init nlsock hash and lock */
 	pthread_mutex_init(&nlsock_mutex, NULL);
 	nlsock_hash = hash_create_size(8, kernel_netlink_nlsock_key,
@@ -1859,7 +2271,13 @@ void kernel_router_init(void)
  */
 void kernel_router_terminate(void)
 {
-	XFREE(MTYPE_NL_BUF, nl_batch_tx_buf);
+	struct nl_batch_txbuf *txbuf = pthread_getspecific(nl_batch_txbuf_key);
+
+	if (txbuf) {
+		pthread_setspecific(nl_batch_txbuf_key, NULL);
+		nl_batch_txbuf_free(txbuf);
+	}
+	pthread_key_delete(nl_batch_txbuf_key);
 
 	pthread_mutex_destroy(&nlsock_mutex);
 
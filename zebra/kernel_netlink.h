@@ -52,6 +52,9 @@ extern int netlink_talk(int (*filter)(struct nlmsghdr *h, ns_id_t ns_id, int sta
 extern int ge_netlink_talk(int (*filter)(struct nlmsghdr *h, ns_id_t ns_id, int startup),
 			   struct nlmsghdr *n, struct zebra_ns *zns, bool startup);
 extern int netlink_request(struct nlsock *nl, void *req);
+extern int netlink_dump_parallel(int (*filter)(struct nlmsghdr *h, ns_id_t ns_id, int startup),
+				 struct zebra_ns *zns, struct nlmsghdr *reqs[], unsigned int nreqs,
+				 bool startup);
 
 enum netlink_msg_status {
 	FRR_NETLINK_SUCCESS,
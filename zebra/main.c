@@ -80,6 +80,7 @@ uint32_t rt_table_main_id = RT_TABLE_MAIN;
 #define OPTION_ASIC_OFFLOAD    2001
 #define OPTION_V6_WITH_V4_NEXTHOP 2002
 #define OPTION_NEXTHOP_WEIGHT_16_BIT 2003
+#define OPTION_DPLANE_SHARDS	     2004
 
 /* Command line options. */
 const struct option longopts[] = {
@@ -95,6 +96,7 @@ const struct option longopts[] = {
 	{ "vrfwnetns", no_argument, NULL, 'n' },
 	{ "nl-bufsize", required_argument, NULL, 's' },
 	{ "v6-rr-semantics", no_argument, NULL, OPTION_V6_RR_SEMANTICS },
+	{ "dplane-shards", required_argument, NULL, OPTION_DPLANE_SHARDS },
 #endif /* HAVE_NETLINK */
 	{ "routing-table", optional_argument, NULL, 'R' },
 	{ 0 }
@@ -185,8 +187,7 @@ static void sigint(void)
 		}
 	}
 
-	if (zrouter.lsp_process_q)
-		work_queue_free_and_null(&zrouter.lsp_process_q);
+	zebra_mpls_process_finish();
 
 	access_list_reset();
 	prefix_list_reset();
@@ -260,6 +261,9 @@ void zebra_finalize(struct event *dummy)
 	zserv_client_list_fini(&zrouter.client_list);
 	zserv_stale_client_list_fini(&zrouter.stale_client_list);
 
+	zebra_rib_slab_fini();
+	zebra_dplane_ctx_pool_fini();
+
 	frr_fini();
 	exit(0);
 }
@@ -414,6 +418,7 @@ int main(int argc, char **argv)
 		    "  -s, --nl-bufsize            Set netlink receive buffer size\n"
 		    "  -n, --vrfwnetns             Use NetNS as VRF backend (deprecated, use -w)\n"
 		    "      --v6-rr-semantics       Use v6 RR semantics\n"
+		    "      --dplane-shards         Number of pthreads programming routes into the kernel\n"
 #else
 		    "  -s,                         Set kernel socket receive buffer size\n"
 #endif /* HAVE_NETLINK */
@@ -490,6 +495,18 @@ int main(int argc, char **argv)
 		case OPTION_V6_WITH_V4_NEXTHOP:
 			v6_with_v4_nexthop = true;
 			break;
+		case OPTION_DPLANE_SHARDS: {
+			unsigned long shards = strtoul(optarg, NULL, 10);
+
+			if (shards == 0 || shards > DPLANE_SHARDS_MAX) {
+				fprintf(stderr,
+					"Dplane shards must be between 1 and %u\n",
+					DPLANE_SHARDS_MAX);
+				return 1;
+			}
+			dplane_set_shard_count(shards);
+			break;
+		}
 #endif /* HAVE_NETLINK */
 		case OPTION_NEXTHOP_WEIGHT_16_BIT:
 			nexthop_weight_16_bit = true;
@@ -571,6 +588,9 @@ int main(int argc, char **argv)
 	/* RNH init */
 	zebra_rnh_init();
 
+	/* Redistribution batching init */
+	zebra_redistribute_init();
+
 	/* Config handler Init */
 	zebra_evpn_init();
 
@@ -17,6 +17,8 @@
 #include "vrf.h"
 #include "srcdest_table.h"
 #include "frrdistance.h"
+#include "jhash.h"
+#include "libfrr.h"
 
 #include "zebra/rib.h"
 #include "zebra/zebra_router.h"
@@ -33,6 +35,247 @@
 
 #define ZEBRA_PTM_SUPPORT
 
+DEFINE_MTYPE_STATIC(ZEBRA, REDIST_BATCH, "Redistribution batch");
+DEFINE_MTYPE_STATIC(ZEBRA, REDIST_MSG, "Redistribution pending message");
+
+/* Longest time a redistribution message is held back for batching */
+#define REDIST_BATCH_DELAY_MSEC 10
+/* Number of held messages at which a batch goes out without waiting */
+#define REDIST_BATCH_MAX 1024
+
+PREDECL_DLIST(redist_msg_list);
+PREDECL_HASH(redist_msg_hash);
+
+/*
+ * A redistribution message waiting to go out to a client, keyed by the
+ * route as the client sees it. A later message for the same route replaces
+ * the held one, so a route changing several times within the batch window
+ * costs the client a single message carrying its latest state.
+ */
+struct redist_msg {
+	struct redist_msg_list_item list_item;
+	struct redist_msg_hash_item hash_item;
+
+	vrf_id_t vrf_id;
+	uint8_t type;
+	unsigned short instance;
+	struct prefix p;
+	struct prefix_ipv6 src_p;
+
+	/* The encoded message, header included */
+	uint8_t *data;
+	size_t len;
+};
+
+/* Per-client list of held messages, in the order they were first queued */
+struct redist_batch {
+	struct zserv *client;
+	struct redist_msg_list_head msgs;
+	struct redist_msg_hash_head hash;
+	struct event *t_flush;
+};
+
+static int redist_msg_cmp(const struct redist_msg *m1,
+			  const struct redist_msg *m2)
+{
+	if (m1->vrf_id != m2->vrf_id)
+		return numcmp(m1->vrf_id, m2->vrf_id);
+	if (m1->type != m2->type)
+		return numcmp(m1->type, m2->type);
+	if (m1->instance != m2->instance)
+		return numcmp(m1->instance, m2->instance);
+	if (!prefix_same(&m1->p, &m2->p))
+		return 1;
+	/* No source prefix is family 0, which prefix_same() won't match */
+	if (m1->src_p.family != m2->src_p.family)
+		return 1;
+	if (m1->src_p.family && !prefix_same(&m1->src_p, &m2->src_p))
+		return 1;
+	return 0;
+}
+
+static uint32_t redist_msg_hash(const struct redist_msg *msg)
+{
+	uint32_t key;
+
+	key = jhash_3words(msg->vrf_id, msg->type, msg->instance,
+			   prefix_hash_key(&msg->p));
+	if (msg->src_p.family)
+		key = jhash_1word(prefix_hash_key(&msg->src_p), key);
+	return key;
+}
+
+DECLARE_DLIST(redist_msg_list, struct redist_msg, list_item);
+DECLARE_HASH(redist_msg_hash, struct redist_msg, hash_item, redist_msg_cmp,
+	     redist_msg_hash);
+
+/* Redistribution messages are encoded here, then copied into the batch */
+static struct stream *redist_stream;
+
+/* The pthread the batches belong to */
+static pthread_t redist_pthread;
+
+static void redist_batch_timer(struct event *event);
+
+static struct redist_batch *redist_batch_get(struct zserv *client)
+{
+	struct redist_batch *batch = client->redist_batch;
+
+	if (batch)
+		return batch;
+
+	batch = XCALLOC(MTYPE_REDIST_BATCH, sizeof(*batch));
+	batch->client = client;
+	redist_msg_list_init(&batch->msgs);
+	redist_msg_hash_init(&batch->hash);
+	client->redist_batch = batch;
+
+	return batch;
+}
+
+static void redist_msg_free(struct redist_msg *msg)
+{
+	XFREE(MTYPE_REDIST_MSG, msg->data);
+	XFREE(MTYPE_REDIST_MSG, msg);
+}
+
+struct stream *redistribute_stream(void)
+{
+	if (!redist_stream)
+		redist_stream = stream_new_expandable(ZEBRA_MAX_PACKET_SIZ);
+
+	stream_reset(redist_stream);
+	return redist_stream;
+}
+
+/*
+ * Hand everything held for the client to its I/O pthread in one go, with
+ * as many messages packed into each stream as fit.
+ */
+void redistribute_flush(struct zserv *client)
+{
+	struct redist_batch *batch;
+	struct redist_msg *msg;
+	struct stream_fifo fifo;
+	struct stream *s = NULL;
+
+	/* Messages sent from other pthreads can't be ordered against these */
+	if (!pthread_equal(pthread_self(), redist_pthread))
+		return;
+
+	batch = client->redist_batch;
+	if (!batch)
+		return;
+
+	event_cancel(&batch->t_flush);
+	if (!redist_msg_list_count(&batch->msgs))
+		return;
+
+	stream_fifo_init(&fifo);
+	while ((msg = redist_msg_list_pop(&batch->msgs))) {
+		redist_msg_hash_del(&batch->hash, msg);
+
+		if (!s || STREAM_WRITEABLE(s) < msg->len) {
+			if (s)
+				stream_fifo_push(&fifo, s);
+			s = stream_new(MAX(msg->len, ZEBRA_MAX_PACKET_SIZ));
+		}
+		stream_put(s, msg->data, msg->len);
+		redist_msg_free(msg);
+	}
+	stream_fifo_push(&fifo, s);
+
+	client->redist_batch_cnt++;
+	zserv_send_batch(client, &fifo);
+	stream_fifo_deinit(&fifo);
+}
+
+static void redist_batch_timer(struct event *event)
+{
+	struct redist_batch *batch = EVENT_ARG(event);
+
+	redistribute_flush(batch->client);
+}
+
+int redistribute_send(struct zserv *client, const struct zapi_route *api,
+		      struct stream *s)
+{
+	struct redist_batch *batch = redist_batch_get(client);
+	struct redist_msg lookup = {}, *msg;
+	size_t len = stream_get_endp(s);
+
+	lookup.vrf_id = api->vrf_id;
+	lookup.type = api->type;
+	lookup.instance = api->instance;
+	lookup.p = api->prefix;
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX))
+		lookup.src_p = api->src_prefix;
+
+	msg = redist_msg_hash_find(&batch->hash, &lookup);
+	if (msg) {
+		/* Superseded before it went out, only the latest state counts */
+		if (msg->len != len)
+			msg->data = XREALLOC(MTYPE_REDIST_MSG, msg->data, len);
+		memcpy(msg->data, STREAM_DATA(s), len);
+		msg->len = len;
+		client->redist_coalesced_cnt++;
+		return 0;
+	}
+
+	msg = XMALLOC(MTYPE_REDIST_MSG, sizeof(*msg));
+	*msg = lookup;
+	msg->data = XMALLOC(MTYPE_REDIST_MSG, len);
+	memcpy(msg->data, STREAM_DATA(s), len);
+	msg->len = len;
+	redist_msg_hash_add(&batch->hash, msg);
+	redist_msg_list_add_tail(&batch->msgs, msg);
+
+	if (redist_msg_list_count(&batch->msgs) >= REDIST_BATCH_MAX)
+		redistribute_flush(client);
+	else
+		/* Armed by the first held message, so the delay is bounded */
+		event_add_timer_msec(zrouter.master, redist_batch_timer, batch,
+				     REDIST_BATCH_DELAY_MSEC, &batch->t_flush);
+
+	return 0;
+}
+
+static int redist_batch_client_close(struct zserv *client)
+{
+	struct redist_batch *batch = client->redist_batch;
+	struct redist_msg *msg;
+
+	if (!batch)
+		return 0;
+
+	event_cancel(&batch->t_flush);
+	while ((msg = redist_msg_list_pop(&batch->msgs))) {
+		redist_msg_hash_del(&batch->hash, msg);
+		redist_msg_free(msg);
+	}
+	redist_msg_hash_fini(&batch->hash);
+	redist_msg_list_fini(&batch->msgs);
+	XFREE(MTYPE_REDIST_BATCH, client->redist_batch);
+
+	return 0;
+}
+
+static int redist_fini(void)
+{
+	stream_free(redist_stream);
+	redist_stream = NULL;
+
+	return 0;
+}
+
+void zebra_redistribute_init(void)
+{
+	redist_pthread = pthread_self();
+
+	hook_register(zserv_client_close, redist_batch_client_close);
+	hook_register(frr_fini, redist_fini);
+}
+
 /* array holding redistribute info about table redistribution */
 /* bit AFI is set if that AFI is redistributing routes from this table */
 static int zebra_import_table_used[AFI_MAX][SAFI_MAX][ZEBRA_KERNEL_TABLE_MAX];
@@ -777,9 +1020,9 @@ int zebra_add_import_table_entry(struct zebra_vrf *zvrf, safi_t safi, struct rou
 	UNSET_FLAG(import_flags, ZEBRA_FLAG_RR_USE_DISTANCE);
 
 	newre = zebra_rib_route_entry_new(0, ZEBRA_ROUTE_TABLE, re->table, import_flags,
-					  re->nhe_id, zvrf->table_id, re->metric, re->mtu,
+					  re->nhe_id, zvrf->table_id, re->metric, re_mtu(re),
 					  zebra_import_table_distance[afi][safi][re->table],
-					  re->tag);
+					  re_tag(re));
 
 	ng = nexthop_group_new();
 	copy_nexthops(&ng->nexthop, re->nhe->nhg.nexthop, NULL);
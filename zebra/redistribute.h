@@ -25,6 +25,19 @@ extern void zebra_redistribute_default_add(ZAPI_HANDLER_ARGS);
 extern void zebra_redistribute_default_delete(ZAPI_HANDLER_ARGS);
 /* ----------------- */
 
+/*
+ * Redistribution messages are held per client for a short while so they go
+ * out in batches, with a newer message for a route replacing a held one.
+ * They are encoded into redistribute_stream(), which redistribute_send()
+ * copies the message out of. redistribute_flush() sends whatever is held
+ * right away, and runs before anything else zebra sends the client.
+ */
+extern struct stream *redistribute_stream(void);
+extern int redistribute_send(struct zserv *client,
+			     const struct zapi_route *api, struct stream *s);
+extern void redistribute_flush(struct zserv *client);
+extern void zebra_redistribute_init(void);
+
 extern void redistribute_update(const struct route_node *rn,
 				const struct route_entry *re,
 				const struct route_entry *prev_re);
@@ -31,7 +31,7 @@ DECLARE_MGROUP(ZEBRA);
 
 DECLARE_MTYPE(RE);
 
-PREDECL_LIST(rnh_list);
+PREDECL_DLIST(rnh_list);
 PREDECL_RBTREE_UNIQ(rnh_rbtree);
 
 /* Nexthop structure. */
@@ -66,6 +66,8 @@ struct rnh {
 	 */
 	bool filtered;
 
+	/* The dest this rnh is tracked on, i.e. whose nht list it is in */
+	struct rib_dest_t_ *nht_dest;
 	struct rnh_list_item rnh_list_item;
 
 	struct rnh_rbtree_item rnh_rbtree_item;
@@ -75,12 +77,28 @@ struct rnh {
 #define ZEBRA_KERNEL_TABLE_MAX 252 /* support for no more than this rt tables */
 
 PREDECL_LIST(re_list);
+PREDECL_DLIST(re_client_list);
+PREDECL_HASH(rib_client_hash);
 
 struct re_opaque {
 	uint16_t length;
 	uint8_t data[];
 };
 
+/*
+ * Route attributes that most routes never set, kept out of line so that
+ * struct route_entry stays small. Allocated on first use; see re_ext_get().
+ */
+struct re_ext {
+	/* Tag */
+	route_tag_t tag;
+
+	/* MTU */
+	uint32_t mtu;
+
+	struct re_opaque *opaque;
+};
+
 struct route_entry {
 	/* Link list. */
 	struct re_list_item next;
@@ -122,8 +140,7 @@ struct route_entry {
 	/* Metric */
 	uint32_t metric;
 
-	/* MTU */
-	uint32_t mtu;
+	/* MTU of the nexthops, as learned from the dataplane */
 	uint32_t nexthop_mtu;
 
 	/* Flags of this route.
@@ -152,6 +169,11 @@ struct route_entry {
  * used for nexthops
  */
 #define ROUTE_ENTRY_ROUTE_REPLACING 0x80
+/*
+ * The route kept its nexthop group, and the group was updated in place in
+ * the dataplane; the route itself needs no reinstall.
+ */
+#define ROUTE_ENTRY_NHG_UPDATED 0x100
 
 	/* Sequence value incremented for each dataplane operation */
 	uint32_t dplane_sequence;
@@ -162,13 +184,26 @@ struct route_entry {
 	/* Distance. */
 	uint8_t distance;
 
-	/* Tag */
-	route_tag_t tag;
+	/* The nhe's members_seq when this route last looked at it */
+	uint32_t nhe_seq;
 
 	/* Uptime. */
 	time_t uptime;
 
-	struct re_opaque *opaque;
+	/* Tag, MTU and opaque data, if any of them is set */
+	struct re_ext *ext;
+
+	/* Linkage on the owning client's list of routes in this table, and
+	 * the node, while tracked; see rib_client_routes().
+	 */
+	struct re_client_list_item client_item;
+	struct route_node *client_rn;
+
+	/* Linkage on the nhe's list of routes using it, and the node, while
+	 * the route is in the RIB; see rib_update_nhe_routes().
+	 */
+	struct re_nhe_list_item nhe_item;
+	struct route_node *nhe_rn;
 };
 
 #define RIB_SYSTEM_ROUTE(R) RSYSTEM_ROUTE((R)->type)
@@ -197,9 +232,17 @@ struct route_entry {
 /* For checking that an object has already queued in some sub-queue */
 #define MQ_BIT_MASK ((1 << MQ_SIZE) - 1)
 
+/*
+ * Route sub-queues do not hold route nodes directly: they hold the
+ * rib_table_info of each table with nodes waiting, in round-robin order,
+ * and the nodes themselves wait on the table's mq_nodes list. Each visit
+ * processes a batch of one table's nodes, so that a burst of updates for
+ * one VRF does not hold up all others.
+ */
 struct meta_queue {
 	struct list *subq[MQ_SIZE];
 	uint32_t size; /* sum of lengths of all subqueues */
+	uint32_t route_subq_len[MQ_SIZE]; /* route nodes in route subqueues */
 	_Atomic uint32_t max_subq[MQ_SIZE];    /* Max size of individual sub queue */
 	_Atomic uint32_t max_metaq;	       /* Max size of the MetaQ */
 	_Atomic uint32_t total_subq[MQ_SIZE];  /* Total subq events */
@@ -231,6 +274,12 @@ typedef struct rib_dest_t_ {
 	 */
 	uint32_t flags;
 
+	/*
+	 * Latency stamp of the oldest update waiting on the meta queue for
+	 * this dest, see zebra_latency.h.
+	 */
+	uint32_t mq_stamp;
+
 	/*
 	 * The list of nht prefixes that have ended up
 	 * depending on this route node.
@@ -245,10 +294,19 @@ typedef struct rib_dest_t_ {
 	 */
 	TAILQ_ENTRY(rib_dest_t_) fpm_q_entries;
 
+	/*
+	 * Bumped whenever a more specific dest is added or removed below
+	 * this one, i.e. whenever a longest-match lookup that used to land
+	 * here may land elsewhere.  Validates cached nexthop lookups.
+	 */
+	uint64_t version;
+
 } rib_dest_t;
 
-DECLARE_LIST(rnh_list, struct rnh, rnh_list_item);
+DECLARE_DLIST(rnh_list, struct rnh, rnh_list_item);
 DECLARE_LIST(re_list, struct route_entry, next);
+DECLARE_DLIST(re_client_list, struct route_entry, client_item);
+DECLARE_DLIST(re_nhe_list, struct route_entry, nhe_item);
 
 #define RIB_ROUTE_QUEUED(x)	(1 << (x))
 // If MQ_SIZE is modified this value needs to be updated.
@@ -319,6 +377,17 @@ struct rib_table_info {
 	afi_t afi;
 	safi_t safi;
 	uint32_t table_id;
+
+	/* Route nodes of this table waiting in each meta queue route
+	 * sub-queue.
+	 */
+	struct list *mq_nodes[MQ_SIZE];
+
+	/* Cached longest-match lookups of recursive nexthops */
+	struct hash *nh_resolve_cache;
+
+	/* Routes of each client (type and instance) in this table */
+	struct rib_client_hash_head client_routes;
 };
 
 enum rib_tables_iter_state {
@@ -424,12 +493,15 @@ extern void rib_sweep_table(struct route_table *table);
 extern void rib_close_table(struct route_table *table);
 extern void zebra_rib_init(void);
 extern void zebra_rib_terminate(void);
+extern void zebra_rib_slab_fini(void);
 extern unsigned long rib_score_proto(uint8_t proto, unsigned short instance);
 extern unsigned long rib_score_proto_table(uint8_t proto,
 					   unsigned short instance,
 					   struct route_table *table);
 
 extern int rib_queue_add(struct route_node *rn);
+/* Queue the routes using an nhe whose members changed in place */
+extern void rib_update_nhe_routes(struct nhg_hash_entry *nhe);
 
 struct nhg_ctx; /* Forward declaration */
 
@@ -463,14 +535,28 @@ int zebra_rib_queue_evpn_rem_vtep_add(vrf_id_t vrf_id, vni_t vni, struct ipaddr
 int zebra_rib_queue_evpn_rem_vtep_del(vrf_id_t vrf_id, vni_t vni, struct ipaddr *vtep_ip);
 
 extern void meta_queue_free(struct meta_queue *mq, struct zebra_vrf *zvrf);
+extern void rib_meta_queue_table_free(struct rib_table_info *info);
 extern int zebra_rib_labeled_unicast(struct route_entry *re);
 extern void rib_meta_queue_early_route_cleanup(const struct prefix *p, afi_t afi, safi_t safi,
 					       vrf_id_t vrf_id, int route_type);
 extern struct route_table *rib_table_ipv6;
 
 extern uint32_t zebra_rib_meta_queue_size(void);
+extern uint32_t zebra_rib_meta_queue_max(void);
 
 extern void rib_unlink(struct route_node *rn, struct route_entry *re);
+
+/*
+ * A client's routes in a table, in the order they were added: the head
+ * has the oldest uptime. Routes from the system (kernel, connected) are
+ * not tracked. Returns NULL if the client has never had a route there.
+ */
+extern struct re_client_list_head *
+rib_client_routes(struct route_table *table, int type, uint16_t instance);
+/* Take a route off its client's list, e.g. once it's being deleted */
+extern void rib_client_route_untrack(struct route_entry *re);
+/* Release the per-client lists of a table that is being freed */
+extern void rib_table_client_routes_free(struct rib_table_info *info);
 extern int rib_gc_dest(struct route_node *rn);
 extern struct route_table *rib_tables_iter_next(rib_tables_iter_t *iter);
 
@@ -601,6 +687,36 @@ DECLARE_HOOK(rib_update, (struct route_node * rn, const char *reason),
 	     (rn, reason));
 DECLARE_HOOK(rib_shutdown, (struct route_node * rn), (rn));
 
+/* Out-of-line attributes; see struct re_ext */
+extern struct re_ext *re_ext_get(struct route_entry *re);
+
+static inline route_tag_t re_tag(const struct route_entry *re)
+{
+	return re->ext ? re->ext->tag : 0;
+}
+
+static inline uint32_t re_mtu(const struct route_entry *re)
+{
+	return re->ext ? re->ext->mtu : 0;
+}
+
+static inline struct re_opaque *re_opaque(const struct route_entry *re)
+{
+	return re->ext ? re->ext->opaque : NULL;
+}
+
+static inline void re_set_tag(struct route_entry *re, route_tag_t tag)
+{
+	if (tag || re->ext)
+		re_ext_get(re)->tag = tag;
+}
+
+static inline void re_set_mtu(struct route_entry *re, uint32_t mtu)
+{
+	if (mtu || re->ext)
+		re_ext_get(re)->mtu = mtu;
+}
+
 /*
  * Access installed/fib nexthops, which may be a subset of the
  * rib nexthops.
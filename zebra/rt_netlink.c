@@ -1575,52 +1575,51 @@ int netlink_route_change(struct nlmsghdr *h, ns_id_t ns_id, int startup)
 	return 0;
 }
 
-/* Request for specific route information from the kernel */
-static int netlink_request_route(struct zebra_ns *zns, int family, int type)
-{
-	struct {
-		struct nlmsghdr n;
-		struct rtmsg rtm;
-	} req;
+/* Dump request for the routes of one address family */
+struct netlink_route_req {
+	struct nlmsghdr n;
+	struct rtmsg rtm;
+};
 
+static void netlink_route_req_init(struct netlink_route_req *req, int family,
+				   int type)
+{
 	/* Form the request, specifying filter (rtattr) if needed. */
-	memset(&req, 0, sizeof(req));
-	req.n.nlmsg_type = type;
-	req.n.nlmsg_flags = NLM_F_ROOT | NLM_F_MATCH | NLM_F_REQUEST;
-	req.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
-	req.rtm.rtm_family = family;
-
-	return netlink_request(&zns->netlink_cmd, &req);
+	memset(req, 0, sizeof(*req));
+	req->n.nlmsg_type = type;
+	req->n.nlmsg_flags = NLM_F_ROOT | NLM_F_MATCH | NLM_F_REQUEST;
+	req->n.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+	req->rtm.rtm_family = family;
 }
 
-/* Routing table read function using netlink interface.  Only called
-   bootstrap time. */
-int netlink_route_read(struct zebra_ns *zns)
+static int netlink_route_read_startup(struct nlmsghdr *h, ns_id_t ns_id,
+				      int startup)
 {
 	int ret;
-	struct zebra_dplane_info dp_info;
 
-	zebra_dplane_info_from_zns(&dp_info, zns, true /*is_cmd*/);
+	ret = netlink_route_change_read_unicast(h, ns_id, startup);
+	if (ret > 0)
+		zrouter.startup_stats.routes_read++;
 
-	/* Get IPv4 routing table. */
-	ret = netlink_request_route(zns, AF_INET, RTM_GETROUTE);
-	if (ret < 0)
-		return ret;
-	ret = netlink_parse_info(netlink_route_change_read_unicast,
-				 &zns->netlink_cmd, &dp_info, 0, true);
-	if (ret < 0)
-		return ret;
+	return ret;
+}
 
-	/* Get IPv6 routing table. */
-	ret = netlink_request_route(zns, AF_INET6, RTM_GETROUTE);
-	if (ret < 0)
-		return ret;
-	ret = netlink_parse_info(netlink_route_change_read_unicast,
-				 &zns->netlink_cmd, &dp_info, 0, true);
-	if (ret < 0)
-		return ret;
+/* Routing table read function using netlink interface.  Only called
+   bootstrap time. The IPv4 and IPv6 tables are dumped in parallel. */
+int netlink_route_read(struct zebra_ns *zns)
+{
+	static const int families[] = { AF_INET, AF_INET6 };
+	struct netlink_route_req req[array_size(families)];
+	struct nlmsghdr *reqs[array_size(families)];
+	unsigned int i;
 
-	return 0;
+	for (i = 0; i < array_size(families); i++) {
+		netlink_route_req_init(&req[i], families[i], RTM_GETROUTE);
+		reqs[i] = &req[i].n;
+	}
+
+	return netlink_dump_parallel(netlink_route_read_startup, zns, reqs,
+				     array_size(reqs), true);
 }
 
 /*
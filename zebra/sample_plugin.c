@@ -19,6 +19,7 @@
 #include "config.h" /* Include this explicitly */
 #include "lib/zebra.h"
 #include "lib/libfrr.h"
+#include "lib/frr_pthread.h"
 #include "zebra/zebra_dplane.h"
 #include "zebra/debug.h"
 
@@ -26,12 +27,18 @@ static const char *plugin_name = "SAMPLE";
 
 static struct zebra_dplane_provider *prov_p;
 
+/* The plugin does its work on a pthread of its own */
+static struct frr_pthread *sample_pthread;
+static struct event *t_work;
+
 /*
  * Startup/init callback, called from the dataplane.
  */
 static int sample_start(struct zebra_dplane_provider *prov)
 {
-	/* Nothing special to do - we don't allocate anything. */
+	sample_pthread = frr_pthread_new(NULL, plugin_name, plugin_name);
+	assert(frr_pthread_run(sample_pthread, NULL) == 0);
+
 	return 0;
 }
 
@@ -41,34 +48,60 @@ static int sample_start(struct zebra_dplane_provider *prov)
  */
 static int sample_fini(struct zebra_dplane_provider *prov, bool early)
 {
-	/* Nothing special to do. */
+	if (early)
+		return 0;
+
+	frr_pthread_stop(sample_pthread, NULL);
+	sample_pthread = NULL;
+
 	return 0;
 }
 
 /*
- * Callback from the dataplane to process incoming work; this runs in the
- * dplane pthread.
+ * Process incoming work; this runs in the plugin's own pthread, which is
+ * therefore the only one taking work from the plugin's inbound ring and
+ * putting it on the outbound ring.
  */
-static int sample_process(struct zebra_dplane_provider *prov)
+static void sample_work(struct event *event)
 {
-	int counter, limit;
-	struct zebra_dplane_ctx *ctx;
+	int counter, limit, i, n = 0;
+	struct zebra_dplane_ctx *ctxs[32];
 
 	limit = dplane_provider_get_work_limit(prov_p);
 
 	/* Respect the configured limit on the amount of work to do in
-	 * any one call.
+	 * any one call. Work is moved in batches, which only costs one
+	 * ring update per batch.
 	 */
-	for (counter = 0; counter < limit; counter++) {
-		ctx = dplane_provider_dequeue_in_ctx(prov_p);
-		if (!ctx)
+	for (counter = 0; counter < limit; counter += n) {
+		n = dplane_provider_dequeue_in_batch(
+			prov_p, ctxs, MIN(limit - counter, (int)array_size(ctxs)));
+		if (n == 0)
 			break;
 
 		/* Just set 'success' status and return to the dataplane */
-		dplane_ctx_set_status(ctx, ZEBRA_DPLANE_REQUEST_SUCCESS);
-		dplane_provider_enqueue_out_ctx(prov_p, ctx);
+		for (i = 0; i < n; i++)
+			dplane_ctx_set_status(ctxs[i],
+					      ZEBRA_DPLANE_REQUEST_SUCCESS);
+		dplane_provider_enqueue_out_batch(prov_p, ctxs, n);
 	}
 
+	/* Have the dataplane pick up the results, and come back for more */
+	if (counter > 0)
+		dplane_provider_work_ready();
+	if (counter >= limit)
+		event_add_event(sample_pthread->master, sample_work, NULL, 0,
+				&t_work);
+}
+
+/*
+ * Callback from the dataplane to process incoming work; this runs in the
+ * dplane pthread, and hands the work to the plugin's pthread.
+ */
+static int sample_process(struct zebra_dplane_provider *prov)
+{
+	event_add_event(sample_pthread->master, sample_work, NULL, 0, &t_work);
+
 	return 0;
 }
 
@@ -82,15 +115,18 @@ static int init_sample_plugin(struct event_loop *tm)
 
 	/* Note that we don't use or store the thread_master 'tm'. We
 	 * don't use the zebra main pthread: our plugin code will run in
-	 * the zebra dataplane pthread context.
+	 * its own pthread, started from the dataplane.
 	 */
 
 	/* Register the plugin with the dataplane infrastructure. We
 	 * register to be called before the kernel, and we register
-	 * our init, process work, and shutdown callbacks.
+	 * our init, process work, and shutdown callbacks. Our queues
+	 * are lock-free rings: the dataplane pthread is at one end and
+	 * our pthread at the other.
 	 */
 	ret = dplane_provider_register(plugin_name, DPLANE_PRIO_PRE_KERNEL,
-				       DPLANE_PROV_FLAGS_DEFAULT,
+				       DPLANE_PROV_FLAG_THREADED |
+					       DPLANE_PROV_FLAG_RING,
 				       sample_start,
 				       sample_process,
 				       sample_fini,
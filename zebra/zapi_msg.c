@@ -607,26 +607,24 @@ int zsend_redistribute_route(int cmd, struct zserv *client, const struct route_n
 		api.distance = re->distance;
 	SET_FLAG(api.message, ZAPI_MESSAGE_METRIC);
 	api.metric = re->metric;
-	if (re->tag) {
+	if (re_tag(re)) {
 		SET_FLAG(api.message, ZAPI_MESSAGE_TAG);
-		api.tag = re->tag;
+		api.tag = re_tag(re);
 	}
 	SET_FLAG(api.message, ZAPI_MESSAGE_MTU);
-	api.mtu = re->mtu;
+	api.mtu = re_mtu(re);
 
-	struct stream *s = stream_new_expandable(ZEBRA_MAX_PACKET_SIZ);
+	struct stream *s = redistribute_stream();
 
 	/* Encode route and send. */
-	if (zapi_route_encode(cmd, s, &api) < 0) {
-		stream_free(s);
+	if (zapi_route_encode(cmd, s, &api) < 0)
 		return -1;
-	}
 
 	if (IS_ZEBRA_DEBUG_SEND)
 		zlog_debug("%s: %s to client %s: type %s, vrf_id %d, table %u, p %pFX", __func__,
 			   zserv_command_string(cmd), zebra_route_string(client->proto),
 			   zebra_route_string(api.type), api.vrf_id, api.tableid, &api.prefix);
-	return zserv_send_message(client, s);
+	return redistribute_send(client, &api, s);
 }
 
 /*
@@ -655,6 +653,7 @@ static int zsend_nexthop_lookup(struct zserv *client, struct ipaddr *addr, struc
 	unsigned long nump;
 	uint16_t num;
 	struct nexthop *nexthop;
+	struct re_opaque *opaque;
 
 	/* Get output stream. */
 	s = stream_new(ZEBRA_SMALL_PACKET_SIZE + ZAPI_MESSAGE_OPAQUE_LENGTH);
@@ -671,9 +670,10 @@ static int zsend_nexthop_lookup(struct zserv *client, struct ipaddr *addr, struc
 		stream_putl(s, re->metric);
 		stream_putw(s, rn->p.prefixlen);
 		stream_putl(s, re->type);
-		if (re->opaque && re->opaque->length > 0) {
-			stream_putl(s, re->opaque->length);
-			stream_put(s, re->opaque->data, re->opaque->length);
+		opaque = re_opaque(re);
+		if (opaque && opaque->length > 0) {
+			stream_putl(s, opaque->length);
+			stream_put(s, opaque->data, opaque->length);
 		} else
 			stream_putl(s, 0);
 
@@ -2211,11 +2211,13 @@ static void zread_route_add(ZAPI_HANDLER_ARGS)
 	}
 
 	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_OPAQUE)) {
-		re->opaque =
-			XMALLOC(MTYPE_RE_OPAQUE,
-				sizeof(struct re_opaque) + api.opaque.length);
-		re->opaque->length = api.opaque.length;
-		memcpy(re->opaque->data, api.opaque.data, re->opaque->length);
+		struct re_opaque *opaque;
+
+		opaque = XMALLOC(MTYPE_RE_OPAQUE,
+				 sizeof(struct re_opaque) + api.opaque.length);
+		opaque->length = api.opaque.length;
+		memcpy(opaque->data, api.opaque.data, opaque->length);
+		re_ext_get(re)->opaque = opaque;
 	}
 
 	afi = family2afi(api.prefix.family);
@@ -2295,8 +2297,8 @@ static void zread_route_add(ZAPI_HANDLER_ARGS)
 
 void zapi_re_opaque_free(struct route_entry *re)
 {
-	XFREE(MTYPE_RE_OPAQUE, re->opaque);
-	re->opaque = NULL;
+	if (re->ext)
+		XFREE(MTYPE_RE_OPAQUE, re->ext->opaque);
 }
 
 static void zread_route_del(ZAPI_HANDLER_ARGS)
@@ -2481,15 +2483,25 @@ static void zread_hello(ZAPI_HANDLER_ARGS)
 	unsigned short instance;
 	uint8_t synchronous;
 	uint32_t session_id;
+	uint8_t flags = 0;
 
 	STREAM_GETC(msg, proto);
 	STREAM_GETW(msg, instance);
 	STREAM_GETL(msg, session_id);
 	STREAM_GETC(msg, synchronous);
+	/* Optional, absent from older clients */
+	if (STREAM_READABLE(msg))
+		STREAM_GETC(msg, flags);
 
 	if (synchronous)
 		client->synchronous = true;
 
+	/* The ring itself was attached by the client pthread on receipt */
+	if (CHECK_FLAG(flags, ZAPI_HELLO_F_RING) && !client->ring)
+		flog_warn(EC_ZEBRA_CLIENT_IO_ERROR,
+			  "client %d announced a shared memory ring but passed none",
+			  client->sock);
+
 	/* accept only dynamic routing protocols */
 	if ((proto < ZEBRA_ROUTE_MAX) && (proto > ZEBRA_ROUTE_LOCAL)) {
 		zlog_notice(
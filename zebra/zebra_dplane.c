@@ -10,12 +10,16 @@
 #include "config.h"
 #endif
 
+#include <stdalign.h>
+
 #include "lib/libfrr.h"
 #include "lib/debug.h"
 #include "lib/lib_errors.h"
 #include "lib/frratomic.h"
 #include "lib/frr_pthread.h"
+#include "lib/jhash.h"
 #include "lib/memory.h"
+#include "lib/slab.h"
 #include "lib/zebra.h"
 #include "zebra/netconf_netlink.h"
 #include "zebra/zebra_router.h"
@@ -36,6 +40,8 @@ DEFINE_MTYPE_STATIC(ZEBRA, DP_INTF, "Zebra DPlane Intf");
 DEFINE_MTYPE_STATIC(ZEBRA, DP_PROV, "Zebra DPlane Provider");
 DEFINE_MTYPE_STATIC(ZEBRA, DP_NETFILTER, "Zebra Netfilter Internal Object");
 DEFINE_MTYPE_STATIC(ZEBRA, DP_NS, "DPlane NSes");
+DEFINE_MTYPE_STATIC(ZEBRA, DP_SHARD, "Zebra DPlane Shards");
+DEFINE_MTYPE_STATIC(ZEBRA, DP_NHG_SNAP, "Zebra DPlane Nexthop Snapshot");
 
 DEFINE_MTYPE(ZEBRA, VLAN_CHANGE_ARR, "Vlan Change Array");
 
@@ -64,6 +70,9 @@ const uint32_t DPLANE_DEFAULT_MAX_QUEUED = 200;
 /* Default value for new work per cycle */
 const uint32_t DPLANE_DEFAULT_NEW_WORK = 100;
 
+/* Number of kernel update shards, from the command line */
+static uint32_t dplane_shard_config = 1;
+
 /* Validation check macro for context blocks */
 /* #define DPLANE_DEBUG 1 */
 
@@ -105,6 +114,21 @@ struct dplane_intf_extra {
 	struct dplane_intf_extra_list_item dlink;
 };
 
+/*
+ * Read-only copy of an nhe's nexthops, shared by the route contexts that
+ * use it. Contexts can't point at zebra's own nexthops, which change under
+ * them, but one copy per nhe does instead of one per context. FIB flags are
+ * clear; 'fib' is a second copy, made when first needed, with them set the
+ * way a successful install marks them.
+ */
+struct dplane_nhg_snap {
+	_Atomic uint32_t refcnt;
+
+	struct nexthop_group ng;
+
+	_Atomic(struct nexthop *) fib;
+};
+
 /*
  * Route information captured for route updates.
  */
@@ -140,9 +164,10 @@ struct dplane_route_info {
 	/* Nexthop hash entry info */
 	struct dplane_nexthop_info nhe;
 
-	/* Nexthops */
+	/* Nexthops; if 'zd_ng_snap' is set, they belong to the snapshot */
 	uint32_t zd_nhg_id;
 	struct nexthop_group zd_ng;
+	struct dplane_nhg_snap *zd_ng_snap;
 
 	/* Backup nexthops (if present) */
 	struct nexthop_group backup_ng;
@@ -402,6 +427,9 @@ struct dplane_vlan_info {
 	struct zebra_vxlan_vlan_array *vlan_array;
 };
 
+/* Link updates held in an incoming batch, by namespace and ifindex */
+PREDECL_HASH(dplane_link_hash);
+
 /*
  * The context block used to exchange info about route updates across
  * the boundary between the zebra main context (and pthread) and the
@@ -431,6 +459,16 @@ struct zebra_dplane_ctx {
 	 */
 	uint32_t zd_notif_provider;
 
+	/* Kernel update shard, picked from namespace and table */
+	uint32_t zd_shard;
+
+	/* Route install latency: stamps of the update's origin and of the
+	 * last stage it passed, which is zd_lat_stage.
+	 */
+	uint32_t zd_lat_origin;
+	uint32_t zd_lat_stamp;
+	enum zebra_lat_stage zd_lat_stage;
+
 	/* TODO -- internal/sub-operation status? */
 	enum zebra_dplane_result zd_remote_status;
 	enum zebra_dplane_result zd_kernel_status;
@@ -473,6 +511,9 @@ struct zebra_dplane_ctx {
 
 	/* Embedded list linkage */
 	struct dplane_ctx_list_item zd_entries;
+
+	/* Linkage for incoming batches, see dplane_zebra_batch_begin() */
+	struct dplane_link_hash_item zd_link_item;
 };
 
 /* Flag that can be set by a pre-kernel provider as a signal that an update
@@ -484,9 +525,59 @@ struct zebra_dplane_ctx {
 DECLARE_DLIST(dplane_ctx_list, struct zebra_dplane_ctx, zd_entries);
 DECLARE_DLIST(dplane_intf_extra_list, struct dplane_intf_extra, dlink);
 
+static int dplane_link_hash_cmp(const struct zebra_dplane_ctx *c1,
+				const struct zebra_dplane_ctx *c2)
+{
+	if (c1->zd_ns_info.ns_id != c2->zd_ns_info.ns_id)
+		return numcmp(c1->zd_ns_info.ns_id, c2->zd_ns_info.ns_id);
+	return numcmp(c1->zd_ifindex, c2->zd_ifindex);
+}
+
+static uint32_t dplane_link_hash_key(const struct zebra_dplane_ctx *ctx)
+{
+	return jhash_2words(ctx->zd_ns_info.ns_id, ctx->zd_ifindex, 0);
+}
+
+DECLARE_HASH(dplane_link_hash, struct zebra_dplane_ctx, zd_link_item,
+	     dplane_link_hash_cmp, dplane_link_hash_key);
+
 /* List for dplane plugins/providers */
 PREDECL_DLIST(dplane_prov_list);
 
+/*
+ * Single-producer, single-consumer ring of contexts, used for the queues of
+ * providers registered with DPLANE_PROV_FLAG_RING. 'head' is only written by
+ * the producer and 'tail' only by the consumer, so neither side needs a lock;
+ * they sit on separate cache lines so the two threads don't contend.
+ */
+struct dplane_ctx_ring {
+	/* Number of slots - 1; the size is a power of two */
+	uint32_t mask;
+
+	/* Next slot to fill */
+	alignas(64) _Atomic uint32_t head;
+
+	/* Next slot to drain */
+	alignas(64) _Atomic uint32_t tail;
+
+	alignas(64) struct zebra_dplane_ctx *slots[];
+};
+
+/*
+ * One direction of a provider's queueing. Without a ring, all contexts are
+ * on the list, under the provider's mutex. With a ring, the list only holds
+ * what didn't fit in the ring; once anything is on it the producer keeps
+ * appending there until the consumer has drained it, which keeps order.
+ */
+struct dplane_prov_queue {
+	struct dplane_ctx_list_head list;
+
+	struct dplane_ctx_ring *ring;
+
+	/* Length of the list, readable without the mutex (ring only) */
+	_Atomic uint32_t overflow;
+};
+
 /*
  * Registration block for one dataplane provider.
  */
@@ -522,12 +613,12 @@ struct zebra_dplane_provider {
 	_Atomic uint32_t dp_error_counter;
 
 	/* Queue of contexts inbound to the provider */
-	struct dplane_ctx_list_head dp_ctx_in_list;
+	struct dplane_prov_queue dp_in_q;
 
 	/* Queue of completed contexts outbound from the provider back
 	 * towards the dataplane module.
 	 */
-	struct dplane_ctx_list_head dp_ctx_out_list;
+	struct dplane_prov_queue dp_out_q;
 
 	/* Embedded list linkage for provider objects */
 	struct dplane_prov_list_item dp_link;
@@ -552,6 +643,25 @@ struct dplane_zns_info {
 	struct zns_info_list_item link;
 };
 
+/*
+ * Kernel update shard. Route updates are spread across shards by namespace
+ * and table; each shard programs the kernel through its own netlink socket,
+ * so updates for one table (and therefore one prefix) stay in order. Shard
+ * 0 runs on the dplane pthread, the others on their own pthreads.
+ */
+struct dplane_shard {
+	uint32_t ds_id;
+
+	struct frr_pthread *ds_pthread;
+	struct event *ds_t_work;
+
+	/* Contexts handed to the shard for one kernel update pass */
+	struct dplane_ctx_list_head ds_work;
+
+	_Atomic uint32_t ds_routes;
+	_Atomic uint32_t ds_passes;
+};
+
 /*
  * Globals
  */
@@ -617,6 +727,7 @@ static struct zebra_dplane_globals {
 	_Atomic uint32_t dg_intf_addr_errors;
 	_Atomic uint32_t dg_intf_changes;
 	_Atomic uint32_t dg_intf_changes_errors;
+	_Atomic uint32_t dg_intf_links_coalesced;
 
 	_Atomic uint32_t dg_macs_in;
 	_Atomic uint32_t dg_mac_errors;
@@ -628,6 +739,15 @@ static struct zebra_dplane_globals {
 	_Atomic uint32_t dg_rule_errors;
 
 	_Atomic uint32_t dg_update_yields;
+	_Atomic uint32_t dg_update_batches;
+	_Atomic uint32_t dg_updates_batched;
+
+	/* Context objects are carved from, and returned to, this pool */
+	struct slab *dg_ctx_slab;
+
+	/* Route nexthop snapshots made, and reused by later contexts */
+	_Atomic uint32_t dg_nhg_snaps_made;
+	_Atomic uint32_t dg_nhg_snaps_shared;
 
 	_Atomic uint32_t dg_iptable_in;
 	_Atomic uint32_t dg_iptable_errors;
@@ -664,6 +784,15 @@ static struct zebra_dplane_globals {
 	/* Event pointer for pending shutdown check loop */
 	struct event *dg_t_shutdown_check;
 
+	/* Kernel update shards */
+	struct dplane_shard *dg_shards;
+	uint32_t dg_shard_count;
+
+	/* Shard workers still busy with the current pass */
+	pthread_mutex_t dg_shard_mutex;
+	pthread_cond_t dg_shard_cond;
+	uint32_t dg_shards_busy;
+
 } zdplane_info;
 
 /* Instantiate zns list type */
@@ -682,8 +811,207 @@ DECLARE_DLIST(zns_info_list, struct dplane_zns_info, link);
 #define DPLANE_PROV_LOCK(p)   pthread_mutex_lock(&((p)->dp_mutex))
 #define DPLANE_PROV_UNLOCK(p) pthread_mutex_unlock(&((p)->dp_mutex))
 
+/* Contexts moved through a ring per step when starting from a list */
+#define DPLANE_RING_BATCH 32
+
+static struct dplane_ctx_ring *dplane_ctx_ring_new(uint32_t min_size)
+{
+	struct dplane_ctx_ring *ring;
+	uint32_t size = 64;
+
+	while (size < min_size)
+		size <<= 1;
+
+	ring = XCALLOC(MTYPE_DP_PROV,
+		       sizeof(*ring) + size * sizeof(ring->slots[0]));
+	ring->mask = size - 1;
+
+	return ring;
+}
+
+/* Approximate when called from a third pthread, but never negative */
+static uint32_t dplane_ctx_ring_count(struct dplane_ctx_ring *ring)
+{
+	uint32_t tail, head;
+
+	tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	return MIN(head - tail, ring->mask + 1);
+}
+
+/* Producer side: add up to 'n' contexts, return how many fit */
+static uint32_t dplane_ctx_ring_put(struct dplane_ctx_ring *ring,
+				    struct zebra_dplane_ctx **ctxs, uint32_t n)
+{
+	uint32_t head, tail, i;
+
+	head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	n = MIN(n, ring->mask + 1 - (head - tail));
+	for (i = 0; i < n; i++)
+		ring->slots[(head + i) & ring->mask] = ctxs[i];
+
+	atomic_store_explicit(&ring->head, head + n, memory_order_release);
+
+	return n;
+}
+
+/* Consumer side: take up to 'max' contexts, return how many */
+static uint32_t dplane_ctx_ring_get(struct dplane_ctx_ring *ring,
+				    struct zebra_dplane_ctx **ctxs, uint32_t max)
+{
+	uint32_t head, tail, i, n;
+
+	tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	n = MIN(max, head - tail);
+	for (i = 0; i < n; i++)
+		ctxs[i] = ring->slots[(tail + i) & ring->mask];
+
+	atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+
+	return n;
+}
+
+/*
+ * Provider queue helpers; these take the provider's mutex themselves,
+ * which ring queues only need once they have overflowed.
+ */
+static uint32_t dplane_prov_q_count(struct dplane_prov_queue *q)
+{
+	if (!q->ring)
+		return dplane_ctx_queue_count(&q->list);
+
+	return dplane_ctx_ring_count(q->ring) +
+	       atomic_load_explicit(&q->overflow, memory_order_relaxed);
+}
+
+static void dplane_prov_q_push(struct zebra_dplane_provider *prov,
+			       struct dplane_prov_queue *q,
+			       struct zebra_dplane_ctx **ctxs, uint32_t n)
+{
+	uint32_t i = 0;
+
+	/* Once the list is in use, keep appending there to preserve order */
+	if (q->ring &&
+	    atomic_load_explicit(&q->overflow, memory_order_acquire) == 0)
+		i = dplane_ctx_ring_put(q->ring, ctxs, n);
+
+	if (i == n)
+		return;
+
+	DPLANE_PROV_LOCK(prov);
+
+	if (q->ring)
+		atomic_fetch_add_explicit(&q->overflow, n - i,
+					  memory_order_release);
+	for (; i < n; i++)
+		dplane_ctx_list_add_tail(&q->list, ctxs[i]);
+
+	DPLANE_PROV_UNLOCK(prov);
+}
+
+static uint32_t dplane_prov_q_pop(struct zebra_dplane_provider *prov,
+				  struct dplane_prov_queue *q,
+				  struct zebra_dplane_ctx **ctxs, uint32_t max)
+{
+	struct zebra_dplane_ctx *ctx;
+	uint32_t n = 0, overflow;
+
+	if (q->ring) {
+		/*
+		 * Look at the overflow count before draining the ring: if the
+		 * list is in use, whatever went onto the ring before it is
+		 * then visible here, and must come out first.
+		 */
+		overflow = atomic_load_explicit(&q->overflow,
+						memory_order_acquire);
+		n = dplane_ctx_ring_get(q->ring, ctxs, max);
+		if (n == max || overflow == 0)
+			return n;
+	}
+
+	DPLANE_PROV_LOCK(prov);
+
+	while (n < max && (ctx = dplane_ctx_list_pop(&q->list)) != NULL) {
+		ctxs[n++] = ctx;
+		if (q->ring)
+			atomic_fetch_sub_explicit(&q->overflow, 1,
+						  memory_order_release);
+	}
+
+	DPLANE_PROV_UNLOCK(prov);
+
+	return n;
+}
+
+/* Move all of 'list' onto a provider queue */
+static void dplane_prov_q_push_list(struct zebra_dplane_provider *prov,
+				    struct dplane_prov_queue *q,
+				    struct dplane_ctx_list_head *list)
+{
+	struct zebra_dplane_ctx *batch[DPLANE_RING_BATCH];
+	struct zebra_dplane_ctx *ctx;
+	uint32_t n;
+
+	if (!q->ring) {
+		DPLANE_PROV_LOCK(prov);
+		while ((ctx = dplane_ctx_list_pop(list)) != NULL)
+			dplane_ctx_list_add_tail(&q->list, ctx);
+		DPLANE_PROV_UNLOCK(prov);
+		return;
+	}
+
+	do {
+		for (n = 0; n < DPLANE_RING_BATCH; n++) {
+			batch[n] = dplane_ctx_list_pop(list);
+			if (!batch[n])
+				break;
+		}
+		dplane_prov_q_push(prov, q, batch, n);
+	} while (n == DPLANE_RING_BATCH);
+}
+
+/* Move up to 'limit' contexts from a provider queue to 'list' */
+static int dplane_prov_q_pop_list(struct zebra_dplane_provider *prov,
+				  struct dplane_prov_queue *q,
+				  struct dplane_ctx_list_head *list, int limit)
+{
+	struct zebra_dplane_ctx *batch[DPLANE_RING_BATCH];
+	struct zebra_dplane_ctx *ctx;
+	uint32_t n, want, i;
+	int count = 0;
+
+	if (!q->ring) {
+		DPLANE_PROV_LOCK(prov);
+		while (count < limit &&
+		       (ctx = dplane_ctx_list_pop(&q->list)) != NULL) {
+			dplane_ctx_list_add_tail(list, ctx);
+			count++;
+		}
+		DPLANE_PROV_UNLOCK(prov);
+		return count;
+	}
+
+	while (count < limit) {
+		want = MIN(limit - count, DPLANE_RING_BATCH);
+		n = dplane_prov_q_pop(prov, q, batch, want);
+		for (i = 0; i < n; i++)
+			dplane_ctx_list_add_tail(list, batch[i]);
+		count += n;
+		if (n < want)
+			break;
+	}
+
+	return count;
+}
+
 /* Prototypes */
 static void dplane_thread_loop(struct event *event);
+static uint32_t dplane_update_batch_len(void);
 static enum zebra_dplane_result lsp_update_internal(struct zebra_lsp *lsp,
 						    enum dplane_op_e op);
 static enum zebra_dplane_result pw_update_internal(struct zebra_pw *pw,
@@ -728,14 +1056,8 @@ uint32_t zebra_dplane_get_work_limit(void)
  */
 struct zebra_dplane_ctx *dplane_ctx_alloc(void)
 {
-	struct zebra_dplane_ctx *p;
-
-	/* TODO -- just alloc'ing memory, but would like to maintain
-	 * a pool
-	 */
-	p = XCALLOC(MTYPE_DP_CTX, sizeof(struct zebra_dplane_ctx));
-
-	return p;
+	/* Comes back zeroed, whether new or reused */
+	return slab_alloc(zdplane_info.dg_ctx_slab);
 }
 
 /* Enable system route notifications */
@@ -744,6 +1066,150 @@ void dplane_enable_sys_route_notifs(void)
 	zdplane_info.dg_sys_route_notifs = true;
 }
 
+/*
+ * Route nexthop snapshots
+ */
+static struct dplane_nhg_snap *
+dplane_nhg_snap_new(const struct nexthop_group *nhg)
+{
+	struct dplane_nhg_snap *snap;
+	struct nexthop *nh;
+
+	/* EVPN encapsulation is filled in per context, so can't be shared */
+	for (ALL_NEXTHOPS_PTR(nhg, nh))
+		if (CHECK_FLAG(nh->flags, NEXTHOP_FLAG_EVPN))
+			return NULL;
+
+	snap = XCALLOC(MTYPE_DP_NHG_SNAP, sizeof(*snap));
+	copy_nexthops(&snap->ng.nexthop, nhg->nexthop, NULL);
+	for (ALL_NEXTHOPS(snap->ng, nh))
+		UNSET_FLAG(nh->flags, NEXTHOP_FLAG_FIB);
+
+	atomic_store_explicit(&snap->refcnt, 1, memory_order_relaxed);
+
+	return snap;
+}
+
+void dplane_nhg_snap_release(struct dplane_nhg_snap **snapp)
+{
+	struct dplane_nhg_snap *snap = *snapp;
+	struct nexthop *fib;
+
+	if (!snap)
+		return;
+
+	*snapp = NULL;
+
+	if (atomic_fetch_sub_explicit(&snap->refcnt, 1,
+				      memory_order_acq_rel) != 1)
+		return;
+
+	nexthops_free(snap->ng.nexthop);
+	fib = atomic_load_explicit(&snap->fib, memory_order_acquire);
+	nexthops_free(fib);
+	XFREE(MTYPE_DP_NHG_SNAP, snap);
+}
+
+/*
+ * Does a snapshot still match 'nhg', the same nexthops (resolved ones
+ * included) with the same attributes, apart from FIB flags?
+ */
+static bool dplane_nhg_snap_current(const struct dplane_nhg_snap *snap,
+				    const struct nexthop_group *nhg)
+{
+	const struct nexthop *a = snap->ng.nexthop;
+	const struct nexthop *b = nhg->nexthop;
+
+	while (a && b) {
+		if (nexthop_cmp(a, b) != 0)
+			return false;
+		if ((a->flags ^ b->flags) & ~NEXTHOP_FLAG_FIB)
+			return false;
+		if (!a->resolved != !b->resolved)
+			return false;
+		if (a->nh_label_type != b->nh_label_type ||
+		    a->nh_encap_type != b->nh_encap_type ||
+		    a->nh_encap.vni != b->nh_encap.vni ||
+		    memcmp(&a->rmac, &b->rmac, sizeof(a->rmac)))
+			return false;
+
+		a = nexthop_next(a);
+		b = nexthop_next(b);
+	}
+
+	return !a && !b;
+}
+
+/*
+ * Take a reference to a snapshot of an nhe's nexthops, reusing the one
+ * cached on the nhe if it is still current. Returns NULL if the context
+ * needs a copy of its own. Called in the zebra main pthread only.
+ */
+static struct dplane_nhg_snap *dplane_nhg_snap_get(struct nhg_hash_entry *nhe)
+{
+	if (nhe->dp_snap && !dplane_nhg_snap_current(nhe->dp_snap, &nhe->nhg))
+		dplane_nhg_snap_release(&nhe->dp_snap);
+
+	if (nhe->dp_snap) {
+		atomic_fetch_add_explicit(&zdplane_info.dg_nhg_snaps_shared, 1,
+					  memory_order_relaxed);
+	} else {
+		nhe->dp_snap = dplane_nhg_snap_new(&nhe->nhg);
+		if (!nhe->dp_snap)
+			return NULL;
+
+		atomic_fetch_add_explicit(&zdplane_info.dg_nhg_snaps_made, 1,
+					  memory_order_relaxed);
+	}
+
+	atomic_fetch_add_explicit(&nhe->dp_snap->refcnt, 1,
+				  memory_order_relaxed);
+
+	return nhe->dp_snap;
+}
+
+/*
+ * The installed variant of a snapshot's nexthops. Several pthreads may get
+ * here for one snapshot; the first copy published wins.
+ */
+static struct nexthop *dplane_nhg_snap_fib(struct dplane_nhg_snap *snap)
+{
+	struct nexthop_group ng = {};
+	struct nexthop *nh, *fib;
+
+	fib = atomic_load_explicit(&snap->fib, memory_order_acquire);
+	if (fib)
+		return fib;
+
+	copy_nexthops(&ng.nexthop, snap->ng.nexthop, NULL);
+	for (ALL_NEXTHOPS(ng, nh)) {
+		if (!CHECK_FLAG(nh->flags, NEXTHOP_FLAG_RECURSIVE) &&
+		    CHECK_FLAG(nh->flags, NEXTHOP_FLAG_ACTIVE))
+			SET_FLAG(nh->flags, NEXTHOP_FLAG_FIB);
+	}
+
+	if (!atomic_compare_exchange_strong_explicit(&snap->fib, &fib,
+						     ng.nexthop,
+						     memory_order_acq_rel,
+						     memory_order_acquire)) {
+		nexthops_free(ng.nexthop);
+		return fib;
+	}
+
+	return ng.nexthop;
+}
+
+/* Release a route context's nexthops, whether its own or a snapshot's */
+static void dplane_ctx_route_free_ng(struct zebra_dplane_ctx *ctx)
+{
+	if (ctx->u.rinfo.zd_ng_snap)
+		dplane_nhg_snap_release(&ctx->u.rinfo.zd_ng_snap);
+	else
+		nexthops_free(ctx->u.rinfo.zd_ng.nexthop);
+
+	ctx->u.rinfo.zd_ng.nexthop = NULL;
+}
+
 /*
  * Clean up dependent/internal allocations inside a context object
  */
@@ -763,13 +1229,8 @@ static void dplane_ctx_free_internal(struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_SYS_ROUTE_DELETE:
 	case DPLANE_OP_ROUTE_NOTIFY:
 
-		/* Free allocated nexthops */
-		if (ctx->u.rinfo.zd_ng.nexthop) {
-			/* This deals with recursive nexthops too */
-			nexthops_free(ctx->u.rinfo.zd_ng.nexthop);
-
-			ctx->u.rinfo.zd_ng.nexthop = NULL;
-		}
+		/* Free allocated nexthops, or drop the snapshot */
+		dplane_ctx_route_free_ng(ctx);
 
 		/* Free backup info also (if present) */
 		if (ctx->u.rinfo.backup_ng.nexthop) {
@@ -945,16 +1406,13 @@ static void dplane_ctx_free(struct zebra_dplane_ctx **pctx)
 
 	DPLANE_CTX_VALID(*pctx);
 
-	/* TODO -- just freeing memory, but would like to maintain
-	 * a pool
-	 */
-
 	/* Some internal allocations may need to be freed, depending on
 	 * the type of info captured in the ctx.
 	 */
 	dplane_ctx_free_internal(*pctx);
 
-	XFREE(MTYPE_DP_CTX, *pctx);
+	slab_free(zdplane_info.dg_ctx_slab, *pctx);
+	*pctx = NULL;
 }
 
 /*
@@ -972,10 +1430,55 @@ void dplane_ctx_reset(struct zebra_dplane_ctx *ctx)
  */
 void dplane_ctx_fini(struct zebra_dplane_ctx **pctx)
 {
-	/* TODO -- maintain pool; for now, just free */
+	/* The context goes back to the pool */
 	dplane_ctx_free(pctx);
 }
 
+static void dplane_ctx_lat_mark_at(struct zebra_dplane_ctx *ctx,
+				   enum zebra_lat_stage stage, uint32_t now)
+{
+	zebra_lat_add(stage, (uint32_t)(now - ctx->zd_lat_stamp));
+	ctx->zd_lat_stamp = now;
+	ctx->zd_lat_stage = stage;
+}
+
+/*
+ * Route install latency: account the time since the previous stage
+ */
+void dplane_ctx_lat_mark(struct zebra_dplane_ctx *ctx,
+			 enum zebra_lat_stage stage)
+{
+	if (!ctx->zd_lat_stamp || stage <= ctx->zd_lat_stage)
+		return;
+
+	dplane_ctx_lat_mark_at(ctx, stage, zebra_lat_stamp());
+}
+
+void dplane_ctx_list_lat_mark(struct dplane_ctx_list_head *list,
+			      enum zebra_lat_stage stage)
+{
+	struct zebra_dplane_ctx *ctx;
+	uint32_t now = 0;
+
+	frr_each (dplane_ctx_list, list, ctx) {
+		if (!ctx->zd_lat_stamp || stage <= ctx->zd_lat_stage)
+			continue;
+
+		if (!now)
+			now = zebra_lat_stamp();
+		dplane_ctx_lat_mark_at(ctx, stage, now);
+	}
+}
+
+void dplane_ctx_lat_finish(struct zebra_dplane_ctx *ctx)
+{
+	if (!ctx->zd_lat_stamp)
+		return;
+
+	zebra_lat_record(ZEBRA_LAT_TOTAL, ctx->zd_lat_origin);
+	ctx->zd_lat_stamp = 0;
+}
+
 /* Init a list of contexts */
 void dplane_ctx_q_init(struct dplane_ctx_list_head *q)
 {
@@ -2276,10 +2779,7 @@ void dplane_ctx_set_nexthops(struct zebra_dplane_ctx *ctx, struct nexthop *nh)
 {
 	DPLANE_CTX_VALID(ctx);
 
-	if (ctx->u.rinfo.zd_ng.nexthop) {
-		nexthops_free(ctx->u.rinfo.zd_ng.nexthop);
-		ctx->u.rinfo.zd_ng.nexthop = NULL;
-	}
+	dplane_ctx_route_free_ng(ctx);
 	nexthop_group_copy_nh_sorted(&(ctx->u.rinfo.zd_ng), nh);
 }
 
@@ -3678,7 +4178,28 @@ void dplane_set_in_queue_limit(uint32_t limit, bool set)
 uint32_t dplane_get_in_queue_len(void)
 {
 	return atomic_load_explicit(&zdplane_info.dg_routes_queued,
-				    memory_order_seq_cst);
+				    memory_order_seq_cst) +
+	       dplane_update_batch_len();
+}
+
+uint32_t dplane_get_in_queue_max(void)
+{
+	return atomic_load_explicit(&zdplane_info.dg_routes_queued_max,
+				    memory_order_relaxed);
+}
+
+/*
+ * Configure the number of kernel update shards; used at startup only.
+ */
+void dplane_set_shard_count(uint32_t count)
+{
+	dplane_shard_config = MAX(1U, MIN(count, (uint32_t)DPLANE_SHARDS_MAX));
+}
+
+uint32_t dplane_get_shard_count(void)
+{
+	return zdplane_info.dg_shard_count ? zdplane_info.dg_shard_count
+					   : dplane_shard_config;
 }
 
 void dplane_ctx_set_vlan_ifindex(struct zebra_dplane_ctx *ctx, ifindex_t ifindex)
@@ -3710,19 +4231,55 @@ dplane_ctx_get_vxlan_vlan_array(struct zebra_dplane_ctx *ctx)
 	return ctx->u.vlan_info.vlan_array;
 }
 
+/* Only route updates are spread across kernel update shards */
+static bool dplane_op_is_sharded(enum dplane_op_e op)
+{
+	switch (op) {
+	case DPLANE_OP_ROUTE_INSTALL:
+	case DPLANE_OP_ROUTE_UPDATE:
+	case DPLANE_OP_ROUTE_DELETE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static uint32_t dplane_shard_select(const struct zebra_dplane_ctx *ctx,
+				    const struct zebra_ns *zns)
+{
+	if (zdplane_info.dg_shard_count <= 1 || !dplane_op_is_sharded(ctx->zd_op))
+		return 0;
+
+	return jhash_2words(zns->ns_id, ctx->zd_table_id, 0) %
+	       zdplane_info.dg_shard_count;
+}
+
+#if defined(HAVE_NETLINK)
+/* Outbound netlink socket used by a shard in a namespace */
+static struct nlsock *dplane_shard_nlsock(struct zebra_ns *zns, uint32_t shard)
+{
+	if (shard == 0 || !zns->netlink_dplane_shards)
+		return &zns->netlink_dplane_out;
+
+	return &zns->netlink_dplane_shards[shard - 1];
+}
+#endif
+
 /*
  * Internal helper that copies information from a zebra ns object; this is
  * called in the zebra main pthread context as part of dplane ctx init.
  */
 static void ctx_info_from_zns(struct zebra_dplane_info *ns_info,
-			      struct zebra_ns *zns)
+			      struct zebra_ns *zns, uint32_t shard)
 {
 	ns_info->ns_id = zns->ns_id;
 
 #if defined(HAVE_NETLINK)
+	struct nlsock *nls = dplane_shard_nlsock(zns, shard);
+
 	ns_info->is_cmd = true;
-	ns_info->sock = zns->netlink_dplane_out.sock;
-	ns_info->seq = zns->netlink_dplane_out.seq;
+	ns_info->sock = nls->sock;
+	ns_info->seq = nls->seq;
 #endif /* NETLINK */
 }
 
@@ -3733,7 +4290,12 @@ static int dplane_ctx_ns_init(struct zebra_dplane_ctx *ctx,
 			      struct zebra_ns *zns,
 			      bool is_update)
 {
-	ctx_info_from_zns(&(ctx->zd_ns_info), zns); /*  */
+#if defined(HAVE_NETLINK)
+	struct nlsock *nls;
+#endif
+
+	ctx->zd_shard = dplane_shard_select(ctx, zns);
+	ctx_info_from_zns(&(ctx->zd_ns_info), zns, ctx->zd_shard);
 
 	ctx->zd_is_update = is_update;
 
@@ -3741,10 +4303,11 @@ static int dplane_ctx_ns_init(struct zebra_dplane_ctx *ctx,
 	/* Increment message counter after copying to context struct - may need
 	 * two messages in some 'update' cases.
 	 */
+	nls = dplane_shard_nlsock(zns, ctx->zd_shard);
 	if (is_update)
-		zns->netlink_dplane_out.seq += 2;
+		nls->seq += 2;
 	else
-		zns->netlink_dplane_out.seq++;
+		nls->seq++;
 #endif	/* HAVE_NETLINK */
 
 	return AOK;
@@ -3797,11 +4360,11 @@ int dplane_ctx_route_init_basic(struct zebra_dplane_ctx *ctx,
 	ctx->u.rinfo.zd_metric = re->metric;
 	ctx->u.rinfo.zd_old_metric = re->metric;
 	ctx->zd_vrf_id = re->vrf_id;
-	ctx->u.rinfo.zd_mtu = re->mtu;
+	ctx->u.rinfo.zd_mtu = re_mtu(re);
 	ctx->u.rinfo.zd_nexthop_mtu = re->nexthop_mtu;
 	ctx->u.rinfo.zd_instance = re->instance;
-	ctx->u.rinfo.zd_tag = re->tag;
-	ctx->u.rinfo.zd_old_tag = re->tag;
+	ctx->u.rinfo.zd_tag = re_tag(re);
+	ctx->u.rinfo.zd_old_tag = re_tag(re);
 	ctx->u.rinfo.zd_distance = re->distance;
 
 	return AOK;
@@ -3852,9 +4415,22 @@ int dplane_ctx_route_init(struct zebra_dplane_ctx *ctx, enum dplane_op_e op,
 					info->safi) != AOK)
 		return ret;
 
-	/* Copy nexthops; recursive info is included too */
-	copy_nexthops(&(ctx->u.rinfo.zd_ng.nexthop),
-		      re->nhe->nhg.nexthop, NULL);
+	/* Track latency from when the update reached the dest */
+	if (rn->info)
+		ctx->zd_lat_origin = rib_dest_from_rnode(rn)->mq_stamp;
+
+	/* Reference the nexthops, or copy them; recursive info is included
+	 * too. BSD's routing socket code marks nexthops in the context as it
+	 * installs them, so it always gets a copy.
+	 */
+#ifdef HAVE_NETLINK
+	ctx->u.rinfo.zd_ng_snap = dplane_nhg_snap_get(re->nhe);
+#endif
+	if (ctx->u.rinfo.zd_ng_snap)
+		ctx->u.rinfo.zd_ng.nexthop = ctx->u.rinfo.zd_ng_snap->ng.nexthop;
+	else
+		copy_nexthops(&(ctx->u.rinfo.zd_ng.nexthop),
+			      re->nhe->nhg.nexthop, NULL);
 	ctx->u.rinfo.zd_nhg_id = re->nhe->id;
 
 	/* Copy backup nexthop info, if present */
@@ -3865,10 +4441,12 @@ int dplane_ctx_route_init(struct zebra_dplane_ctx *ctx, enum dplane_op_e op,
 
 	/*
 	 * Ensure that the dplane nexthops' flags are clear and copy
-	 * encapsulation information.
+	 * encapsulation information. A snapshot is read-only, and already
+	 * has its flags clear and no EVPN nexthops.
 	 */
 	for (ALL_NEXTHOPS(ctx->u.rinfo.zd_ng, nexthop)) {
-		UNSET_FLAG(nexthop->flags, NEXTHOP_FLAG_FIB);
+		if (!ctx->u.rinfo.zd_ng_snap)
+			UNSET_FLAG(nexthop->flags, NEXTHOP_FLAG_FIB);
 
 		/* Optionally capture extra interface info while we're in the
 		 * main zebra pthread - a plugin has to ask for this info.
@@ -4575,15 +5153,20 @@ dplane_ctx_ipset_entry_init(struct zebra_dplane_ctx *ctx, enum dplane_op_e op,
  * Enqueue a new update,
  * and ensure an event is active for the dataplane pthread.
  */
-static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
+static int dplane_update_enqueue_list(struct dplane_ctx_list_head *list)
 {
 	int ret = EINVAL;
-	uint32_t high, curr;
+	uint32_t high, curr, count;
+	struct zebra_dplane_ctx *ctx;
+
+	count = dplane_ctx_list_count(list);
 
 	/* Enqueue for processing by the dataplane pthread */
 	DPLANE_LOCK();
 	{
-		dplane_ctx_list_add_tail(&zdplane_info.dg_update_list, ctx);
+		while ((ctx = dplane_ctx_list_pop(list)))
+			dplane_ctx_list_add_tail(&zdplane_info.dg_update_list,
+						 ctx);
 		curr = dplane_ctx_queue_count(&zdplane_info.dg_update_list);
 		high = atomic_load_explicit(&zdplane_info.dg_incoming_q_max, memory_order_relaxed);
 		if (curr > high)
@@ -4594,9 +5177,9 @@ static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
 
 	curr = atomic_fetch_add_explicit(
 		&(zdplane_info.dg_routes_queued),
-		1, memory_order_seq_cst);
+		count, memory_order_seq_cst);
 
-	curr++;	/* We got the pre-incremented value */
+	curr += count;	/* We got the pre-incremented value */
 
 	/* Maybe update high-water counter also */
 	high = atomic_load_explicit(&zdplane_info.dg_routes_queued_max,
@@ -4616,6 +5199,76 @@ static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
 	return ret;
 }
 
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+/*
+ * Updates enqueued by zebra main between dplane_update_batch_begin/end
+ * are held and handed to the dataplane pthread as one list: one lock,
+ * one wakeup, and the kernel provider sees them together, so it packs
+ * them into shared netlink batches.
+ */
+static thread_local struct {
+	unsigned int depth;
+	struct dplane_ctx_list_head ctxs;
+} update_batch;
+
+void dplane_update_batch_begin(void)
+{
+	if (update_batch.depth++)
+		return;
+
+	dplane_ctx_list_init(&update_batch.ctxs);
+}
+
+void dplane_update_batch_end(void)
+{
+	uint32_t count;
+
+	assert(update_batch.depth);
+	if (--update_batch.depth)
+		return;
+
+	count = dplane_ctx_list_count(&update_batch.ctxs);
+	if (count) {
+		dplane_update_enqueue_list(&update_batch.ctxs);
+		atomic_fetch_add_explicit(&zdplane_info.dg_update_batches, 1,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&zdplane_info.dg_updates_batched,
+					  count, memory_order_relaxed);
+	}
+	dplane_ctx_list_fini(&update_batch.ctxs);
+}
+
+static uint32_t dplane_update_batch_len(void)
+{
+	if (!update_batch.depth)
+		return 0;
+
+	return dplane_ctx_list_count(&update_batch.ctxs);
+}
+
+static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
+{
+	struct dplane_ctx_list_head temp_list;
+
+	/* rib_process is the stage that produced the update */
+	if (ctx->zd_lat_origin) {
+		ctx->zd_lat_stamp = zebra_lat_stamp();
+		ctx->zd_lat_stage = ZEBRA_LAT_RIB_PROCESS;
+	}
+
+	if (update_batch.depth) {
+		dplane_ctx_list_add_tail(&update_batch.ctxs, ctx);
+		return 0;
+	}
+
+	dplane_ctx_list_init(&temp_list);
+	dplane_ctx_list_add_tail(&temp_list, ctx);
+	return dplane_update_enqueue_list(&temp_list);
+}
+
 /*
  * Utility that prepares a route update and enqueues it for processing
  */
@@ -4645,7 +5298,7 @@ dplane_route_update_internal(struct route_node *rn,
 				zebra_router_get_next_sequence();
 			ctx->zd_old_seq = old_re->dplane_sequence;
 
-			ctx->u.rinfo.zd_old_tag = old_re->tag;
+			ctx->u.rinfo.zd_old_tag = re_tag(old_re);
 			ctx->u.rinfo.zd_old_type = old_re->type;
 			ctx->u.rinfo.zd_old_instance = old_re->instance;
 			ctx->u.rinfo.zd_old_distance = old_re->distance;
@@ -4998,8 +5651,7 @@ dplane_route_notif_update(struct route_node *rn,
 	if (op == DPLANE_OP_ROUTE_UPDATE ||
 	    op == DPLANE_OP_ROUTE_INSTALL) {
 
-		nexthops_free(new_ctx->u.rinfo.zd_ng.nexthop);
-		new_ctx->u.rinfo.zd_ng.nexthop = NULL;
+		dplane_ctx_route_free_ng(new_ctx);
 
 		nhg = rib_get_fib_nhg(re);
 		if (nhg && nhg->nexthop)
@@ -6309,6 +6961,7 @@ dplane_srv6_encap_srcaddr_set(const struct in6_addr *addr, ns_id_t ns_id)
 int dplane_show_helper(struct vty *vty, bool detailed)
 {
 	uint64_t queued, queue_max, limit, errs, incoming, yields, other_errs, kernels_skipped;
+	uint32_t i;
 
 	/* Using atomics because counters are being changed in different
 	 * pthread contexts.
@@ -6348,6 +7001,53 @@ int dplane_show_helper(struct vty *vty, bool detailed)
 	vty_out(vty, "Route updates skipped:    %" PRIu64 "\n", kernels_skipped);
 	vty_out(vty, "Dplane update yields:     %"PRIu64"\n", yields);
 
+	incoming = atomic_load_explicit(&zdplane_info.dg_update_batches,
+					memory_order_relaxed);
+	queued = atomic_load_explicit(&zdplane_info.dg_updates_batched,
+				      memory_order_relaxed);
+	vty_out(vty, "Batched update handoffs:  %" PRIu64 " (%" PRIu64 " updates)\n",
+		incoming, queued);
+
+	incoming = atomic_load_explicit(&zdplane_info.dg_nhg_snaps_made,
+					memory_order_relaxed);
+	queued = atomic_load_explicit(&zdplane_info.dg_nhg_snaps_shared,
+				      memory_order_relaxed);
+	vty_out(vty, "Route nexthop snapshots:  %" PRIu64 " (%" PRIu64 " reused)\n",
+		incoming, queued);
+
+	if (detailed) {
+		struct slab_stats st;
+
+		slab_get_stats(zdplane_info.dg_ctx_slab, &st);
+		vty_out(vty,
+			"Context pool:             %zu in use, %zu free, %zu bytes\n",
+			st.in_use, st.free, st.bytes);
+
+		vty_out(vty, "Meta queue depth:         %u (max %u)\n",
+			zebra_rib_meta_queue_size(),
+			zebra_rib_meta_queue_max());
+		vty_out(vty, "Results queue depth:      %u (max %u)\n",
+			zebra_rib_dplane_results_count(),
+			zebra_rib_dplane_results_max());
+		zebra_lat_show(vty);
+	}
+
+	if (zdplane_info.dg_shard_count > 1) {
+		vty_out(vty, "Kernel update shards:     %u\n",
+			zdplane_info.dg_shard_count);
+		for (i = 0; detailed && i < zdplane_info.dg_shard_count; i++) {
+			struct dplane_shard *shard = &zdplane_info.dg_shards[i];
+
+			vty_out(vty,
+				"  Shard %u: %u route updates in %u passes\n",
+				shard->ds_id,
+				atomic_load_explicit(&shard->ds_routes,
+						     memory_order_relaxed),
+				atomic_load_explicit(&shard->ds_passes,
+						     memory_order_relaxed));
+		}
+	}
+
 	incoming = atomic_load_explicit(&zdplane_info.dg_lsps_in,
 					memory_order_relaxed);
 	errs = atomic_load_explicit(&zdplane_info.dg_lsp_errors,
@@ -6376,6 +7076,10 @@ int dplane_show_helper(struct vty *vty, bool detailed)
 	vty_out(vty, "Intf change updates:        %" PRIu64 "\n", incoming);
 	vty_out(vty, "Intf change errors:         %" PRIu64 "\n", errs);
 
+	incoming = atomic_load_explicit(&zdplane_info.dg_intf_links_coalesced,
+					memory_order_relaxed);
+	vty_out(vty, "Intf link updates coalesced: %" PRIu64 "\n", incoming);
+
 	incoming = atomic_load_explicit(&zdplane_info.dg_macs_in,
 					memory_order_relaxed);
 	errs = atomic_load_explicit(&zdplane_info.dg_mac_errors,
@@ -6460,8 +7164,8 @@ int dplane_show_provs_helper(struct vty *vty, bool detailed)
 	/* Show counters, useful info from each registered provider */
 	while (prov) {
 		dplane_provider_lock(prov);
-		in_q = dplane_ctx_queue_count(&prov->dp_ctx_in_list);
-		out_q = dplane_ctx_queue_count(&prov->dp_ctx_out_list);
+		in_q = dplane_prov_q_count(&prov->dp_in_q);
+		out_q = dplane_prov_q_count(&prov->dp_out_q);
 		dplane_provider_unlock(prov);
 
 		in = atomic_load_explicit(&prov->dp_in_counter,
@@ -6536,8 +7240,16 @@ int dplane_provider_register(const char *name,
 	p = XCALLOC(MTYPE_DP_PROV, sizeof(struct zebra_dplane_provider));
 
 	pthread_mutex_init(&(p->dp_mutex), NULL);
-	dplane_ctx_list_init(&p->dp_ctx_in_list);
-	dplane_ctx_list_init(&p->dp_ctx_out_list);
+	dplane_ctx_list_init(&p->dp_in_q.list);
+	dplane_ctx_list_init(&p->dp_out_q.list);
+
+	/* Room for a couple of work cycles before falling back to the lists */
+	if (CHECK_FLAG(flags, DPLANE_PROV_FLAG_RING)) {
+		p->dp_in_q.ring =
+			dplane_ctx_ring_new(2 * zdplane_info.dg_updates_per_cycle);
+		p->dp_out_q.ring =
+			dplane_ctx_ring_new(2 * zdplane_info.dg_updates_per_cycle);
+	}
 
 	p->dp_flags = flags;
 	p->dp_priority = prio;
@@ -6625,11 +7337,8 @@ struct zebra_dplane_ctx *dplane_provider_dequeue_in_ctx(
 {
 	struct zebra_dplane_ctx *ctx = NULL;
 
-	dplane_provider_lock(prov);
-
-	ctx = dplane_ctx_list_pop(&(prov->dp_ctx_in_list));
-
-	dplane_provider_unlock(prov);
+	if (dplane_prov_q_pop(prov, &prov->dp_in_q, &ctx, 1) == 0)
+		return NULL;
 
 	return ctx;
 }
@@ -6640,24 +7349,20 @@ struct zebra_dplane_ctx *dplane_provider_dequeue_in_ctx(
 int dplane_provider_dequeue_in_list(struct zebra_dplane_provider *prov,
 				    struct dplane_ctx_list_head *listp)
 {
-	int limit, ret;
-	struct zebra_dplane_ctx *ctx;
-
-	limit = zdplane_info.dg_updates_per_cycle;
-
-	dplane_provider_lock(prov);
-
-	for (ret = 0; ret < limit; ret++) {
-		ctx = dplane_ctx_list_pop(&(prov->dp_ctx_in_list));
-		if (ctx)
-			dplane_ctx_list_add_tail(listp, ctx);
-		else
-			break;
-	}
+	return dplane_prov_q_pop_list(prov, &prov->dp_in_q, listp,
+				      zdplane_info.dg_updates_per_cycle);
+}
 
-	dplane_provider_unlock(prov);
+/*
+ * Dequeue work to an array, return count
+ */
+int dplane_provider_dequeue_in_batch(struct zebra_dplane_provider *prov,
+				     struct zebra_dplane_ctx **ctxs, int max)
+{
+	if (max <= 0)
+		return 0;
 
-	return ret;
+	return dplane_prov_q_pop(prov, &prov->dp_in_q, ctxs, max);
 }
 
 uint32_t dplane_provider_out_ctx_queue_len(struct zebra_dplane_provider *prov)
@@ -6671,34 +7376,41 @@ uint32_t dplane_provider_out_ctx_queue_len(struct zebra_dplane_provider *prov)
  */
 void dplane_provider_enqueue_out_ctx(struct zebra_dplane_provider *prov,
 				     struct zebra_dplane_ctx *ctx)
+{
+	dplane_provider_enqueue_out_batch(prov, &ctx, 1);
+}
+
+/*
+ * Enqueue an array of completed work, maintain associated counters
+ */
+void dplane_provider_enqueue_out_batch(struct zebra_dplane_provider *prov,
+				       struct zebra_dplane_ctx **ctxs, int count)
 {
 	uint64_t curr, high;
 
-	dplane_provider_lock(prov);
+	if (count <= 0)
+		return;
 
-	dplane_ctx_list_add_tail(&(prov->dp_ctx_out_list), ctx);
+	dplane_prov_q_push(prov, &prov->dp_out_q, ctxs, count);
 
 	/* Maintain out-queue counters */
-	curr = dplane_ctx_queue_count(&prov->dp_ctx_out_list);
+	curr = dplane_prov_q_count(&prov->dp_out_q);
 	high = atomic_load_explicit(&prov->dp_out_max,
 				    memory_order_relaxed);
 	if (curr > high)
 		atomic_store_explicit(&prov->dp_out_max, curr,
 				      memory_order_relaxed);
 
-	dplane_provider_unlock(prov);
-
-	atomic_fetch_add_explicit(&(prov->dp_out_counter), 1,
+	atomic_fetch_add_explicit(&(prov->dp_out_counter), count,
 				  memory_order_relaxed);
 }
 
 static struct zebra_dplane_ctx *
 dplane_provider_dequeue_out_ctx(struct zebra_dplane_provider *prov)
 {
-	struct zebra_dplane_ctx *ctx;
+	struct zebra_dplane_ctx *ctx = NULL;
 
-	ctx = dplane_ctx_list_pop(&(prov->dp_ctx_out_list));
-	if (!ctx)
+	if (dplane_prov_q_pop(prov, &prov->dp_out_q, &ctx, 1) == 0)
 		return NULL;
 
 	return ctx;
@@ -6848,6 +7560,125 @@ void dplane_provider_enqueue_ctx_list_to_zebra(struct dplane_ctx_list_head *batc
 	(zdplane_info.dg_results_cb)(batch_list);
 }
 
+/*
+ * Contexts for zebra main generated while a pthread reads a burst of OS
+ * notifications are held and handed over as one list. A link update for
+ * an interface that already has one held takes the held one's place, so
+ * an interface that flaps within a burst costs zebra a single update.
+ */
+struct dplane_zebra_batch {
+	unsigned int depth;
+	struct dplane_ctx_list_head ctxs;
+	struct dplane_link_hash_head links;
+};
+
+static thread_local struct dplane_zebra_batch zebra_batch;
+
+void dplane_zebra_batch_begin(void)
+{
+	if (zebra_batch.depth++)
+		return;
+
+	dplane_ctx_list_init(&zebra_batch.ctxs);
+	dplane_link_hash_init(&zebra_batch.links);
+}
+
+void dplane_zebra_batch_end(void)
+{
+	assert(zebra_batch.depth);
+	if (--zebra_batch.depth)
+		return;
+
+	while (dplane_link_hash_pop(&zebra_batch.links))
+		;
+	dplane_link_hash_fini(&zebra_batch.links);
+
+	if (dplane_ctx_list_count(&zebra_batch.ctxs))
+		(zdplane_info.dg_results_cb)(&zebra_batch.ctxs);
+	dplane_ctx_list_fini(&zebra_batch.ctxs);
+}
+
+/*
+ * Has anything for the link of 'held', or for its master, been queued
+ * since 'held'? Merging 'ctx' into 'held' moves its state ahead of that.
+ */
+static bool dplane_zebra_batch_touched(const struct zebra_dplane_ctx *held,
+				       const struct zebra_dplane_ctx *ctx)
+{
+	const struct zebra_dplane_ctx *other = held;
+	ifindex_t ifindex = held->zd_ifindex;
+
+	while ((other = dplane_ctx_list_const_next(&zebra_batch.ctxs, other))) {
+		if (other->zd_ns_info.ns_id != held->zd_ns_info.ns_id)
+			continue;
+
+		if (other->zd_ifindex == ifindex ||
+		    (held->u.intf.master_ifindex &&
+		     other->zd_ifindex == held->u.intf.master_ifindex) ||
+		    (ctx->u.intf.master_ifindex &&
+		     other->zd_ifindex == ctx->u.intf.master_ifindex))
+			return true;
+
+		/* A link enslaved to this one */
+		if ((other->zd_op == DPLANE_OP_INTF_INSTALL ||
+		     other->zd_op == DPLANE_OP_INTF_UPDATE ||
+		     other->zd_op == DPLANE_OP_INTF_DELETE) &&
+		    other->u.intf.master_ifindex == ifindex)
+			return true;
+	}
+
+	return false;
+}
+
+static void dplane_zebra_batch_add(struct zebra_dplane_ctx *ctx)
+{
+	struct zebra_dplane_ctx *held = NULL;
+	bool promisc_only;
+
+	/* Link messages only, not the AF_BRIDGE or AF_INET6 ones */
+	if ((ctx->zd_op == DPLANE_OP_INTF_INSTALL &&
+	     ctx->u.intf.family == AF_UNSPEC) ||
+	    ctx->zd_op == DPLANE_OP_INTF_DELETE)
+		held = dplane_link_hash_find(&zebra_batch.links, ctx);
+
+	if (held)
+		dplane_link_hash_del(&zebra_batch.links, held);
+
+	/* Never merge across a delete */
+	if (ctx->zd_op == DPLANE_OP_INTF_DELETE) {
+		dplane_ctx_list_add_tail(&zebra_batch.ctxs, ctx);
+		return;
+	}
+
+	if (ctx->zd_op != DPLANE_OP_INTF_INSTALL ||
+	    ctx->u.intf.family != AF_UNSPEC) {
+		dplane_ctx_list_add_tail(&zebra_batch.ctxs, ctx);
+		return;
+	}
+
+	/*
+	 * A NEWLINK carries the link's full state, so the newer one can
+	 * stand in for the held one. The change masks are merged, except
+	 * that a promiscuity-only change (which zebra handles quietly) is
+	 * not merged with anything else. The merged update takes the held
+	 * one's place, so nothing queued since for the link or its master
+	 * may be passed over: in that case, don't merge.
+	 */
+	promisc_only = ctx->u.intf.change_flags == IFF_PROMISC;
+	if (held && promisc_only == (held->u.intf.change_flags == IFF_PROMISC) &&
+	    !dplane_zebra_batch_touched(held, ctx)) {
+		ctx->u.intf.change_flags |= held->u.intf.change_flags;
+		dplane_ctx_list_add_after(&zebra_batch.ctxs, held, ctx);
+		dplane_ctx_list_del(&zebra_batch.ctxs, held);
+		dplane_ctx_fini(&held);
+		atomic_fetch_add_explicit(&zdplane_info.dg_intf_links_coalesced,
+					  1, memory_order_relaxed);
+	} else
+		dplane_ctx_list_add_tail(&zebra_batch.ctxs, ctx);
+
+	dplane_link_hash_add(&zebra_batch.links, ctx);
+}
+
 /*
  * Enqueue a context directly to zebra main.
  */
@@ -6855,6 +7686,11 @@ void dplane_provider_enqueue_to_zebra(struct zebra_dplane_ctx *ctx)
 {
 	struct dplane_ctx_list_head temp_list;
 
+	if (zebra_batch.depth) {
+		dplane_zebra_batch_add(ctx);
+		return;
+	}
+
 	/* Zebra's api takes a list, so we need to use a temporary list */
 	dplane_ctx_list_init(&temp_list);
 
@@ -7050,6 +7886,20 @@ static void kernel_dplane_log_detail(struct zebra_dplane_ctx *ctx)
 	}
 }
 
+/* Mark a route context's own nexthops as installed */
+static void dplane_ctx_route_mark_fib(struct zebra_dplane_ctx *ctx)
+{
+	struct nexthop *nexthop;
+
+	for (ALL_NEXTHOPS(ctx->u.rinfo.zd_ng, nexthop)) {
+		if (CHECK_FLAG(nexthop->flags, NEXTHOP_FLAG_RECURSIVE))
+			continue;
+
+		if (CHECK_FLAG(nexthop->flags, NEXTHOP_FLAG_ACTIVE))
+			SET_FLAG(nexthop->flags, NEXTHOP_FLAG_FIB);
+	}
+}
+
 static void kernel_dplane_handle_result(struct zebra_dplane_ctx *ctx)
 {
 	enum zebra_dplane_result res = dplane_ctx_get_status(ctx);
@@ -7059,29 +7909,23 @@ static void kernel_dplane_handle_result(struct zebra_dplane_ctx *ctx)
 	case DPLANE_OP_ROUTE_INSTALL:
 	case DPLANE_OP_ROUTE_UPDATE:
 	case DPLANE_OP_ROUTE_DELETE:
+		/* Unless the netlink batch code got here first */
+		dplane_ctx_lat_mark(ctx, ZEBRA_LAT_KERNEL);
+
 		if (res != ZEBRA_DPLANE_REQUEST_SUCCESS)
 			atomic_fetch_add_explicit(&zdplane_info.dg_route_errors,
 						  1, memory_order_relaxed);
 
 		if ((dplane_ctx_get_op(ctx) != DPLANE_OP_ROUTE_DELETE)
 		    && (res == ZEBRA_DPLANE_REQUEST_SUCCESS)) {
-			struct nexthop *nexthop;
-
 			/* Update installed nexthops to signal which have been
-			 * installed.
+			 * installed. A snapshot has a shared copy for that.
 			 */
-			for (ALL_NEXTHOPS_PTR(dplane_ctx_get_ng(ctx),
-					      nexthop)) {
-				if (CHECK_FLAG(nexthop->flags,
-					       NEXTHOP_FLAG_RECURSIVE))
-					continue;
-
-				if (CHECK_FLAG(nexthop->flags,
-					       NEXTHOP_FLAG_ACTIVE)) {
-					SET_FLAG(nexthop->flags,
-						 NEXTHOP_FLAG_FIB);
-				}
-			}
+			if (ctx->u.rinfo.zd_ng_snap)
+				ctx->u.rinfo.zd_ng.nexthop = dplane_nhg_snap_fib(
+					ctx->u.rinfo.zd_ng_snap);
+			else
+				dplane_ctx_route_mark_fib(ctx);
 		}
 		break;
 
@@ -7256,6 +8100,125 @@ kernel_dplane_process_ipset_entry(struct zebra_dplane_provider *prov,
 	dplane_provider_enqueue_out_ctx(prov, ctx);
 }
 
+/*
+ * Kernel update shard worker, runs one pass in the shard's pthread
+ */
+static void dplane_shard_work(struct event *event)
+{
+	struct dplane_shard *shard = EVENT_ARG(event);
+
+	kernel_update_multi(&shard->ds_work);
+
+	frr_with_mutex (&zdplane_info.dg_shard_mutex) {
+		if (--zdplane_info.dg_shards_busy == 0)
+			pthread_cond_signal(&zdplane_info.dg_shard_cond);
+	}
+}
+
+/*
+ * Run one kernel update pass on every shard with queued work, and wait for
+ * all of them; completed contexts are appended to 'done_list'.
+ */
+static void dplane_shards_run(struct dplane_ctx_list_head *done_list)
+{
+	struct dplane_shard *shard;
+	uint32_t i, count;
+
+	frr_with_mutex (&zdplane_info.dg_shard_mutex) {
+		for (i = 1; i < zdplane_info.dg_shard_count; i++) {
+			shard = &zdplane_info.dg_shards[i];
+			count = dplane_ctx_queue_count(&shard->ds_work);
+			if (count == 0)
+				continue;
+
+			atomic_fetch_add_explicit(&shard->ds_routes, count,
+						  memory_order_relaxed);
+			atomic_fetch_add_explicit(&shard->ds_passes, 1,
+						  memory_order_relaxed);
+			zdplane_info.dg_shards_busy++;
+			event_add_event(shard->ds_pthread->master,
+					dplane_shard_work, shard, 0,
+					&shard->ds_t_work);
+		}
+	}
+
+	/* Shard 0 is programmed from here while the others run */
+	shard = &zdplane_info.dg_shards[0];
+	count = dplane_ctx_queue_count(&shard->ds_work);
+	if (count) {
+		atomic_fetch_add_explicit(&shard->ds_routes, count,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&shard->ds_passes, 1,
+					  memory_order_relaxed);
+		kernel_update_multi(&shard->ds_work);
+	}
+
+	frr_with_mutex (&zdplane_info.dg_shard_mutex) {
+		while (zdplane_info.dg_shards_busy)
+			pthread_cond_wait(&zdplane_info.dg_shard_cond,
+					  &zdplane_info.dg_shard_mutex);
+	}
+
+	for (i = 0; i < zdplane_info.dg_shard_count; i++)
+		dplane_ctx_list_append(done_list,
+				       &zdplane_info.dg_shards[i].ds_work);
+}
+
+/*
+ * Program a list of contexts into the kernel. Route updates are handed to
+ * their shards and run in parallel; anything else (nexthop groups, for
+ * example) acts as a barrier and is programmed from the dplane pthread
+ * once preceding route updates are done, so that ordering between a
+ * route and the objects it depends on is kept.
+ */
+static void kernel_dplane_update(struct dplane_ctx_list_head *work_list)
+{
+	struct dplane_ctx_list_head serial_list, done_list;
+	struct zebra_dplane_ctx *ctx;
+	bool sharded = false;
+
+	if (zdplane_info.dg_shard_count <= 1) {
+		kernel_update_multi(work_list);
+		return;
+	}
+
+	dplane_ctx_list_init(&serial_list);
+	dplane_ctx_list_init(&done_list);
+
+	while ((ctx = dplane_ctx_list_pop(work_list)) != NULL) {
+		if (dplane_op_is_sharded(ctx->zd_op)) {
+			if (dplane_ctx_queue_count(&serial_list)) {
+				kernel_update_multi(&serial_list);
+				dplane_ctx_list_append(&done_list,
+						       &serial_list);
+			}
+
+			dplane_ctx_list_add_tail(
+				&zdplane_info.dg_shards[ctx->zd_shard].ds_work,
+				ctx);
+			sharded = true;
+			continue;
+		}
+
+		if (sharded) {
+			dplane_shards_run(&done_list);
+			sharded = false;
+		}
+
+		dplane_ctx_list_add_tail(&serial_list, ctx);
+	}
+
+	if (sharded)
+		dplane_shards_run(&done_list);
+
+	if (dplane_ctx_queue_count(&serial_list)) {
+		kernel_update_multi(&serial_list);
+		dplane_ctx_list_append(&done_list, &serial_list);
+	}
+
+	dplane_ctx_list_append(work_list, &done_list);
+}
+
 /*
  * Kernel provider callback
  */
@@ -7277,6 +8240,7 @@ static int kernel_dplane_process_func(struct zebra_dplane_provider *prov)
 		ctx = dplane_provider_dequeue_in_ctx(prov);
 		if (ctx == NULL)
 			break;
+		dplane_ctx_lat_mark(ctx, ZEBRA_LAT_DPLANE_QUEUE);
 		if (IS_ZEBRA_DEBUG_DPLANE_DETAIL)
 			kernel_dplane_log_detail(ctx);
 
@@ -7318,7 +8282,7 @@ static int kernel_dplane_process_func(struct zebra_dplane_provider *prov)
 			dplane_ctx_list_add_tail(&work_list, ctx);
 	}
 
-	kernel_update_multi(&work_list);
+	kernel_dplane_update(&work_list);
 
 	while ((ctx = dplane_ctx_list_pop(&work_list)) != NULL) {
 		kernel_dplane_handle_result(ctx);
@@ -7567,13 +8531,13 @@ static bool dplane_work_pending(void)
 
 		dplane_provider_lock(prov);
 
-		ctx = dplane_ctx_list_first(&(prov->dp_ctx_in_list));
-		if (ctx == NULL)
-			ctx = dplane_ctx_list_first(&(prov->dp_ctx_out_list));
+		if (dplane_prov_q_count(&prov->dp_in_q) > 0 ||
+		    dplane_prov_q_count(&prov->dp_out_q) > 0)
+			ret = true;
 
 		dplane_provider_unlock(prov);
 
-		if (ctx != NULL)
+		if (ret)
 			break;
 
 		prov = dplane_prov_list_next(&zdplane_info.dg_providers, prov);
@@ -7688,8 +8652,8 @@ static void dplane_thread_loop(struct event *event)
 	/* Locate initial registered provider */
 	prov = dplane_prov_list_first(&zdplane_info.dg_providers);
 
-	curr = dplane_ctx_queue_count(&prov->dp_ctx_in_list);
-	out_curr = dplane_ctx_queue_count(&prov->dp_ctx_out_list);
+	curr = dplane_prov_q_count(&prov->dp_in_q);
+	out_curr = dplane_prov_q_count(&prov->dp_out_q);
 
 	if (curr >= (uint64_t)limit) {
 		if (IS_ZEBRA_DEBUG_DPLANE_DETAIL)
@@ -7726,7 +8690,7 @@ static void dplane_thread_loop(struct event *event)
 	/*
 	 * If there is anything still on the two input queues reschedule
 	 */
-	if (dplane_ctx_queue_count(&prov->dp_ctx_in_list) > 0 ||
+	if (dplane_prov_q_count(&prov->dp_in_q) > 0 ||
 	    dplane_ctx_queue_count(&zdplane_info.dg_update_list) > 0)
 		reschedule = true;
 
@@ -7776,22 +8740,17 @@ static void dplane_thread_loop(struct event *event)
 		}
 
 		/* Enqueue new work to the provider */
-		dplane_provider_lock(prov);
-
-		while ((ctx = dplane_ctx_list_pop(&work_list)) != NULL)
-			dplane_ctx_list_add_tail(&(prov->dp_ctx_in_list), ctx);
+		dplane_prov_q_push_list(prov, &prov->dp_in_q, &work_list);
 
 		atomic_fetch_add_explicit(&prov->dp_in_counter, counter,
 					  memory_order_relaxed);
-		curr = dplane_ctx_queue_count(&prov->dp_ctx_in_list);
+		curr = dplane_prov_q_count(&prov->dp_in_q);
 		high = atomic_load_explicit(&prov->dp_in_max,
 					    memory_order_relaxed);
 		if (curr > high)
 			atomic_store_explicit(&prov->dp_in_max, curr,
 					      memory_order_relaxed);
 
-		dplane_provider_unlock(prov);
-
 		/* Reset the temp list (though the 'concat' may have done this
 		 * already), and the counter
 		 */
@@ -7822,16 +8781,12 @@ static void dplane_thread_loop(struct event *event)
 		next_prov = dplane_prov_list_next(&zdplane_info.dg_providers,
 						  prov);
 		if (next_prov) {
-			curr = dplane_ctx_queue_count(
-				&next_prov->dp_ctx_in_list);
-			out_curr = dplane_ctx_queue_count(
-				&next_prov->dp_ctx_out_list);
+			curr = dplane_prov_q_count(&next_prov->dp_in_q);
+			out_curr = dplane_prov_q_count(&next_prov->dp_out_q);
 		} else
 			out_curr = curr = 0;
 
 		/* Dequeue completed work from the provider */
-		dplane_provider_lock(prov);
-
 		if (curr >= (uint64_t)limit) {
 			if (IS_ZEBRA_DEBUG_DPLANE_DETAIL)
 				zlog_debug("%s: Next Provider(%s) Input queue is %" PRIu64
@@ -7853,15 +8808,8 @@ static void dplane_thread_loop(struct event *event)
 			 * in or out queue without going over
 			 */
 			tlimit = limit - MAX(curr, out_curr);
-			while (counter < tlimit) {
-				ctx = dplane_provider_dequeue_out_ctx(prov);
-				if (ctx) {
-					dplane_ctx_list_add_tail(&work_list,
-								 ctx);
-					counter++;
-				} else
-					break;
-			}
+			counter = dplane_prov_q_pop_list(prov, &prov->dp_out_q,
+							 &work_list, tlimit);
 		}
 
 		/*
@@ -7869,12 +8817,10 @@ static void dplane_thread_loop(struct event *event)
 		 * input or output queues of the current provider
 		 * if so then we know we need to reschedule.
 		 */
-		if (dplane_ctx_queue_count(&prov->dp_ctx_in_list) > 0 ||
-		    dplane_ctx_queue_count(&prov->dp_ctx_out_list) > 0)
+		if (dplane_prov_q_count(&prov->dp_in_q) > 0 ||
+		    dplane_prov_q_count(&prov->dp_out_q) > 0)
 			reschedule = true;
 
-		dplane_provider_unlock(prov);
-
 		if (counter >= limit)
 			reschedule = true;
 
@@ -7922,6 +8868,7 @@ static void dplane_thread_loop(struct event *event)
  */
 void zebra_dplane_shutdown(void)
 {
+	uint32_t i;
 	struct zebra_dplane_provider *dp;
 	struct zebra_dplane_ctx *ctx;
 	struct dplane_zns_info *zi;
@@ -7940,6 +8887,20 @@ void zebra_dplane_shutdown(void)
 	zdplane_info.dg_pthread = NULL;
 	zdplane_info.dg_master = NULL;
 
+	/* Stop kernel update shard pthreads; the dplane pthread waited for
+	 * their last pass, so they have no pending work.
+	 */
+	for (i = 1; i < zdplane_info.dg_shard_count; i++) {
+		struct dplane_shard *shard = &zdplane_info.dg_shards[i];
+
+		if (!shard->ds_pthread)
+			continue;
+
+		frr_pthread_stop(shard->ds_pthread, NULL);
+		frr_pthread_destroy(shard->ds_pthread);
+		shard->ds_pthread = NULL;
+	}
+
 	/* Notify provider(s) of final shutdown.
 	 * Note that this call is in the main pthread, so providers must
 	 * be prepared for that.
@@ -7956,6 +8917,8 @@ void zebra_dplane_shutdown(void)
 	while (dp) {
 		dplane_prov_list_del(&zdplane_info.dg_providers, dp);
 		pthread_mutex_destroy(&dp->dp_mutex);
+		XFREE(MTYPE_DP_PROV, dp->dp_in_q.ring);
+		XFREE(MTYPE_DP_PROV, dp->dp_out_q.ring);
 		XFREE(MTYPE_DP_PROV, dp);
 
 		dp = dplane_prov_list_first(&zdplane_info.dg_providers);
@@ -7984,29 +8947,61 @@ void zebra_dplane_shutdown(void)
 	/* Clean up any startup stage contexts in provider queues */
 	frr_each (dplane_prov_list, &zdplane_info.dg_providers, dp) {
 		/* Clean in-queue contexts */
-		ctx = dplane_ctx_list_pop(&dp->dp_ctx_in_list);
+		ctx = dplane_provider_dequeue_in_ctx(dp);
 		while (ctx) {
 			dplane_ctx_free(&ctx);
-			ctx = dplane_ctx_list_pop(&dp->dp_ctx_in_list);
+			ctx = dplane_provider_dequeue_in_ctx(dp);
 		}
 
 		/* Clean out-queue contexts */
-		ctx = dplane_ctx_list_pop(&dp->dp_ctx_out_list);
+		ctx = dplane_provider_dequeue_out_ctx(dp);
+		while (ctx) {
+			dplane_ctx_free(&ctx);
+			ctx = dplane_provider_dequeue_out_ctx(dp);
+		}
+	}
+
+	/* Clean up any contexts left on the shards */
+	for (i = 0; i < zdplane_info.dg_shard_count; i++) {
+		ctx = dplane_ctx_list_pop(&zdplane_info.dg_shards[i].ds_work);
 		while (ctx) {
 			dplane_ctx_free(&ctx);
-			ctx = dplane_ctx_list_pop(&dp->dp_ctx_out_list);
+			ctx = dplane_ctx_list_pop(
+				&zdplane_info.dg_shards[i].ds_work);
 		}
 	}
+	XFREE(MTYPE_DP_SHARD, zdplane_info.dg_shards);
+
+	pthread_cond_destroy(&zdplane_info.dg_shard_cond);
+	pthread_mutex_destroy(&zdplane_info.dg_shard_mutex);
 
 	/* Destroy global mutex */
 	pthread_mutex_destroy(&zdplane_info.dg_mutex);
 }
 
+/*
+ * Release the context pool, once zebra main has freed the contexts it
+ * still held.
+ */
+void zebra_dplane_ctx_pool_fini(void)
+{
+	struct slab_stats st;
+
+	slab_get_stats(zdplane_info.dg_ctx_slab, &st);
+	if (st.in_use)
+		zlog_warn("%s: %zu dataplane contexts still allocated",
+			  __func__, st.in_use);
+
+	slab_destroy(&zdplane_info.dg_ctx_slab);
+}
+
 /*
  * Initialize the dataplane module during startup, internal/private version
  */
 static void zebra_dplane_init_internal(void)
 {
+	uint32_t i;
+
 	memset(&zdplane_info, 0, sizeof(zdplane_info));
 
 	pthread_mutex_init(&zdplane_info.dg_mutex, NULL);
@@ -8023,6 +9018,23 @@ static void zebra_dplane_init_internal(void)
 
 	zdplane_info.dg_max_queued_updates = DPLANE_DEFAULT_MAX_QUEUED;
 
+	/* Enough contexts per chunk for a work cycle or so */
+	zdplane_info.dg_ctx_slab = slab_new(MTYPE_DP_CTX,
+					    sizeof(struct zebra_dplane_ctx),
+					    DPLANE_DEFAULT_NEW_WORK);
+
+	pthread_mutex_init(&zdplane_info.dg_shard_mutex, NULL);
+	pthread_cond_init(&zdplane_info.dg_shard_cond, NULL);
+
+	zdplane_info.dg_shard_count = dplane_shard_config;
+	zdplane_info.dg_shards = XCALLOC(MTYPE_DP_SHARD,
+					 zdplane_info.dg_shard_count *
+						 sizeof(struct dplane_shard));
+	for (i = 0; i < zdplane_info.dg_shard_count; i++) {
+		zdplane_info.dg_shards[i].ds_id = i;
+		dplane_ctx_list_init(&zdplane_info.dg_shards[i].ds_work);
+	}
+
 	/* Register default kernel 'provider' during init */
 	dplane_provider_init();
 }
@@ -8033,6 +9045,7 @@ static void zebra_dplane_init_internal(void)
  */
 void zebra_dplane_start(void)
 {
+	uint32_t i;
 	struct dplane_zns_info *zi;
 	struct zebra_dplane_provider *prov;
 	struct frr_pthread_attr pattr = {
@@ -8049,6 +9062,17 @@ void zebra_dplane_start(void)
 
 	zdplane_info.dg_run = true;
 
+	/* Shard 0 runs on the dplane pthread itself */
+	for (i = 1; i < zdplane_info.dg_shard_count; i++) {
+		struct dplane_shard *shard = &zdplane_info.dg_shards[i];
+		char name[32], os_name[OS_THREAD_NAMELEN];
+
+		snprintf(name, sizeof(name), "Zebra dplane shard %u", i);
+		snprintf(os_name, sizeof(os_name), "zebra_dp_%u", i);
+		shard->ds_pthread = frr_pthread_new(&pattr, name, os_name);
+		frr_pthread_run(shard->ds_pthread, NULL);
+	}
+
 	/* Enqueue an initial event for the dataplane pthread */
 	event_add_event(zdplane_info.dg_master, dplane_thread_loop, NULL, 0,
 			&zdplane_info.dg_t_update);
@@ -19,6 +19,7 @@
 #include "zebra/zebra_mpls.h"
 #include "zebra/zebra_nhg.h"
 #include "zebra/ge_netlink.h"
+#include "zebra/zebra_latency.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -1127,6 +1128,25 @@ int dplane_ctx_route_init_basic(struct zebra_dplane_ctx *ctx,
 				const struct prefix_ipv6 *src_p, afi_t afi,
 				safi_t safi);
 
+/* Drop a reference to a route nexthop snapshot, e.g. the one cached on
+ * an nhe that is being freed.
+ */
+void dplane_nhg_snap_release(struct dplane_nhg_snap **snapp);
+
+/*
+ * Route install latency: account the time since the previous stage a
+ * route update passed to 'stage'. Stages only move forward, so marking
+ * one a second time, or an earlier one, does nothing; neither does
+ * marking a context that isn't tracked.
+ */
+void dplane_ctx_lat_mark(struct zebra_dplane_ctx *ctx,
+			 enum zebra_lat_stage stage);
+/* Mark every context on a list, with one timestamp */
+void dplane_ctx_list_lat_mark(struct dplane_ctx_list_head *list,
+			      enum zebra_lat_stage stage);
+/* Account the update's whole time in zebra, once its result is handled */
+void dplane_ctx_lat_finish(struct zebra_dplane_ctx *ctx);
+
 /* Encode next hop information into data plane context. */
 int dplane_ctx_nexthop_init(struct zebra_dplane_ctx *ctx, enum dplane_op_e op,
 			    struct nhg_hash_entry *nhe);
@@ -1148,6 +1168,18 @@ void dplane_set_in_queue_limit(uint32_t limit, bool set);
 
 /* Retrieve the current queue depth of incoming, unprocessed updates */
 uint32_t dplane_get_in_queue_len(void);
+/* ... and its high-water mark */
+uint32_t dplane_get_in_queue_max(void);
+
+/* Maximum number of kernel update shards, each with its own pthread */
+#define DPLANE_SHARDS_MAX 16
+
+/* Configure the number of shards that route updates are spread across,
+ * by namespace and table, when programming the kernel. Must be called
+ * before zebra_dplane_init().
+ */
+void dplane_set_shard_count(uint32_t count);
+uint32_t dplane_get_shard_count(void);
 
 void dplane_ctx_set_vlan_ifindex(struct zebra_dplane_ctx *ctx,
 				 ifindex_t ifindex);
@@ -1205,6 +1237,13 @@ enum dplane_provider_prio {
 /* Provider will be spawning its own worker thread */
 #define DPLANE_PROV_FLAG_THREADED  0x1
 
+/* Provider's queues are lock-free rings, with the lists only used as
+ * overflow. The provider must then dequeue incoming work from one pthread
+ * only, and enqueue completed work from one pthread only (possibly another
+ * one): the dplane pthread is the other end of both rings.
+ */
+#define DPLANE_PROV_FLAG_RING      0x2
+
 /* Provider registration: ordering or priority value, callbacks, and optional
  * opaque data value. If 'prov_p', return the newly-allocated provider object
  * on success.
@@ -1268,6 +1307,10 @@ struct zebra_dplane_ctx *dplane_provider_dequeue_in_ctx(
 int dplane_provider_dequeue_in_list(struct zebra_dplane_provider *prov,
 				    struct dplane_ctx_list_head *listp);
 
+/* Dequeue up to 'max' contexts to an array, return count */
+int dplane_provider_dequeue_in_batch(struct zebra_dplane_provider *prov,
+				     struct zebra_dplane_ctx **ctxs, int max);
+
 /* Current completed work queue length */
 uint32_t dplane_provider_out_ctx_queue_len(struct zebra_dplane_provider *prov);
 
@@ -1275,12 +1318,31 @@ uint32_t dplane_provider_out_ctx_queue_len(struct zebra_dplane_provider *prov);
 void dplane_provider_enqueue_out_ctx(struct zebra_dplane_provider *prov,
 				     struct zebra_dplane_ctx *ctx);
 
+/* Enqueue an array of completed work, in order */
+void dplane_provider_enqueue_out_batch(struct zebra_dplane_provider *prov,
+				       struct zebra_dplane_ctx **ctxs, int count);
+
 /* Enqueue a context directly to zebra main. */
 void dplane_provider_enqueue_to_zebra(struct zebra_dplane_ctx *ctx);
 
 /* Enqueue a context list to zebra main. */
 void dplane_provider_enqueue_ctx_list_to_zebra(struct dplane_ctx_list_head *batch_list);
 
+/*
+ * Hold updates enqueued to the dataplane by zebra main until the matching
+ * batch_end, and hand them over together. Calls may nest.
+ */
+void dplane_update_batch_begin(void);
+void dplane_update_batch_end(void);
+
+/*
+ * Hold contexts enqueued to zebra main by the calling pthread until the
+ * matching batch_end, and hand them over together. Calls may nest. Used
+ * around reads of OS notifications.
+ */
+void dplane_zebra_batch_begin(void);
+void dplane_zebra_batch_end(void);
+
 /* Enable collection of extra info about interfaces in route updates;
  * this allows a provider/plugin to see some extra info in route update
  * context objects.
@@ -1314,6 +1376,9 @@ void zebra_dplane_pre_finish(void);
 void zebra_dplane_finish(void);
 void zebra_dplane_shutdown(void);
 
+/* Release the context pool, after zebra main has freed its contexts */
+void zebra_dplane_ctx_pool_fini(void);
+
 void zebra_dplane_startup_stage(struct zebra_ns *zns,
 				enum zebra_dplane_startup_notifications spot);
 
@@ -857,14 +857,9 @@ struct interface *zebra_evpn_map_to_macvlan(struct interface *br_if,
 /*
  * Uninstall MAC hash entry - called upon access VLAN change.
  */
-static void zebra_evpn_uninstall_mac_hash(struct hash_bucket *bucket,
-					  void *ctxt)
+static void zebra_evpn_uninstall_mac_hash(struct mac_walk_ctx *wctx,
+					  struct zebra_mac *mac)
 {
-	struct zebra_mac *mac;
-	struct mac_walk_ctx *wctx = ctxt;
-
-	mac = (struct zebra_mac *)bucket->data;
-
 	if (CHECK_FLAG(mac->flags, ZEBRA_MAC_REMOTE))
 		zebra_evpn_rem_mac_uninstall(wctx->zevpn, mac, false);
 }
@@ -872,13 +867,9 @@ static void zebra_evpn_uninstall_mac_hash(struct hash_bucket *bucket,
 /*
  * Install MAC hash entry - called upon access VLAN change.
  */
-static void zebra_evpn_install_mac_hash(struct hash_bucket *bucket, void *ctxt)
+static void zebra_evpn_install_mac_hash(struct mac_walk_ctx *wctx,
+					struct zebra_mac *mac)
 {
-	struct zebra_mac *mac;
-	struct mac_walk_ctx *wctx = ctxt;
-
-	mac = (struct zebra_mac *)bucket->data;
-
 	if (CHECK_FLAG(mac->flags, ZEBRA_MAC_REMOTE))
 		zebra_evpn_rem_mac_install(wctx->zevpn, mac, false);
 }
@@ -889,9 +880,7 @@ static void zebra_evpn_install_mac_hash(struct hash_bucket *bucket, void *ctxt)
 void zebra_evpn_rem_mac_uninstall_all(struct zebra_evpn *zevpn)
 {
 	struct mac_walk_ctx wctx;
-
-	if (!zevpn->mac_table)
-		return;
+	struct zebra_mac *mac;
 
 	memset(&wctx, 0, sizeof(struct mac_walk_ctx));
 	wctx.zevpn = zevpn;
@@ -899,7 +888,8 @@ void zebra_evpn_rem_mac_uninstall_all(struct zebra_evpn *zevpn)
 	wctx.upd_client = 0;
 	wctx.flags = ZEBRA_MAC_REMOTE;
 
-	hash_iterate(zevpn->mac_table, zebra_evpn_uninstall_mac_hash, &wctx);
+	frr_each (zebra_mac_db, zevpn->mac_table, mac)
+		zebra_evpn_uninstall_mac_hash(&wctx, mac);
 }
 
 /*
@@ -908,9 +898,7 @@ void zebra_evpn_rem_mac_uninstall_all(struct zebra_evpn *zevpn)
 void zebra_evpn_rem_mac_install_all(struct zebra_evpn *zevpn)
 {
 	struct mac_walk_ctx wctx;
-
-	if (!zevpn->mac_table)
-		return;
+	struct zebra_mac *mac;
 
 	memset(&wctx, 0, sizeof(struct mac_walk_ctx));
 	wctx.zevpn = zevpn;
@@ -918,7 +906,8 @@ void zebra_evpn_rem_mac_install_all(struct zebra_evpn *zevpn)
 	wctx.upd_client = 0;
 	wctx.flags = ZEBRA_MAC_REMOTE;
 
-	hash_iterate(zevpn->mac_table, zebra_evpn_install_mac_hash, &wctx);
+	frr_each (zebra_mac_db, zevpn->mac_table, mac)
+		zebra_evpn_install_mac_hash(&wctx, mac);
 }
 
 /*
@@ -1051,9 +1040,8 @@ struct zebra_evpn *zebra_evpn_add(vni_t vni)
 
 	zebra_evpn_es_evi_init(zevpn);
 
-	snprintf(buffer, sizeof(buffer), "Zebra EVPN MAC Table vni: %u", vni);
 	/* Create hash table for MAC */
-	zevpn->mac_table = zebra_mac_db_create(buffer);
+	zebra_mac_db_init(zevpn->mac_table);
 
 	snprintf(buffer, sizeof(buffer), "Zebra EVPN Neighbor Table vni: %u", vni);
 	/* Create hash table for neighbors */
@@ -1078,8 +1066,7 @@ int zebra_evpn_del(struct zebra_evpn *zevpn)
 	zebra_neigh_db_fini(zevpn->neigh_table);
 
 	/* Free the MAC hash table. */
-	hash_free(zevpn->mac_table);
-	zevpn->mac_table = NULL;
+	zebra_mac_db_fini(zevpn->mac_table);
 
 	/* Remove references to the zevpn in the MH databases */
 	if (zevpn->vxlan_if)
@@ -17,6 +17,7 @@
 #include "lib/vxlan.h" /* vni_t */
 #include "lib/ipaddr.h"
 
+PREDECL_HASH(zebra_mac_db);
 PREDECL_HASH(zebra_neigh_db);
 
 RB_HEAD(zebra_es_evi_rb_head, zebra_evpn_es_evi);
@@ -71,7 +72,7 @@ struct zebra_evpn {
 	vrf_id_t vrf_id;
 
 	/* List of local or remote MAC */
-	struct hash *mac_table;
+	struct zebra_mac_db_head mac_table[1];
 
 	/* List of local or remote neighbors (MAC+IP) */
 	struct zebra_neigh_db_head neigh_table[1];
@@ -35,23 +35,14 @@ DEFINE_MTYPE_STATIC(ZEBRA, MAC, "EVPN MAC");
  */
 uint32_t num_valid_macs(struct zebra_evpn *zevpn)
 {
-	unsigned int i;
 	uint32_t num_macs = 0;
-	struct hash *hash;
-	struct hash_bucket *hb;
 	struct zebra_mac *mac;
 
-	hash = zevpn->mac_table;
-	if (!hash)
-		return num_macs;
-	for (i = 0; i < hash->size; i++) {
-		for (hb = hash->index[i]; hb; hb = hb->next) {
-			mac = (struct zebra_mac *)hb->data;
-			if (CHECK_FLAG(mac->flags, ZEBRA_MAC_REMOTE) ||
-			    CHECK_FLAG(mac->flags, ZEBRA_MAC_LOCAL) ||
-			    !CHECK_FLAG(mac->flags, ZEBRA_MAC_AUTO))
-				num_macs++;
-		}
+	frr_each (zebra_mac_db, zevpn->mac_table, mac) {
+		if (CHECK_FLAG(mac->flags, ZEBRA_MAC_REMOTE) ||
+		    CHECK_FLAG(mac->flags, ZEBRA_MAC_LOCAL) ||
+		    !CHECK_FLAG(mac->flags, ZEBRA_MAC_AUTO))
+			num_macs++;
 	}
 
 	return num_macs;
@@ -59,21 +50,12 @@ uint32_t num_valid_macs(struct zebra_evpn *zevpn)
 
 uint32_t num_dup_detected_macs(struct zebra_evpn *zevpn)
 {
-	unsigned int i;
 	uint32_t num_macs = 0;
-	struct hash *hash;
-	struct hash_bucket *hb;
 	struct zebra_mac *mac;
 
-	hash = zevpn->mac_table;
-	if (!hash)
-		return num_macs;
-	for (i = 0; i < hash->size; i++) {
-		for (hb = hash->index[i]; hb; hb = hb->next) {
-			mac = (struct zebra_mac *)hb->data;
-			if (CHECK_FLAG(mac->flags, ZEBRA_MAC_DUPLICATE))
-				num_macs++;
-		}
+	frr_each (zebra_mac_db, zevpn->mac_table, mac) {
+		if (CHECK_FLAG(mac->flags, ZEBRA_MAC_DUPLICATE))
+			num_macs++;
 	}
 
 	return num_macs;
@@ -826,19 +808,16 @@ static char *zebra_evpn_print_mac_flags(struct zebra_mac *mac, char *flags_buf,
 /*
  * Print MAC hash entry - called for display of all MACs.
  */
-void zebra_evpn_print_mac_hash(struct hash_bucket *bucket, void *ctxt)
+void zebra_evpn_print_mac_hash(struct mac_walk_ctx *wctx, struct zebra_mac *mac)
 {
 	struct vty *vty;
 	json_object *json_mac_hdr = NULL, *json_mac = NULL;
-	struct zebra_mac *mac;
 	char buf1[ETHER_ADDR_STRLEN];
 	char addr_buf[PREFIX_STRLEN];
-	struct mac_walk_ctx *wctx = ctxt;
 	char flags_buf[6];
 
 	vty = wctx->vty;
 	json_mac_hdr = wctx->json;
-	mac = (struct zebra_mac *)bucket->data;
 
 	prefix_mac2str(&mac->macaddr, buf1, sizeof(buf1));
 
@@ -951,18 +930,14 @@ void zebra_evpn_print_mac_hash(struct hash_bucket *bucket, void *ctxt)
 /*
  * Print MAC hash entry in detail - called for display of all MACs.
  */
-void zebra_evpn_print_mac_hash_detail(struct hash_bucket *bucket, void *ctxt)
+void zebra_evpn_print_mac_hash_detail(struct mac_walk_ctx *wctx,
+				      struct zebra_mac *mac)
 {
 	struct vty *vty;
 	json_object *json_mac_hdr = NULL;
-	struct zebra_mac *mac;
-	struct mac_walk_ctx *wctx = ctxt;
 
 	vty = wctx->vty;
 	json_mac_hdr = wctx->json;
-	mac = (struct zebra_mac *)bucket->data;
-	if (!mac)
-		return;
 
 	wctx->count++;
 	wctx->json_counter++;
@@ -1070,37 +1045,25 @@ static bool mac_cmp(const void *p1, const void *p2)
 		0);
 }
 
-/*
- * Callback to allocate MAC hash entry.
- */
-static void *zebra_evpn_mac_alloc(void *p)
-{
-	const struct zebra_mac *tmp_mac = p;
-	struct zebra_mac *mac;
-
-	mac = XCALLOC(MTYPE_MAC, sizeof(struct zebra_mac));
-	*mac = *tmp_mac;
-
-	return ((void *)mac);
-}
-
 /*
  * Add MAC entry.
  */
 struct zebra_mac *zebra_evpn_mac_add(struct zebra_evpn *zevpn,
 				     const struct ethaddr *macaddr)
 {
-	struct zebra_mac tmp_mac;
-	struct zebra_mac *mac = NULL;
+	struct zebra_mac *mac;
 
-	memset(&tmp_mac, 0, sizeof(tmp_mac));
-	memcpy(&tmp_mac.macaddr, macaddr, ETH_ALEN);
-	mac = hash_get(zevpn->mac_table, &tmp_mac, zebra_evpn_mac_alloc);
+	mac = zebra_evpn_mac_lookup(zevpn, macaddr);
+	if (mac)
+		return mac;
+
+	mac = XCALLOC(MTYPE_MAC, sizeof(struct zebra_mac));
+	memcpy(&mac->macaddr, macaddr, ETH_ALEN);
+	zebra_mac_db_add(zevpn->mac_table, mac);
 
 	mac->zevpn = zevpn;
 	mac->dad_mac_auto_recovery_timer = NULL;
 
-	mac->neigh_list = list_new();
 	mac->neigh_list->cmp = neigh_list_cmp;
 
 	mac->uptime = monotime(NULL);
@@ -1121,8 +1084,6 @@ struct zebra_mac *zebra_evpn_mac_add(struct zebra_evpn *zevpn,
  */
 int zebra_evpn_mac_del(struct zebra_evpn *zevpn, struct zebra_mac *mac)
 {
-	struct zebra_mac *tmp_mac;
-
 	if (IS_ZEBRA_DEBUG_VXLAN || IS_ZEBRA_DEBUG_EVPN_MH_MAC) {
 		char mac_buf[MAC_BUF_SIZE];
 
@@ -1163,11 +1124,9 @@ int zebra_evpn_mac_del(struct zebra_evpn *zevpn, struct zebra_mac *mac)
 		return 0;
 	}
 
-	list_delete(&mac->neigh_list);
-
 	/* Free the VNI hash entry and allocated memory. */
-	tmp_mac = hash_release(zevpn->mac_table, mac);
-	XFREE(MTYPE_MAC, tmp_mac);
+	zebra_mac_db_del(zevpn->mac_table, mac);
+	XFREE(MTYPE_MAC, mac);
 
 	return 0;
 }
@@ -1243,13 +1202,11 @@ static bool zebra_evpn_check_mac_del_from_db(struct mac_walk_ctx *wctx,
 }
 
 /*
- * Free MAC hash entry (callback)
+ * Free MAC hash entry
  */
-static void zebra_evpn_mac_del_hash_entry(struct hash_bucket *bucket, void *arg)
+static void zebra_evpn_mac_del_hash_entry(struct mac_walk_ctx *wctx,
+					  struct zebra_mac *mac)
 {
-	struct mac_walk_ctx *wctx = arg;
-	struct zebra_mac *mac = bucket->data;
-
 	if (!zebra_evpn_check_mac_del_from_db(wctx, mac))
 		return;
 
@@ -1279,9 +1236,7 @@ void zebra_evpn_mac_del_all(struct zebra_evpn *zevpn, int uninstall, int upd_cli
 			    uint32_t flags, struct l2vni_walk_ctx *l2_wctx)
 {
 	struct mac_walk_ctx wctx;
-
-	if (!zevpn->mac_table)
-		return;
+	struct zebra_mac *mac;
 
 	memset(&wctx, 0, sizeof(wctx));
 	wctx.zevpn = zevpn;
@@ -1293,7 +1248,8 @@ void zebra_evpn_mac_del_all(struct zebra_evpn *zevpn, int uninstall, int upd_cli
 		wctx.gr_cleanup_time = l2_wctx->gr_cleanup_time;
 	}
 
-	hash_iterate(zevpn->mac_table, zebra_evpn_mac_del_hash_entry, &wctx);
+	frr_each_safe (zebra_mac_db, zevpn->mac_table, mac)
+		zebra_evpn_mac_del_hash_entry(&wctx, mac);
 }
 
 /*
@@ -1303,13 +1259,9 @@ struct zebra_mac *zebra_evpn_mac_lookup(struct zebra_evpn *zevpn,
 					const struct ethaddr *mac)
 {
 	struct zebra_mac tmp;
-	struct zebra_mac *pmac;
 
-	memset(&tmp, 0, sizeof(tmp));
 	memcpy(&tmp.macaddr, mac, ETH_ALEN);
-	pmac = hash_lookup(zevpn->mac_table, &tmp);
-
-	return pmac;
+	return zebra_mac_db_find(zevpn->mac_table, &tmp);
 }
 
 /*
@@ -1913,12 +1865,9 @@ static bool zebra_evpn_local_mac_update_fwd_info(struct zebra_mac *mac,
 }
 
 /* Notify Local MACs to the clienti, skips GW MAC */
-static void zebra_evpn_send_mac_hash_entry_to_client(struct hash_bucket *bucket,
-						     void *arg)
+static void zebra_evpn_send_mac_hash_entry_to_client(struct mac_walk_ctx *wctx,
+						     struct zebra_mac *zmac)
 {
-	struct mac_walk_ctx *wctx = arg;
-	struct zebra_mac *zmac = bucket->data;
-
 	if (CHECK_FLAG(zmac->flags, ZEBRA_MAC_DEF_GW))
 		return;
 
@@ -1932,15 +1881,13 @@ static void zebra_evpn_send_mac_hash_entry_to_client(struct hash_bucket *bucket,
 void zebra_evpn_send_mac_list_to_client(struct zebra_evpn *zevpn)
 {
 	struct mac_walk_ctx wctx;
-
-	if (!zevpn->mac_table)
-		return;
+	struct zebra_mac *zmac;
 
 	memset(&wctx, 0, sizeof(wctx));
 	wctx.zevpn = zevpn;
 
-	hash_iterate(zevpn->mac_table, zebra_evpn_send_mac_hash_entry_to_client,
-		     &wctx);
+	frr_each (zebra_mac_db, zevpn->mac_table, zmac)
+		zebra_evpn_send_mac_hash_entry_to_client(&wctx, zmac);
 }
 
 void zebra_evpn_rem_mac_del(struct zebra_evpn *zevpn, struct zebra_mac *mac)
@@ -1969,29 +1916,19 @@ void zebra_evpn_rem_mac_del(struct zebra_evpn *zevpn, struct zebra_mac *mac)
 }
 
 /* Print Duplicate MAC */
-void zebra_evpn_print_dad_mac_hash(struct hash_bucket *bucket, void *ctxt)
+void zebra_evpn_print_dad_mac_hash(struct mac_walk_ctx *wctx,
+				   struct zebra_mac *mac)
 {
-	struct zebra_mac *mac;
-
-	mac = (struct zebra_mac *)bucket->data;
-	if (!mac)
-		return;
-
 	if (CHECK_FLAG(mac->flags, ZEBRA_MAC_DUPLICATE))
-		zebra_evpn_print_mac_hash(bucket, ctxt);
+		zebra_evpn_print_mac_hash(wctx, mac);
 }
 
 /* Print Duplicate MAC in detail */
-void zebra_evpn_print_dad_mac_hash_detail(struct hash_bucket *bucket, void *ctxt)
+void zebra_evpn_print_dad_mac_hash_detail(struct mac_walk_ctx *wctx,
+					  struct zebra_mac *mac)
 {
-	struct zebra_mac *mac;
-
-	mac = (struct zebra_mac *)bucket->data;
-	if (!mac)
-		return;
-
 	if (CHECK_FLAG(mac->flags, ZEBRA_MAC_DUPLICATE))
-		zebra_evpn_print_mac_hash_detail(bucket, ctxt);
+		zebra_evpn_print_mac_hash_detail(wctx, mac);
 }
 
 int zebra_evpn_mac_remote_macip_add(struct zebra_evpn *zevpn, struct zebra_vrf *zvrf,
@@ -14,12 +14,15 @@
 #include "lib/typesafe.h"
 #include "lib/linklist.h"
 #include "lib/hash.h"
+#include "lib/jhash.h"
 #include "lib/vlan.h"	/* vlanid_t */
 #include "lib/vxlan.h"	/* vni_t */
 #include "lib/prefix.h" /* esi_t, ethaddr */
 #include "lib/if.h"
 #include "lib/ns.h"
 
+#include "zebra/zebra_evpn_base.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -50,6 +53,9 @@ struct zebra_mac {
 	/* MAC address. */
 	struct ethaddr macaddr;
 
+	/* Linkage in the per-EVPN MAC table (unused for RMACs) */
+	struct zebra_mac_db_item zmd_item;
+
 	/* When modifying flags please fixup zebra_evpn_zebra_mac_flag_dump */
 	uint32_t flags;
 #define ZEBRA_MAC_LOCAL 0x01
@@ -116,8 +122,10 @@ struct zebra_mac {
 	uint32_t rem_seq;
 	uint32_t loc_seq;
 
-	/* List of neigh associated with this mac */
-	struct list *neigh_list;
+	/* List of neigh associated with this mac, embedded to save an
+	 * allocation per MAC
+	 */
+	struct list neigh_list[1];
 
 	/* List of nexthop associated with this RMAC */
 	struct list *nh_list;
@@ -148,6 +156,19 @@ struct zebra_mac {
 	uint64_t gr_refresh_time;
 };
 
+static inline int zebra_mac_cmp(const struct zebra_mac *m1,
+				const struct zebra_mac *m2)
+{
+	return memcmp(m1->macaddr.octet, m2->macaddr.octet, ETH_ALEN);
+}
+
+static inline uint32_t zebra_mac_hash(const struct zebra_mac *m)
+{
+	return jhash(m->macaddr.octet, ETH_ALEN, 0xa5a5a55a);
+}
+
+DECLARE_HASH(zebra_mac_db, struct zebra_mac, zmd_item, zebra_mac_cmp, zebra_mac_hash);
+
 /*
  * Context for MAC hash walk - used by callbacks.
  */
@@ -237,8 +258,10 @@ int zebra_evpn_macip_send_msg_to_client(uint32_t id,
 					uint32_t seq, int state,
 					struct zebra_evpn_es *es, uint16_t cmd);
 void zebra_evpn_print_mac(struct zebra_mac *mac, struct vty *vty, json_object *json);
-void zebra_evpn_print_mac_hash(struct hash_bucket *bucket, void *ctxt);
-void zebra_evpn_print_mac_hash_detail(struct hash_bucket *bucket, void *ctxt);
+void zebra_evpn_print_mac_hash(struct mac_walk_ctx *wctx,
+			       struct zebra_mac *mac);
+void zebra_evpn_print_mac_hash_detail(struct mac_walk_ctx *wctx,
+				      struct zebra_mac *mac);
 int zebra_evpn_sync_mac_dp_install(struct zebra_mac *mac, bool set_inactive,
 				   bool force_clear_static, const char *caller);
 void zebra_evpn_mac_send_add_del_to_client(struct zebra_mac *mac,
@@ -261,9 +284,10 @@ struct zebra_mac *zebra_evpn_proc_sync_mac_update(struct zebra_evpn *zevi,
 						  const esi_t *esi);
 void zebra_evpn_sync_mac_del(struct zebra_mac *mac);
 void zebra_evpn_rem_mac_del(struct zebra_evpn *zevi, struct zebra_mac *mac);
-void zebra_evpn_print_dad_mac_hash(struct hash_bucket *bucket, void *ctxt);
-void zebra_evpn_print_dad_mac_hash_detail(struct hash_bucket *bucket,
-					  void *ctxt);
+void zebra_evpn_print_dad_mac_hash(struct mac_walk_ctx *wctx,
+				   struct zebra_mac *mac);
+void zebra_evpn_print_dad_mac_hash_detail(struct mac_walk_ctx *wctx,
+					  struct zebra_mac *mac);
 int zebra_evpn_mac_remote_macip_add(struct zebra_evpn *zevpn, struct zebra_vrf *zvrf,
 				    const struct ethaddr *macaddr, struct ipaddr *vtep_ip,
 				    uint8_t flags, uint32_t seq, const esi_t *esi);
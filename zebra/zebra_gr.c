@@ -634,46 +634,65 @@ static bool zebra_gr_should_reschedule(const struct zebra_gr_afi_clean *gac)
 	return false;
 }
 
+/*
+ * Delete the client's routes in this table that were not refreshed after
+ * it restarted. Its routes are kept oldest first, so the stale ones are
+ * all at the front of its list, and the sweep is done at the first route
+ * that is new enough; nothing else in the table is looked at.
+ *
+ * Unless no_max is set, a pass stops once it has used its time budget
+ * and reschedules itself, backing off if the route deletions it queued
+ * are piling up in the meta queue. Returns true if it was rescheduled.
+ */
 static bool zebra_gr_unicast_stale_route_delete(struct route_table *table,
 						struct zebra_gr_afi_clean *gac, bool no_max)
 {
+	struct re_client_list_head *routes;
+	struct route_entry *re;
 	struct route_node *rn;
-	struct route_entry *re, *next;
-	uint32_t n = 0;
+	struct timeval start, now;
+	uint32_t n = 0, checked = 0;
 
-	for (rn = route_top(table); rn; rn = srcdest_route_next(rn)) {
-		RNODE_FOREACH_RE_SAFE (rn, re, next) {
-			if (CHECK_FLAG(re->status, ROUTE_ENTRY_REMOVED))
-				continue;
+	routes = rib_client_routes(table, gac->proto, gac->instance);
+	if (!routes)
+		return false;
 
-			/* If the route refresh is received
-			 * after restart then do not delete
-			 * the route
-			 */
+	monotime(&start);
 
-			if (re->type == gac->proto &&
-			    re->instance == gac->instance &&
-			    zebra_gr_process_route_entry(rn, re,
-							 gac->restart_time,
-							 gac->proto))
-				n++;
+	while ((re = re_client_list_first(routes))) {
+		/* This one, and all after it, were refreshed after restart */
+		if (re->uptime >= gac->restart_time)
+			break;
 
-			/* If the max route count is reached
-			 * then timer thread will be restarted
-			 * Store the current prefix and afi
-			 */
-			if ((n >= ZEBRA_MAX_STALE_ROUTE_COUNT) &&
-			    zebra_gr_should_reschedule(gac) && !no_max) {
-				LOG_GR("GR: Stale routes deleted %d. Restarting timer.", n);
-				event_add_timer(
-					zrouter.master,
-					zebra_gr_delete_stale_route_table_afi,
-					gac, ZEBRA_DEFAULT_STALE_UPDATE_DELAY,
-					&gac->t_gac);
-				return true;
-			}
-		}
+		/* Stale or already going away, either way it's done with */
+		rn = re->client_rn;
+		rib_client_route_untrack(re);
+		if (!CHECK_FLAG(re->status, ROUTE_ENTRY_REMOVED) &&
+		    zebra_gr_process_route_entry(rn, re, gac->restart_time,
+						 gac->proto))
+			n++;
+
+		/* Look at the clock every so often */
+		if (no_max || (++checked % 64) != 0)
+			continue;
+
+		monotime(&now);
+		if (timeval_elapsed(now, start) < ZEBRA_GR_SWEEP_BUDGET_USEC ||
+		    !zebra_gr_should_reschedule(gac))
+			continue;
+
+		LOG_GR("GR: Stale routes deleted %u, %u left to check; yielding",
+		       n, (uint32_t)re_client_list_count(routes));
+		event_add_timer_msec(zrouter.master,
+				     zebra_gr_delete_stale_route_table_afi, gac,
+				     zrouter.mq->size > ZEBRA_GR_SWEEP_MQ_LIMIT
+					     ? ZEBRA_GR_SWEEP_BACKOFF_MSEC
+					     : 0,
+				     &gac->t_gac);
+		return true;
 	}
+
+	LOG_GR("GR: Stale routes deleted %u, sweep complete", n);
 	return false;
 }
 
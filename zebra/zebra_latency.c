@@ -0,0 +1,274 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Zebra route install latency telemetry.
+ */
+#include <zebra.h>
+
+#include "monotime.h"
+#include "frratomic.h"
+#include "memory.h"
+#include "libfrr.h"
+
+#include "zebra/zebra_latency.h"
+
+DEFINE_MTYPE_STATIC(ZEBRA, LAT_HISTS, "Route install latency histograms");
+
+#ifndef thread_local
+#define thread_local __thread
+#endif
+
+/*
+ * Each pthread accounts to histograms of its own, so samples cost plain
+ * loads and stores on lines no other pthread writes; the histograms are
+ * only summed up when read. The fields are atomic so that a reader sees
+ * whole values.
+ */
+struct zebra_lat_hist {
+	_Atomic uint64_t count;
+	_Atomic uint64_t total;
+	_Atomic uint32_t max;
+	_Atomic uint64_t buckets[ZEBRA_LAT_BUCKETS];
+};
+
+struct zebra_lat_hists {
+	struct zebra_lat_hists *next;
+	struct zebra_lat_hist stages[ZEBRA_LAT_STAGE_MAX];
+};
+
+/* Every pthread's histograms, added to as pthreads first record a sample */
+static struct zebra_lat_hists *_Atomic zebra_lat_all;
+
+static thread_local struct zebra_lat_hists *zebra_lat_local;
+
+/* Off by default; see "zebra route-latency" */
+static _Atomic bool zebra_lat_on;
+
+static const char *const zebra_lat_stage_names[ZEBRA_LAT_STAGE_MAX] = {
+	[ZEBRA_LAT_ZAPI_INPUT] = "zapi-input",
+	[ZEBRA_LAT_META_QUEUE] = "meta-queue",
+	[ZEBRA_LAT_RIB_PROCESS] = "rib-process",
+	[ZEBRA_LAT_DPLANE_QUEUE] = "dplane-queue",
+	[ZEBRA_LAT_KERNEL] = "kernel",
+	[ZEBRA_LAT_DPLANE_RETURN] = "dplane-return",
+	[ZEBRA_LAT_RESULTS_QUEUE] = "results-queue",
+	[ZEBRA_LAT_TOTAL] = "total",
+};
+
+#define B(i) (1U << (i))
+const uint32_t zebra_lat_bucket_bounds[ZEBRA_LAT_BUCKETS] = {
+	B(0),  B(1),  B(2),  B(3),  B(4),  B(5),  B(6),  B(7),  B(8),
+	B(9),  B(10), B(11), B(12), B(13), B(14), B(15), B(16), B(17),
+	B(18), B(19), B(20), B(21), B(22), B(23), B(24), UINT32_MAX,
+};
+#undef B
+
+/* Set and read by zebra main only */
+static uint32_t zebra_lat_cur_origin;
+
+void zebra_lat_enable(bool enable)
+{
+	atomic_store_explicit(&zebra_lat_on, enable, memory_order_relaxed);
+}
+
+bool zebra_lat_enabled(void)
+{
+	return atomic_load_explicit(&zebra_lat_on, memory_order_relaxed);
+}
+
+uint32_t zebra_lat_stamp_tv(const struct timeval *tv)
+{
+	uint32_t stamp;
+
+	if (!zebra_lat_enabled())
+		return 0;
+
+	stamp = (uint32_t)((uint64_t)tv->tv_sec * 1000000 + tv->tv_usec);
+	return stamp ? stamp : 1;
+}
+
+uint32_t zebra_lat_stamp(void)
+{
+	struct timeval tv;
+
+	if (!zebra_lat_enabled())
+		return 0;
+
+	monotime(&tv);
+	return zebra_lat_stamp_tv(&tv);
+}
+
+static struct zebra_lat_hists *zebra_lat_hists_local(void)
+{
+	struct zebra_lat_hists *hists = zebra_lat_local;
+
+	if (hists)
+		return hists;
+
+	hists = XCALLOC(MTYPE_LAT_HISTS, sizeof(*hists));
+	hists->next = atomic_load_explicit(&zebra_lat_all,
+					   memory_order_relaxed);
+	while (!atomic_compare_exchange_weak_explicit(&zebra_lat_all,
+						      &hists->next, hists,
+						      memory_order_release,
+						      memory_order_relaxed))
+		;
+
+	zebra_lat_local = hists;
+	return hists;
+}
+
+/* Only the owning pthread writes, so no read-modify-write is needed */
+#define LAT_ADD(field, n)                                                      	atomic_store_explicit(&(field),                                        			      atomic_load_explicit(&(field),                   						   memory_order_relaxed) +     				      (n),                                     			      memory_order_relaxed)
+
+void zebra_lat_add_n(enum zebra_lat_stage stage, uint64_t usec, uint64_t count)
+{
+	struct zebra_lat_hist *hist;
+	uint32_t sample;
+	unsigned int i;
+
+	/* Also drops samples taken across the knob being turned off */
+	if (!count || !zebra_lat_enabled())
+		return;
+
+	hist = &zebra_lat_hists_local()->stages[stage];
+
+	sample = MIN(usec, UINT32_MAX);
+	i = sample ? 32 - __builtin_clz(sample) : 0;
+	if (i >= ZEBRA_LAT_BUCKETS)
+		i = ZEBRA_LAT_BUCKETS - 1;
+
+	LAT_ADD(hist->buckets[i], count);
+	LAT_ADD(hist->count, count);
+	LAT_ADD(hist->total, sample * count);
+	if (sample > atomic_load_explicit(&hist->max, memory_order_relaxed))
+		atomic_store_explicit(&hist->max, sample, memory_order_relaxed);
+}
+
+#undef LAT_ADD
+
+void zebra_lat_origin_set(uint32_t stamp)
+{
+	zebra_lat_cur_origin = stamp;
+}
+
+uint32_t zebra_lat_origin(void)
+{
+	if (zebra_lat_cur_origin)
+		return zebra_lat_cur_origin;
+
+	return zebra_lat_stamp();
+}
+
+const char *zebra_lat_stage_name(enum zebra_lat_stage stage)
+{
+	if (stage >= ZEBRA_LAT_STAGE_MAX)
+		return "unknown";
+
+	return zebra_lat_stage_names[stage];
+}
+
+enum zebra_lat_stage zebra_lat_stage_by_name(const char *name)
+{
+	enum zebra_lat_stage stage;
+
+	for (stage = 0; stage < ZEBRA_LAT_STAGE_MAX; stage++)
+		if (strmatch(zebra_lat_stage_names[stage], name))
+			break;
+
+	return stage;
+}
+
+void zebra_lat_get(enum zebra_lat_stage stage, struct zebra_lat_stats *stats)
+{
+	struct zebra_lat_hists *hists;
+	struct zebra_lat_hist *hist;
+	uint32_t max;
+	unsigned int i;
+
+	memset(stats, 0, sizeof(*stats));
+
+	hists = atomic_load_explicit(&zebra_lat_all, memory_order_acquire);
+	for (; hists; hists = hists->next) {
+		hist = &hists->stages[stage];
+
+		/* Counters move on while we read them, so count the buckets */
+		for (i = 0; i < ZEBRA_LAT_BUCKETS; i++) {
+			uint64_t n = atomic_load_explicit(&hist->buckets[i],
+							  memory_order_relaxed);
+
+			stats->buckets[i] += n;
+			stats->count += n;
+		}
+		stats->total += atomic_load_explicit(&hist->total,
+						     memory_order_relaxed);
+		max = atomic_load_explicit(&hist->max, memory_order_relaxed);
+		stats->max = MAX(stats->max, max);
+	}
+}
+
+uint32_t zebra_lat_percentile(const struct zebra_lat_stats *stats,
+			      unsigned int pct)
+{
+	uint64_t want, seen = 0;
+	unsigned int i;
+
+	if (!stats->count)
+		return 0;
+
+	want = (stats->count * pct + 99) / 100;
+	for (i = 0; i < ZEBRA_LAT_BUCKETS; i++) {
+		seen += stats->buckets[i];
+		if (seen >= want)
+			break;
+	}
+
+	if (i >= ZEBRA_LAT_BUCKETS)
+		return stats->max;
+
+	return MIN(zebra_lat_bucket_bounds[i], stats->max);
+}
+
+void zebra_lat_show(struct vty *vty)
+{
+	struct zebra_lat_stats stats;
+	enum zebra_lat_stage stage;
+
+	if (!zebra_lat_enabled()) {
+		vty_out(vty, "Route install latency: not recorded\n");
+		return;
+	}
+
+	vty_out(vty, "Route install latency (usec):\n");
+	vty_out(vty, "  %-14s %12s %10s %10s %10s %10s\n", "Stage", "Count",
+		"Avg", "p50", "p99", "Max");
+
+	for (stage = 0; stage < ZEBRA_LAT_STAGE_MAX; stage++) {
+		zebra_lat_get(stage, &stats);
+		vty_out(vty,
+			"  %-14s %12" PRIu64 " %10" PRIu64 " %10u %10u %10u\n",
+			zebra_lat_stage_name(stage), stats.count,
+			stats.count ? stats.total / stats.count : 0,
+			zebra_lat_percentile(&stats, 50),
+			zebra_lat_percentile(&stats, 99), stats.max);
+	}
+}
+
+static int zebra_lat_fini(void)
+{
+	struct zebra_lat_hists *hists, *next;
+
+	/* All other pthreads have stopped by now */
+	hists = atomic_exchange_explicit(&zebra_lat_all, NULL,
+					 memory_order_acquire);
+	for (; hists; hists = next) {
+		next = hists->next;
+		XFREE(MTYPE_LAT_HISTS, hists);
+	}
+
+	return 0;
+}
+
+void zebra_lat_init(void)
+{
+	hook_register(frr_fini, zebra_lat_fini);
+}
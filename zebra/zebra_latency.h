@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Zebra route install latency telemetry.
+ *
+ * Route updates are timestamped as they move from ZAPI input, through the
+ * meta queue and rib_process, into the dataplane, the kernel, and back to
+ * zebra to notify the owning client. The time spent in each stage is
+ * accounted to a log2 histogram, so that the stage holding things up
+ * during convergence can be told apart from the others.
+ *
+ * Stamps are 32-bit monotonic microseconds, so intervals of up to about
+ * 71 minutes are measured correctly. A stamp is never 0: 0 means "not
+ * stamped", and nothing gets recorded for it.
+ *
+ * Recording is off unless enabled; while it is off, stamps are 0, so
+ * the hot paths skip the clock and the histograms.
+ */
+#ifndef _ZEBRA_LATENCY_H
+#define _ZEBRA_LATENCY_H
+
+#include "vty.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum zebra_lat_stage {
+	/* ZAPI message waiting on a client's input queue for zebra main */
+	ZEBRA_LAT_ZAPI_INPUT = 0,
+	/* From ZAPI receipt (or queueing) until rib_process picks the node */
+	ZEBRA_LAT_META_QUEUE,
+	/* rib_process run for one route node */
+	ZEBRA_LAT_RIB_PROCESS,
+	/* Route update waiting for the kernel provider */
+	ZEBRA_LAT_DPLANE_QUEUE,
+	/* Kernel provider pickup until the kernel answered */
+	ZEBRA_LAT_KERNEL,
+	/* Through the remaining providers, back to zebra main */
+	ZEBRA_LAT_DPLANE_RETURN,
+	/* Result waiting for zebra main */
+	ZEBRA_LAT_RESULTS_QUEUE,
+	/* From ZAPI receipt (or queueing) until the result was handled */
+	ZEBRA_LAT_TOTAL,
+
+	ZEBRA_LAT_STAGE_MAX,
+};
+
+/*
+ * Bucket i counts samples below 2^i usec that were not counted in bucket
+ * i - 1; the last bucket counts everything else.
+ */
+#define ZEBRA_LAT_BUCKETS 26
+
+struct zebra_lat_stats {
+	uint64_t count;
+	/* Sum of all samples, usec */
+	uint64_t total;
+	uint32_t max;
+	uint64_t buckets[ZEBRA_LAT_BUCKETS];
+};
+
+/* Exclusive upper bound of each bucket in usec, UINT32_MAX for the last */
+extern const uint32_t zebra_lat_bucket_bounds[ZEBRA_LAT_BUCKETS];
+
+extern void zebra_lat_init(void);
+extern void zebra_lat_enable(bool enable);
+extern bool zebra_lat_enabled(void);
+
+extern uint32_t zebra_lat_stamp(void);
+extern uint32_t zebra_lat_stamp_tv(const struct timeval *tv);
+
+/* Account 'count' samples of 'usec' to a stage; any pthread, each to
+ * histograms of its own
+ */
+extern void zebra_lat_add_n(enum zebra_lat_stage stage, uint64_t usec,
+			    uint64_t count);
+
+static inline void zebra_lat_add(enum zebra_lat_stage stage, uint64_t usec)
+{
+	zebra_lat_add_n(stage, usec, 1);
+}
+
+/* Account the time since 'stamp' to a stage, if it is set */
+static inline void zebra_lat_record(enum zebra_lat_stage stage, uint32_t stamp)
+{
+	if (stamp)
+		zebra_lat_add(stage, (uint32_t)(zebra_lat_stamp() - stamp));
+}
+
+/*
+ * Origin of the work zebra main is handling right now: set around the
+ * processing of ZAPI messages and of early route queue entries, so that
+ * the route nodes they queue are stamped with the time of ZAPI receipt.
+ * Without one set, zebra_lat_origin() returns the current time.
+ * zebra main pthread only.
+ */
+extern void zebra_lat_origin_set(uint32_t stamp);
+extern uint32_t zebra_lat_origin(void);
+
+extern const char *zebra_lat_stage_name(enum zebra_lat_stage stage);
+/* ZEBRA_LAT_STAGE_MAX if there's no such stage */
+extern enum zebra_lat_stage zebra_lat_stage_by_name(const char *name);
+
+extern void zebra_lat_get(enum zebra_lat_stage stage,
+			  struct zebra_lat_stats *stats);
+
+/* Upper bound of the bucket holding the 'pct' percentile sample */
+extern uint32_t zebra_lat_percentile(const struct zebra_lat_stats *stats,
+				     unsigned int pct);
+
+extern void zebra_lat_show(struct vty *vty);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ZEBRA_LATENCY_H */
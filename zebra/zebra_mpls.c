@@ -14,7 +14,6 @@
 #include "sockunion.h"
 #include "linklist.h"
 #include "frrevent.h"
-#include "workqueue.h"
 #include "prefix.h"
 #include "routemap.h"
 #include "stream.h"
@@ -41,6 +40,60 @@ DEFINE_MTYPE_STATIC(ZEBRA, NHLFE, "MPLS nexthop object");
 bool mpls_enabled;
 bool mpls_pw_reach_strict; /* Strict reachability checking */
 
+/* Delay before processing scheduled LSPs, and the most handled per run */
+#define LSP_PROCESS_HOLD_MSEC 10
+#define LSP_PROCESS_BATCH     256
+
+/*
+ * LSP processing state. MPLS is only supported in the default VRF, so
+ * this is kept globally rather than per zvrf.
+ */
+static struct lsp_dirty_list_head lsp_dirty_queue;
+static struct event *t_lsp_process;
+
+/* FECs with a label index, re-evaluated upon label block changes */
+static struct fec_index_list_head fec_index_fecs;
+
+static struct lsp_process_stats {
+	uint64_t runs;
+	uint64_t processed;
+	uint32_t max_batch;
+	uint64_t total_usec;
+	uint64_t last_usec;
+	uint64_t max_usec;
+	uint64_t full_schedules;
+	uint64_t prefix_schedules;
+	uint64_t prefix_scheduled;
+} lsp_stats;
+
+/*
+ * Primary NHLFEs of forwarding LSPs, ordered by gateway address so that a
+ * RIB change only needs to schedule the LSPs whose nexthops fall within
+ * the changed prefix. Entries without a routable gateway sort first.
+ */
+static int nhlfe_gate_cmp(const struct zebra_nhlfe *n1,
+			  const struct zebra_nhlfe *n2)
+{
+	if (n1->gate_family != n2->gate_family)
+		return numcmp(n1->gate_family, n2->gate_family);
+
+	switch (n1->gate_family) {
+	case AF_INET:
+		return memcmp(&n1->nexthop->gate.ipv4, &n2->nexthop->gate.ipv4,
+			      sizeof(struct in_addr));
+	case AF_INET6:
+		return memcmp(&n1->nexthop->gate.ipv6, &n2->nexthop->gate.ipv6,
+			      sizeof(struct in6_addr));
+	}
+
+	return 0;
+}
+
+DECLARE_RBTREE_NONUNIQ(nhlfe_gate_index, struct zebra_nhlfe, gate_item,
+		       nhlfe_gate_cmp);
+
+static struct nhlfe_gate_index_head nhlfe_gate_index;
+
 /* static function declarations */
 
 static void fec_evaluate(struct zebra_vrf *zvrf);
@@ -71,9 +124,8 @@ static int nhlfe_nexthop_active(struct zebra_nhlfe *nhlfe);
 static void lsp_select_best_nhlfe(struct zebra_lsp *lsp);
 static void lsp_uninstall_from_kernel(struct hash_bucket *bucket, void *ctxt);
 static void lsp_schedule(struct hash_bucket *bucket, void *ctxt);
-static wq_item_status lsp_process(struct work_queue *wq, void *data);
-static void lsp_processq_del(struct work_queue *wq, void *data);
-static void lsp_processq_complete(struct work_queue *wq);
+static void lsp_process(struct zebra_lsp *lsp);
+static void lsp_process_done(struct zebra_lsp *lsp);
 static int lsp_processq_add(struct zebra_lsp *lsp);
 static void *lsp_alloc(void *p);
 
@@ -337,48 +389,34 @@ static int lsp_uninstall(struct zebra_vrf *zvrf, mpls_label_t label)
  */
 static void fec_evaluate(struct zebra_vrf *zvrf)
 {
-	struct route_node *rn;
 	struct zebra_fec *fec;
 	uint32_t old_label, new_label;
-	int af;
 
-	for (af = AFI_IP; af < AFI_MAX; af++) {
-		if (zvrf->fec_table[af] == NULL)
+	/* Only FECs with a label index can be affected */
+	frr_each (fec_index_list, &fec_index_fecs, fec) {
+		/* Skip configured FECs. */
+		if (CHECK_FLAG(fec->flags, FEC_FLAG_CONFIGURED))
 			continue;
 
-		for (rn = route_top(zvrf->fec_table[af]); rn;
-		     rn = route_next(rn)) {
-			if ((fec = rn->info) == NULL)
-				continue;
-
-			/* Skip configured FECs and those without a label index.
-			 */
-			if (CHECK_FLAG(fec->flags, FEC_FLAG_CONFIGURED)
-			    || fec->label_index == MPLS_INVALID_LABEL_INDEX)
-				continue;
-
-			/* Save old label, determine new label. */
-			old_label = fec->label;
-			new_label =
-				zvrf->mpls_srgb.start_label + fec->label_index;
-			if (new_label >= zvrf->mpls_srgb.end_label)
-				new_label = MPLS_INVALID_LABEL;
+		/* Save old label, determine new label. */
+		old_label = fec->label;
+		new_label = zvrf->mpls_srgb.start_label + fec->label_index;
+		if (new_label >= zvrf->mpls_srgb.end_label)
+			new_label = MPLS_INVALID_LABEL;
 
-			/* If label has changed, update FEC and clients. */
-			if (new_label == old_label)
-				continue;
+		/* If label has changed, update FEC and clients. */
+		if (new_label == old_label)
+			continue;
 
-			if (IS_ZEBRA_DEBUG_MPLS)
-				zlog_debug(
-					"Update fec %pRN new label %u upon label block",
-					rn, new_label);
+		if (IS_ZEBRA_DEBUG_MPLS)
+			zlog_debug("Update fec %pRN new label %u upon label block",
+				   fec->rn, new_label);
 
-			fec->label = new_label;
-			fec_update_clients(fec);
+		fec->label = new_label;
+		fec_update_clients(fec);
 
-			/* Update label forwarding entries appropriately */
-			fec_change_update_lsp(zvrf, fec, old_label, false);
-		}
+		/* Update label forwarding entries appropriately */
+		fec_change_update_lsp(zvrf, fec, old_label, false);
 	}
 }
 
@@ -561,6 +599,23 @@ static struct zebra_fec *fec_find(struct route_table *table, struct prefix *p)
 	return (rn->info);
 }
 
+/*
+ * Set the label index of a FEC, keeping track of the FECs that have one.
+ */
+static void fec_set_label_index(struct zebra_fec *fec, uint32_t label_index)
+{
+	if (fec->label_index == label_index)
+		return;
+
+	if (fec->label_index != MPLS_INVALID_LABEL_INDEX)
+		fec_index_list_del(&fec_index_fecs, fec);
+
+	fec->label_index = label_index;
+
+	if (fec->label_index != MPLS_INVALID_LABEL_INDEX)
+		fec_index_list_add_tail(&fec_index_fecs, fec);
+}
+
 /*
  * Add a FEC. This may be upon a client registering for a binding
  * or when a binding is configured.
@@ -587,11 +642,12 @@ static struct zebra_fec *fec_add(struct route_table *table, struct prefix *p,
 		rn->info = fec;
 		fec->rn = rn;
 		fec->label = label;
+		fec->label_index = MPLS_INVALID_LABEL_INDEX;
 		fec->client_list = list_new();
 	} else
 		route_unlock_node(rn); /* for the route_node_get */
 
-	fec->label_index = label_index;
+	fec_set_label_index(fec, label_index);
 	fec->flags = flags;
 
 	return fec;
@@ -604,6 +660,7 @@ static struct zebra_fec *fec_add(struct route_table *table, struct prefix *p,
  */
 static int fec_del(struct zebra_fec *fec)
 {
+	fec_set_label_index(fec, MPLS_INVALID_LABEL_INDEX);
 	list_delete(&fec->client_list);
 	fec->rn->info = NULL;
 	route_unlock_node(fec->rn);
@@ -910,18 +967,14 @@ static void lsp_uninstall_from_kernel(struct hash_bucket *bucket, void *ctxt)
  * Schedule LSP forwarding entry for processing. Called upon changes
  * that may impact LSPs such as nexthop / connected route changes.
  */
-static void lsp_schedule(struct hash_bucket *bucket, void *ctxt)
+static void lsp_schedule_lsp(struct zebra_lsp *lsp, bool external)
 {
-	struct zebra_lsp *lsp;
-
-	lsp = (struct zebra_lsp *)bucket->data;
-
 	/* In the common flow, this is used when external events occur. For
 	 * LSPs with backup nhlfes, we'll assume that the forwarding
 	 * plane will use the backups to handle these events, until the
 	 * owning protocol can react.
 	 */
-	if (ctxt == NULL) {
+	if (external) {
 		/* Skip LSPs with backups */
 		if (nhlfe_list_first(&lsp->backup_nhlfe_list) != NULL) {
 			if (IS_ZEBRA_DEBUG_MPLS_DETAIL)
@@ -934,21 +987,68 @@ static void lsp_schedule(struct hash_bucket *bucket, void *ctxt)
 	(void)lsp_processq_add(lsp);
 }
 
+static void lsp_schedule(struct hash_bucket *bucket, void *ctxt)
+{
+	lsp_schedule_lsp(bucket->data, ctxt == NULL);
+}
+
+/*
+ * Which address family a NHLFE's gateway is looked up in, for the gateway
+ * index; AF_UNSPEC if its state doesn't depend on the RIB by address.
+ */
+static uint8_t nhlfe_gate_family(const struct zebra_nhlfe *nhlfe)
+{
+	const struct nexthop *nexthop = nhlfe->nexthop;
+
+	switch (nexthop->type) {
+	case NEXTHOP_TYPE_IPV4:
+	case NEXTHOP_TYPE_IPV4_IFINDEX:
+		return AF_INET;
+	case NEXTHOP_TYPE_IPV6:
+	case NEXTHOP_TYPE_IPV6_IFINDEX:
+		if (IN6_IS_ADDR_LINKLOCAL(&nexthop->gate.ipv6))
+			return AF_UNSPEC;
+		return AF_INET6;
+	case NEXTHOP_TYPE_IFINDEX:
+	case NEXTHOP_TYPE_BLACKHOLE:
+		break;
+	}
+
+	return AF_UNSPEC;
+}
+
+/*
+ * Add any primary NHLFEs of a forwarding LSP that aren't in the gateway
+ * index yet. This is done when the LSP is processed, which every change
+ * to a forwarding LSP leads to; copies held by the dataplane and static
+ * LSP configuration are never processed and so never indexed.
+ */
+static void lsp_gate_index_update(struct zebra_lsp *lsp)
+{
+	struct zebra_nhlfe *nhlfe;
+
+	frr_each (nhlfe_list, &lsp->nhlfe_list, nhlfe) {
+		if (nhlfe->gate_indexed || !nhlfe->nexthop)
+			continue;
+
+		nhlfe->gate_family = nhlfe_gate_family(nhlfe);
+		nhlfe_gate_index_add(&nhlfe_gate_index, nhlfe);
+		nhlfe->gate_indexed = true;
+	}
+}
+
 /*
  * Process a LSP entry that is in the queue. Recalculate best NHLFE and
  * any multipaths and update or delete from the kernel, as needed.
  */
-static wq_item_status lsp_process(struct work_queue *wq, void *data)
+static void lsp_process(struct zebra_lsp *lsp)
 {
-	struct zebra_lsp *lsp;
 	struct zebra_nhlfe *oldbest, *newbest;
 	char buf[BUFSIZ], buf2[BUFSIZ];
 	struct zebra_vrf *zvrf = zebra_vrf_lookup_by_id(VRF_DEFAULT);
 	enum zebra_dplane_result res;
 
-	lsp = (struct zebra_lsp *)data;
-	if (!lsp) // unexpected
-		return WQ_SUCCESS;
+	lsp_gate_index_update(lsp);
 
 	oldbest = lsp->best_nhlfe;
 
@@ -1062,18 +1162,15 @@ static wq_item_status lsp_process(struct work_queue *wq, void *data)
 			}
 		}
 	}
-
-	return WQ_SUCCESS;
 }
 
 
 /*
- * Callback upon processing completion of a LSP forwarding entry.
+ * Cleanup upon processing completion of a LSP forwarding entry.
  */
-static void lsp_processq_del(struct work_queue *wq, void *data)
+static void lsp_process_done(struct zebra_lsp *lsp)
 {
 	struct zebra_vrf *zvrf;
-	struct zebra_lsp *lsp;
 	struct hash *lsp_table;
 	struct zebra_nhlfe *nhlfe;
 
@@ -1089,10 +1186,6 @@ static void lsp_processq_del(struct work_queue *wq, void *data)
 	if (!lsp_table) // unexpected
 		return;
 
-	lsp = (struct zebra_lsp *)data;
-	if (!lsp) // unexpected
-		return;
-
 	/* Clear flag, remove any NHLFEs marked for deletion. If no NHLFEs
 	 * exist,
 	 * delete LSP entry also.
@@ -1113,12 +1206,53 @@ static void lsp_processq_del(struct work_queue *wq, void *data)
 }
 
 /*
- * Callback upon finishing the processing of all scheduled
- * LSP forwarding entries.
+ * Process a batch of scheduled LSP forwarding entries, handing their
+ * updates to the dataplane together. Stops early if the dataplane is
+ * backed up, and comes back for whatever is left.
  */
-static void lsp_processq_complete(struct work_queue *wq)
+static void lsp_process_run(struct event *event)
 {
-	/* Nothing to do for now. */
+	struct zebra_lsp *lsp;
+	struct timeval start, end;
+	uint32_t count = 0;
+	uint64_t usec;
+
+	monotime(&start);
+
+	dplane_update_batch_begin();
+	while (count < LSP_PROCESS_BATCH &&
+	       (lsp = lsp_dirty_list_pop(&lsp_dirty_queue))) {
+		lsp_process(lsp);
+		lsp_process_done(lsp);
+		count++;
+
+		if (dplane_get_in_queue_len() > dplane_get_in_queue_limit())
+			break;
+	}
+	dplane_update_batch_end();
+
+	monotime(&end);
+	usec = timeval_elapsed(end, start);
+
+	lsp_stats.runs++;
+	lsp_stats.processed += count;
+	lsp_stats.max_batch = MAX(lsp_stats.max_batch, count);
+	lsp_stats.total_usec += usec;
+	lsp_stats.last_usec = usec;
+	lsp_stats.max_usec = MAX(lsp_stats.max_usec, usec);
+
+	if (IS_ZEBRA_DEBUG_MPLS_DETAIL)
+		zlog_debug("%s: processed %u LSPs in %" PRIu64
+			   " usec, %zu remaining",
+			   __func__, count, usec,
+			   lsp_dirty_list_count(&lsp_dirty_queue));
+
+	if (lsp_dirty_list_count(&lsp_dirty_queue))
+		event_add_timer_msec(zrouter.master, lsp_process_run, NULL,
+				     count < LSP_PROCESS_BATCH
+					     ? LSP_PROCESS_HOLD_MSEC
+					     : 0,
+				     &t_lsp_process);
 }
 
 /*
@@ -1130,14 +1264,18 @@ static int lsp_processq_add(struct zebra_lsp *lsp)
 	if (CHECK_FLAG(lsp->flags, LSP_FLAG_SCHEDULED))
 		return 0;
 
-	if (zrouter.lsp_process_q == NULL) {
+	if (!mpls_enabled) {
 		flog_err(EC_ZEBRA_WQ_NONEXISTENT,
-			 "%s: work_queue does not exist!", __func__);
+			 "%s: LSP processing is not enabled!", __func__);
 		return -1;
 	}
 
-	work_queue_add(zrouter.lsp_process_q, lsp);
+	lsp_dirty_list_add_tail(&lsp_dirty_queue, lsp);
 	SET_FLAG(lsp->flags, LSP_FLAG_SCHEDULED);
+
+	/* Changes arriving together are handled in one run */
+	event_add_timer_msec(zrouter.master, lsp_process_run, NULL,
+			     LSP_PROCESS_HOLD_MSEC, &t_lsp_process);
 	return 0;
 }
 
@@ -1212,6 +1350,9 @@ static void lsp_free(struct hash *lsp_table, struct zebra_lsp **plsp)
 
 	lsp_free_nhlfe(lsp);
 
+	if (CHECK_FLAG(lsp->flags, LSP_FLAG_SCHEDULED))
+		lsp_dirty_list_del(&lsp_dirty_queue, lsp);
+
 	hash_release(lsp_table, &lsp->ile);
 	XFREE(MTYPE_LSP, lsp);
 
@@ -1406,6 +1547,9 @@ static void nhlfe_free(struct zebra_nhlfe *nhlfe)
 	if (!nhlfe)
 		return;
 
+	if (nhlfe->gate_indexed)
+		nhlfe_gate_index_del(&nhlfe_gate_index, nhlfe);
+
 	/* Free nexthop. */
 	if (nhlfe->nexthop)
 		nexthop_free(nhlfe->nexthop);
@@ -1785,17 +1929,17 @@ static int lsp_cmp(const struct zebra_lsp *lsp1, const struct zebra_lsp *lsp2)
 }
 
 /*
- * Initialize work queue for processing changed LSPs.
+ * Drop any LSPs still waiting to be processed; called on shutdown, the
+ * LSPs themselves are released along with their tables.
  */
-static void mpls_processq_init(void)
+void zebra_mpls_process_finish(void)
 {
-	zrouter.lsp_process_q = work_queue_new(zrouter.master, "LSP processing");
+	struct zebra_lsp *lsp;
+
+	event_cancel(&t_lsp_process);
 
-	zrouter.lsp_process_q->spec.workfunc = &lsp_process;
-	zrouter.lsp_process_q->spec.del_item_data = &lsp_processq_del;
-	zrouter.lsp_process_q->spec.completion_func = &lsp_processq_complete;
-	zrouter.lsp_process_q->spec.max_retries = 0;
-	zrouter.lsp_process_q->spec.hold = 10;
+	while ((lsp = lsp_dirty_list_pop(&lsp_dirty_queue)))
+		UNSET_FLAG(lsp->flags, LSP_FLAG_SCHEDULED);
 }
 
 
@@ -2353,7 +2497,7 @@ int zebra_mpls_fec_register(struct zebra_vrf *zvrf, struct prefix *p,
 
 		/* Save current label, update the FEC */
 		old_label = fec->label;
-		fec->label_index = label_index;
+		fec_set_label_index(fec, label_index);
 	}
 
 	if (new_client)
@@ -3717,9 +3861,154 @@ void zebra_mpls_lsp_schedule(struct zebra_vrf *zvrf)
 {
 	if (!zvrf)
 		return;
+	lsp_stats.full_schedules++;
 	hash_iterate(zvrf->lsp_table, lsp_schedule, NULL);
 }
 
+/*
+ * Schedule the MPLS label forwarding entries with a nexthop that may
+ * resolve through the given prefix: those whose gateway falls within it,
+ * plus those that don't resolve by address at all.
+ */
+void zebra_mpls_lsp_schedule_prefix(struct zebra_vrf *zvrf,
+				    const struct prefix *p)
+{
+	struct zebra_nhlfe *nhlfe;
+	struct zebra_nhlfe ref = {};
+	struct nexthop ref_nh = {};
+	struct prefix pmask, gate;
+	uint64_t count = 0;
+
+	if (!zvrf)
+		return;
+
+	if (p->family != AF_INET && p->family != AF_INET6) {
+		zebra_mpls_lsp_schedule(zvrf);
+		return;
+	}
+
+	lsp_stats.prefix_schedules++;
+
+	frr_each (nhlfe_gate_index, &nhlfe_gate_index, nhlfe) {
+		if (nhlfe->gate_family != AF_UNSPEC)
+			break;
+		lsp_schedule_lsp(nhlfe->lsp, true);
+		count++;
+	}
+
+	/* Gateways within the prefix are contiguous in the index, starting
+	 * at its (masked) network address.
+	 */
+	prefix_copy(&pmask, p);
+	apply_mask(&pmask);
+
+	ref.nexthop = &ref_nh;
+	ref.gate_family = pmask.family;
+	if (pmask.family == AF_INET)
+		ref_nh.gate.ipv4 = pmask.u.prefix4;
+	else
+		ref_nh.gate.ipv6 = pmask.u.prefix6;
+
+	memset(&gate, 0, sizeof(gate));
+	gate.family = pmask.family;
+	gate.prefixlen = pmask.family == AF_INET ? IPV4_MAX_BITLEN
+						 : IPV6_MAX_BITLEN;
+
+	for (nhlfe = nhlfe_gate_index_find_gteq(&nhlfe_gate_index, &ref);
+	     nhlfe; nhlfe = nhlfe_gate_index_next(&nhlfe_gate_index, nhlfe)) {
+		if (nhlfe->gate_family != pmask.family)
+			break;
+
+		if (pmask.family == AF_INET)
+			gate.u.prefix4 = nhlfe->nexthop->gate.ipv4;
+		else
+			gate.u.prefix6 = nhlfe->nexthop->gate.ipv6;
+
+		if (!prefix_match(&pmask, &gate))
+			break;
+
+		lsp_schedule_lsp(nhlfe->lsp, true);
+		count++;
+	}
+
+	lsp_stats.prefix_scheduled += count;
+
+	if (IS_ZEBRA_DEBUG_MPLS_DETAIL)
+		zlog_debug("%s: %pFX matched %" PRIu64 " nexthops", __func__,
+			   p, count);
+}
+
+/*
+ * Display LSP processing statistics (VTY command handler).
+ */
+void zebra_mpls_print_lsp_summary(struct vty *vty, struct zebra_vrf *zvrf,
+				  bool use_json)
+{
+	json_object *json;
+	uint64_t avg_usec;
+
+	avg_usec = lsp_stats.runs ? lsp_stats.total_usec / lsp_stats.runs : 0;
+
+	if (use_json) {
+		json = json_object_new_object();
+
+		json_object_int_add(json, "lsps", hashcount(zvrf->lsp_table));
+		json_object_int_add(json, "staticLsps",
+				    hashcount(zvrf->slsp_table));
+		json_object_int_add(json, "indexedNexthops",
+				    nhlfe_gate_index_count(&nhlfe_gate_index));
+		json_object_int_add(json, "indexedFecs",
+				    fec_index_list_count(&fec_index_fecs));
+		json_object_int_add(json, "scheduled",
+				    lsp_dirty_list_count(&lsp_dirty_queue));
+		json_object_int_add(json, "processRuns", lsp_stats.runs);
+		json_object_int_add(json, "processed", lsp_stats.processed);
+		json_object_int_add(json, "maxBatch", lsp_stats.max_batch);
+		json_object_int_add(json, "lastRunUsec", lsp_stats.last_usec);
+		json_object_int_add(json, "avgRunUsec", avg_usec);
+		json_object_int_add(json, "maxRunUsec", lsp_stats.max_usec);
+		json_object_int_add(json, "fullSchedules",
+				    lsp_stats.full_schedules);
+		json_object_int_add(json, "prefixSchedules",
+				    lsp_stats.prefix_schedules);
+		json_object_int_add(json, "prefixScheduledNexthops",
+				    lsp_stats.prefix_scheduled);
+		json_object_int_add(json, "installsQueued",
+				    zvrf->lsp_installs_queued);
+		json_object_int_add(json, "removalsQueued",
+				    zvrf->lsp_removals_queued);
+
+		vty_json(vty, json);
+		return;
+	}
+
+	vty_out(vty, "LSPs:                      %lu (%lu static)\n",
+		hashcount(zvrf->lsp_table), hashcount(zvrf->slsp_table));
+	vty_out(vty, "Indexed nexthops:          %zu\n",
+		nhlfe_gate_index_count(&nhlfe_gate_index));
+	vty_out(vty, "FECs with label index:     %zu\n",
+		fec_index_list_count(&fec_index_fecs));
+	vty_out(vty, "Scheduled for processing:  %zu\n",
+		lsp_dirty_list_count(&lsp_dirty_queue));
+	vty_out(vty, "Processing runs:           %" PRIu64 "\n", lsp_stats.runs);
+	vty_out(vty, "LSPs processed:            %" PRIu64 " (max %u per run)\n",
+		lsp_stats.processed, lsp_stats.max_batch);
+	vty_out(vty,
+		"Run time (usec):           last %" PRIu64 ", avg %" PRIu64
+		", max %" PRIu64 "\n",
+		lsp_stats.last_usec, avg_usec, lsp_stats.max_usec);
+	vty_out(vty, "Full table schedules:      %" PRIu64 "\n",
+		lsp_stats.full_schedules);
+	vty_out(vty,
+		"Prefix schedules:          %" PRIu64 " (%" PRIu64
+		" nexthops matched)\n",
+		lsp_stats.prefix_schedules, lsp_stats.prefix_scheduled);
+	vty_out(vty, "Installs queued:           %" PRIu64 "\n",
+		zvrf->lsp_installs_queued);
+	vty_out(vty, "Removals queued:           %" PRIu64 "\n",
+		zvrf->lsp_removals_queued);
+}
+
 /*
  * Display MPLS label forwarding table for a specific LSP
  * (VTY command handler).
@@ -4097,7 +4386,6 @@ void zebra_mpls_init_tables(struct zebra_vrf *zvrf)
 void zebra_mpls_turned_on(void)
 {
 	if (!mpls_enabled) {
-		mpls_processq_init();
 		mpls_enabled = true;
 
 		hook_register(zserv_client_close,
@@ -4115,6 +4403,10 @@ void zebra_mpls_init(void)
 	mpls_enabled = false;
 	mpls_pw_reach_strict = false;
 
+	lsp_dirty_list_init(&lsp_dirty_queue);
+	nhlfe_gate_index_init(&nhlfe_gate_index);
+	fec_index_list_init(&fec_index_fecs);
+
 	if (mpls_kernel_init() < 0) {
 		flog_warn(EC_ZEBRA_MPLS_SUPPORT_DISABLED,
 			  "Disabling MPLS support (no kernel support)");
@@ -35,6 +35,12 @@ extern "C" {
 
 /* Declare LSP nexthop list types */
 PREDECL_DLIST(nhlfe_list);
+/* NHLFEs of forwarding LSPs, indexed by gateway address */
+PREDECL_RBTREE_NONUNIQ(nhlfe_gate_index);
+/* LSPs waiting to be processed */
+PREDECL_DLIST(lsp_dirty_list);
+/* FECs whose label is derived from the label block */
+PREDECL_DLIST(fec_index_list);
 
 /*
  * (Outgoing) nexthop label forwarding entry
@@ -62,6 +68,14 @@ struct zebra_nhlfe {
 
 	/* Linkage for LSPs' lists */
 	struct nhlfe_list_item list;
+
+	/* Gateway index linkage, only used for LSPs in the forwarding table.
+	 * gate_family is AF_UNSPEC for nexthops that don't resolve through
+	 * the RIB by address (interface and link-local nexthops).
+	 */
+	struct nhlfe_gate_index_item gate_item;
+	uint8_t gate_family;
+	bool gate_indexed;
 };
 
 /*
@@ -100,6 +114,9 @@ struct zebra_lsp {
 	/* Address-family of NHLFE - saved here for delete. All NHLFEs */
 	/* have to be of the same AF */
 	uint8_t addr_family;
+
+	/* Linkage for the processing queue, while LSP_FLAG_SCHEDULED */
+	struct lsp_dirty_list_item dirty_item;
 };
 
 /*
@@ -121,10 +138,15 @@ struct zebra_fec {
 
 	/* Clients interested in this FEC. */
 	struct list *client_list;
+
+	/* Linkage for FECs with a valid label index */
+	struct fec_index_list_item index_item;
 };
 
 /* Declare typesafe list apis/macros */
 DECLARE_DLIST(nhlfe_list, struct zebra_nhlfe, list);
+DECLARE_DLIST(lsp_dirty_list, struct zebra_lsp, dirty_item);
+DECLARE_DLIST(fec_index_list, struct zebra_fec, index_item);
 
 /* Function declarations. */
 
@@ -362,6 +384,19 @@ void zebra_mpls_process_dplane_notify(struct zebra_dplane_ctx *ctx);
  */
 void zebra_mpls_lsp_schedule(struct zebra_vrf *zvrf);
 
+/*
+ * Schedule only the MPLS label forwarding entries whose nexthops may
+ * resolve through the given prefix, after a RIB change for it.
+ */
+void zebra_mpls_lsp_schedule_prefix(struct zebra_vrf *zvrf,
+				    const struct prefix *p);
+
+/*
+ * Display LSP processing statistics (VTY command handler).
+ */
+void zebra_mpls_print_lsp_summary(struct vty *vty, struct zebra_vrf *zvrf,
+				  bool use_json);
+
 /*
  * Display MPLS label forwarding table for a specific LSP
  * (VTY command handler).
@@ -413,6 +448,11 @@ void zebra_mpls_turned_on(void);
 void zebra_mpls_init(void);
 void zebra_mpls_terminate(void);
 
+/*
+ * Drop any LSPs still waiting to be processed; called on shutdown.
+ */
+void zebra_mpls_process_finish(void);
+
 /*
  * MPLS VTY.
  */
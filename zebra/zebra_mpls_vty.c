@@ -323,6 +323,23 @@ DEFUN (show_mpls_table,
 	return CMD_SUCCESS;
 }
 
+DEFUN (show_mpls_table_summary,
+       show_mpls_table_summary_cmd,
+       "show mpls table summary [json]",
+       SHOW_STR
+       MPLS_STR
+       "MPLS table\n"
+       "LSP processing summary\n"
+       JSON_STR)
+{
+	struct zebra_vrf *zvrf;
+	bool uj = use_json(argc, argv);
+
+	zvrf = zebra_vrf_lookup_by_id(VRF_DEFAULT);
+	zebra_mpls_print_lsp_summary(vty, zvrf, uj);
+	return CMD_SUCCESS;
+}
+
 DEFUN (show_mpls_table_lsp,
        show_mpls_table_lsp_cmd,
        "show mpls table (16-1048575) [json]",
@@ -450,6 +467,7 @@ void zebra_mpls_vty_init(void)
 	install_element(CONFIG_NODE, &no_mpls_label_global_block_cmd);
 
 	install_element(VIEW_NODE, &show_mpls_table_cmd);
+	install_element(VIEW_NODE, &show_mpls_table_summary_cmd);
 	install_element(VIEW_NODE, &show_mpls_table_lsp_cmd);
 	install_element(VIEW_NODE, &show_mpls_fec_cmd);
 }
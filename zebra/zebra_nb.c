@@ -61,6 +61,94 @@ const struct frr_yang_module_info frr_zebra_info = {
 				.get_elem = zebra_state_mpls_forwarding_get_elem,
 			}
 		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/meta-queue-depth",
+			.cbs = {
+				.get_elem = zebra_state_route_install_meta_queue_depth_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/meta-queue-max-depth",
+			.cbs = {
+				.get_elem = zebra_state_route_install_meta_queue_max_depth_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/dplane-queue-depth",
+			.cbs = {
+				.get_elem = zebra_state_route_install_dplane_queue_depth_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/dplane-queue-max-depth",
+			.cbs = {
+				.get_elem = zebra_state_route_install_dplane_queue_max_depth_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/results-queue-depth",
+			.cbs = {
+				.get_elem = zebra_state_route_install_results_queue_depth_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/results-queue-max-depth",
+			.cbs = {
+				.get_elem = zebra_state_route_install_results_queue_max_depth_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/stage",
+			.cbs = {
+				.get_next = zebra_state_route_install_stage_get_next,
+				.get_keys = zebra_state_route_install_stage_get_keys,
+				.lookup_entry = zebra_state_route_install_stage_lookup_entry,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/stage/name",
+			.cbs = {
+				.get_elem = zebra_state_route_install_stage_name_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/stage/count",
+			.cbs = {
+				.get_elem = zebra_state_route_install_stage_count_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/stage/average",
+			.cbs = {
+				.get_elem = zebra_state_route_install_stage_average_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/stage/max",
+			.cbs = {
+				.get_elem = zebra_state_route_install_stage_max_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/stage/bucket",
+			.cbs = {
+				.get_next = zebra_state_route_install_stage_bucket_get_next,
+				.get_keys = zebra_state_route_install_stage_bucket_get_keys,
+				.lookup_entry = zebra_state_route_install_stage_bucket_lookup_entry,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/stage/bucket/upper-bound",
+			.cbs = {
+				.get_elem = zebra_state_route_install_stage_bucket_upper_bound_get_elem,
+			}
+		},
+		{
+			.xpath = "/frr-zebra:zebra/state/route-install/stage/bucket/count",
+			.cbs = {
+				.get_elem = zebra_state_route_install_stage_bucket_count_get_elem,
+			}
+		},
 		{
 			.xpath = "/frr-zebra:zebra/workqueue-hold-timer",
 			.cbs = {
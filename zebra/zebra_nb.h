@@ -38,6 +38,36 @@ int zebra_ipv6_forwarding_destroy(struct nb_cb_destroy_args *args);
 int zebra_workqueue_hold_timer_modify(struct nb_cb_modify_args *args);
 struct yang_data *zebra_ipv6_forwarding_get_elem(struct nb_cb_get_elem_args *args);
 struct yang_data *zebra_state_mpls_forwarding_get_elem(struct nb_cb_get_elem_args *args);
+struct yang_data *
+zebra_state_route_install_meta_queue_depth_get_elem(struct nb_cb_get_elem_args *args);
+struct yang_data *
+zebra_state_route_install_meta_queue_max_depth_get_elem(struct nb_cb_get_elem_args *args);
+struct yang_data *
+zebra_state_route_install_dplane_queue_depth_get_elem(struct nb_cb_get_elem_args *args);
+struct yang_data *
+zebra_state_route_install_dplane_queue_max_depth_get_elem(struct nb_cb_get_elem_args *args);
+struct yang_data *
+zebra_state_route_install_results_queue_depth_get_elem(struct nb_cb_get_elem_args *args);
+struct yang_data *
+zebra_state_route_install_results_queue_max_depth_get_elem(struct nb_cb_get_elem_args *args);
+const void *zebra_state_route_install_stage_get_next(struct nb_cb_get_next_args *args);
+int zebra_state_route_install_stage_get_keys(struct nb_cb_get_keys_args *args);
+const void *zebra_state_route_install_stage_lookup_entry(struct nb_cb_lookup_entry_args *args);
+struct yang_data *
+zebra_state_route_install_stage_name_get_elem(struct nb_cb_get_elem_args *args);
+struct yang_data *
+zebra_state_route_install_stage_count_get_elem(struct nb_cb_get_elem_args *args);
+struct yang_data *
+zebra_state_route_install_stage_average_get_elem(struct nb_cb_get_elem_args *args);
+struct yang_data *
+zebra_state_route_install_stage_max_get_elem(struct nb_cb_get_elem_args *args);
+const void *zebra_state_route_install_stage_bucket_get_next(struct nb_cb_get_next_args *args);
+int zebra_state_route_install_stage_bucket_get_keys(struct nb_cb_get_keys_args *args);
+const void *zebra_state_route_install_stage_bucket_lookup_entry(struct nb_cb_lookup_entry_args *args);
+struct yang_data *
+zebra_state_route_install_stage_bucket_upper_bound_get_elem(struct nb_cb_get_elem_args *args);
+struct yang_data *
+zebra_state_route_install_stage_bucket_count_get_elem(struct nb_cb_get_elem_args *args);
 int zebra_zapi_packets_modify(struct nb_cb_modify_args *args);
 int zebra_import_kernel_table_create(struct nb_cb_create_args *args);
 int zebra_import_kernel_table_destroy(struct nb_cb_destroy_args *args);
@@ -17,6 +17,8 @@
 #include "zebra/ipforward.h"
 #include "zebra/router-id.h"
 #include "zebra/zebra_mpls.h"
+#include "zebra/zebra_latency.h"
+#include "zebra/zebra_dplane.h"
 
 /*
  * XPath: /frr-interface:lib/interface/frr-zebra:zebra/state/up-count
@@ -586,8 +588,8 @@ struct yang_data *lib_vrf_zebra_ribs_rib_route_route_entry_tag_get_elem(
 {
 	struct route_entry *re = (struct route_entry *)args->list_entry;
 
-	if (re->tag)
-		return yang_data_new_uint32(args->xpath, re->tag);
+	if (re_tag(re))
+		return yang_data_new_uint32(args->xpath, re_tag(re));
 
 	return NULL;
 }
@@ -1281,3 +1283,240 @@ struct yang_data *zebra_state_mpls_forwarding_get_elem(struct nb_cb_get_elem_arg
 {
 	return yang_data_new_bool(args->xpath, mpls_enabled);
 }
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/meta-queue-depth
+ */
+struct yang_data *
+zebra_state_route_install_meta_queue_depth_get_elem(struct nb_cb_get_elem_args *args)
+{
+	return yang_data_new_uint32(args->xpath, zebra_rib_meta_queue_size());
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/meta-queue-max-depth
+ */
+struct yang_data *
+zebra_state_route_install_meta_queue_max_depth_get_elem(struct nb_cb_get_elem_args *args)
+{
+	return yang_data_new_uint32(args->xpath, zebra_rib_meta_queue_max());
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/dplane-queue-depth
+ */
+struct yang_data *
+zebra_state_route_install_dplane_queue_depth_get_elem(struct nb_cb_get_elem_args *args)
+{
+	return yang_data_new_uint32(args->xpath, dplane_get_in_queue_len());
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/dplane-queue-max-depth
+ */
+struct yang_data *
+zebra_state_route_install_dplane_queue_max_depth_get_elem(struct nb_cb_get_elem_args *args)
+{
+	return yang_data_new_uint32(args->xpath, dplane_get_in_queue_max());
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/results-queue-depth
+ */
+struct yang_data *
+zebra_state_route_install_results_queue_depth_get_elem(struct nb_cb_get_elem_args *args)
+{
+	return yang_data_new_uint32(args->xpath, zebra_rib_dplane_results_count());
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/results-queue-max-depth
+ */
+struct yang_data *
+zebra_state_route_install_results_queue_max_depth_get_elem(struct nb_cb_get_elem_args *args)
+{
+	return yang_data_new_uint32(args->xpath, zebra_rib_dplane_results_max());
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/stage
+ *
+ * List entries are the stage names returned by zebra_lat_stage_name().
+ */
+const void *zebra_state_route_install_stage_get_next(struct nb_cb_get_next_args *args)
+{
+	enum zebra_lat_stage stage = ZEBRA_LAT_ZAPI_INPUT;
+
+	if (args->list_entry)
+		stage = zebra_lat_stage_by_name(args->list_entry) + 1;
+
+	if (stage >= ZEBRA_LAT_STAGE_MAX)
+		return NULL;
+
+	return zebra_lat_stage_name(stage);
+}
+
+int zebra_state_route_install_stage_get_keys(struct nb_cb_get_keys_args *args)
+{
+	args->keys->num = 1;
+	strlcpy(args->keys->key[0], args->list_entry, sizeof(args->keys->key[0]));
+
+	return NB_OK;
+}
+
+const void *zebra_state_route_install_stage_lookup_entry(struct nb_cb_lookup_entry_args *args)
+{
+	enum zebra_lat_stage stage = zebra_lat_stage_by_name(args->keys->key[0]);
+
+	if (stage >= ZEBRA_LAT_STAGE_MAX)
+		return NULL;
+
+	return zebra_lat_stage_name(stage);
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/stage/name
+ */
+struct yang_data *
+zebra_state_route_install_stage_name_get_elem(struct nb_cb_get_elem_args *args)
+{
+	return yang_data_new_enum(args->xpath,
+				  zebra_lat_stage_by_name(args->list_entry));
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/stage/count
+ */
+struct yang_data *
+zebra_state_route_install_stage_count_get_elem(struct nb_cb_get_elem_args *args)
+{
+	struct zebra_lat_stats stats;
+
+	zebra_lat_get(zebra_lat_stage_by_name(args->list_entry), &stats);
+	return yang_data_new_uint64(args->xpath, stats.count);
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/stage/average
+ */
+struct yang_data *
+zebra_state_route_install_stage_average_get_elem(struct nb_cb_get_elem_args *args)
+{
+	struct zebra_lat_stats stats;
+
+	zebra_lat_get(zebra_lat_stage_by_name(args->list_entry), &stats);
+	return yang_data_new_uint32(args->xpath,
+				    stats.count ? stats.total / stats.count : 0);
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/stage/max
+ */
+struct yang_data *
+zebra_state_route_install_stage_max_get_elem(struct nb_cb_get_elem_args *args)
+{
+	struct zebra_lat_stats stats;
+
+	zebra_lat_get(zebra_lat_stage_by_name(args->list_entry), &stats);
+	return yang_data_new_uint32(args->xpath, stats.max);
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/stage/bucket
+ *
+ * A bucket's leaves need its stage too, so list entries point into a
+ * table of both. Only buckets with samples are listed.
+ */
+struct lat_bucket_ref {
+	enum zebra_lat_stage stage;
+	unsigned int bucket;
+};
+
+static struct lat_bucket_ref lat_bucket_refs[ZEBRA_LAT_STAGE_MAX][ZEBRA_LAT_BUCKETS];
+
+static const struct lat_bucket_ref *lat_bucket_ref_get(enum zebra_lat_stage stage,
+						       unsigned int bucket)
+{
+	struct lat_bucket_ref *ref = &lat_bucket_refs[stage][bucket];
+
+	ref->stage = stage;
+	ref->bucket = bucket;
+	return ref;
+}
+
+const void *zebra_state_route_install_stage_bucket_get_next(struct nb_cb_get_next_args *args)
+{
+	const struct lat_bucket_ref *ref = args->list_entry;
+	enum zebra_lat_stage stage;
+	struct zebra_lat_stats stats;
+	unsigned int i = 0;
+
+	stage = zebra_lat_stage_by_name(args->parent_list_entry);
+	if (stage >= ZEBRA_LAT_STAGE_MAX)
+		return NULL;
+
+	if (ref)
+		i = ref->bucket + 1;
+
+	zebra_lat_get(stage, &stats);
+	for (; i < ZEBRA_LAT_BUCKETS; i++)
+		if (stats.buckets[i])
+			return lat_bucket_ref_get(stage, i);
+
+	return NULL;
+}
+
+int zebra_state_route_install_stage_bucket_get_keys(struct nb_cb_get_keys_args *args)
+{
+	const struct lat_bucket_ref *ref = args->list_entry;
+
+	args->keys->num = 1;
+	snprintfrr(args->keys->key[0], sizeof(args->keys->key[0]), "%u",
+		   zebra_lat_bucket_bounds[ref->bucket]);
+
+	return NB_OK;
+}
+
+const void *
+zebra_state_route_install_stage_bucket_lookup_entry(struct nb_cb_lookup_entry_args *args)
+{
+	enum zebra_lat_stage stage;
+	uint32_t bound;
+	unsigned int i;
+
+	stage = zebra_lat_stage_by_name(args->parent_list_entry);
+	if (stage >= ZEBRA_LAT_STAGE_MAX)
+		return NULL;
+
+	bound = yang_str2uint32(args->keys->key[0]);
+	for (i = 0; i < ZEBRA_LAT_BUCKETS; i++)
+		if (zebra_lat_bucket_bounds[i] == bound)
+			return lat_bucket_ref_get(stage, i);
+
+	return NULL;
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/stage/bucket/upper-bound
+ */
+struct yang_data *
+zebra_state_route_install_stage_bucket_upper_bound_get_elem(struct nb_cb_get_elem_args *args)
+{
+	const struct lat_bucket_ref *ref = args->list_entry;
+
+	return yang_data_new_uint32(args->xpath,
+				    zebra_lat_bucket_bounds[ref->bucket]);
+}
+
+/*
+ * XPath: /frr-zebra:zebra/state/route-install/stage/bucket/count
+ */
+struct yang_data *
+zebra_state_route_install_stage_bucket_count_get_elem(struct nb_cb_get_elem_args *args)
+{
+	const struct lat_bucket_ref *ref = args->list_entry;
+	struct zebra_lat_stats stats;
+
+	zebra_lat_get(ref->stage, &stats);
+	return yang_data_new_uint64(args->xpath, stats.buckets[ref->bucket]);
+}
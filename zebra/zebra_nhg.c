@@ -34,6 +34,7 @@
 DEFINE_MTYPE_STATIC(ZEBRA, NHG, "Nexthop Group Entry");
 DEFINE_MTYPE_STATIC(ZEBRA, NHG_CONNECTED, "Nexthop Group Connected");
 DEFINE_MTYPE_STATIC(ZEBRA, NHG_CTX, "Nexthop Group Context");
+DEFINE_MTYPE_STATIC(ZEBRA, NH_RESOLVE_CACHE, "Nexthop resolution cache");
 
 /* Map backup nexthop indices between two nhes */
 struct backup_nh_map_s {
@@ -45,6 +46,13 @@ struct backup_nh_map_s {
 	} map[MULTIPATH_NUM];
 };
 
+/*
+ * Stack space for lookup keys: enough for a MULTIPATH_NUM-way group with
+ * each nexthop resolved through one other. Keys with labels, SRv6 data,
+ * backups or deeper resolution may still spill to the heap.
+ */
+#define NHG_KEY_BUF_SIZE NEXTHOP_GROUP_KEY_GROUP_SIZE(2 * MULTIPATH_NUM)
+
 /* id counter to keep in sync with kernel */
 uint32_t id_counter;
 
@@ -401,6 +409,7 @@ struct nhg_hash_entry *zebra_nhg_alloc(void)
 	struct nhg_hash_entry *nhe;
 
 	nhe = XCALLOC(MTYPE_NHG, sizeof(struct nhg_hash_entry));
+	re_nhe_list_init(&nhe->routes);
 
 	return nhe;
 }
@@ -449,6 +458,9 @@ static void *zebra_nhg_hash_alloc(void *arg)
 
 	nhe = zebra_nhe_copy(copy, copy->id);
 
+	if (copy->nhg_key.data)
+		nexthop_group_key_copy(&nhe->nhg_key, &copy->nhg_key);
+
 	/* Mark duplicate nexthops in a group at creation time. */
 	nexthop_group_mark_duplicates(&(nhe->nhg));
 
@@ -483,73 +495,43 @@ uint32_t zebra_nhg_hash_key(const void *arg)
 {
 	const struct nhg_hash_entry *nhe = arg;
 	uint32_t key = 0x5a351234;
-	uint32_t primary = 0;
-	uint32_t backup = 0;
-
-	primary = nexthop_group_hash(&(nhe->nhg));
-	if (nhe->backup_info)
-		backup = nexthop_group_hash(&(nhe->backup_info->nhe->nhg));
 
-	key = jhash_3words(primary, backup, nhe->type, key);
+	key = jhash_3words((uint32_t)nhe->nhg_key.hash,
+			   (uint32_t)(nhe->nhg_key.hash >> 32), nhe->type, key);
 
 	key = jhash_2words(nhe->vrf_id, nhe->afi, key);
 
 	return key;
 }
 
-uint32_t zebra_nhg_id_key(const void *arg)
+/*
+ * Build the flat key for an nhe about to be looked up in, or added to, the
+ * zebra-owned hash. Primary and backup nexthops go into the same key; a
+ * present-but-empty backup list still adds a (zero-length) group, so it
+ * doesn't match an nhe without backup info.
+ */
+static void zebra_nhe_key_build(struct nhg_hash_entry *nhe, void *buf,
+				size_t size)
 {
-	const struct nhg_hash_entry *nhe = arg;
-
-	return nhe->id;
+	nexthop_group_key_init(&nhe->nhg_key, buf, size);
+	nexthop_group_key_add(&nhe->nhg_key, &nhe->nhg);
+	if (nhe->backup_info)
+		nexthop_group_key_add(&nhe->nhg_key,
+				      &nhe->backup_info->nhe->nhg);
+	nexthop_group_key_finish(&nhe->nhg_key);
 }
 
-/* Helper with common nhg/nhe nexthop comparison logic */
-static bool nhg_compare_nexthops(const struct nexthop *nh1,
-				 const struct nexthop *nh2)
+uint32_t zebra_nhg_id_key(const void *arg)
 {
-	assert(nh1 != NULL && nh2 != NULL);
-
-	/*
-	 * We have to check the active flag of each individual one,
-	 * not just the overall active_num. This solves the special case
-	 * issue of a route with a nexthop group with one nexthop
-	 * resolving to itself and thus marking it inactive. If we
-	 * have two different routes each wanting to mark a different
-	 * nexthop inactive, they need to hash to two different groups.
-	 *
-	 * If we just hashed on num_active, they would hash the same
-	 * which is incorrect.
-	 *
-	 * ex)
-	 *      1.1.1.0/24
-	 *           -> 1.1.1.1 dummy1 (inactive)
-	 *           -> 1.1.2.1 dummy2
-	 *
-	 *      1.1.2.0/24
-	 *           -> 1.1.1.1 dummy1
-	 *           -> 1.1.2.1 dummy2 (inactive)
-	 *
-	 * Without checking each individual one, they would hash to
-	 * the same group and both have 1.1.1.1 dummy1 marked inactive.
-	 *
-	 */
-	if (CHECK_FLAG(nh1->flags, NEXTHOP_FLAG_ACTIVE)
-	    != CHECK_FLAG(nh2->flags, NEXTHOP_FLAG_ACTIVE))
-		return false;
-
-	if (!nexthop_same(nh1, nh2))
-		return false;
+	const struct nhg_hash_entry *nhe = arg;
 
-	return true;
+	return nhe->id;
 }
 
 bool zebra_nhg_hash_equal(const void *arg1, const void *arg2)
 {
 	const struct nhg_hash_entry *nhe1 = arg1;
 	const struct nhg_hash_entry *nhe2 = arg2;
-	struct nexthop *nexthop1;
-	struct nexthop *nexthop2;
 
 	/* If both NHG's have id's then we can just know that
 	 * they are either identical or not.  This comparison
@@ -582,50 +564,23 @@ bool zebra_nhg_hash_equal(const void *arg1, const void *arg2)
 	if (nhe1->nhg.nhgr.unbalanced_timer != nhe2->nhg.nhgr.unbalanced_timer)
 		return false;
 
-	/* Nexthops should be in-order, so we simply compare them in-place */
-	for (nexthop1 = nhe1->nhg.nexthop, nexthop2 = nhe2->nhg.nexthop;
-	     nexthop1 && nexthop2;
-	     nexthop1 = nexthop_next(nexthop1), nexthop2 = nexthop_next(nexthop2)) {
-		if (!nhg_compare_nexthops(nexthop1, nexthop2))
-			return false;
-	}
-
-	/* Check for unequal list lengths */
-	if (nexthop1 || nexthop2)
-		return false;
-
-	/* If there's no backup info, comparison is done. */
-	if ((nhe1->backup_info == NULL) && (nhe2->backup_info == NULL))
-		return true;
-
-	/* Compare backup info also - test the easy things first */
-	if (nhe1->backup_info && (nhe2->backup_info == NULL))
-		return false;
-	if (nhe2->backup_info && (nhe1->backup_info == NULL))
-		return false;
-
-	/* Compare number of backups before actually comparing any */
-	for (nexthop1 = nhe1->backup_info->nhe->nhg.nexthop,
-	     nexthop2 = nhe2->backup_info->nhe->nhg.nexthop;
-	     nexthop1 && nexthop2;
-	     nexthop1 = nexthop1->next, nexthop2 = nexthop2->next) {
-		;
-	}
-
-	/* Did we find the end of one list before the other? */
-	if (nexthop1 || nexthop2)
-		return false;
-
-	/* Have to compare the backup nexthops */
-	for (nexthop1 = nhe1->backup_info->nhe->nhg.nexthop,
-	     nexthop2 = nhe2->backup_info->nhe->nhg.nexthop;
-	     nexthop1 && nexthop2;
-	     nexthop1 = nexthop_next(nexthop1), nexthop2 = nexthop_next(nexthop2)) {
-		if (!nhg_compare_nexthops(nexthop1, nexthop2))
-			return false;
-	}
-
-	return true;
+	/*
+	 * The keys cover the primary and backup nexthops in order, with
+	 * each one's ACTIVE flag. That flag matters, not just the overall
+	 * active count: a route with a nexthop resolving to itself marks
+	 * that nexthop inactive, and two routes marking different nexthops
+	 * inactive must hash to two different groups.
+	 *
+	 * ex)
+	 *      1.1.1.0/24
+	 *           -> 1.1.1.1 dummy1 (inactive)
+	 *           -> 1.1.2.1 dummy2
+	 *
+	 *      1.1.2.0/24
+	 *           -> 1.1.1.1 dummy1
+	 *           -> 1.1.2.1 dummy2 (inactive)
+	 */
+	return nexthop_group_key_equal(&nhe1->nhg_key, &nhe2->nhg_key);
 }
 
 bool zebra_nhg_hash_id_equal(const void *arg1, const void *arg2)
@@ -710,12 +665,18 @@ static bool zebra_nhe_find(struct nhg_hash_entry **nhe, /* return value */
 	bool recursive = false;
 	struct nhg_hash_entry *newnhe, *backup_nhe;
 	struct nexthop *nh = NULL;
+	struct nexthop_group_key saved_key = lookup->nhg_key;
+	uint8_t keybuf[NHG_KEY_BUF_SIZE];
 
+	/* The lookup key only lives for this call; the new nhe copies it */
+	memset(&lookup->nhg_key, 0, sizeof(lookup->nhg_key));
 
 	if (lookup->id)
 		(*nhe) = zebra_nhg_lookup_id(lookup->id);
-	else
+	else {
+		zebra_nhe_key_build(lookup, keybuf, sizeof(keybuf));
 		(*nhe) = hash_lookup(zrouter.nhgs, lookup);
+	}
 
 	if (IS_ZEBRA_DEBUG_NHG_DETAIL)
 		zlog_debug("%s: id %u, lookup %p, vrf %d, type %d, depends %p%s => Found %p(%pNG)",
@@ -739,6 +700,8 @@ static bool zebra_nhe_find(struct nhg_hash_entry **nhe, /* return value */
 		 *
 		 * It goes in HASH and ID table.
 		 */
+		if (!lookup->nhg_key.data)
+			zebra_nhe_key_build(lookup, keybuf, sizeof(keybuf));
 		newnhe = hash_get(zrouter.nhgs, lookup, zebra_nhg_hash_alloc);
 		zebra_nhg_insert_id(newnhe);
 	} else {
@@ -866,6 +829,9 @@ done:
 	/* Reset time since last update */
 	(*nhe)->uptime = monotime(NULL);
 
+	nexthop_group_key_free(&lookup->nhg_key);
+	lookup->nhg_key = saved_key;
+
 	return created;
 }
 
@@ -1062,10 +1028,60 @@ static struct nhg_ctx *nhg_ctx_init(uint32_t id, struct nexthop *nh, struct nh_g
 	return ctx;
 }
 
+/*
+ * The state of a hashed group's members was changed in place: file it
+ * under its new key, so that lookups for that state find it. It keeps its
+ * ID, and so does everything using it. The routes using it have not seen
+ * the change, as their nexthops did not change in their own evaluation:
+ * have them redistributed and their nexthop tracking redone.
+ */
+static void zebra_nhg_rekey(struct nhg_hash_entry *nhe)
+{
+	uint8_t keybuf[NHG_KEY_BUF_SIZE];
+	struct nexthop_group_key key;
+
+	if (PROTO_OWNED(nhe) || !nhe->nhg_key.data)
+		return;
+
+	/* Hash equality is by ID for entries that have one */
+	hash_release(zrouter.nhgs, nhe);
+
+	nexthop_group_key_free(&nhe->nhg_key);
+	zebra_nhe_key_build(nhe, keybuf, sizeof(keybuf));
+	key = nhe->nhg_key;
+	nexthop_group_key_copy(&nhe->nhg_key, &key);
+	nexthop_group_key_free(&key);
+
+	(void)hash_get(zrouter.nhgs, nhe, hash_alloc_intern);
+
+	nhe->members_seq++;
+	rib_update_nhe_routes(nhe);
+}
+
+/*
+ * Members of a group changed state in place: re-key it, and if it's in
+ * the kernel, replace the kernel object so it carries only the valid
+ * members. Routes pointing at the group by ID follow along without being
+ * touched.
+ */
+static void zebra_nhg_replace_kernel(struct nhg_hash_entry *nhe)
+{
+	zebra_nhg_rekey(nhe);
+
+	if (zebra_router_in_shutdown() || !ZEBRA_OWNED(nhe) ||
+	    !CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_INSTALLED) ||
+	    CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_INITIAL_DELAY_INSTALL))
+		return;
+
+	SET_FLAG(nhe->flags, NEXTHOP_GROUP_REINSTALL);
+	zebra_nhg_install_kernel(nhe, ZEBRA_ROUTE_MAX);
+}
+
 static void zebra_nhg_set_valid(struct nhg_hash_entry *nhe, bool valid)
 {
 	struct nhg_connected *rb_node_dep;
 	bool dependent_valid = valid;
+	bool changed = false;
 
 	if (valid)
 		SET_FLAG(nhe->flags, NEXTHOP_GROUP_VALID);
@@ -1090,9 +1106,13 @@ static void zebra_nhg_set_valid(struct nhg_hash_entry *nhe, bool valid)
 			 */
 			struct nexthop *nexthop = rb_node_dep->nhe->nhg.nexthop;
 
+			changed = false;
 			while (nexthop) {
 				if (nexthop_same_no_weight(nexthop, nhe->nhg.nexthop)) {
 					/* Invalid Nexthop */
+					if (CHECK_FLAG(nexthop->flags,
+						       NEXTHOP_FLAG_ACTIVE))
+						changed = true;
 					UNSET_FLAG(nexthop->flags, NEXTHOP_FLAG_ACTIVE);
 				} else {
 					/*
@@ -1107,6 +1127,13 @@ static void zebra_nhg_set_valid(struct nhg_hash_entry *nhe, bool valid)
 			}
 		}
 		zebra_nhg_set_valid(rb_node_dep->nhe, dependent_valid);
+
+		/*
+		 * An ECMP member went away but the group is still usable:
+		 * update the group alone, rather than each route using it.
+		 */
+		if (!valid && dependent_valid && changed)
+			zebra_nhg_replace_kernel(rb_node_dep->nhe);
 	}
 }
 
@@ -1690,6 +1717,8 @@ nhg_backup_copy(const struct nhg_backup_info *orig)
 static void zebra_nhg_free_members(struct nhg_hash_entry *nhe)
 {
 	nexthops_free(nhe->nhg.nexthop);
+	nexthop_group_key_free(&nhe->nhg_key);
+	dplane_nhg_snap_release(&nhe->dp_snap);
 
 	zebra_nhg_backup_free(&nhe->backup_info);
 
@@ -1717,6 +1746,7 @@ void zebra_nhg_free(struct nhg_hash_entry *nhe)
 		frrtrace(1, frr_zebra, zebra_nhg_free_nhe_refcount, nhe);
 
 	zebra_nhg_free_members(nhe);
+	re_nhe_list_fini(&nhe->routes);
 
 	XFREE(MTYPE_NHG, nhe);
 }
@@ -1741,6 +1771,8 @@ void zebra_nhg_hash_free(void *p)
 	event_cancel(&nhe->timer);
 
 	nexthops_free(nhe->nhg.nexthop);
+	nexthop_group_key_free(&nhe->nhg_key);
+	dplane_nhg_snap_release(&nhe->dp_snap);
 
 	XFREE(MTYPE_NHG, nhe);
 }
@@ -2247,6 +2279,92 @@ zebra_nhg_connected_ifindex(struct route_node *rn, struct route_entry *match,
 	return match;
 }
 
+/*
+ * Recursive nexthop lookups are cached per table: many routes (BGP, say)
+ * share a handful of nexthops, and each of them would otherwise redo the
+ * same longest-match lookup. An entry remembers the node matched and the
+ * version of its dest; adding or removing a more specific dest bumps the
+ * version of the dest covering it, which invalidates the entry.
+ */
+#define NH_RESOLVE_CACHE_MAX 65536
+
+struct nh_resolve_cache_entry {
+	struct prefix p;
+	struct route_node *rn;
+	uint64_t version;
+};
+
+static unsigned int nh_resolve_cache_key(const void *arg)
+{
+	const struct nh_resolve_cache_entry *entry = arg;
+
+	return prefix_hash_key(&entry->p);
+}
+
+static bool nh_resolve_cache_cmp(const void *a1, const void *a2)
+{
+	const struct nh_resolve_cache_entry *e1 = a1, *e2 = a2;
+
+	return prefix_same(&e1->p, &e2->p);
+}
+
+static void nh_resolve_cache_entry_free(void *arg)
+{
+	struct nh_resolve_cache_entry *entry = arg;
+
+	route_unlock_node(entry->rn);
+	XFREE(MTYPE_NH_RESOLVE_CACHE, entry);
+}
+
+void zebra_nhg_resolve_cache_free(struct rib_table_info *info)
+{
+	if (info->nh_resolve_cache)
+		hash_clean_and_free(&info->nh_resolve_cache,
+				    nh_resolve_cache_entry_free);
+}
+
+/* Cached equivalent of route_node_match(); the node is returned locked */
+static struct route_node *nh_resolve_cache_match(struct route_table *table,
+						 const struct prefix *p)
+{
+	struct rib_table_info *info = route_table_get_info(table);
+	struct nh_resolve_cache_entry lookup, *entry;
+	struct route_node *rn;
+	rib_dest_t *dest;
+
+	if (!info->nh_resolve_cache)
+		info->nh_resolve_cache =
+			hash_create_size(64, nh_resolve_cache_key,
+					 nh_resolve_cache_cmp,
+					 "Nexthop resolution cache");
+
+	prefix_copy(&lookup.p, p);
+	entry = hash_lookup(info->nh_resolve_cache, &lookup);
+	if (entry) {
+		dest = rib_dest_from_rnode(entry->rn);
+		if (dest && dest->version == entry->version)
+			return route_lock_node(entry->rn);
+
+		hash_release(info->nh_resolve_cache, entry);
+		nh_resolve_cache_entry_free(entry);
+	}
+
+	rn = route_node_match(table, p);
+	if (!rn)
+		return NULL;
+
+	if (info->nh_resolve_cache->count >= NH_RESOLVE_CACHE_MAX)
+		hash_clean(info->nh_resolve_cache, nh_resolve_cache_entry_free);
+
+	entry = XCALLOC(MTYPE_NH_RESOLVE_CACHE, sizeof(*entry));
+	prefix_copy(&entry->p, p);
+	entry->rn = route_lock_node(rn);
+	entry->version = rib_dest_from_rnode(rn)->version;
+	(void)hash_get(info->nh_resolve_cache, entry, hash_alloc_intern);
+
+	return rn;
+}
+
 /*
  * Given a nexthop we need to properly recursively resolve,
  * do a table lookup to find and match if at all possible.
@@ -2432,7 +2550,7 @@ static int nexthop_active(struct nexthop *nexthop, struct nhg_hash_entry *nhe,
 		return 0;
 	}
 
-	rn = route_node_match(table, (struct prefix *)&p);
+	rn = nh_resolve_cache_match(table, &p);
 	while (rn) {
 		route_unlock_node(rn);
 
@@ -2592,7 +2710,7 @@ done_with_match:
 			/* Capture resolving mtu */
 			if (resolved) {
 				if (pmtu)
-					*pmtu = match->mtu;
+					*pmtu = re_mtu(match);
 
 			} else {
 				if (IS_ZEBRA_DEBUG_RIB_DETAILED)
@@ -3180,6 +3298,126 @@ static struct nhg_hash_entry *zebra_nhg_rib_compare_old_nhe(
 		return new_nhe;
 }
 
+/* Is the singleton a group member depends on valid? -1 if not a member */
+static int zebra_nhg_member_valid(const struct nhg_hash_entry *nhe,
+				  const struct nexthop *nh)
+{
+	const struct nhg_connected *rb_node_dep;
+
+	frr_each (nhg_connected_tree_const, &nhe->nhg_depends, rb_node_dep) {
+		if (nexthop_same(rb_node_dep->nhe->nhg.nexthop, nh))
+			return CHECK_FLAG(rb_node_dep->nhe->flags,
+					  NEXTHOP_GROUP_VALID);
+	}
+
+	return -1;
+}
+
+/*
+ * Can the kernel group for nhe simply be replaced to match curr, the
+ * route's freshly evaluated copy of it? That's the case when the nexthop
+ * set is the same and only members went inactive or came back, because
+ * the singleton they resolve to changed state: that's the same for every
+ * route sharing the group, unlike e.g. a recursive nexthop resolving via
+ * the route itself.
+ */
+static bool zebra_nhg_members_only_changed(const struct nhg_hash_entry *nhe,
+					   const struct nhg_hash_entry *curr)
+{
+	const struct nexthop *nh, *cnh, *rnh, *crnh;
+	bool active, cactive, any_active = false, any_changed = false;
+	int valid;
+
+	if (nhe->backup_info || curr->backup_info)
+		return false;
+
+	for (nh = nhe->nhg.nexthop, cnh = curr->nhg.nexthop; nh && cnh;
+	     nh = nh->next, cnh = cnh->next) {
+		if (!nexthop_same(nh, cnh) || nh->ifindex != cnh->ifindex ||
+		    memcmp(&nh->rmap_src, &cnh->rmap_src, sizeof(nh->rmap_src)))
+			return false;
+
+		/* Resolution must not have moved */
+		for (rnh = nh->resolved, crnh = cnh->resolved; rnh && crnh;
+		     rnh = rnh->next, crnh = crnh->next)
+			if (!nexthop_same(rnh, crnh) ||
+			    CHECK_FLAG(rnh->flags, NEXTHOP_FLAG_ACTIVE) !=
+				    CHECK_FLAG(crnh->flags, NEXTHOP_FLAG_ACTIVE))
+				return false;
+		if (rnh || crnh)
+			return false;
+
+		cactive = CHECK_FLAG(cnh->flags, NEXTHOP_FLAG_ACTIVE);
+		active = CHECK_FLAG(nh->flags, NEXTHOP_FLAG_ACTIVE);
+		if (cactive)
+			any_active = true;
+		if (active == cactive)
+			continue;
+
+		any_changed = true;
+
+		if (CHECK_FLAG(nh->flags, NEXTHOP_FLAG_RECURSIVE) ||
+		    CHECK_FLAG(cnh->flags, NEXTHOP_FLAG_RECURSIVE))
+			return false;
+
+		valid = zebra_nhg_member_valid(nhe, cnh);
+		if (valid < 0 || !!valid != cactive)
+			return false;
+	}
+
+	return !nh && !cnh && any_active && any_changed;
+}
+
+/*
+ * A group zebra created and installed in the kernel may be shared by a
+ * large number of routes. When only the state of its members changed (an
+ * ECMP member went down, or came back) update the group in place, and
+ * replace just the group object in the kernel: the routes using it keep
+ * their group ID and need not be reinstalled one by one. This works for
+ * any route using zebra's own groups, whether or not the owning daemon
+ * uses ZAPI nexthop groups.
+ *
+ * Returns true if nhe was updated to match curr.
+ */
+static bool zebra_nhg_update_members(struct nhg_hash_entry *nhe,
+				     struct nhg_hash_entry *curr)
+{
+	struct nexthop *nh, *cnh;
+
+	if (!zebra_nhg_kernel_nexthops_enabled() || !ZEBRA_OWNED(nhe) ||
+	    PROTO_OWNED(nhe) || ZEBRA_NHG_IS_SINGLETON(nhe) ||
+	    zebra_nhg_depends_is_empty(nhe))
+		return false;
+
+	if (!CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_INSTALLED) ||
+	    !CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_VALID) ||
+	    CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_INITIAL_DELAY_INSTALL))
+		return false;
+
+	if (!zebra_nhg_members_only_changed(nhe, curr))
+		return false;
+
+	for (nh = nhe->nhg.nexthop, cnh = curr->nhg.nexthop; nh && cnh;
+	     nh = nh->next, cnh = cnh->next) {
+		/* The group is in the FIB, so its active members are too */
+		if (CHECK_FLAG(cnh->flags, NEXTHOP_FLAG_ACTIVE))
+			SET_FLAG(nh->flags,
+				 NEXTHOP_FLAG_ACTIVE | NEXTHOP_FLAG_FIB);
+		else {
+			UNSET_FLAG(nh->flags, NEXTHOP_FLAG_ACTIVE);
+			UNSET_FLAG(nh->flags, NEXTHOP_FLAG_FIB);
+		}
+	}
+
+	if (IS_ZEBRA_DEBUG_NHG)
+		zlog_debug("%s: nhe %pNG members changed, replacing group in place",
+			   __func__, nhe);
+
+	zebra_nhg_replace_kernel(nhe);
+
+	return true;
+}
+
 /*
  * Iterate over all nexthops of the given RIB entry and refresh their
  * ACTIVE flag.  If any nexthop is found to toggle the ACTIVE flag,
@@ -3193,6 +3431,8 @@ int nexthop_active_update(struct route_node *rn, struct route_entry *re,
 	struct nhg_hash_entry *curr_nhe, *remove;
 	uint32_t curr_active = 0, backup_active = 0;
 
+	UNSET_FLAG(re->status, ROUTE_ENTRY_NHG_UPDATED);
+
 	if (PROTO_OWNED(re->nhe) ||
 	    CHECK_FLAG(re->nhe->flags, NEXTHOP_GROUP_RECEIVED_FROM_EXTERNAL))
 		return proto_nhg_nexthop_active_update(&re->nhe->nhg);
@@ -3240,7 +3480,11 @@ backups_done:
 	 * Ref or create an nhe that matches the current state of the
 	 * nexthop(s).
 	 */
-	if (CHECK_FLAG(re->status, ROUTE_ENTRY_CHANGED)) {
+	if (CHECK_FLAG(re->status, ROUTE_ENTRY_CHANGED) &&
+	    zebra_nhg_update_members(re->nhe, curr_nhe)) {
+		/* The route keeps its group; the group changed under it */
+		SET_FLAG(re->status, ROUTE_ENTRY_NHG_UPDATED);
+	} else if (CHECK_FLAG(re->status, ROUTE_ENTRY_CHANGED)) {
 		struct nhg_hash_entry *new_nhe = NULL;
 
 		new_nhe = zebra_nhg_rib_find_nhe(curr_nhe, rt_afi);
@@ -3267,8 +3511,15 @@ backups_done:
 			zebra_nhg_handle_uninstall(remove);
 
 		route_entry_update_nhe(re, new_nhe);
+	} else if (re->nhe_seq != re->nhe->members_seq) {
+		/* Another route sharing the group already updated it in
+		 * place, so this one's evaluation matched the group.
+		 */
+		SET_FLAG(re->status, ROUTE_ENTRY_CHANGED);
+		SET_FLAG(re->status, ROUTE_ENTRY_NHG_UPDATED);
 	}
 
+	re->nhe_seq = re->nhe->members_seq;
 
 	/* Walk the NHE depends tree and toggle NEXTHOP_GROUP_VALID
 	 * flag where appropriate.
@@ -4136,9 +4387,13 @@ void zebra_interface_nhg_reinstall(struct interface *ifp)
 				while (nhop_dependent && !nexthop_same_no_weight(nhop_dependent, nh))
 					nhop_dependent = nhop_dependent->next;
 
-				if (nhop_dependent)
+				if (nhop_dependent &&
+				    !CHECK_FLAG(nhop_dependent->flags,
+						NEXTHOP_FLAG_ACTIVE)) {
 					SET_FLAG(nhop_dependent->flags,
 						 NEXTHOP_FLAG_ACTIVE);
+					zebra_nhg_rekey(rb_node_dependent->nhe);
+				}
 
 				if (IS_ZEBRA_DEBUG_NHG_DETAIL)
 					zlog_debug("%s dependent nhe (%pNG) flags (0x%x) Setting Reinstall flag",
@@ -26,6 +26,9 @@ struct nh_grp {
 };
 
 PREDECL_RBTREE_UNIQ(nhg_connected_tree);
+PREDECL_DLIST(re_nhe_list);
+
+struct dplane_nhg_snap;
 
 /*
  * Hashtables containing nhg entries is in `zebra_router`.
@@ -50,6 +53,9 @@ struct nhg_hash_entry {
 	/* If supported, a mapping of backup nexthops. */
 	struct nhg_backup_info *backup_info;
 
+	/* Flat key over nhg and backup nexthops, for the zebra-owned hash */
+	struct nexthop_group_key nhg_key;
+
 	/* If this is not a group, it
 	 * will be a single nexthop
 	 * and must have an interface
@@ -63,6 +69,14 @@ struct nhg_hash_entry {
 
 	uint32_t flags;
 
+	/* Bumped when the state of the group's members is changed in place,
+	 * so that routes sharing the group notice; see route_entry nhe_seq.
+	 */
+	uint32_t members_seq;
+
+	/* Routes in the RIB using this entry; see route_entry nhe_item */
+	struct re_nhe_list_head routes;
+
 	/* Dependency trees for other entries.
 	 * For instance a group with two
 	 * nexthops will have two dependencies
@@ -91,6 +105,9 @@ struct nhg_hash_entry {
 
 	struct event *timer;
 
+	/* Copy of the nexthops shared by dataplane route contexts */
+	struct dplane_nhg_snap *dp_snap;
+
 /*
  * Is this nexthop group valid, ie all nexthops are fully resolved.
  * What is fully resolved?  It's a nexthop that is either self contained
@@ -409,6 +426,8 @@ struct route_entry; /* Forward ref to avoid circular includes */
 extern void nexthop_vrf_update(struct route_node *rn, struct route_entry *re, vrf_id_t vrf_id);
 extern int nexthop_active_update(struct route_node *rn, struct route_entry *re,
 				 struct route_entry *old_re);
+struct rib_table_info;
+extern void zebra_nhg_resolve_cache_free(struct rib_table_info *info);
 
 extern const char *zebra_nhg_afi2str(struct nhg_hash_entry *nhe);
 
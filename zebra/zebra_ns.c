@@ -10,6 +10,8 @@
 #include "lib/vrf.h"
 #include "lib/prefix.h"
 #include "lib/memory.h"
+#include "lib/hash.h"
+#include "lib/jhash.h"
 
 #include "zebra_ns.h"
 #include "zebra_vrf.h"
@@ -35,6 +37,35 @@ static int ifp_tree_cmp(const struct ifp_tree_link *a, const struct ifp_tree_lin
 
 DECLARE_RBTREE_UNIQ(ifp_tree, struct ifp_tree_link, link, ifp_tree_cmp);
 
+static int ifp_index_hash_cmp(const struct ifp_tree_link *a,
+			      const struct ifp_tree_link *b)
+{
+	return numcmp(a->ifindex, b->ifindex);
+}
+
+static uint32_t ifp_index_hash_key(const struct ifp_tree_link *link)
+{
+	return jhash_1word(link->ifindex, 0x1f3d5b79);
+}
+
+DECLARE_HASH(ifp_index_hash, struct ifp_tree_link, index_item,
+	     ifp_index_hash_cmp, ifp_index_hash_key);
+
+/* An interface's name doesn't change once it exists, so it can be a key */
+static int ifp_name_hash_cmp(const struct ifp_tree_link *a,
+			     const struct ifp_tree_link *b)
+{
+	return strcmp(a->ifp->name, b->ifp->name);
+}
+
+static uint32_t ifp_name_hash_key(const struct ifp_tree_link *link)
+{
+	return string_hash_make(link->ifp->name);
+}
+
+DECLARE_HASH(ifp_name_hash, struct ifp_tree_link, name_item,
+	     ifp_name_hash_cmp, ifp_name_hash_key);
+
 static struct zebra_ns *dzns;
 
 static int ifp_tree_cmp(const struct ifp_tree_link *a, const struct ifp_tree_link *b)
@@ -42,6 +73,24 @@ static int ifp_tree_cmp(const struct ifp_tree_link *a, const struct ifp_tree_lin
 	return (a->ifindex - b->ifindex);
 }
 
+/*
+ * Only one interface per name is indexed. The kernel won't have two at
+ * once, but zebra may briefly hold on to a stale one; when the indexed
+ * interface goes, index the next one in ifindex order, as a walk would
+ * have found it.
+ */
+static void zebra_ns_name_reindex(struct zebra_ns *zns, const char *ifname)
+{
+	struct ifp_tree_link *link;
+
+	frr_each (ifp_tree, &zns->ifp_tree, link) {
+		if (strcmp(link->ifp->name, ifname) == 0) {
+			ifp_name_hash_add(&zns->ifp_name_hash, link);
+			return;
+		}
+	}
+}
+
 /*
  * Link an ifp into its parent NS
  */
@@ -80,6 +129,8 @@ void zebra_ns_link_ifp(struct zebra_ns *zns, struct interface *ifp)
 	link->zns = zns;
 
 	ifp_tree_add(&zns->ifp_tree, link);
+	ifp_index_hash_add(&zns->ifp_index_hash, link);
+	ifp_name_hash_add(&zns->ifp_name_hash, link);
 
 	zif->ns_tree_link = link;
 }
@@ -99,6 +150,11 @@ void zebra_ns_unlink_ifp(struct interface *ifp)
 		zns = link->zns;
 
 		ifp_tree_del(&zns->ifp_tree, link);
+		ifp_index_hash_del(&zns->ifp_index_hash, link);
+		if (ifp_name_hash_find(&zns->ifp_name_hash, link) == link) {
+			ifp_name_hash_del(&zns->ifp_name_hash, link);
+			zebra_ns_name_reindex(zns, ifp->name);
+		}
 
 		zif->ns_tree_link = NULL;
 
@@ -117,41 +173,25 @@ struct interface *zebra_ns_lookup_ifp(struct zebra_ns *zns, uint32_t ifindex)
 	/* Init temp struct for lookup */
 	tlink.ifindex = ifindex;
 
-	link = ifp_tree_find(&zns->ifp_tree, &tlink);
+	link = ifp_index_hash_find(&zns->ifp_index_hash, &tlink);
 	if (link)
 		ifp = link->ifp;
 
 	return ifp;
 }
 
-static int lookup_ifp_name_cb(struct interface *ifp, void *arg);
-
-struct ifp_name_ctx {
-	const char *ifname;
-	struct interface *ifp;
-};
-
 struct interface *zebra_ns_lookup_ifp_name(struct zebra_ns *zns, const char *ifname)
 {
-	struct ifp_name_ctx ctx = {};
-
-	/* Hand context struct into walker function for use in its callback */
-	ctx.ifname = ifname;
-	zebra_ns_ifp_walk(zns, lookup_ifp_name_cb, &ctx);
-
-	return ctx.ifp;
-}
+	struct interface tifp = {};
+	struct ifp_tree_link *link, tlink = {};
 
-static int lookup_ifp_name_cb(struct interface *ifp, void *arg)
-{
-	struct ifp_name_ctx *pctx = arg;
+	/* Init temp structs for lookup */
+	strlcpy(tifp.name, ifname, sizeof(tifp.name));
+	tlink.ifp = &tifp;
 
-	if (strcmp(ifp->name, pctx->ifname) == 0) {
-		pctx->ifp = ifp;
-		return NS_WALK_STOP;
-	}
+	link = ifp_name_hash_find(&zns->ifp_name_hash, &tlink);
 
-	return NS_WALK_CONTINUE;
+	return link ? link->ifp : NULL;
 }
 
 /* Iterate collection of ifps, calling application's callback. Callback uses
@@ -242,6 +282,8 @@ static int zebra_ns_new(struct ns *ns)
 
 	/* Do any needed per-NS data structure allocation. */
 	ifp_tree_init(&zns->ifp_tree);
+	ifp_index_hash_init(&zns->ifp_index_hash);
+	ifp_name_hash_init(&zns->ifp_name_hash);
 
 	return 0;
 }
@@ -259,11 +301,16 @@ static int zebra_ns_delete(struct ns *ns)
 
 	/* Clean up ifp tree */
 	while ((link = ifp_tree_pop(&zns->ifp_tree)) != NULL) {
+		ifp_index_hash_del(&zns->ifp_index_hash, link);
+		if (ifp_name_hash_find(&zns->ifp_name_hash, link) == link)
+			ifp_name_hash_del(&zns->ifp_name_hash, link);
 		zif = link->ifp->info;
 
 		zif->ns_tree_link = NULL;
 		XFREE(MTYPE_ZNS_IFP, link);
 	}
+	ifp_index_hash_fini(&zns->ifp_index_hash);
+	ifp_name_hash_fini(&zns->ifp_name_hash);
 
 	XFREE(MTYPE_ZEBRA_NS, ns->info);
 	return 0;
@@ -295,6 +342,8 @@ void zebra_ns_startup_continue(struct zebra_dplane_ctx *ctx)
 {
 	struct zebra_ns *zns = zebra_ns_lookup(dplane_ctx_get_ns_id(ctx));
 	enum zebra_dplane_startup_notifications spot;
+	struct zebra_startup_stats *stats = &zrouter.startup_stats;
+	struct timeval start;
 
 	if (!zns) {
 		flog_err(EC_ZEBRA_NS_NO_DEFAULT, "%s: No Namespace associated with %u", __func__,
@@ -312,12 +361,22 @@ void zebra_ns_startup_continue(struct zebra_dplane_ctx *ctx)
 		interface_list_second(zns);
 		break;
 	case ZEBRA_DPLANE_ADDRESSES_READ:
+		if (zns->ns_id == NS_DEFAULT)
+			stats->links_usec = monotime_since(&stats->begin, NULL);
+
+		monotime(&start);
 		neigh_read(zns);
+		stats->neighs_usec += monotime_since(&start, NULL);
+
+		monotime(&start);
 		route_read(zns);
+		stats->routes_usec += monotime_since(&start, NULL);
 
+		monotime(&start);
 		vlan_read(zns);
 		kernel_read_pbr_rules(zns);
 		kernel_read_tc_qdisc(zns);
+		stats->other_usec += monotime_since(&start, NULL);
 
 		/*
 		 * At this point FRR has requested and read a bunch
@@ -340,6 +399,9 @@ int zebra_ns_enable(ns_id_t ns_id, void **info)
 
 	zns->ns_id = ns_id;
 
+	if (ns_id == NS_DEFAULT)
+		monotime(&zrouter.startup_stats.begin);
+
 	kernel_init(zns);
 	zebra_dplane_ns_enable(zns, true);
 	interface_list(zns);
@@ -36,11 +36,19 @@ struct nlsock {
 };
 #endif
 
-/* Tree of interfaces: external linkage struct, and rbtree */
+/*
+ * Tree of interfaces: external linkage struct, and rbtree. The tree keeps
+ * walks in ifindex order; lookups go through the hashes, by ifindex and by
+ * name.
+ */
 PREDECL_RBTREE_UNIQ(ifp_tree);
+PREDECL_HASH(ifp_index_hash);
+PREDECL_HASH(ifp_name_hash);
 
 struct ifp_tree_link {
 	struct ifp_tree_item link;
+	struct ifp_index_hash_item index_item;
+	struct ifp_name_hash_item name_item;
 
 	ifindex_t ifindex;
 
@@ -66,13 +74,18 @@ struct zebra_ns {
 	 */
 	struct nlsock netlink_dplane_out;
 	struct nlsock netlink_dplane_in;
+
+	/* Extra outgoing channels, one per additional dplane shard */
+	struct nlsock *netlink_dplane_shards;
 	struct event *t_netlink;
 
 	struct nlsock ge_netlink_cmd; /* command channel for generic netlink */
 #endif
 
-	/* Tree of interfaces in this ns */
+	/* Tree of interfaces in this ns, with its lookup indexes */
 	struct ifp_tree_head ifp_tree;
+	struct ifp_index_hash_head ifp_index_hash;
+	struct ifp_name_hash_head ifp_name_hash;
 
 	/* Back pointer */
 	struct ns *ns;
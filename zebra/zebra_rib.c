@@ -31,6 +31,8 @@
 #include "frrscript.h"
 #include "frrdistance.h"
 #include "lib/termtable.h"
+#include "slab.h"
+#include "lib_vty.h"
 
 #include "zebra/zebra_router.h"
 #include "zebra/connected.h"
@@ -52,6 +54,7 @@
 #include "zebra/zebra_evpn_mh.h"
 #include "zebra/zebra_neigh.h"
 #include "zebra/zebra_script.h"
+#include "zebra/zebra_latency.h"
 
 DEFINE_MGROUP(ZEBRA, "zebra");
 
@@ -59,6 +62,18 @@ DEFINE_MTYPE(ZEBRA, RE,       "Route Entry");
 DEFINE_MTYPE_STATIC(ZEBRA, RIB_DEST,       "RIB destination");
 DEFINE_MTYPE_STATIC(ZEBRA, RIB_UPDATE_CTX, "Rib update context object");
 DEFINE_MTYPE_STATIC(ZEBRA, WQ_WRAPPER, "WQ wrapper");
+DEFINE_MTYPE_STATIC(ZEBRA, RIB_CLIENT_ROUTES, "RIB client routes");
+DEFINE_MTYPE_STATIC(ZEBRA, RE_EXT, "Route Entry extension");
+
+/*
+ * Route entries and dests exist once per route, so they come out of slabs
+ * rather than individual allocations. The chunks are accounted to
+ * MTYPE_RE and MTYPE_RIB_DEST.
+ */
+#define RIB_SLAB_CHUNK 512
+
+static struct slab *re_slab;
+static struct slab *dest_slab;
 
 /*
  * Event, list, and mutex for delivery of dataplane results
@@ -277,6 +292,37 @@ static const char *subqueue2str(enum meta_queue_indexes index)
 }
 
 /* Handler for 'show zebra metaq' */
+static bool meta_queue_is_route_subq(enum meta_queue_indexes qindex)
+{
+	switch (qindex) {
+	case META_QUEUE_CONNECTED:
+	case META_QUEUE_KERNEL:
+	case META_QUEUE_STATIC:
+	case META_QUEUE_NOTBGP:
+	case META_QUEUE_BGP:
+	case META_QUEUE_OTHER:
+		return true;
+	case META_QUEUE_NHG:
+	case META_QUEUE_EVPN:
+	case META_QUEUE_EARLY_ROUTE:
+	case META_QUEUE_EARLY_LABEL:
+	case META_QUEUE_GR_RUN:
+		break;
+	}
+
+	return false;
+}
+
+/* Number of items waiting in a sub-queue */
+static uint32_t meta_queue_subq_len(struct meta_queue *mq,
+				    enum meta_queue_indexes qindex)
+{
+	if (meta_queue_is_route_subq(qindex))
+		return mq->route_subq_len[qindex];
+
+	return listcount(mq->subq[qindex]);
+}
+
 int zebra_show_metaq_counter(struct vty *vty, bool uj)
 {
 	struct meta_queue *mq = zrouter.mq;
@@ -294,7 +340,7 @@ int zebra_show_metaq_counter(struct vty *vty, bool uj)
 
 	/* Add rows for each subqueue */
 	for (uint8_t i = 0; i < MQ_SIZE; i++) {
-		ttable_add_row(tt, "%s|%u|%u|%u", subqueue2str(i), mq->subq[i]->count,
+		ttable_add_row(tt, "%s|%u|%u|%u", subqueue2str(i), meta_queue_subq_len(mq, i),
 			       mq->max_subq[i], mq->total_subq[i]);
 	}
 
@@ -459,12 +505,39 @@ int zebra_check_addr(const struct prefix *p)
 	return 1;
 }
 
+/* Routes in the RIB are listed on the nhe they use */
+static void rib_nhe_route_track(struct route_entry *re)
+{
+	if (re->nhe_rn && re->nhe)
+		re_nhe_list_add_tail(&re->nhe->routes, re);
+}
+
+static void rib_nhe_route_untrack(struct route_entry *re)
+{
+	if (re->nhe_rn && re->nhe)
+		re_nhe_list_del(&re->nhe->routes, re);
+}
+
+void rib_update_nhe_routes(struct nhg_hash_entry *nhe)
+{
+	struct route_entry *re;
+
+	frr_each (re_nhe_list, &nhe->routes, re) {
+		if (CHECK_FLAG(re->status, ROUTE_ENTRY_REMOVED))
+			continue;
+
+		SET_FLAG(re->status, ROUTE_ENTRY_CHANGED);
+		rib_queue_add(re->nhe_rn);
+	}
+}
+
 static void route_entry_attach_ref(struct route_entry *re,
 				   struct nhg_hash_entry *new)
 {
 	re->nhe = new;
 	re->nhe_id = new->id;
 	re->nhe_installed_id = 0;
+	re->nhe_seq = new->members_seq;
 
 	zebra_nhg_increment_ref(new);
 }
@@ -482,6 +555,8 @@ int route_entry_update_nhe(struct route_entry *re,
 	int ret = 0;
 	struct nhg_hash_entry *old_nhg = NULL;
 
+	rib_nhe_route_untrack(re);
+
 	if (new_nhghe == NULL) {
 		old_nhg = re->nhe;
 
@@ -501,6 +576,8 @@ int route_entry_update_nhe(struct route_entry *re,
 		route_entry_attach_ref(re, new_nhghe);
 
 done:
+	rib_nhe_route_track(re);
+
 	/* Detach / deref previous nhg */
 
 	if (old_nhg) {
@@ -920,6 +997,37 @@ void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq,
 	}
 }
 
+/* Source of rib_dest_t versions; only touched by the main pthread */
+static uint64_t rib_dest_version;
+
+/*
+ * A dest appeared or went away at this node: nexthop lookups that matched
+ * the closest covering dest may now match here instead, or vice versa.
+ */
+static void rib_dest_covering_bump(struct route_node *rn)
+{
+	rib_dest_t *dest;
+
+	for (rn = rn->parent; rn; rn = rn->parent) {
+		dest = rib_dest_from_rnode(rn);
+		if (dest) {
+			dest->version = ++rib_dest_version;
+			break;
+		}
+	}
+}
+
+/* Unlink the tracked nexthops still on a dest that is going away */
+static void rib_dest_nht_detach(rib_dest_t *dest)
+{
+	struct rnh *rnh;
+
+	while ((rnh = rnh_list_pop(&dest->nht)) != NULL)
+		rnh->nht_dest = NULL;
+
+	rnh_list_fini(&dest->nht);
+}
+
 /*
  * rib_gc_dest
  *
@@ -949,9 +1057,11 @@ int rib_gc_dest(struct route_node *rn)
 	zebra_rib_evaluate_rn_nexthops(rn, zebra_router_get_next_sequence(),
 				       true);
 
+	rib_dest_covering_bump(rn);
+
 	dest->rnode = NULL;
-	rnh_list_fini(&dest->nht);
-	XFREE(MTYPE_RIB_DEST, dest);
+	rib_dest_nht_detach(dest);
+	slab_free(dest_slab, dest);
 	rn->info = NULL;
 
 	/*
@@ -981,8 +1091,9 @@ void zebra_node_info_cleanup(struct route_node *node)
 		/* Remove from update queue of FPM module */
 		hook_call(rib_shutdown, node);
 
-		rnh_list_fini(&dest->nht);
-		XFREE(MTYPE_RIB_DEST, node->info);
+		rib_dest_nht_detach(dest);
+		slab_free(dest_slab, dest);
+		node->info = NULL;
 	}
 }
 
@@ -1010,6 +1121,7 @@ static void rib_process_add_fib(struct zebra_vrf *zvrf, struct route_node *rn,
 	rib_install_kernel(rn, new, NULL);
 
 	UNSET_FLAG(new->status, ROUTE_ENTRY_CHANGED);
+	UNSET_FLAG(new->status, ROUTE_ENTRY_NHG_UPDATED);
 }
 
 static void rib_process_del_fib(struct zebra_vrf *zvrf, struct route_node *rn,
@@ -1040,6 +1152,24 @@ static void rib_process_del_fib(struct zebra_vrf *zvrf, struct route_node *rn,
 		UNSET_FLAG(old->status, ROUTE_ENTRY_CHANGED);
 }
 
+/*
+ * The installed route's nexthop group was replaced in place in the
+ * dataplane (see zebra_nhg_update_members()), so the route itself stays as
+ * it is. Do what a successful reinstall would have: tell redistribution
+ * and nexthop tracking that its nexthops changed.
+ */
+static void rib_nhg_updated(struct route_node *rn, struct route_entry *re)
+{
+	if (IS_ZEBRA_DEBUG_RIB)
+		zlog_debug("%s(%u:%u):%pRN: nexthop group %pNG updated in place, not reinstalling route",
+			   VRF_LOGNAME(vrf_lookup_by_id(re->vrf_id)),
+			   re->vrf_id, re->table, rn, re->nhe);
+
+	redistribute_update(rn, re, re);
+	zebra_rib_evaluate_rn_nexthops(rn, zebra_router_get_next_sequence(),
+				       false);
+}
+
 static void rib_process_update_fib(struct zebra_vrf *zvrf,
 				   struct route_node *rn,
 				   struct route_entry *old,
@@ -1095,7 +1225,13 @@ static void rib_process_update_fib(struct zebra_vrf *zvrf,
 			if (zebra_rib_labeled_unicast(new))
 				zebra_mpls_lsp_install(zvrf, rn, new);
 
-			rib_install_kernel(rn, new, old);
+			if (new == old &&
+			    CHECK_FLAG(new->status, ROUTE_ENTRY_NHG_UPDATED) &&
+			    CHECK_FLAG(new->status, ROUTE_ENTRY_INSTALLED))
+				rib_nhg_updated(rn, new);
+			else
+				rib_install_kernel(rn, new, old);
+			UNSET_FLAG(new->status, ROUTE_ENTRY_NHG_UPDATED);
 		}
 
 		/*
@@ -1157,6 +1293,7 @@ static void rib_process_update_fib(struct zebra_vrf *zvrf,
 
 	/* Clear changed flag. */
 	UNSET_FLAG(new->status, ROUTE_ENTRY_CHANGED);
+	UNSET_FLAG(new->status, ROUTE_ENTRY_NHG_UPDATED);
 }
 
 static struct route_entry *rib_choose_best_type(uint8_t route_type,
@@ -1523,10 +1660,9 @@ static void zebra_rib_evaluate_mpls(struct route_node *rn)
 
 	if (CHECK_FLAG(dest->flags, RIB_DEST_UPDATE_LSPS)) {
 		if (IS_ZEBRA_DEBUG_MPLS)
-			zlog_debug(
-				"%s(%u): Scheduling all LSPs upon RIB completion",
-				zvrf_name(zvrf), zvrf_id(zvrf));
-		zebra_mpls_lsp_schedule(zvrf);
+			zlog_debug("%s(%u): Scheduling LSPs via %pRN upon RIB completion",
+				   zvrf_name(zvrf), zvrf_id(zvrf), rn);
+		zebra_mpls_lsp_schedule_prefix(zvrf, &rn->p);
 		mpls_unmark_lsps_for_processing(rn);
 	}
 }
@@ -2484,19 +2620,28 @@ static void process_subq_early_label(struct listnode *lnode)
 	XFREE(MTYPE_WQ_WRAPPER, w);
 }
 
-static void process_subq_route(struct listnode *lnode, uint8_t qindex)
+/* Max route nodes of one table processed per meta queue visit */
+#define ZEBRA_MQ_TABLE_BATCH 32
+
+/* Max EVPN updates processed per meta queue visit */
+#define ZEBRA_MQ_EVPN_BATCH 64
+
+static void process_subq_route_node(struct route_node *rnode, uint8_t qindex)
 {
-	struct route_node *rnode = NULL;
 	rib_dest_t *dest = NULL;
 	struct zebra_vrf *zvrf = NULL;
+	uint32_t start;
 
-	rnode = listgetdata(lnode);
 	dest = rib_dest_from_rnode(rnode);
 	assert(dest);
 
 	zvrf = rib_dest_vrf(dest);
 
+	/* The dest keeps its stamp until here, for the dplane contexts */
+	zebra_lat_record(ZEBRA_LAT_META_QUEUE, dest->mq_stamp);
+	start = zebra_lat_stamp();
 	rib_process(rnode);
+	zebra_lat_record(ZEBRA_LAT_RIB_PROCESS, start);
 
 	if (IS_ZEBRA_DEBUG_RIB_DETAILED) {
 		struct route_entry *re = NULL;
@@ -2515,13 +2660,54 @@ static void process_subq_route(struct listnode *lnode, uint8_t qindex)
 			   rnode, rnode, subqueue2str(qindex));
 	}
 
-	if (rnode->info)
-		UNSET_FLAG(rib_dest_from_rnode(rnode)->flags,
-			   RIB_ROUTE_QUEUED(qindex));
+	if (rnode->info) {
+		dest = rib_dest_from_rnode(rnode);
+		UNSET_FLAG(dest->flags, RIB_ROUTE_QUEUED(qindex));
+		dest->mq_stamp = 0;
+	}
 
 	route_unlock_node(rnode);
 }
 
+/*
+ * Process a batch of route nodes from the table at the head of a route
+ * sub-queue, then move the table to the back of the sub-queue if it still
+ * has nodes waiting. Returns the number of nodes processed.
+ *
+ * This runs on the main pthread. rib_process() can't move to per-table
+ * workers yet: the NHG hash and refcounts, route node locks, recursive
+ * resolution through other tables and the zapi client streams it touches
+ * have no locking.
+ */
+static unsigned int process_subq_route(struct list *subq, uint8_t qindex)
+{
+	struct listnode *lnode = listhead(subq);
+	struct rib_table_info *info = listgetdata(lnode);
+	struct list *nodes = info->mq_nodes[qindex];
+	struct route_node *rnode;
+	unsigned int count = 0;
+
+	while (count < ZEBRA_MQ_TABLE_BATCH && listcount(nodes)) {
+		/* Leave room for the dataplane, as meta_queue_process does */
+		if (count &&
+		    dplane_get_in_queue_len() > dplane_get_in_queue_limit())
+			break;
+
+		rnode = listgetdata(listhead(nodes));
+		list_delete_node(nodes, listhead(nodes));
+		zrouter.mq->route_subq_len[qindex]--;
+
+		process_subq_route_node(rnode, qindex);
+		count++;
+	}
+
+	list_delete_node(subq, lnode);
+	if (listcount(nodes))
+		listnode_add(subq, info);
+
+	return count;
+}
+
 static void rib_re_nhg_free(struct route_entry *re)
 {
 	if (re->nhe && re->nhe_id) {
@@ -2548,6 +2734,8 @@ struct zebra_early_route {
 	bool deletion;
 	bool fromkernel;
 	bool replace;
+	/* Latency stamp of ZAPI receipt, or of queueing */
+	uint32_t lat_origin;
 };
 
 static void early_route_memory_free(struct zebra_early_route *ere)
@@ -3058,10 +3246,15 @@ static void process_subq_early_route(struct listnode *lnode)
 {
 	struct zebra_early_route *ere = listgetdata(lnode);
 
+	/* Route nodes queued from here inherit the update's origin */
+	zebra_lat_origin_set(ere->lat_origin);
+
 	if (ere->deletion)
 		process_subq_early_route_delete(ere);
 	else
 		process_subq_early_route_add(ere);
+
+	zebra_lat_origin_set(0);
 }
 
 struct meta_q_gr_run {
@@ -3085,6 +3278,32 @@ static void process_subq_gr_run(struct listnode *lnode)
 	XFREE(MTYPE_WQ_WRAPPER, gr_run);
 }
 
+/*
+ * Process a burst of EVPN updates. The dataplane updates they generate,
+ * mostly remote MAC and neighbor installs, are handed over as one list,
+ * so the kernel provider can pack them into shared netlink batches.
+ */
+static unsigned int process_subq_evpn_batch(struct list *subq)
+{
+	struct listnode *lnode;
+	unsigned int count = 0;
+
+	dplane_update_batch_begin();
+	while (count < ZEBRA_MQ_EVPN_BATCH && (lnode = listhead(subq))) {
+		/* Leave room for the dataplane, as meta_queue_process does */
+		if (count &&
+		    dplane_get_in_queue_len() > dplane_get_in_queue_limit())
+			break;
+
+		process_subq_evpn(lnode);
+		list_delete_node(subq, lnode);
+		count++;
+	}
+	dplane_update_batch_end();
+
+	return count;
+}
+
 /*
  * Examine the specified subqueue; process one entry and return 1 if
  * there is a node, return 0 otherwise.
@@ -3093,14 +3312,16 @@ static unsigned int process_subq(struct list *subq,
 				 enum meta_queue_indexes qindex)
 {
 	struct listnode *lnode = listhead(subq);
+	unsigned int count;
 
 	if (!lnode)
 		return 0;
 
 	switch (qindex) {
 	case META_QUEUE_EVPN:
-		process_subq_evpn(lnode);
-		break;
+		count = process_subq_evpn_batch(subq);
+		frrtrace(1, frr_zebra, rib_process_subq_dequeue, qindex);
+		return count;
 	case META_QUEUE_NHG:
 		process_subq_nhg(lnode);
 		break;
@@ -3116,8 +3337,9 @@ static unsigned int process_subq(struct list *subq,
 	case META_QUEUE_NOTBGP:
 	case META_QUEUE_BGP:
 	case META_QUEUE_OTHER:
-		process_subq_route(lnode, qindex);
-		break;
+		count = process_subq_route(subq, qindex);
+		frrtrace(1, frr_zebra, rib_process_subq_dequeue, qindex);
+		return count;
 	case META_QUEUE_GR_RUN:
 		process_subq_gr_run(lnode);
 		break;
@@ -3154,11 +3376,17 @@ static wq_item_status meta_queue_process(struct work_queue *dummy, void *data)
 		return WQ_QUEUE_BLOCKED;
 	}
 
-	for (i = 0; i < MQ_SIZE; i++)
-		if (process_subq(mq->subq[i], i)) {
-			mq->size--;
+	zebra_rnh_notify_batch_begin();
+	for (i = 0; i < MQ_SIZE; i++) {
+		unsigned int count = process_subq(mq->subq[i], i);
+
+		if (count) {
+			mq->size -= count;
 			break;
 		}
+	}
+	zebra_rnh_notify_batch_end();
+
 	return mq->size ? WQ_REQUEUE : WQ_SUCCESS;
 }
 
@@ -3184,6 +3412,7 @@ static wq_item_status meta_queue_process(struct work_queue *dummy, void *data)
  */
 static int rib_meta_queue_add(struct meta_queue *mq, void *data)
 {
+	struct rib_table_info *info;
 	struct route_node *rn = NULL;
 	struct route_entry *re = NULL, *curr_re = NULL;
 	uint8_t qindex = MQ_SIZE, curr_qindex = MQ_SIZE;
@@ -3228,12 +3457,24 @@ static int rib_meta_queue_add(struct meta_queue *mq, void *data)
 	}
 
 	SET_FLAG(rib_dest_from_rnode(rn)->flags, RIB_ROUTE_QUEUED(qindex));
-	listnode_add(mq->subq[qindex], rn);
+	rib_dest_from_rnode(rn)->mq_stamp = zebra_lat_origin();
+
+	/* Queue the node on its table, and the table on the sub-queue if it
+	 * had nothing waiting there yet.
+	 */
+	info = srcdest_rnode_table_info(rn);
+	if (!info->mq_nodes[qindex])
+		info->mq_nodes[qindex] = list_new();
+	if (!listcount(info->mq_nodes[qindex]))
+		listnode_add(mq->subq[qindex], info);
+	listnode_add(info->mq_nodes[qindex], rn);
+	mq->route_subq_len[qindex]++;
+
 	route_lock_node(rn);
 	mq->size++;
 	atomic_fetch_add_explicit(&mq->total_metaq, 1, memory_order_relaxed);
 	atomic_fetch_add_explicit(&mq->total_subq[qindex], 1, memory_order_relaxed);
-	curr = listcount(mq->subq[qindex]);
+	curr = mq->route_subq_len[qindex];
 	high = atomic_load_explicit(&mq->max_subq[qindex], memory_order_relaxed);
 	if (curr > high)
 		atomic_store_explicit(&mq->max_subq[qindex], curr, memory_order_relaxed);
@@ -3415,6 +3656,11 @@ uint32_t zebra_rib_meta_queue_size(void)
 	return zrouter.mq->size;
 }
 
+uint32_t zebra_rib_meta_queue_max(void)
+{
+	return atomic_load_explicit(&zrouter.mq->max_metaq, memory_order_relaxed);
+}
+
 void mpls_ftn_uninstall(struct zebra_vrf *zvrf, enum lsp_types_t type,
 			struct prefix *prefix, uint8_t route_type,
 			uint8_t route_instance)
@@ -3789,21 +4035,61 @@ static void early_label_meta_queue_free(struct meta_queue *mq, struct list *l,
 }
 
 static void rib_meta_queue_free(struct meta_queue *mq, struct list *l,
-				struct zebra_vrf *zvrf)
+				uint8_t qindex, struct zebra_vrf *zvrf)
+{
+	struct rib_table_info *info;
+	struct route_node *rnode;
+	struct listnode *tnode, *tnnode, *node, *nnode;
+
+	for (ALL_LIST_ELEMENTS(l, tnode, tnnode, info)) {
+		struct list *nodes = info->mq_nodes[qindex];
+
+		for (ALL_LIST_ELEMENTS(nodes, node, nnode, rnode)) {
+			rib_dest_t *dest = rib_dest_from_rnode(rnode);
+
+			if (dest && rib_dest_vrf(dest) != zvrf)
+				continue;
+
+			route_unlock_node(rnode);
+			node->data = NULL;
+			list_delete_node(nodes, node);
+			mq->route_subq_len[qindex]--;
+			mq->size--;
+		}
+
+		if (!listcount(nodes))
+			list_delete_node(l, tnode);
+	}
+}
+
+/* Drop the route nodes a table still has waiting, and the table itself
+ * from the route sub-queues, before the table is freed.
+ */
+void rib_meta_queue_table_free(struct rib_table_info *info)
 {
+	struct meta_queue *mq = zrouter.mq;
 	struct route_node *rnode;
 	struct listnode *node, *nnode;
+	uint8_t qindex;
 
-	for (ALL_LIST_ELEMENTS(l, node, nnode, rnode)) {
-		rib_dest_t *dest = rib_dest_from_rnode(rnode);
+	if (!mq)
+		return;
+
+	for (qindex = 0; qindex < MQ_SIZE; qindex++) {
+		struct list *nodes = info->mq_nodes[qindex];
 
-		if (dest && rib_dest_vrf(dest) != zvrf)
+		if (!nodes || !listcount(nodes))
 			continue;
 
-		route_unlock_node(rnode);
-		node->data = NULL;
-		list_delete_node(l, node);
-		mq->size--;
+		for (ALL_LIST_ELEMENTS(nodes, node, nnode, rnode)) {
+			route_unlock_node(rnode);
+			node->data = NULL;
+			list_delete_node(nodes, node);
+			mq->route_subq_len[qindex]--;
+			mq->size--;
+		}
+
+		listnode_delete(mq->subq[qindex], info);
 	}
 }
 
@@ -3872,7 +4158,7 @@ void meta_queue_free(struct meta_queue *mq, struct zebra_vrf *zvrf)
 		case META_QUEUE_NOTBGP:
 		case META_QUEUE_BGP:
 		case META_QUEUE_OTHER:
-			rib_meta_queue_free(mq, mq->subq[i], zvrf);
+			rib_meta_queue_free(mq, mq->subq[i], i, zvrf);
 			break;
 		case META_QUEUE_GR_RUN:
 			rib_meta_queue_gr_run_free(mq, mq->subq[i], zvrf);
@@ -3908,12 +4194,15 @@ rib_dest_t *zebra_rib_create_dest(struct route_node *rn)
 {
 	rib_dest_t *dest;
 
-	dest = XCALLOC(MTYPE_RIB_DEST, sizeof(rib_dest_t));
+	dest = slab_alloc(dest_slab);
 	rnh_list_init(&dest->nht);
 	re_list_init(&dest->routes);
 	route_lock_node(rn); /* rn route table reference */
 	rn->info = dest;
 	dest->rnode = rn;
+	dest->version = ++rib_dest_version;
+
+	rib_dest_covering_bump(rn);
 
 	return dest;
 }
@@ -3955,6 +4244,106 @@ rib_dest_t *zebra_rib_create_dest(struct route_node *rn)
  *
  */
 
+/*
+ * Per-client route lists. Each table keeps, for every client that has
+ * routes in it, a list of those routes in the order they were linked,
+ * which is also uptime order. Graceful restart uses this to find a
+ * client's stale routes without walking the whole table.
+ */
+struct rib_client_routes {
+	struct rib_client_hash_item hitem;
+
+	int type;
+	uint16_t instance;
+
+	struct re_client_list_head routes;
+};
+
+static int rib_client_routes_cmp(const struct rib_client_routes *c1,
+				 const struct rib_client_routes *c2)
+{
+	if (c1->type != c2->type)
+		return numcmp(c1->type, c2->type);
+	return numcmp(c1->instance, c2->instance);
+}
+
+static uint32_t rib_client_routes_hash(const struct rib_client_routes *c)
+{
+	return jhash_2words(c->type, c->instance, 0x52c1a7e5);
+}
+
+DECLARE_HASH(rib_client_hash, struct rib_client_routes, hitem,
+	     rib_client_routes_cmp, rib_client_routes_hash);
+
+static struct rib_client_routes *
+rib_client_routes_lookup(struct rib_table_info *info, int type,
+			 uint16_t instance, bool create)
+{
+	struct rib_client_routes ref = { .type = type, .instance = instance };
+	struct rib_client_routes *c;
+
+	c = rib_client_hash_find(&info->client_routes, &ref);
+	if (c || !create)
+		return c;
+
+	c = XCALLOC(MTYPE_RIB_CLIENT_ROUTES, sizeof(*c));
+	c->type = type;
+	c->instance = instance;
+	re_client_list_init(&c->routes);
+	rib_client_hash_add(&info->client_routes, c);
+	return c;
+}
+
+static void rib_client_route_track(struct route_node *rn,
+				   struct route_entry *re)
+{
+	struct rib_client_routes *c;
+
+	if (RIB_SYSTEM_ROUTE(re) || re->client_rn)
+		return;
+
+	c = rib_client_routes_lookup(srcdest_rnode_table_info(rn), re->type,
+				     re->instance, true);
+	re_client_list_add_tail(&c->routes, re);
+	re->client_rn = rn;
+}
+
+void rib_client_route_untrack(struct route_entry *re)
+{
+	struct rib_client_routes *c;
+
+	if (!re->client_rn)
+		return;
+
+	c = rib_client_routes_lookup(srcdest_rnode_table_info(re->client_rn),
+				     re->type, re->instance, false);
+	assert(c);
+	re_client_list_del(&c->routes, re);
+	re->client_rn = NULL;
+}
+
+struct re_client_list_head *
+rib_client_routes(struct route_table *table, int type, uint16_t instance)
+{
+	struct rib_client_routes *c;
+
+	c = rib_client_routes_lookup(rib_table_info(table), type, instance,
+				     false);
+	return c ? &c->routes : NULL;
+}
+
+void rib_table_client_routes_free(struct rib_table_info *info)
+{
+	struct rib_client_routes *c;
+
+	/* The table's routes have all been unlinked by now */
+	while ((c = rib_client_hash_pop(&info->client_routes))) {
+		re_client_list_fini(&c->routes);
+		XFREE(MTYPE_RIB_CLIENT_ROUTES, c);
+	}
+	rib_client_hash_fini(&info->client_routes);
+}
+
 /* Add RE to head of the route node. */
 static void rib_link(struct route_node *rn, struct route_entry *re)
 {
@@ -3971,6 +4360,9 @@ static void rib_link(struct route_node *rn, struct route_entry *re)
 	}
 
 	re_list_add_head(&dest->routes, re);
+	rib_client_route_track(rn, re);
+	re->nhe_rn = rn;
+	rib_nhe_route_track(re);
 
 	rib_queue_add(rn);
 }
@@ -4013,6 +4405,9 @@ void rib_unlink(struct route_node *rn, struct route_entry *re)
 	dest = rib_dest_from_rnode(rn);
 
 	re_list_del(&dest->routes, re);
+	rib_client_route_untrack(re);
+	rib_nhe_route_untrack(re);
+	re->nhe_rn = NULL;
 
 	if (dest->selected_fib == re)
 		dest->selected_fib = NULL;
@@ -4153,11 +4548,11 @@ void _route_entry_dump(const char *func, union prefixconstptr pp,
 		   straddr, VRF_LOGNAME(vrf), (unsigned long)re->uptime,
 		   re->type, re->instance, re->table);
 	zlog_debug("%s(%s): metric == %u, mtu == %u, distance == %u, flags == %sstatus == %s",
-		   straddr, VRF_LOGNAME(vrf), re->metric, re->mtu, re->distance,
+		   straddr, VRF_LOGNAME(vrf), re->metric, re_mtu(re), re->distance,
 		   zclient_dump_route_flags(re->flags, flags_buf, sizeof(flags_buf)),
 		   zebra_rib_dump_re_status(re, status_buf, sizeof(status_buf)));
 	zlog_debug("%s(%s): tag == %u, nexthop_num == %u, nexthop_active_num == %u",
-		   straddr, VRF_LOGNAME(vrf), re->tag,
+		   straddr, VRF_LOGNAME(vrf), re_tag(re),
 		   nexthop_group_nexthop_num(&(re->nhe->nhg)),
 		   nexthop_group_active_nexthop_num(&(re->nhe->nhg)));
 
@@ -4291,17 +4686,17 @@ struct route_entry *zebra_rib_route_entry_new(vrf_id_t vrf_id, int type,
 {
 	struct route_entry *re;
 
-	re = XCALLOC(MTYPE_RE, sizeof(struct route_entry));
+	re = slab_alloc(re_slab);
 	re->type = type;
 	re->instance = instance;
 	re->distance = distance;
 	re->flags = flags;
 	re->metric = metric;
-	re->mtu = mtu;
+	re_set_mtu(re, mtu);
 	re->table = table_id;
 	re->vrf_id = vrf_id;
 	re->uptime = monotime(NULL);
-	re->tag = tag;
+	re_set_tag(re, tag);
 	re->nhe_id = nhe_id;
 
 	return re;
@@ -4310,7 +4705,16 @@ struct route_entry *zebra_rib_route_entry_new(vrf_id_t vrf_id, int type,
 void zebra_rib_route_entry_free(struct route_entry *re)
 {
 	zapi_re_opaque_free(re);
-	XFREE(MTYPE_RE, re);
+	XFREE(MTYPE_RE_EXT, re->ext);
+	slab_free(re_slab, re);
+}
+
+struct re_ext *re_ext_get(struct route_entry *re)
+{
+	if (!re->ext)
+		re->ext = XCALLOC(MTYPE_RE_EXT, sizeof(struct re_ext));
+
+	return re->ext;
 }
 
 /*
@@ -4346,6 +4750,7 @@ int rib_add_multipath_nhe(afi_t afi, safi_t safi, struct prefix *p, struct prefi
 	ere->re_nhe = re_nhe;
 	ere->startup = startup;
 	ere->replace = replace;
+	ere->lat_origin = zebra_lat_origin();
 
 	return mq_add_handler(ere, rib_meta_queue_early_route_add);
 }
@@ -4467,6 +4872,7 @@ void rib_delete(afi_t afi, safi_t safi, vrf_id_t vrf_id, int type,
 	ere->startup = false;
 	ere->deletion = true;
 	ere->fromkernel = fromkernel;
+	ere->lat_origin = zebra_lat_origin();
 
 	mq_add_handler(ere, rib_meta_queue_early_route_add);
 }
@@ -5031,6 +5437,9 @@ static void rib_process_dplane_results(struct event *event)
 	}
 #endif /* HAVE_SCRIPTING */
 
+	/* Nexthop updates resulting from this run go out together */
+	zebra_rnh_notify_batch_begin();
+
 	/* Dequeue a list of completed updates with one lock/unlock cycle */
 
 	do {
@@ -5086,8 +5495,11 @@ static void rib_process_dplane_results(struct event *event)
 				 * we don't want to continue processing these
 				 * in the rib.
 				 */
-				if (dplane_ctx_get_notif_provider(ctx) == 0)
+				if (dplane_ctx_get_notif_provider(ctx) == 0) {
+					dplane_ctx_lat_mark(ctx, ZEBRA_LAT_RESULTS_QUEUE);
 					rib_process_result(ctx);
+					dplane_ctx_lat_finish(ctx);
+				}
 				break;
 
 			case DPLANE_OP_ROUTE_NOTIFY:
@@ -5196,6 +5608,8 @@ static void rib_process_dplane_results(struct event *event)
 
 	} while (1);
 
+	zebra_rnh_notify_batch_end();
+
 #ifdef HAVE_SCRIPTING
 	if (fs)
 		frrscript_delete(fs);
@@ -5213,6 +5627,8 @@ static void rib_process_dplane_results(struct event *event)
  */
 static int rib_dplane_results(struct dplane_ctx_list_head *ctxlist)
 {
+	dplane_ctx_list_lat_mark(ctxlist, ZEBRA_LAT_DPLANE_RETURN);
+
 	/* Take lock controlling queue of results */
 	frr_with_mutex (&dplane_mutex) {
 		uint32_t q_count, q_high;
@@ -5269,6 +5685,49 @@ static void check_route_info(void)
 	}
 }
 
+/* "show memory": what the RIB actually costs per route */
+static int zebra_rib_show_memory(struct vty *vty, struct json_object *json)
+{
+	struct slab_stats re_st, dest_st;
+	size_t n_ext, bytes, per_route;
+	struct json_object *json_rib;
+
+	slab_get_stats(re_slab, &re_st);
+	slab_get_stats(dest_slab, &dest_st);
+	n_ext = atomic_load_explicit(&MTYPE_RE_EXT->n_alloc,
+				     memory_order_relaxed);
+
+	bytes = re_st.bytes + dest_st.bytes + n_ext * sizeof(struct re_ext);
+	per_route = re_st.in_use ? bytes / re_st.in_use : 0;
+
+	if (json) {
+		json_rib = json_object_new_object();
+		json_object_int_add(json_rib, "routeEntries", re_st.in_use);
+		json_object_int_add(json_rib, "routeEntrySize", re_st.objsize);
+		json_object_int_add(json_rib, "routeEntryBytes", re_st.bytes);
+		json_object_int_add(json_rib, "routeEntriesFree", re_st.free);
+		json_object_int_add(json_rib, "destinations", dest_st.in_use);
+		json_object_int_add(json_rib, "destinationSize", dest_st.objsize);
+		json_object_int_add(json_rib, "destinationBytes", dest_st.bytes);
+		json_object_int_add(json_rib, "destinationsFree", dest_st.free);
+		json_object_int_add(json_rib, "routeEntryExtensions", n_ext);
+		json_object_int_add(json_rib, "bytesPerRoute", per_route);
+		json_object_object_add(json, "zebraRib", json_rib);
+		return 0;
+	}
+
+	vty_out(vty, "--- zebra RIB slabs:\n");
+	vty_out(vty, "Route entries:     %zu in use, %zu free, %zu bytes each, %zu bytes total\n",
+		re_st.in_use, re_st.free, re_st.objsize, re_st.bytes);
+	vty_out(vty, "RIB destinations:  %zu in use, %zu free, %zu bytes each, %zu bytes total\n",
+		dest_st.in_use, dest_st.free, dest_st.objsize, dest_st.bytes);
+	vty_out(vty, "Route extensions:  %zu (tag, MTU or opaque data)\n", n_ext);
+	vty_out(vty, "Bytes per route:   %zu\n", per_route);
+	vty_out(vty, "\n");
+
+	return 0;
+}
+
 /* Routing information base initialize. */
 void zebra_rib_init(void)
 {
@@ -5276,6 +5735,12 @@ void zebra_rib_init(void)
 
 	rib_queue_init();
 
+	re_slab = slab_new(MTYPE_RE, sizeof(struct route_entry),
+			   RIB_SLAB_CHUNK);
+	dest_slab = slab_new(MTYPE_RIB_DEST, sizeof(rib_dest_t),
+			     RIB_SLAB_CHUNK);
+	hook_register(show_memory_extra, zebra_rib_show_memory);
+
 	/* Init dataplane, and register for results */
 	pthread_mutex_init(&dplane_mutex, NULL);
 	dplane_ctx_q_init(&rib_dplane_q);
@@ -5296,6 +5761,21 @@ void zebra_rib_terminate(void)
 	}
 }
 
+/* Release the route entry and dest slabs, once all tables are gone */
+void zebra_rib_slab_fini(void)
+{
+	struct slab_stats re_st, dest_st;
+
+	slab_get_stats(re_slab, &re_st);
+	slab_get_stats(dest_slab, &dest_st);
+	if (re_st.in_use || dest_st.in_use)
+		zlog_warn("%s: %zu route entries and %zu dests still allocated",
+			  __func__, re_st.in_use, dest_st.in_use);
+
+	slab_destroy(&re_slab);
+	slab_destroy(&dest_slab);
+}
+
 /*
  * vrf_id_get_next
  *
@@ -38,6 +38,19 @@
 
 DEFINE_MTYPE_STATIC(ZEBRA, RNH, "Nexthop tracking object");
 DEFINE_MTYPE_STATIC(ZEBRA, RNH_CONTAINER, "RNH per-client");
+DEFINE_MTYPE_STATIC(ZEBRA, RNH_NOTIFY, "RNH client notification batch");
+
+/*
+ * Nexthop updates generated while a batch of route changes is processed
+ * are held per client and handed to the client's I/O pthread in one go.
+ */
+struct rnh_notify_batch {
+	struct zserv *client;
+	struct stream_fifo fifo;
+};
+
+static struct list *rnh_notify_batches;
+static unsigned int rnh_notify_depth;
 
 /* Container for multiple rnh structures per prefix.
  * This is stored in route_node->info in the rnh_table.
@@ -88,9 +101,60 @@ DECLARE_RBTREE_UNIQ(rnh_rbtree, struct rnh, rnh_rbtree_item, rnh_rbtree_cmp);
 
 void zebra_rnh_init(void)
 {
+	rnh_notify_batches = list_new();
 	hook_register(zserv_client_close, zebra_client_cleanup_rnh);
 }
 
+static void rnh_notify_batch_free(struct rnh_notify_batch *batch)
+{
+	stream_fifo_deinit(&batch->fifo);
+	XFREE(MTYPE_RNH_NOTIFY, batch);
+}
+
+void zebra_rnh_notify_batch_begin(void)
+{
+	rnh_notify_depth++;
+}
+
+void zebra_rnh_notify_batch_end(void)
+{
+	struct rnh_notify_batch *batch;
+
+	assert(rnh_notify_depth);
+	if (--rnh_notify_depth)
+		return;
+
+	while ((batch = listnode_head(rnh_notify_batches)) != NULL) {
+		listnode_delete(rnh_notify_batches, batch);
+		zserv_send_batch(batch->client, &batch->fifo);
+		rnh_notify_batch_free(batch);
+	}
+}
+
+/* Send now, or hold on to the message until the batch ends */
+static int zebra_rnh_send(struct zserv *client, struct stream *s)
+{
+	struct rnh_notify_batch *batch;
+	struct listnode *node;
+
+	if (!rnh_notify_depth)
+		return zserv_send_message(client, s);
+
+	for (ALL_LIST_ELEMENTS_RO(rnh_notify_batches, node, batch))
+		if (batch->client == client)
+			break;
+
+	if (!node) {
+		batch = XCALLOC(MTYPE_RNH_NOTIFY, sizeof(*batch));
+		batch->client = client;
+		stream_fifo_init(&batch->fifo);
+		listnode_add(rnh_notify_batches, batch);
+	}
+
+	stream_fifo_push(&batch->fifo, s);
+	return 0;
+}
+
 static inline struct route_table *get_rnh_table(vrf_id_t vrfid, afi_t afi,
 						safi_t safi)
 {
@@ -110,30 +174,18 @@ static inline struct route_table *get_rnh_table(vrf_id_t vrfid, afi_t afi,
 
 static void zebra_rnh_remove_from_routing_table(struct rnh *rnh)
 {
-	struct zebra_vrf *zvrf = zebra_vrf_lookup_by_id(rnh->vrf_id);
-	struct route_table *table;
-	struct route_node *rn;
-	rib_dest_t *dest;
-
-	if (!zvrf)
-		return;
-
-	table = zvrf->table[rnh->afi][rnh->safi];
-	if (!table)
-		return;
+	rib_dest_t *dest = rnh->nht_dest;
 
-	rn = route_node_match(table, &rnh->resolved_route);
-	if (!rn)
+	if (!dest)
 		return;
 
 	if (IS_ZEBRA_DEBUG_NHT_DETAILED)
 		zlog_debug("%s: %s(%u):%pRN removed from tracking on %pRN",
-			   __func__, VRF_LOGNAME(zvrf->vrf), rnh->vrf_id,
-			   rnh->node, rn);
+			   __func__, vrf_id_to_name(rnh->vrf_id), rnh->vrf_id,
+			   rnh->node, dest->rnode);
 
-	dest = rib_dest_from_rnode(rn);
 	rnh_list_del(&dest->nht, rnh);
-	route_unlock_node(rn);
+	rnh->nht_dest = NULL;
 }
 
 static void zebra_rnh_store_in_routing_table(struct rnh *rnh)
@@ -161,6 +213,7 @@ static void zebra_rnh_store_in_routing_table(struct rnh *rnh)
 
 	dest = rib_dest_from_rnode(rn);
 	rnh_list_add_tail(&dest->nht, rnh);
+	rnh->nht_dest = dest;
 	route_unlock_node(rn);
 }
 
@@ -283,30 +336,10 @@ struct rnh *zebra_lookup_rnh(struct prefix *p, vrf_id_t vrfid, safi_t safi, stru
 
 void zebra_free_rnh(struct rnh *rnh)
 {
-	struct zebra_vrf *zvrf;
-	struct route_table *table;
-
 	zebra_rnh_remove_from_routing_table(rnh);
 	rnh->flags |= ZEBRA_NHT_DELETED;
 	list_delete(&rnh->zebra_pseudowire_list);
 
-	zvrf = zebra_vrf_lookup_by_id(rnh->vrf_id);
-	if (zvrf) {
-		table = zvrf->table[family2afi(rnh->resolved_route.family)][rnh->safi];
-
-		if (table) {
-			struct route_node *rern;
-
-			rern = route_node_match(table, &rnh->resolved_route);
-			if (rern) {
-				rib_dest_t *dest;
-
-				dest = rib_dest_from_rnode(rern);
-				rnh_list_del(&dest->nht, rnh);
-				route_unlock_node(rern);
-			}
-		}
-	}
 	free_state(rnh->vrf_id, rnh->state, rnh->node);
 	XFREE(MTYPE_RNH, rnh);
 }
@@ -910,6 +943,8 @@ void zebra_evaluate_rnh(struct zebra_vrf *zvrf, afi_t afi, int force,
 	if (!rnh_table)
 		return;
 
+	zebra_rnh_notify_batch_begin();
+
 	if (p) {
 		/* Evaluating a specific entry, make sure it exists. */
 		nrn = route_node_lookup(rnh_table, p);
@@ -933,6 +968,8 @@ void zebra_evaluate_rnh(struct zebra_vrf *zvrf, afi_t afi, int force,
 			nrn = route_next(nrn); /* this will also unlock nrn */
 		}
 	}
+
+	zebra_rnh_notify_batch_end();
 }
 
 void zebra_print_rnh_table(vrf_id_t vrfid, afi_t afi, safi_t safi,
@@ -1022,11 +1059,8 @@ static void copy_state(struct rnh *rnh, const struct route_entry *re,
 	if (!re)
 		return;
 
-	state = XCALLOC(MTYPE_RE, sizeof(struct route_entry));
-	state->type = re->type;
-	state->distance = re->distance;
-	state->metric = re->metric;
-	state->vrf_id = re->vrf_id;
+	state = zebra_rib_route_entry_new(re->vrf_id, re->type, 0, 0, 0, 0,
+					  re->metric, 0, re->distance, 0);
 	state->status = re->status;
 
 	state->nhe = zebra_nhe_copy(re->nhe, 0);
@@ -1241,7 +1275,7 @@ int zebra_send_rnh_update(struct rnh *rnh, struct zserv *client,
 	stream_putw_at(s, 0, stream_get_endp(s));
 
 	client->nh_last_upd_time = monotime(NULL);
-	return zserv_send_message(client, s);
+	return zebra_rnh_send(client, s);
 
 failure:
 
@@ -1517,6 +1551,17 @@ static int zebra_client_cleanup_rnh(struct zserv *client)
 {
 	struct vrf *vrf;
 	struct zebra_vrf *zvrf;
+	struct rnh_notify_batch *batch;
+	struct listnode *node, *nnode;
+
+	/* Drop anything still held for the client */
+	for (ALL_LIST_ELEMENTS(rnh_notify_batches, node, nnode, batch)) {
+		if (batch->client != client)
+			continue;
+
+		list_delete_node(rnh_notify_batches, node);
+		rnh_notify_batch_free(batch);
+	}
 
 	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id) {
 		zvrf = vrf->info;
@@ -40,6 +40,8 @@ extern int zebra_send_rnh_update(struct rnh *rnh, struct zserv *client,
 extern void zebra_register_rnh_pseudowire(vrf_id_t vrf_id, struct zebra_pw *pw, bool *nht_exists);
 extern void zebra_deregister_rnh_pseudowire(vrf_id_t vrf_id, struct zebra_pw *pw);
 extern void zebra_remove_rnh_client(struct rnh *rnh, struct zserv *client);
+extern void zebra_rnh_notify_batch_begin(void);
+extern void zebra_rnh_notify_batch_end(void);
 extern void zebra_evaluate_rnh(struct zebra_vrf *zvrf, afi_t afi, int force,
 			       const struct prefix *p, safi_t safi);
 extern void zebra_print_rnh_table(vrf_id_t vrfid, afi_t afi, safi_t safi,
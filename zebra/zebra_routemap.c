@@ -49,7 +49,7 @@ route_match_tag(void *rule, const struct prefix *prefix, void *object)
 	tag = rule;
 	rm_data = object;
 
-	if (rm_data->re->tag == *tag)
+	if (re_tag(rm_data->re) == *tag)
 		return RMAP_MATCH;
 
 	return RMAP_NOMATCH;
@@ -16,6 +16,7 @@
 #include "zebra_nhg.h"
 #include "zebra_neigh.h"
 #include "zebra/zebra_tc.h"
+#include "zebra/zebra_latency.h"
 #include "debug.h"
 #include "zebra_script.h"
 #include "wheel.h"
@@ -191,12 +192,20 @@ void zebra_router_sweep_nhgs(void)
 
 static void zebra_router_free_table(struct zebra_router_table *zrt)
 {
-	void *table_info;
+	struct rib_table_info *table_info;
+	int i;
 
 	table_info = route_table_get_info(zrt->table);
+	zebra_nhg_resolve_cache_free(table_info);
+	rib_meta_queue_table_free(table_info);
 	route_table_finish(zrt->table);
+	rib_table_client_routes_free(table_info);
 	RB_REMOVE(zebra_router_table_head, &zrouter.tables, zrt);
 
+	for (i = 0; i < MQ_SIZE; i++)
+		if (table_info->mq_nodes[i])
+			list_delete(&table_info->mq_nodes[i]);
+
 	XFREE(MTYPE_RIB_TABLE_INFO, table_info);
 	XFREE(MTYPE_ZEBRA_RT_TABLE, zrt);
 }
@@ -310,6 +319,7 @@ void zebra_router_init(bool asic_offload, bool notify_on_ack, bool v6_with_v4_ne
 
 	zebra_vxlan_init();
 	zebra_mlag_init();
+	zebra_lat_init();
 	zebra_neigh_init();
 
 	zrouter.rules_hash = hash_create_size(8, zebra_pbr_rules_hash_key,
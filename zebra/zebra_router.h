@@ -137,6 +137,22 @@ struct zebra_architectural_values {
 
 };
 
+/*
+ * Time spent reading the initial kernel state, per startup phase
+ */
+struct zebra_startup_stats {
+	struct timeval begin;
+
+	/* Interfaces, tunnels and addresses */
+	uint64_t links_usec;
+	uint64_t neighs_usec;
+	uint64_t routes_usec;
+	/* VLANs, rules and qdiscs */
+	uint64_t other_usec;
+
+	uint32_t routes_read;
+};
+
 struct zebra_router {
 	atomic_bool in_shutdown;
 
@@ -188,9 +204,6 @@ struct zebra_router {
 	/* Meta Queue Information */
 	struct meta_queue *mq;
 
-	/* LSP work queue */
-	struct work_queue *lsp_process_q;
-
 #define ZEBRA_ZAPI_PACKETS_TO_PROCESS 1000
 	_Atomic uint32_t packets_to_process;
 
@@ -211,6 +224,7 @@ struct zebra_router {
 	 */
 	time_t startup_time;
 	time_t rib_sweep_time;
+	struct zebra_startup_stats startup_stats;
 
 	/* FRR fast/graceful restart info */
 	bool graceful_restart;
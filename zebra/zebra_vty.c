@@ -31,6 +31,7 @@
 #include "zebra/zebra_rnh.h"
 #include "zebra/redistribute.h"
 #include "zebra/zebra_affinitymap.h"
+#include "zebra/zebra_latency.h"
 #include "zebra/zebra_routemap.h"
 #include "lib/json.h"
 #include "lib/route_opaque.h"
@@ -332,22 +333,23 @@ static void zebra_show_ip_route_opaque(struct vty *vty, struct route_entry *re,
 {
 	struct bgp_zebra_opaque bzo = {};
 	struct ospf_zebra_opaque ozo = {};
+	struct re_opaque *opaque = re_opaque(re);
 
-	if (!re->opaque)
+	if (!opaque)
 		return;
 
 	switch (re->type) {
 	case ZEBRA_ROUTE_SHARP:
 		if (json)
 			json_object_string_add(json, "opaque",
-					       (char *)re->opaque->data);
+					       (char *)opaque->data);
 		else
 			vty_out(vty, "    Opaque Data: %s",
-				(char *)re->opaque->data);
+				(char *)opaque->data);
 		break;
 
 	case ZEBRA_ROUTE_BGP:
-		memcpy(&bzo, re->opaque->data, re->opaque->length);
+		memcpy(&bzo, opaque->data, opaque->length);
 
 		if (json) {
 			json_object_string_add(json, "asPath", bzo.aspath);
@@ -374,7 +376,7 @@ static void zebra_show_ip_route_opaque(struct vty *vty, struct route_entry *re,
 		break;
 	case ZEBRA_ROUTE_OSPF:
 	case ZEBRA_ROUTE_OSPF6:
-		memcpy(&ozo, re->opaque->data, re->opaque->length);
+		memcpy(&ozo, opaque->data, opaque->length);
 
 		if (json) {
 			json_object_string_add(json, "ospfPathType",
@@ -450,15 +452,15 @@ static void vty_show_ip_route_detail(struct vty *vty, struct route_node *rn,
 		vty_out(vty, "\"");
 		vty_out(vty, ", distance %u, metric %u", re->distance,
 			re->metric);
-		if (re->tag) {
-			vty_out(vty, ", tag %u", re->tag);
+		if (re_tag(re)) {
+			vty_out(vty, ", tag %u", re_tag(re));
 #if defined(SUPPORT_REALMS)
-			if (re->tag > 0 && re->tag <= 255)
+			if (re_tag(re) > 0 && re_tag(re) <= 255)
 				vty_out(vty, "(realm)");
 #endif
 		}
-		if (re->mtu)
-			vty_out(vty, ", mtu %u", re->mtu);
+		if (re_mtu(re))
+			vty_out(vty, ", mtu %u", re_mtu(re));
 		if (re->vrf_id != VRF_DEFAULT) {
 			zvrf = zebra_vrf_lookup_by_id(re->vrf_id);
 			vty_out(vty, ", vrf %s", zvrf_name(zvrf));
@@ -588,8 +590,9 @@ static void vty_show_ip_route(struct vty *vty, struct route_node *rn, struct rou
 				uint16_t nh_ecmp_count = nexthop_group_nexthop_num_no_recurse(nhg);
 				uint16_t fib_nh_count = nexthop_group_fib_nexthop_num(nhg);
 
-				if (re->tag)
-					json_object_int_add(json_route, "tag", re->tag);
+				if (re_tag(re))
+					json_object_int_add(json_route, "tag",
+							    re_tag(re));
 
 				if (re->table)
 					json_object_int_add(json_route, "table", re->table);
@@ -618,8 +621,9 @@ static void vty_show_ip_route(struct vty *vty, struct route_node *rn, struct rou
 					json_object_boolean_true_add(json_route, "trapped");
 
 
-				if (re->tag)
-					json_object_int_add(json_route, "tag", re->tag);
+				if (re_tag(re))
+					json_object_int_add(json_route, "tag",
+							    re_tag(re));
 
 				if (re->table)
 					json_object_int_add(json_route, "table", re->table);
@@ -884,7 +888,7 @@ static void do_show_route_helper(struct vty *vty, struct zebra_vrf *zvrf,
 			if (failed_only && !CHECK_FLAG(re->status, ROUTE_ENTRY_FAILED))
 				continue;
 
-			if (tag && re->tag != tag)
+			if (tag && re_tag(re) != tag)
 				continue;
 
 			/* This can only be true when the afi is IPv4 */
@@ -2352,7 +2356,7 @@ static void show_ip_route_dump_vty(struct vty *vty, struct route_table *table, a
 				vty_out(vty, "   metric: %u\n", re->metric);
 			}
 
-			vty_out(vty, "   tag: %u\n", re->tag);
+			vty_out(vty, "   tag: %u\n", re_tag(re));
 
 			uptime = monotime(&tv);
 			uptime -= re->uptime;
@@ -3793,6 +3797,18 @@ DEFPY (zebra_nexthop_group_keep,
 	return CMD_SUCCESS;
 }
 
+DEFPY (zebra_route_latency,
+       zebra_route_latency_cmd,
+       "[no] zebra route-latency",
+       NO_STR
+       ZEBRA_STR
+       "Record per-stage route install latency\n")
+{
+	zebra_lat_enable(!no);
+
+	return CMD_SUCCESS;
+}
+
 static int config_write_protocol(struct vty *vty)
 {
 	if (zrouter.allow_delete)
@@ -3801,6 +3817,9 @@ static int config_write_protocol(struct vty *vty)
 	if (zrouter.nhg_keep != ZEBRA_DEFAULT_NHG_KEEP_TIMER)
 		vty_out(vty, "zebra nexthop-group keep %u\n", zrouter.nhg_keep);
 
+	if (zebra_lat_enabled())
+		vty_out(vty, "zebra route-latency\n");
+
 	if (zrouter.ribq->spec.hold != ZEBRA_RIB_PROCESS_HOLD_TIME)
 		vty_out(vty, "zebra work-queue %u\n", zrouter.ribq->spec.hold);
 
@@ -3936,6 +3955,15 @@ DEFUN (show_zebra,
 		       zrouter.default_mc_forwardingv6 ? "On" : "Off");
 	ttable_add_row(table, "Backup Nexthops Installed|%s",
 		       zrouter.backup_nhs_installed ? "Yes" : "No");
+	ttable_add_row(table, "Startup Interface Read|%" PRIu64 " ms",
+		       zrouter.startup_stats.links_usec / 1000);
+	ttable_add_row(table, "Startup Neighbor Read|%" PRIu64 " ms",
+		       zrouter.startup_stats.neighs_usec / 1000);
+	ttable_add_row(table, "Startup Route Read|%" PRIu64 " ms, %u routes",
+		       zrouter.startup_stats.routes_usec / 1000,
+		       zrouter.startup_stats.routes_read);
+	ttable_add_row(table, "Startup Other Read|%" PRIu64 " ms",
+		       zrouter.startup_stats.other_usec / 1000);
 
 	out = ttable_dump(table, "\n");
 	vty_out(vty, "%s\n", out);
@@ -4277,6 +4305,7 @@ void zebra_vty_init(void)
 	install_node(&protocol_node);
 
 	install_element(CONFIG_NODE, &zebra_nexthop_group_keep_cmd);
+	install_element(CONFIG_NODE, &zebra_route_latency_cmd);
 	install_element(CONFIG_NODE, &nexthop_group_use_enable_cmd);
 	install_element(CONFIG_NODE, &proto_nexthop_group_only_cmd);
 	install_element(CONFIG_NODE, &backup_nexthop_recursive_use_enable_cmd);
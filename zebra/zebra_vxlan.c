@@ -435,6 +435,7 @@ static void zevpn_print_mac_hash_all_evpn(struct hash_bucket *bucket, void *ctxt
 	json_object *json = NULL, *json_evpn = NULL;
 	json_object *json_mac = NULL;
 	struct zebra_evpn *zevpn;
+	struct zebra_mac *mac;
 	uint32_t num_macs;
 	struct mac_walk_ctx *wctx = ctxt;
 	char vni_str[VNI_STR_LEN];
@@ -499,10 +500,11 @@ static void zevpn_print_mac_hash_all_evpn(struct hash_bucket *bucket, void *ctxt
 	 */
 	wctx->json = json_mac;
 	if (wctx->print_dup)
-		hash_iterate(zevpn->mac_table, zebra_evpn_print_dad_mac_hash,
-			     wctx);
+		frr_each (zebra_mac_db, zevpn->mac_table, mac)
+			zebra_evpn_print_dad_mac_hash(wctx, mac);
 	else
-		hash_iterate(zevpn->mac_table, zebra_evpn_print_mac_hash, wctx);
+		frr_each (zebra_mac_db, zevpn->mac_table, mac)
+			zebra_evpn_print_mac_hash(wctx, mac);
 	wctx->json = json;
 
 	if (json) {
@@ -524,6 +526,7 @@ static void zevpn_print_mac_hash_all_evpn_detail(struct hash_bucket *bucket,
 	json_object *json = NULL, *json_evpn = NULL;
 	json_object *json_mac = NULL;
 	struct zebra_evpn *zevpn;
+	struct zebra_mac *mac;
 	uint32_t num_macs;
 	struct mac_walk_ctx *wctx = ctxt;
 	char vni_str[VNI_STR_LEN];
@@ -575,11 +578,11 @@ static void zevpn_print_mac_hash_all_evpn_detail(struct hash_bucket *bucket,
 	 */
 	wctx->json = json_mac;
 	if (wctx->print_dup)
-		hash_iterate(zevpn->mac_table,
-			     zebra_evpn_print_dad_mac_hash_detail, wctx);
+		frr_each (zebra_mac_db, zevpn->mac_table, mac)
+			zebra_evpn_print_dad_mac_hash_detail(wctx, mac);
 	else
-		hash_iterate(zevpn->mac_table, zebra_evpn_print_mac_hash_detail,
-			     wctx);
+		frr_each (zebra_mac_db, zevpn->mac_table, mac)
+			zebra_evpn_print_mac_hash_detail(wctx, mac);
 	wctx->json = json;
 
 	if (json) {
@@ -3418,6 +3421,7 @@ void zebra_vxlan_print_macs_vni(struct vty *vty, struct zebra_vrf *zvrf,
 				vni_t vni, bool use_json, bool detail)
 {
 	struct zebra_evpn *zevpn;
+	struct zebra_mac *mac;
 	uint32_t num_macs;
 	struct mac_walk_ctx wctx;
 	json_object *json = NULL;
@@ -3471,11 +3475,11 @@ void zebra_vxlan_print_macs_vni(struct vty *vty, struct zebra_vrf *zvrf,
 		json_object_int_add(json, "numMacs", num_macs);
 
 	if (detail)
-		hash_iterate(zevpn->mac_table, zebra_evpn_print_mac_hash_detail,
-			     &wctx);
+		frr_each (zebra_mac_db, zevpn->mac_table, mac)
+			zebra_evpn_print_mac_hash_detail(&wctx, mac);
 	else
-		hash_iterate(zevpn->mac_table, zebra_evpn_print_mac_hash,
-			     &wctx);
+		frr_each (zebra_mac_db, zevpn->mac_table, mac)
+			zebra_evpn_print_mac_hash(&wctx, mac);
 
 	if (use_json) {
 		json_object_object_add(json, "macs", json_mac);
@@ -3637,6 +3641,7 @@ void zebra_vxlan_print_macs_vni_dad(struct vty *vty,
 				    vni_t vni, bool use_json)
 {
 	struct zebra_evpn *zevpn;
+	struct zebra_mac *mac;
 	struct mac_walk_ctx wctx;
 	uint32_t num_macs;
 	json_object *json = NULL;
@@ -3690,7 +3695,8 @@ void zebra_vxlan_print_macs_vni_dad(struct vty *vty,
 	} else
 		json_object_int_add(json, "numMacs", num_macs);
 
-	hash_iterate(zevpn->mac_table, zebra_evpn_print_dad_mac_hash, &wctx);
+	frr_each (zebra_mac_db, zevpn->mac_table, mac)
+		zebra_evpn_print_dad_mac_hash(&wctx, mac);
 
 	if (use_json) {
 		json_object_object_add(json, "macs", json_mac);
@@ -3854,18 +3860,13 @@ int zebra_vxlan_clear_dup_detect_vni_ip(struct zebra_vrf *zvrf, vni_t vni,
 	return 0;
 }
 
-static void zevpn_clear_dup_mac_hash(struct hash_bucket *bucket, void *ctxt)
+static void zevpn_clear_dup_mac_hash(struct mac_walk_ctx *wctx,
+				     struct zebra_mac *mac)
 {
-	struct mac_walk_ctx *wctx = ctxt;
-	struct zebra_mac *mac;
 	struct zebra_evpn *zevpn;
 	struct listnode *node = NULL;
 	struct zebra_neigh *nbr = NULL;
 
-	mac = (struct zebra_mac *)bucket->data;
-	if (!mac)
-		return;
-
 	zevpn = wctx->zevpn;
 
 	if (!CHECK_FLAG(mac->flags, ZEBRA_MAC_DUPLICATE))
@@ -3931,10 +3932,13 @@ static void zevpn_clear_dup_detect_hash_vni_all(struct hash_bucket *bucket,
 	}
 
 	if (num_valid_macs(zevpn)) {
+		struct zebra_mac *mac;
+
 		memset(&m_wctx, 0, sizeof(m_wctx));
 		m_wctx.zevpn = zevpn;
 		m_wctx.zvrf = zvrf;
-		hash_iterate(zevpn->mac_table, zevpn_clear_dup_mac_hash, &m_wctx);
+		frr_each (zebra_mac_db, zevpn->mac_table, mac)
+			zevpn_clear_dup_mac_hash(&m_wctx, mac);
 	}
 
 }
@@ -3977,10 +3981,13 @@ int zebra_vxlan_clear_dup_detect_vni(struct zebra_vrf *zvrf, vni_t vni)
 	}
 
 	if (num_valid_macs(zevpn)) {
+		struct zebra_mac *mac;
+
 		memset(&m_wctx, 0, sizeof(m_wctx));
 		m_wctx.zevpn = zevpn;
 		m_wctx.zvrf = zvrf;
-		hash_iterate(zevpn->mac_table, zevpn_clear_dup_mac_hash, &m_wctx);
+		frr_each (zebra_mac_db, zevpn->mac_table, mac)
+			zevpn_clear_dup_mac_hash(&m_wctx, mac);
 	}
 
 	return 0;
@@ -3993,6 +4000,7 @@ void zebra_vxlan_print_macs_vni_vtep(struct vty *vty, struct zebra_vrf *zvrf, vn
 				     struct ipaddr *vtep_ip, bool use_json)
 {
 	struct zebra_evpn *zevpn;
+	struct zebra_mac *mac;
 	uint32_t num_macs;
 	struct mac_walk_ctx wctx;
 	json_object *json = NULL;
@@ -4030,7 +4038,8 @@ void zebra_vxlan_print_macs_vni_vtep(struct vty *vty, struct zebra_vrf *zvrf, vn
 	wctx.flags = SHOW_REMOTE_MAC_FROM_VTEP;
 	wctx.r_vtep_ip = *vtep_ip;
 	wctx.json = json_mac;
-	hash_iterate(zevpn->mac_table, zebra_evpn_print_mac_hash, &wctx);
+	frr_each (zebra_mac_db, zevpn->mac_table, mac)
+		zebra_evpn_print_mac_hash(&wctx, mac);
 
 	if (use_json) {
 		json_object_int_add(json, "numMacs", wctx.count);
@@ -39,6 +39,7 @@
 #include "lib/zclient.h"          /* for zmsghdr, ZEBRA_HEADER_SIZE, ZEBRA... */
 #include "lib/frr_pthread.h"      /* for frr_pthread_new, frr_pthread_stop... */
 #include "lib/frratomic.h"        /* for atomic_load_explicit, atomic_stor... */
+#include "lib/shmring.h"          /* for shmring_attach, shmring_peek... */
 #include "lib/lib_errors.h"       /* for generic ferr ids */
 #include "lib/printfrr.h"         /* for string functions */
 #include "lib/json.h"
@@ -50,6 +51,8 @@
 #include "zebra/zserv.h"          /* for zserv */
 #include "zebra/zebra_router.h"
 #include "zebra/zebra_errors.h"   /* for error messages */
+#include "zebra/zebra_latency.h"
+#include "zebra/redistribute.h"
 
 #ifndef VTYSH_EXTRACT_PL
 #include "zebra/zserv_clippy.c"
@@ -72,6 +75,31 @@ static struct zserv *find_client_internal(uint8_t proto,
 
 /* Mem type for zclients. */
 DEFINE_MTYPE_STATIC(ZEBRA, ZSERV_CLIENT, "ZClients");
+DEFINE_MTYPE_STATIC(ZEBRA, ZSERV_IBUF_BATCH, "ZClient input batch");
+
+/* Messages read by a client pthread in one go, queued for the main pthread */
+struct zserv_ibuf_batch {
+	struct zserv_ibuf_list_item entry;
+	struct stream_fifo *msgs;
+	/* when the batch was queued */
+	struct timeval queued;
+};
+
+DECLARE_ATOMLIST(zserv_ibuf_list, struct zserv_ibuf_batch, entry);
+DECLARE_ATOMLIST(zserv_sched_incoming, struct zserv, sched_incoming_entry);
+DECLARE_DLIST(zserv_sched_list, struct zserv, sched_entry);
+
+/*
+ * Input scheduling. Client pthreads push clients with new input onto the
+ * incoming list; the main pthread moves them onto the active list and
+ * serves that round-robin, see zserv_process_messages().
+ */
+static struct zserv_sched_incoming_head zserv_sched_incoming;
+static struct zserv_sched_list_head zserv_sched_active;
+static struct event *t_zserv_sched;
+
+/* Messages per unit of weight a client may have processed per round */
+#define ZSERV_SCHED_QUANTUM 64
 
 /*
  * Client thread events.
@@ -136,6 +164,8 @@ static void zserv_client_event(struct zserv *client,
  */
 static void zserv_event(struct zserv *client, enum zserv_event event);
 
+static void zserv_read_ring(struct event *event);
+
 
 /* Client thread lifecycle -------------------------------------------------- */
 
@@ -197,6 +227,7 @@ static void zserv_client_fail(struct zserv *client)
 
 	event_cancel(&client->t_read);
 	event_cancel(&client->t_write);
+	event_cancel(&client->t_ring);
 	zserv_event(client, ZSERV_HANDLE_CLIENT_FAIL);
 }
 
@@ -291,6 +322,171 @@ zwrite_fail:
 	zserv_client_fail(client);
 }
 
+/*
+ * Fetch and validate the header of the message at the start of s.
+ *
+ * Returns false, after logging why, if the header is unusable.
+ */
+static bool zserv_read_header(struct zserv *client, struct stream *s,
+			      struct zmsghdr *hdr)
+{
+	char errmsg[256];
+
+	if (!zapi_parse_header(s, hdr)) {
+		snprintf(errmsg, sizeof(errmsg),
+			 "%s: Message has corrupt header", __func__);
+		zserv_log_message(errmsg, s, NULL);
+		return false;
+	}
+
+	if (hdr->marker != ZEBRA_HEADER_MARKER
+	    || hdr->version != ZSERV_VERSION) {
+		snprintf(
+			errmsg, sizeof(errmsg),
+			"Message has corrupt header\n%s: socket %d version mismatch, marker %d, version %d",
+			__func__, client->sock, hdr->marker, hdr->version);
+		zserv_log_message(errmsg, s, hdr);
+		return false;
+	}
+	if (hdr->length < ZEBRA_HEADER_SIZE) {
+		snprintf(
+			errmsg, sizeof(errmsg),
+			"Message has corrupt header\n%s: socket %d message length %u is less than header size %d",
+			__func__, client->sock, hdr->length, ZEBRA_HEADER_SIZE);
+		zserv_log_message(errmsg, s, hdr);
+		return false;
+	}
+	if (hdr->length > STREAM_SIZE(s)) {
+		snprintf(
+			errmsg, sizeof(errmsg),
+			"Message has corrupt header\n%s: socket %d message length %u exceeds buffer size %lu",
+			__func__, client->sock, hdr->length,
+			(unsigned long)STREAM_SIZE(s));
+		zserv_log_message(errmsg, s, hdr);
+		return false;
+	}
+
+	return true;
+}
+
+#ifndef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC 0
+#endif
+
+/*
+ * Read the start of the client's first message.
+ *
+ * A client that supports it passes the descriptors of a shared memory ring
+ * along with its HELLO, which is always the first message it sends. Those
+ * arrive as ancillary data on the first bytes of the stream, so they have to
+ * be read with recvmsg(); the ring is attached right away so that nothing the
+ * client writes into it can be read ahead of the HELLO.
+ *
+ * Return values follow stream_read_try().
+ */
+static ssize_t zserv_read_first(struct zserv *client, int sock, size_t size)
+{
+	union {
+		char buf[CMSG_SPACE(sizeof(int) * SHMRING_NFDS)];
+		struct cmsghdr align;
+	} cmsgbuf;
+	struct msghdr msgh = {};
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	ssize_t nb;
+
+	msgh.msg_iov = &iov;
+	msgh.msg_iovlen = 1;
+	msgh.msg_control = cmsgbuf.buf;
+	msgh.msg_controllen = sizeof(cmsgbuf.buf);
+
+	nb = stream_recvmsg(client->ibuf_work, sock, &msgh, MSG_CMSG_CLOEXEC,
+			    size);
+	if (nb < 0)
+		return ERRNO_IO_RETRY(errno) ? -2 : -1;
+
+	for (cmsg = CMSG_FIRSTHDR(&msgh); cmsg;
+	     cmsg = CMSG_NXTHDR(&msgh, cmsg)) {
+		int fds[SHMRING_NFDS];
+		size_t nfds;
+
+		if (cmsg->cmsg_level != SOL_SOCKET ||
+		    cmsg->cmsg_type != SCM_RIGHTS)
+			continue;
+
+		nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		if (nfds != SHMRING_NFDS || client->ring) {
+			int *p = (int *)CMSG_DATA(cmsg);
+
+			while (nfds--)
+				close(*p++);
+			flog_warn(EC_ZEBRA_CLIENT_IO_ERROR,
+				  "Client %d passed unexpected descriptors",
+				  sock);
+			return -1;
+		}
+
+		memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+		client->ring = shmring_attach(fds);
+		if (!client->ring) {
+			flog_warn(EC_ZEBRA_CLIENT_IO_ERROR,
+				  "Client %d passed an unusable shared memory ring",
+				  sock);
+			return -1;
+		}
+		client->ring_work = stream_new(STREAM_SIZE(client->ibuf_work));
+
+		if (IS_ZEBRA_DEBUG_EVENT)
+			zlog_debug("Client %d attached shared memory ring",
+				   sock);
+
+		/* Runs after the HELLO has been queued */
+		event_add_event(client->pthread->master, zserv_read_ring,
+				client, 0, &client->t_ring);
+	}
+
+	return nb;
+}
+
+/*
+ * Hand messages read by the client pthread over to the main thread; the
+ * cache is consumed.
+ *
+ * The batch goes onto the client's lock-free input list. Since the client
+ * pthread is the only producer, it is fully linked in by the time
+ * zserv_ibuf_list_add_tail() returns, which zserv_sched_idle() relies on.
+ */
+static void zserv_read_publish(struct zserv *client, struct stream_fifo *cache,
+			       uint16_t last_cmd)
+{
+	struct zserv_ibuf_batch *batch;
+	uint64_t time_now = monotime(NULL);
+	uint32_t count;
+
+	/* update session statistics */
+	frr_with_mutex (&client->stats_mtx) {
+		client->last_read_time = time_now;
+		client->last_read_cmd = last_cmd;
+	}
+
+	batch = XCALLOC(MTYPE_ZSERV_IBUF_BATCH, sizeof(*batch));
+	batch->msgs = cache;
+	monotime(&batch->queued);
+
+	/* Count first, so the main thread never takes it below zero */
+	count = atomic_fetch_add_explicit(&client->ibuf_count, cache->count,
+					  memory_order_relaxed) +
+		cache->count;
+	if (count > client->ibuf_max_count)
+		client->ibuf_max_count = count;
+
+	/* publish read packets on client's input queue */
+	zserv_ibuf_list_add_tail(&client->ibuf_list, batch);
+
+	/* Schedule job to process those packets */
+	zserv_event(client, ZSERV_PROCESS_MESSAGES);
+}
+
 /*
  * Read and process data from a client socket.
  *
@@ -313,12 +509,12 @@ zwrite_fail:
  *
  * Any failure in any of these actions is handled by terminating the client.
  *
- * The client's input buffer ibuf_fifo can have a maximum items as configured
- * in the packets_to_process. This way we are not filling up the FIFO more
- * than the maximum when the zebra main is busy. If the fifo has space, we
+ * The client's input queue can hold at most as many messages as configured
+ * in packets_to_process. This way we are not filling up the queue more
+ * than the maximum when the zebra main is busy. If the queue has space, we
  * reschedule ourselves to read more.
  *
- * The main thread processes the items in ibuf_fifo and always signals the
+ * The main thread processes the queued messages and always signals the
  * client IO thread.
  */
 static void zserv_read(struct event *event)
@@ -331,15 +527,16 @@ static void zserv_read(struct event *event)
 	uint32_t p2p_orig;  /* Configured p2p (Default-1000) */
 	int p2p_avail;	    /* How much space is available for p2p */
 	struct zmsghdr hdr;
-	size_t client_ibuf_fifo_cnt = stream_fifo_count_safe(client->ibuf_fifo);
+	size_t client_ibuf_fifo_cnt = atomic_load_explicit(&client->ibuf_count,
+							   memory_order_relaxed);
 
 	p2p_orig = atomic_load_explicit(&zrouter.packets_to_process,
 					memory_order_relaxed);
 	p2p_avail = p2p_orig - client_ibuf_fifo_cnt;
 
     /*
-     * Do nothing if ibuf_fifo count has reached its max limit. Otherwise
-     * proceed and reschedule ourselves if there is space in the ibuf_fifo.
+     * Do nothing if the input queue has reached its max limit. Otherwise
+     * proceed and reschedule ourselves if there is space in the queue.
      */
 	if (p2p_avail <= 0)
 		return;
@@ -350,15 +547,19 @@ static void zserv_read(struct event *event)
 
 	while (p2p) {
 		ssize_t nb;
-		bool hdrvalid;
-		char errmsg[256];
 
 		already = stream_get_endp(client->ibuf_work);
 
 		/* Read length and command (if we don't have it already). */
 		if (already < ZEBRA_HEADER_SIZE) {
-			nb = stream_read_try(client->ibuf_work, sock,
-					     ZEBRA_HEADER_SIZE - already);
+			if (!client->first_read)
+				nb = zserv_read_first(client, sock,
+						      ZEBRA_HEADER_SIZE -
+							      already);
+			else
+				nb = stream_read_try(client->ibuf_work, sock,
+						     ZEBRA_HEADER_SIZE -
+							     already);
 			if ((nb == 0 || nb == -1)) {
 				if (IS_ZEBRA_DEBUG_EVENT)
 					zlog_debug("connection closed socket [%d]",
@@ -375,43 +576,8 @@ static void zserv_read(struct event *event)
 		/* Reset to read from the beginning of the incoming packet. */
 		stream_set_getp(client->ibuf_work, 0);
 
-		/* Fetch header values */
-		hdrvalid = zapi_parse_header(client->ibuf_work, &hdr);
-
-		if (!hdrvalid) {
-			snprintf(errmsg, sizeof(errmsg),
-				 "%s: Message has corrupt header", __func__);
-			zserv_log_message(errmsg, client->ibuf_work, NULL);
-			goto zread_fail;
-		}
-
-		/* Validate header */
-		if (hdr.marker != ZEBRA_HEADER_MARKER
-		    || hdr.version != ZSERV_VERSION) {
-			snprintf(
-				errmsg, sizeof(errmsg),
-				"Message has corrupt header\n%s: socket %d version mismatch, marker %d, version %d",
-				__func__, sock, hdr.marker, hdr.version);
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
+		if (!zserv_read_header(client, client->ibuf_work, &hdr))
 			goto zread_fail;
-		}
-		if (hdr.length < ZEBRA_HEADER_SIZE) {
-			snprintf(
-				errmsg, sizeof(errmsg),
-				"Message has corrupt header\n%s: socket %d message length %u is less than header size %d",
-				__func__, sock, hdr.length, ZEBRA_HEADER_SIZE);
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
-			goto zread_fail;
-		}
-		if (hdr.length > STREAM_SIZE(client->ibuf_work)) {
-			snprintf(
-				errmsg, sizeof(errmsg),
-				"Message has corrupt header\n%s: socket %d message length %u exceeds buffer size %lu",
-				__func__, sock, hdr.length,
-				(unsigned long)STREAM_SIZE(client->ibuf_work));
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
-			goto zread_fail;
-		}
 
 		/* Read rest of data. */
 		if (already < hdr.length) {
@@ -444,47 +610,126 @@ static void zserv_read(struct event *event)
 
 		stream_fifo_push(cache, msg);
 		stream_reset(client->ibuf_work);
+		client->first_read = true;
 		p2p--;
 	}
 
 	if (p2p < (uint32_t)p2p_avail) {
-		uint64_t time_now = monotime(NULL);
-
-		/* update session statistics */
-		frr_with_mutex (&client->stats_mtx) {
-			client->last_read_time = time_now;
-			client->last_read_cmd = hdr.command;
-		}
-
-		/* publish read packets on client's input queue */
-		frr_with_mutex (&client->ibuf_mtx) {
-			while (cache->head)
-				stream_fifo_push(client->ibuf_fifo,
-						 stream_fifo_pop(cache));
-			/* Need to update count as main event could have processed few */
-			client_ibuf_fifo_cnt =
-				stream_fifo_count_safe(client->ibuf_fifo);
-		}
-
-		/* Schedule job to process those packets */
-		zserv_event(client, ZSERV_PROCESS_MESSAGES);
-	}
+		zserv_read_publish(client, cache, hdr.command);
+		/* Need to update count as main event could have processed few */
+		client_ibuf_fifo_cnt = atomic_load_explicit(&client->ibuf_count,
+							    memory_order_relaxed);
+	} else
+		stream_fifo_free(cache);
 
 	if (IS_ZEBRA_DEBUG_PACKET)
 		zlog_debug("Read %d packets from client: %s(%d). Current ibuf fifo count: %zu. Conf P2p %d",
 			   p2p_avail - p2p, zebra_route_string(client->proto), client->sock,
 			   client_ibuf_fifo_cnt, p2p_orig);
 
-	/* Reschedule ourselves since we have space in ibuf_fifo */
+	/* Reschedule ourselves since we have space in the input queue */
 	if (client_ibuf_fifo_cnt < p2p_orig)
 		zserv_client_event(client, ZSERV_CLIENT_READ);
 
+	return;
+
+zread_fail:
 	stream_fifo_free(cache);
+	zserv_client_fail(client);
+}
+
+/*
+ * Read messages from a client's shared memory ring.
+ *
+ * This is the ring counterpart of zserv_read(), subject to the same
+ * packets_to_process limit on the input queue. Messages are only ever
+ * written to the ring whole, so anything short of a complete message means
+ * the client has scribbled over the ring and is treated like a socket error.
+ *
+ * When the ring is found empty the task waits on the ring's data eventfd;
+ * the client signals it when it writes to a ring it may have seen empty.
+ * Otherwise the task is rescheduled directly, or by the main thread through
+ * zserv_client_event() once it has drained the input queue.
+ */
+static void zserv_read_ring(struct event *event)
+{
+	struct zserv *client = EVENT_ARG(event);
+	struct shmring *ring = client->ring;
+	struct stream_fifo *cache;
+	uint32_t p2p, p2p_orig;
+	int p2p_avail;
+	struct zmsghdr hdr = {};
+	ssize_t used = 0;
+
+	shmring_clear(ring, SHMRING_FD_DATA);
+
+	p2p_orig = atomic_load_explicit(&zrouter.packets_to_process,
+					memory_order_relaxed);
+	p2p_avail = p2p_orig - atomic_load_explicit(&client->ibuf_count,
+						    memory_order_relaxed);
+	if (p2p_avail <= 0)
+		return;
+
+	p2p = p2p_avail;
+	cache = stream_fifo_new();
+
+	while (p2p) {
+		struct stream *s = client->ring_work;
+		struct stream *msg;
 
+		used = shmring_used(ring);
+		if (used == 0)
+			break;
+		if (used < ZEBRA_HEADER_SIZE)
+			goto zread_fail;
+
+		/* Only the header goes through the work stream */
+		stream_reset(s);
+		shmring_peek(ring, STREAM_DATA(s), ZEBRA_HEADER_SIZE);
+		stream_set_endp(s, ZEBRA_HEADER_SIZE);
+		if (!zserv_read_header(client, s, &hdr))
+			goto zread_fail;
+		if (hdr.length > used)
+			goto zread_fail;
+
+		/* The message is copied out of the ring once, into its own stream */
+		msg = stream_new(hdr.length);
+		shmring_peek(ring, STREAM_DATA(msg), hdr.length);
+		stream_set_endp(msg, hdr.length);
+		shmring_consume(ring, hdr.length);
+
+		if (IS_ZEBRA_DEBUG_PACKET) {
+			struct vrf *vrf = vrf_lookup_by_id(hdr.vrf_id);
+
+			zlog_debug("zebra message[%s:%s:%u] comes from ring of socket [%d]",
+				   zserv_command_string(hdr.command),
+				   VRF_LOGNAME(vrf), hdr.length, client->sock);
+		}
+
+		stream_fifo_push(cache, msg);
+		p2p--;
+	}
+
+	if (p2p < (uint32_t)p2p_avail)
+		zserv_read_publish(client, cache, hdr.command);
+	else
+		stream_fifo_free(cache);
+
+	if (used == 0)
+		event_add_read(client->pthread->master, zserv_read_ring, client,
+			       shmring_fd(ring, SHMRING_FD_DATA),
+			       &client->t_ring);
+	else if (atomic_load_explicit(&client->ibuf_count,
+				      memory_order_relaxed) < p2p_orig)
+		event_add_event(client->pthread->master, zserv_read_ring,
+				client, 0, &client->t_ring);
 	return;
 
 zread_fail:
 	stream_fifo_free(cache);
+	flog_warn(EC_ZEBRA_CLIENT_IO_ERROR,
+		  "Client %d '%s' shared memory ring is corrupt", client->sock,
+		  zebra_route_string(client->proto));
 	zserv_client_fail(client);
 }
 
@@ -499,6 +744,14 @@ static void zserv_client_event(struct zserv *client,
 	case ZSERV_CLIENT_READ:
 		event_add_read(client->pthread->master, zserv_read, client,
 			       client->sock, &client->t_read);
+		/*
+		 * The ring's eventfd only fires on an empty to non-empty
+		 * transition, so look at the ring itself.
+		 */
+		if (client->ring)
+			event_add_event(client->pthread->master,
+					zserv_read_ring, client, 0,
+					&client->t_ring);
 		break;
 	case ZSERV_CLIENT_WRITE:
 		event_add_write(client->pthread->master, zserv_write, client,
@@ -510,69 +763,214 @@ static void zserv_client_event(struct zserv *client,
 /* Main thread lifecycle ---------------------------------------------------- */
 
 /*
- * Read and process messages from a client.
+ * Scheduling weight of a client. IGPs, BFD and friends send little but are
+ * latency sensitive, so they get a larger share than a client busy pushing
+ * a full table at us.
+ */
+static uint32_t zserv_sched_weight(const struct zserv *client)
+{
+	switch (client->proto) {
+	case ZEBRA_ROUTE_OSPF:
+	case ZEBRA_ROUTE_OSPF6:
+	case ZEBRA_ROUTE_ISIS:
+	case ZEBRA_ROUTE_LDP:
+	case ZEBRA_ROUTE_BFD:
+	case ZEBRA_ROUTE_VRRP:
+		return 4;
+	default:
+		return 1;
+	}
+}
+
+/*
+ * Move clients queued by client pthreads onto the active list.
+ */
+static void zserv_sched_collect(void)
+{
+	struct zserv *client;
+
+	while ((client = zserv_sched_incoming_pop(&zserv_sched_incoming))) {
+		if (client->sched_active)
+			continue;
+		client->sched_active = true;
+		client->sched_deficit = 0;
+		zserv_sched_list_add_tail(&zserv_sched_active, client);
+	}
+}
+
+/*
+ * Take a client whose input ran dry off the active list.
+ *
+ * Clearing sched_signalled lets the client pthread queue it again. That
+ * pthread publishes its input before testing the flag, and we clear the
+ * flag before looking for input, so one of the two sides always sees the
+ * other; if it is us, the client simply stays active.
+ */
+static void zserv_sched_idle(struct zserv *client)
+{
+	atomic_store_explicit(&client->sched_signalled, false,
+			      memory_order_seq_cst);
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if (zserv_ibuf_list_first(&client->ibuf_list) &&
+	    !atomic_exchange_explicit(&client->sched_signalled, true,
+				      memory_order_seq_cst)) {
+		zserv_sched_list_add_tail(&zserv_sched_active, client);
+		return;
+	}
+
+	client->sched_active = false;
+	client->sched_deficit = 0;
+}
+
+/*
+ * Take the client off the scheduler for good. The client pthread must
+ * have been stopped.
+ */
+static void zserv_sched_remove(struct zserv *client)
+{
+	struct zserv_ibuf_batch *batch;
+
+	zserv_sched_collect();
+	if (client->sched_active) {
+		zserv_sched_list_del(&zserv_sched_active, client);
+		client->sched_active = false;
+	}
+
+	if (client->ibuf_cur) {
+		stream_fifo_free(client->ibuf_cur->msgs);
+		XFREE(MTYPE_ZSERV_IBUF_BATCH, client->ibuf_cur);
+	}
+	while ((batch = zserv_ibuf_list_pop(&client->ibuf_list))) {
+		stream_fifo_free(batch->msgs);
+		XFREE(MTYPE_ZSERV_IBUF_BATCH, batch);
+	}
+	atomic_store_explicit(&client->ibuf_count, 0, memory_order_relaxed);
+}
+
+/*
+ * Process up to max queued messages from one client.
+ *
+ * Returns the number of messages processed, fewer than max only if the
+ * client has nothing more queued.
+ */
+static uint32_t zserv_process_client(struct zserv *client, uint32_t max)
+{
+	struct stream_fifo *cache = stream_fifo_new();
+	struct zserv_ibuf_batch *batch;
+	uint32_t n = 0, taken;
+	uint32_t origin = 0;
+	uint64_t wait;
+
+	while (n < max) {
+		if (!client->ibuf_cur)
+			client->ibuf_cur = zserv_ibuf_list_pop(&client->ibuf_list);
+		batch = client->ibuf_cur;
+		if (!batch)
+			break;
+
+		/* Batches are in arrival order: the first is the oldest */
+		if (!origin)
+			origin = zebra_lat_stamp_tv(&batch->queued);
+
+		taken = n;
+		while (n < max && stream_fifo_head(batch->msgs)) {
+			stream_fifo_push(cache, stream_fifo_pop(batch->msgs));
+			n++;
+		}
+
+		wait = monotime_since(&batch->queued, NULL);
+		zebra_lat_add_n(ZEBRA_LAT_ZAPI_INPUT, wait, n - taken);
+
+		if (!stream_fifo_head(batch->msgs)) {
+			client->ibuf_batches++;
+			client->ibuf_wait_last = wait;
+			client->ibuf_wait_total += wait;
+			if (wait > client->ibuf_wait_max)
+				client->ibuf_wait_max = wait;
+
+			stream_fifo_free(batch->msgs);
+			XFREE(MTYPE_ZSERV_IBUF_BATCH, client->ibuf_cur);
+		}
+	}
+
+	atomic_fetch_sub_explicit(&client->ibuf_count, n, memory_order_relaxed);
+	client->ibuf_processed += n;
+
+	/* Process the batch of messages; the routes they queue are stamped
+	 * with the time they were received.
+	 */
+	if (stream_fifo_head(cache)) {
+		zebra_lat_origin_set(origin);
+		zserv_handle_commands(client, cache);
+		zebra_lat_origin_set(0);
+	}
+
+	stream_fifo_free(cache);
+	return n;
+}
+
+/*
+ * Read and process messages from clients.
  *
  * This task runs on the main pthread. It is scheduled by client pthreads when
- * they have new messages available on their input queues. The client is passed
- * as the task argument.
+ * they have new messages available on their input queues.
  *
- * Each message is popped off the client's input queue and the action associated
- * with the message is executed. This proceeds until an error occurs, or the
- * processing limit is reached.
+ * Clients with input are served by deficit round robin: on each visit a
+ * client is credited ZSERV_SCHED_QUANTUM messages times its weight, and may
+ * have as many messages processed as it has credit. A client whose input
+ * runs dry leaves the round and forfeits its credit. One client flooding us
+ * therefore only delays the others by its quantum per round, instead of by
+ * everything it managed to queue.
  *
- * The client's I/O thread can push at most zrouter.packets_to_process messages
- * onto the input buffer before notifying us there are packets to read. As long
- * as we always process zrouter.packets_to_process messages here, then we can
- * rely on the read thread to handle queuing this task enough times to process
- * everything on the input queue.
+ * Each run processes at most zrouter.packets_to_process messages, less
+ * whatever is already waiting on the RIB meta queue, then yields to the
+ * rest of the event loop and reschedules itself if any client still has
+ * input.
  *
- * If the client ibuf always schedules a wakeup to the client IO to read more
- * items from the socked buffer. This way we ensure
+ * Every client served gets a wakeup of its I/O pthread to read more from its
+ * socket. This way we ensure
  *  - Client IO thread always tries to read the socket buffer and add more
- *    items to the ibuf_fifo (until max limit)
+ *    items to its input queue (until max limit)
  *  - the hidden config change (zebra zapi-packets <>) is taken into account.
  */
 static void zserv_process_messages(struct event *event)
 {
-	struct zserv *client = EVENT_ARG(event);
-	struct stream *msg;
-	struct stream_fifo *cache = stream_fifo_new();
-	uint32_t p2p = zrouter.packets_to_process;
-	bool need_resched = false;
+	struct zserv *client;
+	uint32_t budget = zrouter.packets_to_process;
 	uint32_t meta_queue_size = zebra_rib_meta_queue_size();
 
-	if (meta_queue_size < p2p)
-		p2p = p2p - meta_queue_size;
+	if (meta_queue_size < budget)
+		budget = budget - meta_queue_size;
 	else
-		p2p = 0;
-
-	frr_with_mutex (&client->ibuf_mtx) {
-		uint32_t i;
-		for (i = 0; i < p2p && stream_fifo_head(client->ibuf_fifo);
-		     ++i) {
-			msg = stream_fifo_pop(client->ibuf_fifo);
-			stream_fifo_push(cache, msg);
-		}
+		budget = 0;
 
-		/* Need to reschedule processing work if there are still
-		 * packets in the fifo.
-		 */
-		if (stream_fifo_head(client->ibuf_fifo))
-			need_resched = true;
-	}
+	zserv_sched_collect();
 
-	/* Process the batch of messages */
-	if (stream_fifo_head(cache))
-		zserv_handle_commands(client, cache);
+	while (budget && (client = zserv_sched_list_pop(&zserv_sched_active))) {
+		uint32_t n;
 
-	stream_fifo_free(cache);
+		client->sched_deficit +=
+			ZSERV_SCHED_QUANTUM * zserv_sched_weight(client);
+		n = zserv_process_client(client,
+					 MIN(client->sched_deficit, budget));
+		client->sched_deficit -= n;
+		budget -= n;
 
-	/* Reschedule ourselves if necessary */
-	if (need_resched)
-		zserv_event(client, ZSERV_PROCESS_MESSAGES);
+		if (zserv_ibuf_list_first(&client->ibuf_list) ||
+		    client->ibuf_cur)
+			zserv_sched_list_add_tail(&zserv_sched_active, client);
+		else
+			zserv_sched_idle(client);
 
-	/* Ensure to include the read socket in the select/poll/etc.. */
-	zserv_client_event(client, ZSERV_CLIENT_READ);
+		/* Ensure to include the read socket in the select/poll/etc.. */
+		zserv_client_event(client, ZSERV_CLIENT_READ);
+	}
+
+	/* Reschedule ourselves if necessary */
+	if (zserv_sched_list_count(&zserv_sched_active))
+		event_add_event(zrouter.master, zserv_process_messages, NULL, 0,
+				&t_zserv_sched);
 }
 
 int zserv_send_message(struct zserv *client, struct stream *msg)
@@ -584,6 +982,9 @@ int zserv_send_message(struct zserv *client, struct stream *msg)
 		return 0;
 	}
 
+	/* Anything held for redistribution goes out ahead of this */
+	redistribute_flush(client);
+
 	frr_with_mutex (&client->obuf_mtx) {
 		stream_fifo_push(client->obuf_fifo, msg);
 	}
@@ -608,6 +1009,8 @@ int zserv_send_batch(struct zserv *client, struct stream_fifo *fifo)
 		return 0;
 	}
 
+	redistribute_flush(client);
+
 	frr_with_mutex (&client->obuf_mtx) {
 		msg = stream_fifo_pop(fifo);
 		while (msg) {
@@ -680,17 +1083,17 @@ static void zserv_client_free(struct zserv *client)
 		stream_free(client->ibuf_work);
 	if (client->obuf_work)
 		stream_free(client->obuf_work);
-	if (client->ibuf_fifo)
-		stream_fifo_free(client->ibuf_fifo);
+	if (client->ring_work)
+		stream_free(client->ring_work);
 	if (client->obuf_fifo)
 		stream_fifo_free(client->obuf_fifo);
 	if (client->wb)
 		buffer_free(client->wb);
+	shmring_free(&client->ring);
 
 	/* Free buffer mutexes */
 	pthread_mutex_destroy(&client->stats_mtx);
 	pthread_mutex_destroy(&client->obuf_mtx);
-	pthread_mutex_destroy(&client->ibuf_mtx);
 
 	/* Free bitmaps. */
 	for (afi_t afi = AFI_IP; afi < AFI_MAX; afi++) {
@@ -742,7 +1145,7 @@ void zserv_close_client(struct zserv *client)
 
 		event_cancel_event(zrouter.master, client);
 		event_cancel(&client->t_cleanup);
-		event_cancel(&client->t_process);
+		zserv_sched_remove(client);
 
 		/* destroy pthread */
 		frr_pthread_destroy(client->pthread);
@@ -808,12 +1211,11 @@ static struct zserv *zserv_client_create(int sock)
 
 	/* Make client input/output buffer. */
 	client->sock = sock;
-	client->ibuf_fifo = stream_fifo_new();
+	zserv_ibuf_list_init(&client->ibuf_list);
 	client->obuf_fifo = stream_fifo_new();
 	client->ibuf_work = stream_new(stream_size);
 	client->obuf_work = stream_new(stream_size);
 	client->connect_time = monotime(NULL);
-	pthread_mutex_init(&client->ibuf_mtx, NULL);
 	pthread_mutex_init(&client->obuf_mtx, NULL);
 	pthread_mutex_init(&client->stats_mtx, NULL);
 	client->wb = buffer_new(0);
@@ -1058,8 +1460,14 @@ void zserv_event(struct zserv *client, enum zserv_event event)
 		event_add_read(zrouter.master, zserv_accept, NULL, zsock, NULL);
 		break;
 	case ZSERV_PROCESS_MESSAGES:
-		event_add_event(zrouter.master, zserv_process_messages, client,
-				0, &client->t_process);
+		/* Queue the client unless it is already queued or active */
+		atomic_thread_fence(memory_order_seq_cst);
+		if (!atomic_exchange_explicit(&client->sched_signalled, true,
+					      memory_order_seq_cst))
+			zserv_sched_incoming_add_tail(&zserv_sched_incoming,
+						      client);
+		event_add_event(zrouter.master, zserv_process_messages, NULL,
+				0, &t_zserv_sched);
 		break;
 	case ZSERV_HANDLE_CLIENT_FAIL:
 		event_add_event(zrouter.master, zserv_handle_client_fail,
@@ -1108,6 +1516,7 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client, json
 	json_object *json_connected;
 	json_object *json_gr_info;
 	json_object *json_fifo;
+	json_object *json_sched;
 
 	frr_with_mutex (&client->stats_mtx) {
 		connect_time = client->connect_time;
@@ -1187,6 +1596,10 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client, json
 		json_object_int_add(json_redistv6, "add", client->redist_v6_add_cnt);
 		json_object_int_add(json_redistv6, "delete", client->redist_v6_del_cnt);
 		json_object_object_add(json_client, "redistV6", json_redistv6);
+		json_object_int_add(json_client, "redistBatches",
+				    client->redist_batch_cnt);
+		json_object_int_add(json_client, "redistCoalesced",
+				    client->redist_coalesced_cnt);
 
 		/* Nexthop groups */
 		json_nhg = json_object_new_object();
@@ -1340,12 +1753,33 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client, json
 
 		/* FIFO queues */
 		json_fifo = json_object_new_object();
-		json_object_int_add(json_fifo, "inputCount", client->ibuf_fifo->count);
-		json_object_int_add(json_fifo, "inputMaxCount", client->ibuf_fifo->max_count);
+		json_object_int_add(json_fifo, "inputCount",
+				    atomic_load_explicit(&client->ibuf_count,
+							 memory_order_relaxed));
+		json_object_int_add(json_fifo, "inputMaxCount", client->ibuf_max_count);
 		json_object_int_add(json_fifo, "outputCount", client->obuf_fifo->count);
 		json_object_int_add(json_fifo, "outputMaxCount", client->obuf_fifo->max_count);
 		json_object_object_add(json_client, "fifo", json_fifo);
 
+		/* Input scheduling */
+		json_sched = json_object_new_object();
+		json_object_int_add(json_sched, "weight",
+				    zserv_sched_weight(client));
+		json_object_int_add(json_sched, "processed",
+				    client->ibuf_processed);
+		json_object_int_add(json_sched, "batches", client->ibuf_batches);
+		json_object_int_add(json_sched, "queueLatencyLastUsec",
+				    client->ibuf_wait_last);
+		json_object_int_add(json_sched, "queueLatencyMaxUsec",
+				    client->ibuf_wait_max);
+		json_object_int_add(json_sched, "queueLatencyAvgUsec",
+				    client->ibuf_batches
+					    ? client->ibuf_wait_total /
+						      client->ibuf_batches
+					    : 0);
+		json_object_object_add(json_client, "inputScheduling",
+				       json_sched);
+
 		/* Add this client to the JSON array */
 		json_object_array_add(json, json_client);
 	} else {
@@ -1425,6 +1859,8 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client, json
 			client->local_es_del_cnt);
 		vty_out(vty, "ES-EVI      %-12u%-12u%-12u\n", client->local_es_evi_add_cnt, 0,
 			client->local_es_evi_del_cnt);
+		vty_out(vty, "Redist batches: %u, coalesced: %u\n",
+			client->redist_batch_cnt, client->redist_coalesced_cnt);
 		vty_out(vty, "Errors: %u\n", client->error_cnt);
 
 		TAILQ_FOREACH (info, &client->gr_info_queue, gr_info) {
@@ -1464,9 +1900,23 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client, json
 			}
 		}
 
-		vty_out(vty, "Input Fifo: %zu:%zu Output Fifo: %zu:%zu\n",
-			client->ibuf_fifo->count, client->ibuf_fifo->max_count,
-			client->obuf_fifo->count, client->obuf_fifo->max_count);
+		vty_out(vty, "Input Fifo: %u:%u Output Fifo: %zu:%zu\n",
+			atomic_load_explicit(&client->ibuf_count,
+					     memory_order_relaxed),
+			client->ibuf_max_count, client->obuf_fifo->count,
+			client->obuf_fifo->max_count);
+		vty_out(vty,
+			"Input Scheduling: weight %u, %" PRIu64
+			" processed in %" PRIu64 " batches\n",
+			zserv_sched_weight(client), client->ibuf_processed,
+			client->ibuf_batches);
+		vty_out(vty,
+			"Input Queue Latency (usec): last %" PRIu64
+			" max %" PRIu64 " avg %" PRIu64 "\n",
+			client->ibuf_wait_last, client->ibuf_wait_max,
+			client->ibuf_batches
+				? client->ibuf_wait_total / client->ibuf_batches
+				: 0);
 
 		vty_out(vty, "\n");
 	}
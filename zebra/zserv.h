@@ -23,6 +23,7 @@
 #include "lib/linklist.h"     /* for list */
 #include "lib/workqueue.h"    /* for work_queue */
 #include "lib/hook.h"         /* for DECLARE_HOOK, DECLARE_KOOH */
+#include "lib/atomlist.h"     /* for PREDECL_ATOMLIST */
 /* clang-format on */
 
 #ifdef __cplusplus
@@ -30,6 +31,7 @@ extern "C" {
 #endif
 
 struct zebra_vrf;
+struct shmring;
 
 /* Default configuration filename. */
 #define DEFAULT_CONFIG_FILE "zebra.conf"
@@ -37,11 +39,15 @@ struct zebra_vrf;
 #define ZEBRA_RMAP_DEFAULT_UPDATE_TIMER 5 /* disabled by default */
 
 
-/* Stale route marker timer */
-#define ZEBRA_DEFAULT_STALE_UPDATE_DELAY 1
-
-/* Count of stale routes processed in timer context */
-#define ZEBRA_MAX_STALE_ROUTE_COUNT 50000
+/*
+ * Stale route sweep pacing: each pass runs for at most this long, then
+ * yields. The next pass follows right away unless the meta queue already
+ * holds more than ZEBRA_GR_SWEEP_MQ_LIMIT entries, in which case it waits
+ * ZEBRA_GR_SWEEP_BACKOFF_MSEC for the RIB to catch up.
+ */
+#define ZEBRA_GR_SWEEP_BUDGET_USEC  10000
+#define ZEBRA_GR_SWEEP_MQ_LIMIT	    20000
+#define ZEBRA_GR_SWEEP_BACKOFF_MSEC 50
 
 /* Graceful Restart information */
 struct client_gr_info {
@@ -74,6 +80,13 @@ struct client_gr_info {
 PREDECL_LIST(zserv_client_list);
 PREDECL_LIST(zserv_stale_client_list);
 
+/* For handing input to the main pthread and scheduling its processing */
+PREDECL_ATOMLIST(zserv_ibuf_list);
+PREDECL_ATOMLIST(zserv_sched_incoming);
+PREDECL_DLIST(zserv_sched_list);
+struct zserv_ibuf_batch;
+struct redist_batch;
+
 /* Client structure. */
 struct zserv {
 	/* Client pthread */
@@ -96,9 +109,18 @@ struct zserv {
 	/* For managing this node in the stale client list */
 	struct zserv_stale_client_list_item stale_client_list_entry;
 
-	/* Input/output buffer to the client. */
-	pthread_mutex_t ibuf_mtx;
-	struct stream_fifo *ibuf_fifo;
+	/*
+	 * Input from the client pthread, in batches handed over without
+	 * locking. ibuf_count is the number of messages queued, written by
+	 * both sides; ibuf_max_count is its high-water mark.
+	 */
+	struct zserv_ibuf_list_head ibuf_list;
+	_Atomic uint32_t ibuf_count;
+	uint32_t ibuf_max_count;
+	/* Batch the main pthread is working through */
+	struct zserv_ibuf_batch *ibuf_cur;
+
+	/* Output buffer to the client. */
 	pthread_mutex_t obuf_mtx;
 	struct stream_fifo *obuf_fifo;
 
@@ -113,8 +135,35 @@ struct zserv {
 	struct event *t_read;
 	struct event *t_write;
 
-	/* Event for message processing, for the main pthread */
-	struct event *t_process;
+	/*
+	 * Shared memory ring the client writes its messages into, if it
+	 * passed one with its HELLO; owned by the client pthread.
+	 */
+	struct shmring *ring;
+	struct event *t_ring;
+	/* Header buffer for the ring, apart from the socket's ibuf_work */
+	struct stream *ring_work;
+	/* Set once the first message has been read from the socket */
+	bool first_read;
+
+	/*
+	 * Input scheduling on the main pthread, see zserv_process_messages().
+	 * sched_signalled is set by the client pthread when it queues the
+	 * client for processing and cleared by the main pthread once the
+	 * client's input has run dry.
+	 */
+	struct zserv_sched_incoming_item sched_incoming_entry;
+	struct zserv_sched_list_item sched_entry;
+	atomic_bool sched_signalled;
+	bool sched_active;
+	uint32_t sched_deficit;
+
+	/* Input statistics, main pthread only */
+	uint64_t ibuf_processed;
+	uint64_t ibuf_batches;
+	uint64_t ibuf_wait_last;
+	uint64_t ibuf_wait_max;
+	uint64_t ibuf_wait_total;
 
 	/* Event for the main pthread */
 	struct event *t_cleanup;
@@ -123,6 +172,9 @@ struct zserv {
 	struct redist_proto mi_redist[AFI_MAX][ZEBRA_ROUTE_MAX];
 	vrf_bitmap_t redist[AFI_MAX][ZEBRA_ROUTE_MAX];
 
+	/* Redistribution messages held for batching, see redistribute.c */
+	struct redist_batch *redist_batch;
+
 	/* Redistribute default route flag. */
 	vrf_bitmap_t redist_default[AFI_MAX];
 
@@ -154,6 +206,8 @@ struct zserv {
 	uint32_t redist_v4_del_cnt;
 	uint32_t redist_v6_add_cnt;
 	uint32_t redist_v6_del_cnt;
+	uint32_t redist_batch_cnt;
+	uint32_t redist_coalesced_cnt;
 	uint32_t v4_route_add_cnt;
 	uint32_t v4_route_upd8_cnt;
 	uint32_t v4_route_del_cnt;